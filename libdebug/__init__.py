@@ -1,4 +1,4 @@
-from .libdebug import debugger
+from .libdebug import debugger, lockstep
 from .utils.libcontext import libcontext
 
 try:
@@ -8,4 +8,4 @@ except ImportError:
 else:
     install()
 
-__all__ = ["debugger", "libcontext"]
+__all__ = ["debugger", "libcontext", "lockstep"]
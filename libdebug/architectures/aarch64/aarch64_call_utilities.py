@@ -36,3 +36,43 @@ class Aarch64CallUtilities(CallUtilitiesManager):
         """Check if the current instruction is a call instruction and compute the instruction size."""
         skip = self.compute_call_skip(opcode_window)
         return skip != 0, skip
+
+    def get_return_instructions(self: Aarch64CallUtilities, code: bytes, address: int) -> list[int]:
+        """Find the addresses of the return instructions in the code of a function starting at the given address."""
+        returns = []
+
+        # Instructions are fixed-size and aligned, no need for a disassembler
+        for offset in range(0, len(code) - 3, 4):
+            instruction = int.from_bytes(code[offset : offset + 4], "little")
+
+            # RET Xn, RETAA and RETAB
+            if (instruction & 0xFFFFFC1F) == 0xD65F0000 or instruction in (0xD65F0BFF, 0xD65F0FFF):
+                returns.append(address + offset)
+
+        return returns
+
+    def find_syscall_instruction(self: Aarch64CallUtilities, code: bytes, address: int) -> int | None:
+        """Find the address of a syscall instruction in the code starting at the given address, if any."""
+        for offset in range(0, len(code) - 3, 4):
+            # SVC #0
+            if int.from_bytes(code[offset : offset + 4], "little") == 0xD4000001:
+                return address + offset
+
+        return None
+
+    def get_return_trap(self: Aarch64CallUtilities) -> bytes:
+        """Returns the instruction that traps the return from a function called in the process."""
+        # BRK #0
+        return (0xD4200000).to_bytes(4, "little")
+
+    def get_syscall_stub(self: Aarch64CallUtilities, number: int) -> bytes:
+        """Returns the code of a function that executes the specified syscall with its arguments and returns."""
+        # MOV X8, #number; SVC #0; RET
+        instructions = (0xD2800008 | (number << 5), 0xD4000001, 0xD65F03C0)
+
+        return b"".join(instruction.to_bytes(4, "little") for instruction in instructions)
+
+    def get_canary_offset(self: Aarch64CallUtilities, code: bytes, address: int) -> int:
+        """Find the offset of the stack canary slot w.r.t. the return address slot in the prologue of a function."""
+        # The canary is loaded from __stack_chk_guard through the GOT, its slot cannot be tracked reliably
+        return 0
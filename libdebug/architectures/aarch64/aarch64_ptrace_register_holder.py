@@ -8,10 +8,11 @@ from __future__ import annotations
 
 import sys
 from dataclasses import dataclass
+from threading import get_ident
 from typing import TYPE_CHECKING
 
 from libdebug.architectures.aarch64.aarch64_registers import Aarch64Registers
-from libdebug.ptrace.ptrace_register_holder import PtraceRegisterHolder
+from libdebug.ptrace.ptrace_register_holder import PtraceRegisterHolder, register_file_view, register_index
 
 if TYPE_CHECKING:
     from libdebug.state.thread_context import ThreadContext
@@ -20,27 +21,39 @@ AARCH64_GP_REGS = ["x", "w"]
 
 
 def _get_property_64(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Aarch64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index]
 
     def setter(self: Aarch64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        setattr(self.register_file, name, value)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        self._register_view[index] = value
 
     return property(getter, setter, None, name)
 
 
 def _get_property_32(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Aarch64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name) & 0xFFFFFFFF
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index] & 0xFFFFFFFF
 
     # https://developer.arm.com/documentation/102374/0101/Registers-in-AArch64---general-purpose-registers
     # When a W register is written the top 32 bits of the 64-bit register are zeroed.
     def setter(self: Aarch64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        return setattr(self.register_file, name, value & 0xFFFFFFFF)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        self._register_view[index] = value & 0xFFFFFFFF
 
     return property(getter, setter, None, name)
 
@@ -159,6 +172,7 @@ class Aarch64PtraceRegisterHolder(PtraceRegisterHolder):
     def apply_on_regs(self: Aarch64PtraceRegisterHolder, target: Aarch64Registers, target_class: type) -> None:
         """Apply the register accessors to the Aarch64Registers class."""
         target.register_file = self.register_file
+        target._register_view = register_file_view(self.register_file)
         target._fp_register_file = self.fp_register_file
 
         if hasattr(target_class, "w0"):
@@ -197,6 +211,7 @@ class Aarch64PtraceRegisterHolder(PtraceRegisterHolder):
     def apply_on_thread(self: Aarch64PtraceRegisterHolder, target: ThreadContext, target_class: type) -> None:
         """Apply the register accessors to the thread class."""
         target.register_file = self.register_file
+        target._register_view = target.regs._register_view
 
         # If the accessors are already defined, we don't need to redefine them
         if hasattr(target_class, "instruction_pointer"):
@@ -6,8 +6,20 @@
 
 from __future__ import annotations
 
+import re
+
+from capstone import CS_ARCH_X86, CS_MODE_64, Cs
+
 from libdebug.architectures.call_utilities_manager import CallUtilitiesManager
 
+# The canary is loaded from the TCB, then stored in the frame
+CANARY_LOAD = re.compile(r"^(\w+), qword ptr fs:\[0x28\]$")
+CANARY_STORE = re.compile(r"^qword ptr \[(rbp|rsp)(?: ([+-]) (0x[0-9a-f]+|\d+))?\], (\w+)$")
+STACK_ALLOCATION = re.compile(r"^rsp, (0x[0-9a-f]+|\d+)$")
+
+# The canary is stored in the prologue, there is no need to look further
+CANARY_PROLOGUE_LENGTH = 64
+
 
 class Amd64CallUtilities(CallUtilitiesManager):
     """Class that provides call utilities for the x86_64 architecture."""
@@ -63,3 +75,68 @@ class Amd64CallUtilities(CallUtilitiesManager):
         """Check if the current instruction is a call instruction and compute the instruction size."""
         skip = self.compute_call_skip(opcode_window)
         return skip != 0, skip
+
+    def get_return_instructions(self: Amd64CallUtilities, code: bytes, address: int) -> list[int]:
+        """Find the addresses of the return instructions in the code of a function starting at the given address."""
+        disassembler = Cs(CS_ARCH_X86, CS_MODE_64)
+
+        # Prefixed returns (e.g., "bnd ret" or "repz ret") are trapped on the prefix
+        return [
+            instruction.address
+            for instruction in disassembler.disasm(code, address)
+            if "ret" in instruction.mnemonic.split()
+        ]
+
+    def get_canary_offset(self: Amd64CallUtilities, code: bytes, address: int) -> int:
+        """Find the offset of the stack canary slot w.r.t. the return address slot in the prologue of a function."""
+        disassembler = Cs(CS_ARCH_X86, CS_MODE_64)
+
+        # Track the stack pointer (and the frame pointer) relative to the return address slot
+        stack_pointer, frame_pointer, canary_register = 0, None, None
+
+        for instruction in disassembler.disasm(code[:CANARY_PROLOGUE_LENGTH], address):
+            mnemonic, operands = instruction.mnemonic, instruction.op_str
+
+            if mnemonic == "push":
+                stack_pointer -= 8
+            elif mnemonic == "sub" and (match := STACK_ALLOCATION.match(operands)):
+                stack_pointer -= int(match.group(1), 0)
+            elif mnemonic == "mov" and operands == "rbp, rsp":
+                frame_pointer = stack_pointer
+            elif mnemonic == "mov" and (match := CANARY_LOAD.match(operands)):
+                canary_register = match.group(1)
+            elif mnemonic == "mov" and canary_register and (match := CANARY_STORE.match(operands)):
+                base, sign, displacement, register = match.groups()
+
+                if register != canary_register:
+                    continue
+
+                displacement = int(displacement, 0) if displacement else 0
+                displacement = -displacement if sign == "-" else displacement
+
+                if base == "rsp":
+                    return stack_pointer + displacement
+
+                return frame_pointer + displacement if frame_pointer is not None else 0
+            elif mnemonic in ("call", "jmp") or "ret" in mnemonic.split():
+                # We left the prologue
+                break
+
+        return 0
+
+    def find_syscall_instruction(self: Amd64CallUtilities, code: bytes, address: int) -> int | None:
+        """Find the address of a syscall instruction in the code starting at the given address, if any."""
+        # Any occurrence of the opcode is executable as a syscall, even in the middle of another instruction
+        offset = code.find(b"\x0f\x05")
+
+        return address + offset if offset != -1 else None
+
+    def get_return_trap(self: Amd64CallUtilities) -> bytes:
+        """Returns the instruction that traps the return from a function called in the process."""
+        # int3
+        return b"\xcc"
+
+    def get_syscall_stub(self: Amd64CallUtilities, number: int) -> bytes:
+        """Returns the code of a function that executes the specified syscall with its arguments and returns."""
+        # mov eax, number; syscall; ret
+        return b"\xb8" + number.to_bytes(4, "little") + b"\x0f\x05\xc3"
@@ -7,10 +7,11 @@
 from __future__ import annotations
 
 from dataclasses import dataclass
+from threading import get_ident
 from typing import TYPE_CHECKING
 
 from libdebug.architectures.amd64.amd64_registers import Amd64Registers
-from libdebug.ptrace.ptrace_register_holder import PtraceRegisterHolder
+from libdebug.ptrace.ptrace_register_holder import PtraceRegisterHolder, register_file_view, register_index
 
 if TYPE_CHECKING:
     from libdebug.state.thread_context import ThreadContext
@@ -53,64 +54,94 @@ AMD64_REGS = [
 
 
 def _get_property_64(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Amd64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index]
 
     def setter(self: Amd64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        setattr(self.register_file, name, value)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        self._register_view[index] = value
 
     return property(getter, setter, None, name)
 
 
 def _get_property_32(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Amd64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name) & 0xFFFFFFFF
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index] & 0xFFFFFFFF
 
     def setter(self: Amd64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        return setattr(self.register_file, name, value & 0xFFFFFFFF)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        self._register_view[index] = value & 0xFFFFFFFF
 
     return property(getter, setter, None, name)
 
 
 def _get_property_16(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Amd64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name) & 0xFFFF
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index] & 0xFFFF
 
     def setter(self: Amd64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        value = getattr(self.register_file, name) & ~0xFFFF | (value & 0xFFFF)
-        setattr(self.register_file, name, value)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        view = self._register_view
+        view[index] = view[index] & ~0xFFFF | (value & 0xFFFF)
 
     return property(getter, setter, None, name)
 
 
 def _get_property_8l(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Amd64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name) & 0xFF
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index] & 0xFF
 
     def setter(self: Amd64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        value = getattr(self.register_file, name) & ~0xFF | (value & 0xFF)
-        setattr(self.register_file, name, value)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        view = self._register_view
+        view[index] = view[index] & ~0xFF | (value & 0xFF)
 
     return property(getter, setter, None, name)
 
 
 def _get_property_8h(name: str) -> property:
+    index = register_index(name)
+
     def getter(self: Amd64Registers) -> int:
-        self._internal_debugger._ensure_process_stopped()
-        return getattr(self.register_file, name) >> 8 & 0xFF
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        return self._register_view[index] >> 8 & 0xFF
 
     def setter(self: Amd64Registers, value: int) -> None:
-        self._internal_debugger._ensure_process_stopped()
-        value = getattr(self.register_file, name) & ~0xFF00 | (value & 0xFF) << 8
-        setattr(self.register_file, name, value)
+        internal_debugger = self._internal_debugger
+        if internal_debugger._is_running and get_ident() != internal_debugger._polling_thread_ident:
+            internal_debugger._ensure_process_stopped()
+        view = self._register_view
+        view[index] = view[index] & ~0xFF00 | (value & 0xFF) << 8
 
     return property(getter, setter, None, name)
 
@@ -240,6 +271,7 @@ class Amd64PtraceRegisterHolder(PtraceRegisterHolder):
     def apply_on_regs(self: Amd64PtraceRegisterHolder, target: Amd64Registers, target_class: type) -> None:
         """Apply the register accessors to the Amd64Registers class."""
         target.register_file = self.register_file
+        target._register_view = register_file_view(self.register_file)
         target._fp_register_file = self.fp_register_file
 
         # If the accessors are already defined, we don't need to redefine them
@@ -302,6 +334,7 @@ class Amd64PtraceRegisterHolder(PtraceRegisterHolder):
     def apply_on_thread(self: Amd64PtraceRegisterHolder, target: ThreadContext, target_class: type) -> None:
         """Apply the register accessors to the thread class."""
         target.register_file = self.register_file
+        target._register_view = target.regs._register_view
 
         # If the accessors are already defined, we don't need to redefine them
         if hasattr(target_class, "instruction_pointer"):
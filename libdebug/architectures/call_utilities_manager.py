@@ -21,4 +21,27 @@ class CallUtilitiesManager(ABC):
 
     @abstractmethod
     def get_call_and_skip_amount(self, opcode_window: bytes) -> tuple[bool, int]:
-        """Check if the current instruction is a call instruction and compute the instruction size."""
\ No newline at end of file
+        """Check if the current instruction is a call instruction and compute the instruction size."""
+
+    @abstractmethod
+    def get_return_instructions(self: CallUtilitiesManager, code: bytes, address: int) -> list[int]:
+        """Find the addresses of the return instructions in the code of a function starting at the given address."""
+
+    @abstractmethod
+    def get_canary_offset(self: CallUtilitiesManager, code: bytes, address: int) -> int:
+        """Find the offset of the stack canary slot w.r.t. the return address slot in the prologue of a function.
+
+        Returns 0 if the function does not store a stack canary in its frame, or if the offset cannot be determined.
+        """
+
+    @abstractmethod
+    def find_syscall_instruction(self: CallUtilitiesManager, code: bytes, address: int) -> int | None:
+        """Find the address of a syscall instruction in the code starting at the given address, if any."""
+
+    @abstractmethod
+    def get_return_trap(self: CallUtilitiesManager) -> bytes:
+        """Returns the instruction that traps the return from a function called in the process."""
+
+    @abstractmethod
+    def get_syscall_stub(self: CallUtilitiesManager, number: int) -> bytes:
+        """Returns the code of a function that executes the specified syscall with its arguments and returns."""
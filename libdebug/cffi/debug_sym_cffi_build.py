@@ -6,6 +6,9 @@
 
 # TODO: add support for libdwarf-0
 
+import runpy
+from pathlib import Path
+
 from cffi import FFI
 
 ffibuilder = FFI()
@@ -16,29 +19,101 @@ ffibuilder.cdef(
     {
         char *name;
         unsigned long long high_pc;
-        unsigned long low_pc;
+        unsigned long long low_pc;
         struct SymbolInfo *next;
     } SymbolInfo;
 
+    typedef struct TypeInfo
+    {
+        unsigned long long offset;
+        unsigned long long type;
+        unsigned long long parent;
+        char *name;
+        unsigned long long size;
+        long long value;
+        int tag;
+        int encoding;
+        int bit_size;
+        int bit_offset;
+        int declaration;
+        struct TypeInfo *next;
+    } TypeInfo;
+
+    typedef struct LocationOp
+    {
+        unsigned char atom;
+        unsigned long long op1;
+        unsigned long long op2;
+        unsigned long long offset;
+    } LocationOp;
+
+    typedef struct LocationInfo
+    {
+        unsigned long long low_pc;
+        unsigned long long high_pc;
+        int op_count;
+        LocationOp *ops;
+        struct LocationInfo *next;
+    } LocationInfo;
+
+    typedef struct VariableInfo
+    {
+        char *name;
+        unsigned long long type;
+        unsigned long long low_pc;
+        unsigned long long high_pc;
+        int is_parameter;
+        LocationInfo *locations;
+        struct VariableInfo *next;
+    } VariableInfo;
+
+    typedef struct FunctionInfo
+    {
+        char *name;
+        unsigned long long low_pc;
+        unsigned long long high_pc;
+        LocationInfo *frame_base;
+        VariableInfo *variables;
+        struct FunctionInfo *next;
+    } FunctionInfo;
+
+    typedef struct CfaInfo
+    {
+        unsigned long long low_pc;
+        unsigned long long high_pc;
+        int reg;
+        long long offset;
+        struct CfaInfo *next;
+    } CfaInfo;
+
     SymbolInfo* collect_external_symbols(const char *debug_file_path, int debug_info_level);
     SymbolInfo* read_elf_info(const char *elf_file_path, int debug_info_level);
     char *get_build_id();
     char *get_debug_file();
+    int get_dwarf_index();
+    SymbolInfo* lookup_dwarf_symbol(const char *elf_file_path, const char *name);
+    SymbolInfo* collect_dwarf_symbols(const char *elf_file_path);
     void free_symbol_info(SymbolInfo *head);
+    TypeInfo* collect_types(const char *elf_file_path);
+    void free_type_info(TypeInfo *head);
+    FunctionInfo* collect_functions(const char *elf_file_path);
+    void free_function_info(FunctionInfo *head);
+    CfaInfo* collect_cfa_rules(const char *elf_file_path);
+    void free_cfa_info(CfaInfo *head);
 """
 )
 
-with open("libdebug/cffi/debug_sym_cffi_source.c", "r") as f:
-    ffibuilder.set_source(
-        "libdebug.cffi.debug_sym_cffi",
-        f.read(),
-        libraries=["elf", "dwarf", "iberty"],
-        include_dirs=[
-            "/usr/include/libdwarf/libdwarf-0",
-            "/usr/include/libdwarf-0",
-            "/usr/include/libiberty",
-        ],
-    )
+# The reader is built into libdebug-core, which the module links to
+runpy.run_path("libdebug/core/build_core.py")["build_library"](Path("libdebug/core"))
+
+ffibuilder.set_source(
+    "libdebug.cffi.debug_sym_cffi",
+    '#include "debug_sym_cffi_source.h"',
+    include_dirs=["libdebug/cffi"],
+    libraries=["debug-core"],
+    library_dirs=["libdebug/core"],
+    extra_link_args=["-Wl,-rpath,$ORIGIN/../core"],
+)
 
 if __name__ == "__main__":
     ffibuilder.compile(verbose=True)
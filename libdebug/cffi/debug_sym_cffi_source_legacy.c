@@ -4,24 +4,20 @@
 // Licensed under the MIT license. See LICENSE file in the project root for details.
 //
 
+#include <ctype.h>
 #include <demangle.h>
 #include <fcntl.h>
 #include <gelf.h>
 #include <libdwarf/dwarf.h>
 #include <libdwarf/libdwarf.h>
 #include <libelf.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
-typedef struct SymbolInfo
-{
-    char *name;
-    unsigned long long high_pc;
-    unsigned long long low_pc;
-    struct SymbolInfo *next;
-} SymbolInfo;
+#include "debug_sym_cffi_source.h"
 
 void process_symbol_tables(Elf *elf);
 
@@ -38,9 +34,9 @@ SymbolInfo *add_symbol_info(SymbolInfo **head, const char *name, Dwarf_Addr low_
     return new_node;
 }
 
-SymbolInfo *head = NULL;
-char *build_id = NULL;
-char *debug_file = NULL;
+static SymbolInfo *head = NULL;
+static char *build_id = NULL;
+static char *debug_file = NULL;
 
 // Function to free the linked list
 void free_symbol_info(SymbolInfo *head)
@@ -182,11 +178,224 @@ void retrieve_from_dwarf(int fd)
     dwarf_finish(dbg, &err);
 }
 
-// Function to collect external symbols from the debug file
-SymbolInfo *collect_external_symbols(const char *debug_file_path, int debug_info_level)
+static int dwarf_index = 0;
+
+// Function to get whether the last file read has a DWARF name index
+int get_dwarf_index()
+{
+    return dwarf_index;
+}
+
+// Function to find the data of a debug section, decompressing it if needed
+Elf_Data *find_debug_section(Elf *elf, const char *section_name)
+{
+    Elf_Scn *section = NULL;
+    GElf_Ehdr ehdr;
+    GElf_Shdr shdr;
+
+    if (!gelf_getehdr(elf, &ehdr)) {
+        return NULL;
+    }
+
+    while ((section = elf_nextscn(elf, section)) != NULL) {
+        if (!gelf_getshdr(section, &shdr)) {
+            continue;
+        }
+
+        char *name = elf_strptr(elf, ehdr.e_shstrndx, shdr.sh_name);
+        if (!name || strcmp(name, section_name) != 0) {
+            continue;
+        }
+
+        if (shdr.sh_type == SHT_NOBITS) {
+            return NULL;
+        }
+
+        if ((shdr.sh_flags & SHF_COMPRESSED) && elf_compress(section, 0, 0) < 0) {
+            return NULL;
+        }
+
+        Elf_Data *data = elf_getdata(section, NULL);
+        return data && data->d_buf && data->d_size ? data : NULL;
+    }
+
+    return NULL;
+}
+
+// Function to check whether the ELF file has a .gdb_index name index
+int has_dwarf_index(Elf *elf)
+{
+    return find_debug_section(elf, ".gdb_index") != NULL;
+}
+
+// Function to read a little-endian value of an index, advancing the cursor
+int read_index_value(const unsigned char **cursor, const unsigned char *end, int size, uint64_t *value)
+{
+    if (end - *cursor < size) {
+        return -1;
+    }
+
+    *value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+        *value = (*value << 8) | (*cursor)[i];
+    }
+
+    *cursor += size;
+    return 0;
+}
+
+// Function to append an offset to a growing list of offsets
+void append_index_offset(uint64_t **offsets, int *count, uint64_t offset)
+{
+    if (*count % 16 == 0) {
+        uint64_t *grown = realloc(*offsets, (*count + 16) * sizeof(uint64_t));
+        if (!grown) {
+            return;
+        }
+        *offsets = grown;
+    }
+
+    (*offsets)[(*count)++] = offset;
+}
+
+// Function to hash a name as in the symbol table of .gdb_index
+uint32_t gdb_index_hash(const char *name, uint32_t version)
+{
+    uint32_t hash = 0;
+    unsigned char c;
+
+    while ((c = *name++) != 0) {
+        if (version >= 5) {
+            c = tolower(c);
+        }
+        hash = hash * 67 + c - 113;
+    }
+
+    return hash;
+}
+
+// Function to look up a name in .gdb_index, collecting the offsets of the compilation units that define it.
+// Returns the number of units, or -1 if the index cannot be read
+int lookup_gdb_index(Elf_Data *data, const char *name, uint64_t **cu_offsets)
+{
+    const unsigned char *start = data->d_buf, *end = start + data->d_size, *cursor = start;
+    uint64_t header[7], cu_count, slot_count, name_offset, vector_offset, entry_count, entry;
+    int count = 0, header_size;
+
+    if (read_index_value(&cursor, end, 4, &header[0]) || header[0] < 5 || header[0] > 9) {
+        return -1;
+    }
+
+    // The version 9 adds the offset of the shortcut table before the one of the constant pool
+    header_size = header[0] >= 9 ? 7 : 6;
+    for (int i = 1; i < header_size; i++) {
+        if (read_index_value(&cursor, end, 4, &header[i]) || header[i] > data->d_size) {
+            return -1;
+        }
+    }
+
+    const unsigned char *pool = start + header[header_size - 1];
+    cu_count = (header[2] - header[1]) / 16;
+    slot_count = (header[5] - header[4]) / 8;
+
+    // The symbol table is an open addressing hash table, with a power of two slots
+    if (header[2] < header[1] || header[5] < header[4] || !slot_count || slot_count & (slot_count - 1)) {
+        return -1;
+    }
+
+    uint32_t hash = gdb_index_hash(name, header[0]);
+    uint64_t slot = hash & (slot_count - 1), step = ((hash * 17) & (slot_count - 1)) | 1;
+
+    for (uint64_t probes = 0; probes < slot_count; probes++, slot = (slot + step) & (slot_count - 1)) {
+        cursor = start + header[4] + slot * 8;
+        read_index_value(&cursor, end, 4, &name_offset);
+        read_index_value(&cursor, end, 4, &vector_offset);
+
+        if (!name_offset && !vector_offset) {
+            break;
+        }
+
+        if (name_offset >= (uint64_t)(end - pool) ||
+            strncmp((const char *)pool + name_offset, name, end - pool - name_offset)) {
+            continue;
+        }
+
+        // The vector lists the units of the name, the type units come after the compilation units
+        cursor = pool + vector_offset;
+        if (vector_offset >= (uint64_t)(end - pool) || read_index_value(&cursor, end, 4, &entry_count)) {
+            return -1;
+        }
+
+        for (uint64_t i = 0; i < entry_count && !read_index_value(&cursor, end, 4, &entry); i++) {
+            const unsigned char *cu_entry = start + header[1] + (entry & 0xffffff) * 16;
+            uint64_t cu_offset;
+
+            if ((entry & 0xffffff) < cu_count && !read_index_value(&cu_entry, end, 8, &cu_offset)) {
+                append_index_offset(cu_offsets, &count, cu_offset);
+            }
+        }
+        break;
+    }
+
+    return count;
+}
+
+// Function to add the symbol of a DIE found through a name index, if it has the looked up name
+void process_named_die(Dwarf_Debug dbg, Dwarf_Die die, const char *name)
+{
+    Dwarf_Error err;
+    char *die_name = 0;
+
+    if (dwarf_diename(die, &die_name, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    if (strcmp(die_name, name) == 0) {
+        process_die(dbg, die);
+    }
+    dwarf_dealloc(dbg, die_name, DW_DLA_STRING);
+}
+
+// Function to add the symbols with the looked up name among the top-level DIEs of a compilation unit
+void process_named_cu(Dwarf_Debug dbg, Dwarf_Off cu_offset, const char *name)
+{
+    Dwarf_Error err;
+    Dwarf_Off cu_die_offset;
+    Dwarf_Die cu_die, child_die, sibling_die;
+
+    if (dwarf_get_cu_die_offset_given_cu_header_offset(dbg, cu_offset, &cu_die_offset, &err) != DW_DLV_OK ||
+        dwarf_offdie_b(dbg, cu_die_offset, 1, &cu_die, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    if (dwarf_child(cu_die, &child_die, &err) == DW_DLV_OK) {
+        while (1) {
+            process_named_die(dbg, child_die, name);
+
+            int ret = dwarf_siblingof(dbg, child_die, &sibling_die, &err);
+            dwarf_dealloc(dbg, child_die, DW_DLA_DIE);
+
+            if (ret != DW_DLV_OK) {
+                break;
+            }
+            child_die = sibling_die;
+        }
+    }
+    dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+}
+
+// Function to look up the symbols with a name in the DWARF debug info, through its name index.
+// Without a readable index, all the symbols of the DWARF debug info are collected
+SymbolInfo *lookup_dwarf_symbol(const char *elf_file_path, const char *name)
 {
+    Dwarf_Debug dbg;
+    Dwarf_Error err;
     Elf *elf;
-    int fd;
+    Elf_Data *gdb_index;
+    uint64_t *offsets = NULL;
+    int count = -1, fd;
+
+    head = NULL;
 
     // Initialize the ELF library
     if (elf_version(EV_CURRENT) == EV_NONE) {
@@ -194,19 +403,17 @@ SymbolInfo *collect_external_symbols(const char *debug_file_path, int debug_info
         return NULL;
     }
 
-    // Check if the debug file exists
-    if (access(debug_file_path, R_OK) != 0) {
+    // Check if the file exists
+    if (access(elf_file_path, R_OK) != 0) {
         return NULL;
     }
 
-    // Open the ELF file
-    fd = open(debug_file_path, O_RDONLY);
+    fd = open(elf_file_path, O_RDONLY);
     if (fd < 0) {
         perror("Failed to open ELF file");
         return NULL;
     }
 
-    // Initialize the ELF
     elf = elf_begin(fd, ELF_C_READ, NULL);
     if (!elf) {
         perror("Failed to initialize the ELF descriptor");
@@ -214,18 +421,60 @@ SymbolInfo *collect_external_symbols(const char *debug_file_path, int debug_info
         return NULL;
     }
 
-    process_symbol_tables(elf);
+    // Files without debug info are not an error
+    if (dwarf_init(fd, DW_DLC_READ, NULL, NULL, &dbg, &err) != DW_DLV_OK) {
+        elf_end(elf);
+        close(fd);
+        return NULL;
+    }
 
-    if (debug_info_level > 3) {
-        retrieve_from_dwarf(fd);
+    // The index only yields the compilation units of the name, whose top-level DIEs are scanned
+    gdb_index = find_debug_section(elf, ".gdb_index");
+
+    if (gdb_index) {
+        count = lookup_gdb_index(gdb_index, name, &offsets);
+
+        for (int i = 0; i < count; i++) {
+            process_named_cu(dbg, offsets[i], name);
+        }
+    }
+
+    if (count < 0) {
+        help_symbol_names(dbg);
     }
 
+    free(offsets);
+    dwarf_finish(dbg, &err);
     elf_end(elf);
     close(fd);
 
     return head;
 }
 
+// Function to collect all the symbols of the DWARF debug info, walking every compilation unit
+SymbolInfo *collect_dwarf_symbols(const char *elf_file_path)
+{
+    int fd;
+
+    head = NULL;
+
+    // Check if the file exists
+    if (access(elf_file_path, R_OK) != 0) {
+        return NULL;
+    }
+
+    fd = open(elf_file_path, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open ELF file");
+        return NULL;
+    }
+
+    retrieve_from_dwarf(fd);
+    close(fd);
+
+    return head;
+}
+
 // Function to process the symbol tables
 void process_symbol_tables(Elf *elf)
 {
@@ -257,6 +506,56 @@ void process_symbol_tables(Elf *elf)
     }
 }
 
+// Function to collect external symbols from the debug file
+SymbolInfo *collect_external_symbols(const char *debug_file_path, int debug_info_level)
+{
+    Elf *elf;
+    int fd;
+
+    dwarf_index = 0;
+
+    // Initialize the ELF library
+    if (elf_version(EV_CURRENT) == EV_NONE) {
+        perror("Failed to initialize libelf");
+        return NULL;
+    }
+
+    // Check if the debug file exists
+    if (access(debug_file_path, R_OK) != 0) {
+        return NULL;
+    }
+
+    // Open the ELF file
+    fd = open(debug_file_path, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open ELF file");
+        return NULL;
+    }
+
+    // Initialize the ELF
+    elf = elf_begin(fd, ELF_C_READ, NULL);
+    if (!elf) {
+        perror("Failed to initialize the ELF descriptor");
+        close(fd);
+        return NULL;
+    }
+
+    process_symbol_tables(elf);
+
+    // With a name index, the names are looked up on demand instead of walking every compilation unit
+    if (debug_info_level > 3) {
+        dwarf_index = has_dwarf_index(elf);
+        if (!dwarf_index) {
+            retrieve_from_dwarf(fd);
+        }
+    }
+
+    elf_end(elf);
+    close(fd);
+
+    return head;
+}
+
 void retrieve_build_id(Elf *elf)
 {
     GElf_Shdr shdr;
@@ -343,6 +642,7 @@ SymbolInfo *read_elf_info(const char *elf_file_path, int debug_info_level)
     head = NULL;
     build_id = NULL;
     debug_file = NULL;
+    dwarf_index = 0;
 
     // Initialize the ELF library
     if (elf_version(EV_CURRENT) == EV_NONE) {
@@ -380,11 +680,796 @@ SymbolInfo *read_elf_info(const char *elf_file_path, int debug_info_level)
     // read the debug file path
     retrieve_debug_filename(elf);
 
+    // With a name index, the names are looked up on demand instead of walking every compilation unit
     if (debug_info_level > 1) {
-        retrieve_from_dwarf(fd);
+        dwarf_index = has_dwarf_index(elf);
+        if (!dwarf_index) {
+            retrieve_from_dwarf(fd);
+        }
     }
 
     elf_end(elf);
     close(fd);
     return head;
 }
+
+static TypeInfo *type_head = NULL;
+static TypeInfo *type_tail = NULL;
+
+// Function to free the list of types
+void free_type_info(TypeInfo *head)
+{
+    while (head != NULL) {
+        TypeInfo *tmp = head;
+        head = head->next;
+        free(tmp->name);
+        free(tmp);
+    }
+}
+
+// Function to check whether a DIE describes a type, or a part of a type
+int is_type_tag(Dwarf_Half tag)
+{
+    switch (tag) {
+        case DW_TAG_array_type:
+        case DW_TAG_class_type:
+        case DW_TAG_enumeration_type:
+        case DW_TAG_pointer_type:
+        case DW_TAG_reference_type:
+        case DW_TAG_structure_type:
+        case DW_TAG_typedef:
+        case DW_TAG_union_type:
+        case DW_TAG_base_type:
+        case DW_TAG_const_type:
+        case DW_TAG_volatile_type:
+        case DW_TAG_restrict_type:
+        case DW_TAG_rvalue_reference_type:
+        case DW_TAG_atomic_type:
+        case DW_TAG_unspecified_type:
+        case DW_TAG_member:
+        case DW_TAG_subrange_type:
+        case DW_TAG_enumerator:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Function to read a constant attribute, either signed or unsigned
+int read_constant_attribute(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attrnum, int is_signed, long long *value)
+{
+    Dwarf_Attribute attr;
+    Dwarf_Error err;
+    Dwarf_Unsigned udata;
+    Dwarf_Signed sdata;
+    int ret = -1;
+
+    if (dwarf_attr(die, attrnum, &attr, &err) != DW_DLV_OK) {
+        return -1;
+    }
+
+    if (is_signed && dwarf_formsdata(attr, &sdata, &err) == DW_DLV_OK) {
+        *value = sdata;
+        ret = 0;
+    } else if (dwarf_formudata(attr, &udata, &err) == DW_DLV_OK) {
+        *value = (long long)udata;
+        ret = 0;
+    } else if (!is_signed && dwarf_formsdata(attr, &sdata, &err) == DW_DLV_OK) {
+        *value = sdata;
+        ret = 0;
+    }
+
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+    return ret;
+}
+
+// Function to read the offset of a member, either a constant or a DWARF 2 location expression
+int read_member_location(Dwarf_Debug dbg, Dwarf_Die die, long long *location)
+{
+    Dwarf_Attribute attr;
+    Dwarf_Error err;
+    Dwarf_Unsigned udata;
+    Dwarf_Block *block;
+    int ret = -1;
+
+    if (dwarf_attr(die, DW_AT_data_member_location, &attr, &err) != DW_DLV_OK) {
+        return -1;
+    }
+
+    if (dwarf_formudata(attr, &udata, &err) == DW_DLV_OK) {
+        *location = (long long)udata;
+        ret = 0;
+    } else if (dwarf_formblock(attr, &block, &err) == DW_DLV_OK) {
+        unsigned char *data = (unsigned char *)block->bl_data;
+
+        // Old compilers describe the offset as DW_OP_plus_uconst <ULEB128>
+        if (block->bl_len > 0 && data[0] == DW_OP_plus_uconst) {
+            unsigned long long result = 0;
+            int shift = 0;
+
+            for (Dwarf_Unsigned i = 1; i < block->bl_len && shift < 64; i++) {
+                result |= (unsigned long long)(data[i] & 0x7f) << shift;
+                shift += 7;
+
+                if (!(data[i] & 0x80)) {
+                    break;
+                }
+            }
+
+            *location = (long long)result;
+            ret = 0;
+        }
+
+        dwarf_dealloc(dbg, block, DW_DLA_BLOCK);
+    }
+
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+    return ret;
+}
+
+// Function to read the offset of the DIE referenced by DW_AT_type, 0 if absent
+unsigned long long read_type_reference(Dwarf_Debug dbg, Dwarf_Die die)
+{
+    Dwarf_Attribute attr;
+    Dwarf_Error err;
+    Dwarf_Off offset = 0;
+
+    if (dwarf_attr(die, DW_AT_type, &attr, &err) != DW_DLV_OK) {
+        return 0;
+    }
+
+    if (dwarf_global_formref(attr, &offset, &err) != DW_DLV_OK) {
+        offset = 0;
+    }
+
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+    return offset;
+}
+
+// Function to add a type DIE to the list of types, keeping the order of the debug info
+void add_type_info(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half tag, Dwarf_Off offset, Dwarf_Off parent)
+{
+    Dwarf_Error err;
+    Dwarf_Bool has_attr = 0;
+    char *die_name = NULL;
+    long long value;
+
+    TypeInfo *node = (TypeInfo *)calloc(1, sizeof(TypeInfo));
+    node->offset = offset;
+    node->parent = parent;
+    node->tag = tag;
+    node->type = read_type_reference(dbg, die);
+
+    if (dwarf_diename(die, &die_name, &err) == DW_DLV_OK) {
+        node->name = strdup(die_name);
+        dwarf_dealloc(dbg, die_name, DW_DLA_STRING);
+    }
+
+    if (read_constant_attribute(dbg, die, DW_AT_byte_size, 0, &value) == 0) {
+        node->size = value;
+    }
+
+    if (read_constant_attribute(dbg, die, DW_AT_encoding, 0, &value) == 0) {
+        node->encoding = value;
+    }
+
+    if (dwarf_hasattr(die, DW_AT_declaration, &has_attr, &err) == DW_DLV_OK) {
+        node->declaration = has_attr;
+    }
+
+    if (tag == DW_TAG_member) {
+        long long location = 0;
+        read_member_location(dbg, die, &location);
+        node->value = location;
+
+        if (read_constant_attribute(dbg, die, DW_AT_bit_size, 0, &value) == 0) {
+            node->bit_size = value;
+
+            // The bit offset is always reported from the start of the enclosing structure
+            if (read_constant_attribute(dbg, die, DW_AT_data_bit_offset, 0, &value) == 0) {
+                node->bit_offset = value;
+            } else if (read_constant_attribute(dbg, die, DW_AT_bit_offset, 0, &value) == 0) {
+                // DWARF 2 counts from the most significant bit of the storage unit
+                node->bit_offset = location * 8 + node->size * 8 - value - node->bit_size;
+            } else {
+                node->bit_offset = location * 8;
+            }
+        }
+    } else if (tag == DW_TAG_subrange_type) {
+        if (read_constant_attribute(dbg, die, DW_AT_count, 0, &value) == 0) {
+            node->value = value;
+        } else if (read_constant_attribute(dbg, die, DW_AT_upper_bound, 1, &value) == 0) {
+            node->value = value + 1;
+        }
+    } else if (tag == DW_TAG_enumerator) {
+        if (read_constant_attribute(dbg, die, DW_AT_const_value, 1, &value) == 0) {
+            node->value = value;
+        }
+    }
+
+    if (type_tail) {
+        type_tail->next = node;
+    } else {
+        type_head = node;
+    }
+    type_tail = node;
+}
+
+// Function to collect the types of a DIE and of its children
+void collect_die_types(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Off parent)
+{
+    Dwarf_Error err;
+    Dwarf_Half tag;
+    Dwarf_Off offset;
+    Dwarf_Die child_die, sibling_die;
+
+    if (dwarf_tag(die, &tag, &err) != DW_DLV_OK || dwarf_dieoffset(die, &offset, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    if (is_type_tag(tag)) {
+        add_type_info(dbg, die, tag, offset, parent);
+    }
+
+    if (dwarf_child(die, &child_die, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    while (1) {
+        collect_die_types(dbg, child_die, offset);
+
+        int ret = dwarf_siblingof(dbg, child_die, &sibling_die, &err);
+        dwarf_dealloc(dbg, child_die, DW_DLA_DIE);
+
+        if (ret != DW_DLV_OK) {
+            break;
+        }
+        child_die = sibling_die;
+    }
+}
+
+// Function to collect the types described by the DWARF debug info
+TypeInfo *collect_types(const char *elf_file_path)
+{
+    Dwarf_Debug dbg;
+    Dwarf_Error err;
+    Dwarf_Unsigned cu_header_length, abbrev_offset, next_cu_header;
+    Dwarf_Half version_stamp, address_size;
+    Dwarf_Die cu_die;
+    int fd;
+
+    type_head = NULL;
+    type_tail = NULL;
+
+    // Check if the file exists
+    if (access(elf_file_path, R_OK) != 0) {
+        return NULL;
+    }
+
+    fd = open(elf_file_path, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open ELF file");
+        return NULL;
+    }
+
+    // Files without debug info are not an error
+    if (dwarf_init(fd, DW_DLC_READ, NULL, NULL, &dbg, &err) != DW_DLV_OK) {
+        close(fd);
+        return NULL;
+    }
+
+    // Loop through all the compilation units
+    while (dwarf_next_cu_header(dbg, &cu_header_length, &version_stamp, &abbrev_offset, &address_size,
+                                &next_cu_header, &err) == DW_DLV_OK) {
+        if (dwarf_siblingof(dbg, NULL, &cu_die, &err) != DW_DLV_OK) {
+            continue;
+        }
+
+        collect_die_types(dbg, cu_die, 0);
+        dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+    }
+
+    dwarf_finish(dbg, &err);
+    close(fd);
+
+    return type_head;
+}
+
+static FunctionInfo *function_head = NULL;
+static CfaInfo *cfa_head = NULL;
+
+// Function to free a list of locations
+void free_location_info(LocationInfo *head)
+{
+    while (head != NULL) {
+        LocationInfo *tmp = head;
+        head = head->next;
+        free(tmp->ops);
+        free(tmp);
+    }
+}
+
+// Function to free the list of functions, with their variables
+void free_function_info(FunctionInfo *head)
+{
+    while (head != NULL) {
+        FunctionInfo *tmp = head;
+        head = head->next;
+
+        while (tmp->variables != NULL) {
+            VariableInfo *variable = tmp->variables;
+            tmp->variables = variable->next;
+            free_location_info(variable->locations);
+            free(variable->name);
+            free(variable);
+        }
+
+        free_location_info(tmp->frame_base);
+        free(tmp->name);
+        free(tmp);
+    }
+}
+
+// Function to free the list of CFA rules
+void free_cfa_info(CfaInfo *head)
+{
+    while (head != NULL) {
+        CfaInfo *tmp = head;
+        head = head->next;
+        free(tmp);
+    }
+}
+
+// Function to read the pc range of a DIE, with DW_AT_high_pc either an address or an offset
+int read_pc_range(Dwarf_Die die, Dwarf_Addr *low_pc, Dwarf_Addr *high_pc)
+{
+    Dwarf_Error err;
+    Dwarf_Half form;
+    enum Dwarf_Form_Class form_class;
+
+    if (dwarf_lowpc(die, low_pc, &err) != DW_DLV_OK ||
+        dwarf_highpc_b(die, high_pc, &form, &form_class, &err) != DW_DLV_OK) {
+        return -1;
+    }
+
+    if (form_class == DW_FORM_CLASS_CONSTANT) {
+        *high_pc += *low_pc;
+    }
+
+    return 0;
+}
+
+// Function to read the name and the type of a DIE, following the abstract instance of inlined and out-of-line copies
+void read_origin_name_and_type(Dwarf_Debug dbg, Dwarf_Die die, char **name, unsigned long long *type)
+{
+    Dwarf_Error err;
+    Dwarf_Attribute attr;
+    Dwarf_Off origin_offset;
+    Dwarf_Die origin_die;
+    char *die_name = NULL;
+
+    if (*name == NULL && dwarf_diename(die, &die_name, &err) == DW_DLV_OK) {
+        *name = strdup(die_name);
+        dwarf_dealloc(dbg, die_name, DW_DLA_STRING);
+    }
+
+    if (*type == 0) {
+        *type = read_type_reference(dbg, die);
+    }
+
+    if (*name != NULL && *type != 0) {
+        return;
+    }
+
+    if (dwarf_attr(die, DW_AT_abstract_origin, &attr, &err) != DW_DLV_OK &&
+        dwarf_attr(die, DW_AT_specification, &attr, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    if (dwarf_global_formref(attr, &origin_offset, &err) == DW_DLV_OK &&
+        dwarf_offdie_b(dbg, origin_offset, 1, &origin_die, &err) == DW_DLV_OK) {
+        read_origin_name_and_type(dbg, origin_die, name, type);
+        dwarf_dealloc(dbg, origin_die, DW_DLA_DIE);
+    }
+
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+}
+
+// The location lists are read with dwarf_get_locdesc_entry_d(), which came with the DW_LKIND_* kinds in libdwarf
+// 20200703. With an older libdwarf, the variables have no location and read as optimized out
+#ifdef DW_LKIND_expression
+
+// Function to copy the operations of a location expression, normalizing the ones with a nested block
+LocationOp *read_location_ops(Dwarf_Locdesc_c locdesc, Dwarf_Unsigned op_count)
+{
+    Dwarf_Error err;
+    LocationOp *ops = (LocationOp *)calloc(op_count ? op_count : 1, sizeof(LocationOp));
+
+    for (Dwarf_Unsigned i = 0; i < op_count; i++) {
+        Dwarf_Small atom;
+        Dwarf_Unsigned op1, op2, op3, offset;
+
+        if (dwarf_get_location_op_value_c(locdesc, i, &atom, &op1, &op2, &op3, &offset, &err) != DW_DLV_OK) {
+            free(ops);
+            return NULL;
+        }
+
+        if ((atom == DW_OP_entry_value || atom == DW_OP_GNU_entry_value) && op2) {
+            // Only the entry value of a register can be recovered
+            unsigned char *block = (unsigned char *)(uintptr_t)op2;
+
+            if (op1 == 1 && block[0] >= DW_OP_reg0 && block[0] <= DW_OP_reg31) {
+                op1 = block[0] - DW_OP_reg0;
+            } else if (op1 > 1 && op1 <= 4 && block[0] == DW_OP_regx) {
+                unsigned long long reg = 0;
+                for (Dwarf_Unsigned j = 1, shift = 0; j < op1; j++, shift += 7) {
+                    reg |= (unsigned long long)(block[j] & 0x7f) << shift;
+                }
+                op1 = reg;
+            } else {
+                op1 = (Dwarf_Unsigned)-1;
+            }
+            op2 = 0;
+        } else if (atom == DW_OP_implicit_value && op2) {
+            // Keep the value inline, if it fits a register
+            unsigned long long value = 0;
+
+            if (op1 <= sizeof(value)) {
+                memcpy(&value, (void *)(uintptr_t)op2, op1);
+            }
+            op2 = value;
+        }
+
+        ops[i].atom = atom;
+        ops[i].op1 = op1;
+        ops[i].op2 = op2;
+        ops[i].offset = offset;
+    }
+
+    return ops;
+}
+
+// Function to read a location attribute, either a single expression or a location list
+LocationInfo *read_location_list(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attrnum)
+{
+    Dwarf_Error err;
+    Dwarf_Attribute attr;
+    Dwarf_Loc_Head_c loclist_head;
+    Dwarf_Unsigned count;
+    LocationInfo *head = NULL, *tail = NULL;
+
+    if (dwarf_attr(die, attrnum, &attr, &err) != DW_DLV_OK) {
+        return NULL;
+    }
+
+    if (dwarf_get_loclist_c(attr, &loclist_head, &count, &err) != DW_DLV_OK) {
+        dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+        return NULL;
+    }
+
+    for (Dwarf_Unsigned i = 0; i < count; i++) {
+        Dwarf_Small lle_value, loclist_source;
+        Dwarf_Unsigned raw_low_pc, raw_high_pc, op_count, expression_offset, locdesc_offset;
+        Dwarf_Bool debug_addr_unavailable;
+        Dwarf_Addr low_pc, high_pc;
+        Dwarf_Locdesc_c locdesc;
+
+        if (dwarf_get_locdesc_entry_d(loclist_head, i, &lle_value, &raw_low_pc, &raw_high_pc,
+                                      &debug_addr_unavailable, &low_pc, &high_pc, &op_count, &locdesc,
+                                      &loclist_source, &expression_offset, &locdesc_offset, &err) != DW_DLV_OK) {
+            break;
+        }
+
+        // Skip the base address entries and the end of the list
+        if (loclist_source != DW_LKIND_expression && (debug_addr_unavailable || low_pc >= high_pc)) {
+            continue;
+        }
+
+        LocationOp *ops = read_location_ops(locdesc, op_count);
+        if (ops == NULL) {
+            continue;
+        }
+
+        LocationInfo *node = (LocationInfo *)calloc(1, sizeof(LocationInfo));
+        node->low_pc = loclist_source == DW_LKIND_expression ? 0 : low_pc;
+        node->high_pc = loclist_source == DW_LKIND_expression ? (unsigned long long)-1 : high_pc;
+        node->op_count = op_count;
+        node->ops = ops;
+
+        if (tail) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+    }
+
+    dwarf_dealloc_loc_head_c(loclist_head);
+    dwarf_dealloc(dbg, attr, DW_DLA_ATTR);
+
+    return head;
+}
+
+#else
+
+// Function to read a location attribute, which is not supported by this version of libdwarf
+LocationInfo *read_location_list(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attrnum)
+{
+    return NULL;
+}
+
+#endif
+
+// Function to add a parameter or a variable to a function
+void add_variable_info(Dwarf_Debug dbg, Dwarf_Die die, FunctionInfo *function, Dwarf_Addr low_pc, Dwarf_Addr high_pc,
+                       int is_parameter)
+{
+    Dwarf_Error err;
+    Dwarf_Bool is_declaration = 0;
+    long long value;
+
+    // Extern declarations have no storage in this function
+    if (dwarf_hasattr(die, DW_AT_declaration, &is_declaration, &err) == DW_DLV_OK && is_declaration) {
+        return;
+    }
+
+    VariableInfo *node = (VariableInfo *)calloc(1, sizeof(VariableInfo));
+    read_origin_name_and_type(dbg, die, &node->name, &node->type);
+    node->low_pc = low_pc;
+    node->high_pc = high_pc;
+    node->is_parameter = is_parameter;
+    node->locations = read_location_list(dbg, die, DW_AT_location);
+
+    // Constants folded by the compiler are described as a value on the stack
+    if (node->locations == NULL && read_constant_attribute(dbg, die, DW_AT_const_value, 1, &value) == 0) {
+        node->locations = (LocationInfo *)calloc(1, sizeof(LocationInfo));
+        node->locations->high_pc = (unsigned long long)-1;
+        node->locations->op_count = 2;
+        node->locations->ops = (LocationOp *)calloc(2, sizeof(LocationOp));
+        node->locations->ops[0].atom = DW_OP_consts;
+        node->locations->ops[0].op1 = value;
+        node->locations->ops[1].atom = DW_OP_stack_value;
+        node->locations->ops[1].offset = 1;
+    }
+
+    if (node->name == NULL) {
+        free_location_info(node->locations);
+        free(node);
+        return;
+    }
+
+    node->next = function->variables;
+    function->variables = node;
+}
+
+void collect_die_functions(Dwarf_Debug dbg, Dwarf_Die die);
+
+// Function to collect the variables of a scope of a function, and of its nested lexical blocks
+void collect_scope_variables(Dwarf_Debug dbg, Dwarf_Die die, FunctionInfo *function, Dwarf_Addr low_pc,
+                             Dwarf_Addr high_pc)
+{
+    Dwarf_Error err;
+    Dwarf_Die child_die, sibling_die;
+    Dwarf_Half tag;
+
+    if (dwarf_child(die, &child_die, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    while (1) {
+        if (dwarf_tag(child_die, &tag, &err) == DW_DLV_OK) {
+            if (tag == DW_TAG_formal_parameter || tag == DW_TAG_variable) {
+                add_variable_info(dbg, child_die, function, low_pc, high_pc, tag == DW_TAG_formal_parameter);
+            } else if (tag == DW_TAG_lexical_block) {
+                Dwarf_Addr block_low_pc, block_high_pc;
+
+                // Blocks with non-contiguous ranges are considered as wide as the enclosing scope
+                if (read_pc_range(child_die, &block_low_pc, &block_high_pc) == 0) {
+                    collect_scope_variables(dbg, child_die, function, block_low_pc, block_high_pc);
+                } else {
+                    collect_scope_variables(dbg, child_die, function, low_pc, high_pc);
+                }
+            } else if (tag == DW_TAG_subprogram) {
+                collect_die_functions(dbg, child_die);
+            }
+        }
+
+        int ret = dwarf_siblingof(dbg, child_die, &sibling_die, &err);
+        dwarf_dealloc(dbg, child_die, DW_DLA_DIE);
+
+        if (ret != DW_DLV_OK) {
+            break;
+        }
+        child_die = sibling_die;
+    }
+}
+
+// Function to collect the functions defined in a DIE and in its children
+void collect_die_functions(Dwarf_Debug dbg, Dwarf_Die die)
+{
+    Dwarf_Error err;
+    Dwarf_Half tag;
+    Dwarf_Addr low_pc, high_pc;
+    Dwarf_Die child_die, sibling_die;
+
+    if (dwarf_tag(die, &tag, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    if (tag == DW_TAG_subprogram) {
+        if (read_pc_range(die, &low_pc, &high_pc) == 0 && high_pc > low_pc) {
+            FunctionInfo *function = (FunctionInfo *)calloc(1, sizeof(FunctionInfo));
+            unsigned long long type = 0;
+
+            read_origin_name_and_type(dbg, die, &function->name, &type);
+            function->low_pc = low_pc;
+            function->high_pc = high_pc;
+            function->frame_base = read_location_list(dbg, die, DW_AT_frame_base);
+
+            collect_scope_variables(dbg, die, function, low_pc, high_pc);
+
+            function->next = function_head;
+            function_head = function;
+        }
+        return;
+    }
+
+    if (dwarf_child(die, &child_die, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    while (1) {
+        collect_die_functions(dbg, child_die);
+
+        int ret = dwarf_siblingof(dbg, child_die, &sibling_die, &err);
+        dwarf_dealloc(dbg, child_die, DW_DLA_DIE);
+
+        if (ret != DW_DLV_OK) {
+            break;
+        }
+        child_die = sibling_die;
+    }
+}
+
+// Function to collect the functions described by the DWARF debug info, with their parameters and variables
+FunctionInfo *collect_functions(const char *elf_file_path)
+{
+    Dwarf_Debug dbg;
+    Dwarf_Error err;
+    Dwarf_Unsigned cu_header_length, abbrev_offset, next_cu_header;
+    Dwarf_Half version_stamp, address_size;
+    Dwarf_Die cu_die;
+    int fd;
+
+    function_head = NULL;
+
+    // Check if the file exists
+    if (access(elf_file_path, R_OK) != 0) {
+        return NULL;
+    }
+
+    fd = open(elf_file_path, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open ELF file");
+        return NULL;
+    }
+
+    // Files without debug info are not an error
+    if (dwarf_init(fd, DW_DLC_READ, NULL, NULL, &dbg, &err) != DW_DLV_OK) {
+        close(fd);
+        return NULL;
+    }
+
+    // Loop through all the compilation units
+    while (dwarf_next_cu_header(dbg, &cu_header_length, &version_stamp, &abbrev_offset, &address_size,
+                                &next_cu_header, &err) == DW_DLV_OK) {
+        if (dwarf_siblingof(dbg, NULL, &cu_die, &err) != DW_DLV_OK) {
+            continue;
+        }
+
+        collect_die_functions(dbg, cu_die);
+        dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+    }
+
+    dwarf_finish(dbg, &err);
+    close(fd);
+
+    return function_head;
+}
+
+// Function to collect the rules of the canonical frame address from the call frame information
+CfaInfo *collect_cfa_rules(const char *elf_file_path)
+{
+    Dwarf_Debug dbg;
+    Dwarf_Error err;
+    Dwarf_Cie *cie_data;
+    Dwarf_Fde *fde_data;
+    Dwarf_Signed cie_count, fde_count;
+    CfaInfo *tail = NULL;
+    int fd;
+
+    cfa_head = NULL;
+
+    // Check if the file exists
+    if (access(elf_file_path, R_OK) != 0) {
+        return NULL;
+    }
+
+    fd = open(elf_file_path, O_RDONLY);
+    if (fd < 0) {
+        perror("Failed to open ELF file");
+        return NULL;
+    }
+
+    if (dwarf_init(fd, DW_DLC_READ, NULL, NULL, &dbg, &err) != DW_DLV_OK) {
+        close(fd);
+        return NULL;
+    }
+
+    // Prefer .eh_frame, which is never stripped, over .debug_frame
+    if (dwarf_get_fde_list_eh(dbg, &cie_data, &cie_count, &fde_data, &fde_count, &err) != DW_DLV_OK &&
+        dwarf_get_fde_list(dbg, &cie_data, &cie_count, &fde_data, &fde_count, &err) != DW_DLV_OK) {
+        dwarf_finish(dbg, &err);
+        close(fd);
+        return NULL;
+    }
+
+    for (Dwarf_Signed i = 0; i < fde_count; i++) {
+        Dwarf_Addr low_pc, pc;
+        Dwarf_Unsigned length, fde_byte_length;
+        Dwarf_Small *fde_bytes;
+        Dwarf_Off cie_offset, fde_offset;
+        Dwarf_Signed cie_index;
+
+        if (dwarf_get_fde_range(fde_data[i], &low_pc, &length, &fde_bytes, &fde_byte_length, &cie_offset,
+                                &cie_index, &fde_offset, &err) != DW_DLV_OK) {
+            continue;
+        }
+
+        pc = low_pc;
+
+        while (pc < low_pc + length) {
+            Dwarf_Small value_type;
+            Dwarf_Signed offset_relevant, reg, offset;
+            Dwarf_Ptr block;
+            Dwarf_Addr row_pc, subsequent_pc;
+            Dwarf_Bool has_more_rows;
+
+            if (dwarf_get_fde_info_for_cfa_reg3_b(fde_data[i], pc, &value_type, &offset_relevant, &reg, &offset,
+                                                  &block, &row_pc, &has_more_rows, &subsequent_pc,
+                                                  &err) != DW_DLV_OK) {
+                break;
+            }
+
+            CfaInfo *node = (CfaInfo *)calloc(1, sizeof(CfaInfo));
+            node->low_pc = pc;
+            node->high_pc = has_more_rows && subsequent_pc > pc ? subsequent_pc : low_pc + length;
+
+            // Only the rules in the form register + offset are supported
+            if (value_type == DW_EXPR_OFFSET && offset_relevant) {
+                node->reg = reg;
+                node->offset = offset;
+            } else {
+                node->reg = -1;
+            }
+
+            if (tail) {
+                tail->next = node;
+            } else {
+                cfa_head = node;
+            }
+            tail = node;
+
+            if (!has_more_rows || subsequent_pc <= pc) {
+                break;
+            }
+            pc = subsequent_pc;
+        }
+    }
+
+    dwarf_dealloc_fde_cie_list(dbg, cie_data, cie_count, fde_data, fde_count);
+    dwarf_finish(dbg, &err);
+    close(fd);
+
+    return cfa_head;
+}
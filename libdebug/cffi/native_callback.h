@@ -0,0 +1,36 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+// The declarations needed to write the native callbacks of the breakpoints, see d.breakpoint(native_callback=...)
+
+#ifndef LIBDEBUG_NATIVE_CALLBACK_H
+#define LIBDEBUG_NATIVE_CALLBACK_H
+
+#include <stdint.h>
+#include <sys/user.h>
+
+// The values returned by the callbacks
+#define LIBDEBUG_CALLBACK_RESUME 0
+#define LIBDEBUG_CALLBACK_STOP 1
+
+// The first fields of the state of a thread. The registers are written back when the thread is resumed.
+struct libdebug_thread {
+    int tid;
+    struct user_regs_struct regs;
+};
+
+// The accessor of the memory of the process. Both functions return 0 on success, -1 on failure.
+// Reads see the original instructions in place of the breakpoints.
+struct libdebug_memory {
+    int tid;
+    int (*read)(struct libdebug_memory *memory, uint64_t address, void *buffer, uint64_t size);
+    int (*write)(struct libdebug_memory *memory, uint64_t address, const void *buffer, uint64_t size);
+};
+
+typedef int (*libdebug_breakpoint_callback)(struct libdebug_thread *thread, struct libdebug_memory *memory,
+                                            void *user_data);
+
+#endif
@@ -5,6 +5,7 @@
 #
 
 import platform
+import runpy
 from pathlib import Path
 
 from cffi import FFI
@@ -183,36 +184,12 @@ if architecture == "x86_64":
 
     breakpoint_define = """
     #define INSTRUCTION_POINTER(regs) (regs.rip)
+    #define STACK_POINTER(regs) (regs.rsp)
     #define INSTALL_BREAKPOINT(instruction) ((instruction & 0xFFFFFFFFFFFFFF00) | 0xCC)
     #define BREAKPOINT_SIZE 1
     #define IS_SW_BREAKPOINT(instruction) (instruction == 0xCC)
     """
 
-    control_flow_define = """
-    // X86_64 Architecture specific
-    #define IS_RET_INSTRUCTION(instruction) (instruction == 0xC3 || instruction == 0xCB || instruction == 0xC2 || instruction == 0xCA)
-    
-    int IS_CALL_INSTRUCTION(uint8_t* instr)
-    {
-        // Check for direct CALL (E8 xx xx xx xx)
-        if (instr[0] == (uint8_t)0xE8) {
-            return 1; // It's a CALL
-        }
-        
-        // Check for indirect CALL using ModR/M (FF /2)
-        if (instr[0] == (uint8_t)0xFF) {
-            // Extract ModR/M byte
-            uint8_t modRM = (uint8_t)instr[1];
-            uint8_t reg = (modRM >> 3) & 7; // Middle three bits
-
-            if (reg == 2) {
-                return 1; // It's a CALL
-            }
-        }
-
-        return 0; // Not a CALL
-    }
-    """
 elif architecture == "aarch64":
     fp_regs_struct = """
     struct reg_128
@@ -284,30 +261,12 @@ elif architecture == "aarch64":
 
     breakpoint_define = """
     #define INSTRUCTION_POINTER(regs) (regs.pc)
+    #define STACK_POINTER(regs) (regs.sp)
     #define INSTALL_BREAKPOINT(instruction) ((instruction & 0xFFFFFFFF00000000) | 0xD4200000)
     #define BREAKPOINT_SIZE 4
     #define IS_SW_BREAKPOINT(instruction) (instruction == 0xD4200000)
     """
 
-    control_flow_define = """
-    #define IS_RET_INSTRUCTION(instruction) (instruction == 0xD65F03C0)
-
-    // AARCH64 Architecture specific
-    int IS_CALL_INSTRUCTION(uint8_t* instr)
-    {
-        // Check for direct CALL (BL)
-        if ((instr[3] & 0xFC) == 0x94) {
-            return 1; // It's a CALL
-        }
-
-        // Check for indirect CALL (BLR)
-        if ((instr[3] == 0xD6 && (instr[2] & 0x3F) == 0x3F)) {
-            return 1; // It's a CALL
-        }
-
-        return 0; // Not a CALL
-    }
-    """
 else:
     raise NotImplementedError(f"Architecture {platform.machine()} not available.")
 
@@ -328,6 +287,9 @@ ffibuilder.cdef("""
         uint64_t instruction;
         uint64_t patched_instruction;
         char enabled;
+        uint32_t native_traps;
+        int *threads;
+        int thread_count;
         struct software_breakpoint *next;
     };
 
@@ -351,20 +313,262 @@ ffibuilder.cdef("""
     struct thread_status {
         int tid;
         int status;
+        _Bool interrupted;
         struct thread_status *next;
     };
 
+    struct ra_violation {
+        int tid;
+        _Bool canary;
+        uint64_t function;
+        uint64_t address;
+        uint64_t slot;
+        uint64_t expected;
+        uint64_t actual;
+        struct ra_violation *next;
+    };
+
+    struct ra_monitor;
+
+    struct traced_call {
+        int tid;
+        uint32_t function;
+        _Bool returned;
+        uint64_t args[8];
+        uint64_t return_value;
+        uint64_t timestamp;
+        uint64_t duration;
+    };
+
+    struct traced_function_stats {
+        uint64_t calls;
+        uint64_t returns;
+        uint64_t total_time;
+        uint64_t min_time;
+        uint64_t max_time;
+    };
+
+    struct function_tracer;
+
+    struct heap_allocation {
+        uint64_t address;
+        uint64_t size;
+        int tid;
+        _Bool mmap;
+        uint64_t pc;
+        uint32_t backtrace_depth;
+        uint64_t backtrace[8];
+    };
+
+    struct heap_tracker_stats {
+        uint64_t allocations;
+        uint64_t frees;
+        uint64_t invalid_frees;
+        uint64_t live_count;
+        uint64_t live_bytes;
+        uint64_t peak_bytes;
+        uint64_t mmap_count;
+        uint64_t mmap_bytes;
+        uint64_t brk_start;
+        uint64_t brk_end;
+    };
+
+    struct heap_tracker;
+
+    struct glibc_heap_layout {
+        uint64_t arena;
+        uint64_t heap_start;
+        uint64_t heap_end;
+        uint32_t fastbins_offset;
+        uint32_t top_offset;
+        uint32_t bins_offset;
+        uint32_t tcache_counts_size;
+        _Bool safe_linking;
+    };
+
+    struct glibc_heap_chunk {
+        uint64_t address;
+        uint64_t size;
+        uint32_t flags;
+        int32_t bin;
+    };
+
+    struct glibc_heap_corruption {
+        uint64_t address;
+        uint64_t value;
+        uint32_t code;
+        int32_t bin;
+    };
+
+    struct glibc_heap_walk {
+        struct glibc_heap_chunk *chunks;
+        uint64_t chunk_count;
+        struct glibc_heap_corruption *corruptions;
+        uint64_t corruption_count;
+    };
+
+    struct profiled_stack {
+        int tid;
+        uint32_t depth;
+        uint64_t count;
+        uint64_t frames_offset;
+    };
+
+    struct profiler_stats {
+        uint64_t samples;
+        uint64_t requested;
+        uint64_t missed;
+        uint64_t truncated;
+        uint64_t stacks;
+        uint64_t frames;
+    };
+
+    struct profiler;
+
+    struct cpython_layout {
+        uint64_t runtime;
+        uint64_t code_type;
+        uint32_t runtime_interpreters;
+        uint32_t interp_next;
+        uint32_t interp_threads;
+        uint32_t tstate_next;
+        uint32_t tstate_native_thread_id;
+        uint32_t tstate_cframe;
+        uint32_t tstate_frame;
+        uint32_t frame_code;
+        uint32_t frame_previous;
+        uint32_t frame_instr;
+        uint32_t frame_owner;
+        int32_t frame_is_entry;
+        int32_t cstack_owner;
+        uint32_t code_filename;
+        uint32_t code_qualname;
+        uint32_t code_linetable;
+        uint32_t code_firstlineno;
+        uint32_t code_adaptive;
+        uint32_t bytes_size;
+        uint32_t bytes_data;
+        uint32_t unicode_length;
+        uint32_t unicode_state;
+        uint32_t unicode_ascii_data;
+        uint32_t unicode_compact_data;
+    };
+    
+    struct cpython_frame {
+        uint64_t address;
+        uint64_t code;
+        int32_t line;
+        uint32_t entry;
+        uint32_t name_offset;
+        uint32_t name_size;
+        uint32_t filename_offset;
+        uint32_t filename_size;
+        uint8_t name_kind;
+        uint8_t filename_kind;
+    };
+    
+    struct cpython_stack {
+        struct cpython_frame *frames;
+        uint64_t frame_count;
+        uint8_t *strings;
+        uint64_t strings_size;
+    };
+    
+    struct dwarf_op {
+        uint8_t atom;
+        uint64_t op1;
+        uint64_t op2;
+        uint64_t offset;
+    };
+
+    struct dwarf_piece {
+        uint8_t kind;
+        uint32_t size;
+        uint64_t value;
+    };
+
+    struct dwarf_expression {
+        struct dwarf_op *ops;
+        uint32_t op_count;
+        int32_t piece_count;
+        struct dwarf_piece pieces[8];
+    };
+
+    struct dwarf_frame {
+        uint64_t base_address;
+        int32_t cfa_register;
+        int64_t cfa_offset;
+        _Bool at_entry;
+        struct dwarf_expression frame_base;
+    };
+
+    struct native_callback;
+
+    struct budget_usage {
+        uint64_t wall_time;
+        uint64_t cpu_time;
+        uint64_t syscalls;
+        uint64_t breakpoint_hits;
+        int exhausted;
+    };
+
+    struct execution_budget;
+
+    struct virtual_clock_stats {
+        int64_t offset;
+        uint64_t sleeps;
+        uint64_t clock_reads;
+    };
+
+    struct virtual_clock;
+
+    struct profiled_syscall {
+        int tid;
+        uint64_t number;
+        uint64_t call_site;
+        uint64_t count;
+        uint64_t errors;
+        uint64_t total_time;
+        uint64_t min_time;
+        uint64_t max_time;
+        uint64_t histogram[40];
+    };
+
+    struct syscall_profiler_stats {
+        uint64_t syscalls;
+        uint64_t entries;
+    };
+
+    struct syscall_profiler;
+
+    struct fd_table;
+
     struct global_state {
         struct thread *t_HEAD;
         struct thread *dead_t_HEAD;
         struct software_breakpoint *sw_b_HEAD;
         struct hardware_breakpoint *hw_b_HEAD;
         _Bool handle_syscall_enabled;
+        _Bool sw_breakpoints_installed;
+        uint32_t native_traps_enabled;
+        struct ra_monitor *ra_monitor;
+        struct function_tracer *function_tracer;
+        struct heap_tracker *heap_tracker;
+        struct profiler *profiler;
+        struct native_callback *native_callbacks;
+        uint64_t wait_spin_ns;
+        struct execution_budget *budget;
+        _Bool consume_syscall_stops;
+        int scoped_sw_breakpoints;
+        struct virtual_clock *virtual_clock;
+        struct syscall_profiler *syscall_profiler;
+        struct fd_table *fd_table;
     };
 
 
     int ptrace_trace_me(void);
     int ptrace_attach(int pid);
+    int ptrace_seize_all(struct global_state *state, int pid);
     void ptrace_detach_and_cont(struct global_state *state, int pid);
     void ptrace_detach_for_kill(struct global_state *state, int pid);
     void ptrace_detach_for_migration(struct global_state *state, int pid);
@@ -398,6 +602,7 @@ ffibuilder.cdef("""
     void unregister_breakpoint(struct global_state *state, uint64_t address);
     void enable_breakpoint(struct global_state *state, uint64_t address);
     void disable_breakpoint(struct global_state *state, uint64_t address);
+    void set_breakpoint_threads(struct global_state *state, uint64_t address, int *tids, int count);
 
     void register_hw_breakpoint(struct global_state *state, int tid, uint64_t address, char type[2], char len);
     void unregister_hw_breakpoint(struct global_state *state, int tid, uint64_t address);
@@ -408,21 +613,107 @@ ffibuilder.cdef("""
     int get_remaining_hw_watchpoint_count(struct global_state *state, int tid);
 
     void free_breakpoints(struct global_state *state);
+
+    void register_ra_function(struct global_state *state, int pid, uint64_t address, int64_t canary_offset);
+    void register_ra_return(struct global_state *state, int pid, uint64_t address);
+    void register_ra_canary_check(struct global_state *state, int pid, uint64_t address);
+    void enable_ra_monitor(struct global_state *state);
+    void disable_ra_monitor(struct global_state *state);
+    int pop_ra_violation(struct global_state *state, int tid, struct ra_violation *violation);
+    void free_ra_monitor(struct global_state *state);
+
+    void configure_function_tracer(struct global_state *state, int args, _Bool capture_return, uint64_t buffer_size);
+    void register_traced_function(struct global_state *state, int pid, uint64_t address, uint32_t id);
+    void enable_function_tracer(struct global_state *state);
+    void disable_function_tracer(struct global_state *state);
+    uint64_t pop_traced_calls(struct global_state *state, struct traced_call *buffer, uint64_t max_count);
+    uint64_t pop_dropped_traced_calls(struct global_state *state);
+    int get_traced_function_stats(struct global_state *state, uint32_t id, struct traced_function_stats *stats);
+    void free_function_tracer(struct global_state *state);
+
+    void configure_heap_tracker(struct global_state *state, uint32_t backtrace_depth);
+    void register_heap_function(struct global_state *state, int pid, uint64_t address, int role);
+    void enable_heap_tracker(struct global_state *state);
+    void disable_heap_tracker(struct global_state *state);
+    int get_heap_tracker_stats(struct global_state *state, struct heap_tracker_stats *stats);
+    uint64_t get_heap_allocations(struct global_state *state, struct heap_allocation *buffer, uint64_t max_count);
+    int find_heap_allocation(struct global_state *state, uint64_t address, struct heap_allocation *allocation);
+    void free_heap_tracker(struct global_state *state);
+
+    struct glibc_heap_walk *walk_glibc_heap(int pid, struct glibc_heap_layout *layout);
+    void free_glibc_heap_walk(struct glibc_heap_walk *walk);
+
+    void configure_profiler(struct global_state *state, int pid, uint32_t frequency, uint32_t max_depth);
+    void enable_profiler(struct global_state *state);
+    void disable_profiler(struct global_state *state);
+    int get_profiler_stats(struct global_state *state, struct profiler_stats *stats);
+    uint64_t get_profiled_stacks(struct global_state *state, struct profiled_stack *buffer, uint64_t max_count);
+    uint64_t get_profiled_frames(struct global_state *state, uint64_t *buffer, uint64_t max_count);
+    void reset_profiler(struct global_state *state);
+    void free_profiler(struct global_state *state);
+
+    struct cpython_stack *walk_cpython_stack(int pid, struct cpython_layout *layout, int tid);
+    void free_cpython_stack(struct cpython_stack *stack);
+
+    void evaluate_dwarf_expressions(struct global_state *state, int tid, struct dwarf_frame *frame, struct dwarf_expression *expressions, uint32_t count);
+
+    void register_native_callback(struct global_state *state, int pid, uint64_t address, uint64_t callback, uint64_t user_data);
+    void enable_native_callback(struct global_state *state, uint64_t address, _Bool enabled);
+    void unregister_native_callback(struct global_state *state, uint64_t address);
+    uint64_t get_native_callback_hits(struct global_state *state, uint64_t address);
+    void free_native_callbacks(struct global_state *state);
+
+    void configure_budget(struct global_state *state, int pid, struct budget_usage *limits);
+    int get_budget_usage(struct global_state *state, struct budget_usage *usage);
+    void free_budget(struct global_state *state);
+
+    void configure_virtual_clock(struct global_state *state, _Bool enabled);
+    void advance_virtual_clock(struct global_state *state, int64_t nanoseconds);
+    int get_virtual_clock_stats(struct global_state *state, struct virtual_clock_stats *stats);
+    void free_virtual_clock(struct global_state *state);
+
+    void configure_syscall_profiler(struct global_state *state, _Bool enabled, _Bool call_sites);
+    int get_syscall_profiler_stats(struct global_state *state, struct syscall_profiler_stats *stats);
+    uint64_t get_profiled_syscalls(struct global_state *state, struct profiled_syscall *buffer, uint64_t max_count);
+    void reset_syscall_profiler(struct global_state *state);
+    void free_syscall_profiler(struct global_state *state);
+
+    void configure_fd_table(struct global_state *state, int pid, _Bool enabled);
+    void refresh_fd_table(struct global_state *state);
+    int get_fd_path(struct global_state *state, int fd, char *buffer, uint32_t size);
+    uint32_t get_open_fds(struct global_state *state, int *buffer, uint32_t max_count);
+    void free_fd_table(struct global_state *state);
+
+    int inject_syscall(struct global_state *state, int tid, uint64_t gadget, uint64_t number, uint64_t *args, uint64_t *result);
+    int call_function(struct global_state *state, int tid, uint64_t function, uint64_t trap, uint64_t *args, int count, uint64_t *result, _Bool *mapped);
+
+    struct lockstep;
+
+    struct lockstep *create_lockstep(int mode, uint64_t max_steps, uint32_t *offsets, uint32_t register_count, uint64_t *first_addresses, uint64_t *second_addresses, uint64_t *sizes, uint32_t range_count);
+    int run_lockstep(struct lockstep *lockstep, int side, struct global_state *state, int tid);
+    int get_lockstep_result(struct lockstep *lockstep, uint64_t *steps);
+    void get_lockstep_state(struct lockstep *lockstep, int side, struct ptrace_regs_struct *regs, uint8_t *memory);
+    void free_lockstep(struct lockstep *lockstep);
 """
 )
 
-with open("libdebug/cffi/ptrace_cffi_source.c") as f:
-    ffibuilder.set_source(
-        "libdebug.cffi._ptrace_cffi",
-        ptrace_regs_struct 
-        + arch_define
-        + fp_regs_struct
-        + fpregs_define
-        + breakpoint_define
-        + control_flow_define
-        + f.read(),
-        libraries=[],
-    )
+# The engine is built into libdebug-core, which the module links to
+if __name__ != "libdebug_core":
+    runpy.run_path("libdebug/core/build_core.py")["build_library"](Path("libdebug/core"))
+
+ffibuilder.set_source(
+    "libdebug.cffi._ptrace_cffi",
+    ptrace_regs_struct
+    + arch_define
+    + fp_regs_struct
+    + fpregs_define
+    + breakpoint_define
+    + '#include "ptrace_cffi_source.h"',
+    include_dirs=["libdebug/cffi"],
+    libraries=["debug-core"],
+    library_dirs=["libdebug/core"],
+    extra_link_args=["-Wl,-rpath,$ORIGIN/../core"],
+)
 
 if __name__ == "__main__":
     ffibuilder.compile(verbose=True)
@@ -4,17 +4,28 @@
 // Licensed under the MIT license. See LICENSE file in the project root for details.
 //
 
+#include <dirent.h>
 #include <elf.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <signal.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/ptrace.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <sys/user.h>
 #include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ptrace_cffi_source.h"
 
 // Run some static assertions to ensure that the fp types are correct
 #ifdef ARCH_AMD64
@@ -37,51 +48,39 @@
     #endif
 #endif
 
-struct ptrace_hit_bp {
-    int pid;
-    uint64_t addr;
-    uint64_t bp_instruction;
-    uint64_t prev_instruction;
-};
-
-struct software_breakpoint {
-    uint64_t addr;
-    uint64_t instruction;
-    uint64_t patched_instruction;
-    char enabled;
-    struct software_breakpoint *next;
-};
+int is_sw_breakpoint_armed(struct global_state *state, struct software_breakpoint *b)
+{
+    return b->enabled || (b->native_traps & state->native_traps_enabled);
+}
 
-struct hardware_breakpoint {
-    uint64_t addr;
-    int tid;
-    char enabled;
-    char type[2];
-    char len;
-    struct hardware_breakpoint *next;
-};
+int sw_breakpoint_selects_thread(struct software_breakpoint *b, int tid)
+{
+    // A breakpoint without a thread filter is hit by every thread
+    if (!b->thread_count) return 1;
 
-struct thread {
-    int tid;
-    struct ptrace_regs_struct regs;
-    struct fp_regs_struct fpregs;
-    int signal_to_forward;
-    struct thread *next;
-};
+    for (int i = 0; i < b->thread_count; i++)
+        if (b->threads[i] == tid) return 1;
 
-struct thread_status {
-    int tid;
-    int status;
-    struct thread_status *next;
-};
+    return 0;
+}
 
-struct global_state {
-    struct thread *t_HEAD;
-    struct thread *dead_t_HEAD;
-    struct software_breakpoint *sw_b_HEAD;
-    struct hardware_breakpoint *hw_b_HEAD;
-    _Bool handle_syscall_enabled;
-};
+int handle_native_trap(struct global_state *state, struct thread *t, struct software_breakpoint *b);
+int handle_native_callback(struct global_state *state, struct thread *t, uint64_t address);
+uint64_t monotonic_time(void);
+void ra_forget_thread(struct global_state *state, int tid);
+void trace_forget_thread(struct global_state *state, int tid);
+void heap_forget_thread(struct global_state *state, int tid);
+void set_profiler_process_running(struct global_state *state, _Bool running);
+void dispatch_profiler_sample(struct global_state *state, int pid, struct thread_status **head);
+void set_budget_process_running(struct global_state *state, _Bool running);
+int dispatch_budget(struct global_state *state, int pid, struct thread_status **head);
+void dispatch_virtual_clock(struct global_state *state, struct thread_status *head);
+void drop_syscall_stops(struct thread_status **head);
+void virtual_clock_forget_thread(struct global_state *state, int tid);
+void dispatch_syscall_profiler(struct global_state *state, struct thread_status *head);
+void syscall_profiler_forget_thread(struct global_state *state, int tid);
+void dispatch_fd_table(struct global_state *state, struct thread_status *head);
+void fd_table_forget_thread(struct global_state *state, int tid);
 
 #ifdef ARCH_AMD64
 int getregs(int tid, struct ptrace_regs_struct *regs)
@@ -525,6 +524,13 @@ void unregister_thread(struct global_state *state, int tid)
             // Add the thread to the dead list
             t->next = state->dead_t_HEAD;
             state->dead_t_HEAD = t;
+
+            ra_forget_thread(state, tid);
+            trace_forget_thread(state, tid);
+            heap_forget_thread(state, tid);
+            virtual_clock_forget_thread(state, tid);
+            syscall_profiler_forget_thread(state, tid);
+            fd_table_forget_thread(state, tid);
             return;
         }
         prev = t;
@@ -652,12 +658,142 @@ void ptrace_detach_and_cont(struct global_state *state, int pid)
     kill(pid, SIGCONT);
 }
 
+#define TRACE_OPTIONS                                                                                          \
+    (PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC | \
+     PTRACE_O_TRACEEXIT)
+
 void ptrace_set_options(int pid)
 {
-    int options = PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACESYSGOOD |
-                  PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC | PTRACE_O_TRACEEXIT;
+    ptrace(PTRACE_SETOPTIONS, pid, NULL, TRACE_OPTIONS);
+}
+
+struct seized_task {
+    int tid;
+    int status;
+};
+
+struct seized_tasks {
+    struct seized_task *tasks;
+    int count;
+    int capacity;
+};
+
+struct seized_task *find_seized_task(struct seized_tasks *seized, int tid)
+{
+    for (int i = 0; i < seized->count; i++)
+        if (seized->tasks[i].tid == tid) return &seized->tasks[i];
+
+    return NULL;
+}
+
+struct seized_task *add_seized_task(struct seized_tasks *seized, int tid)
+{
+    if (seized->count == seized->capacity) {
+        seized->capacity = seized->capacity ? seized->capacity * 2 : 64;
+        seized->tasks = realloc(seized->tasks, seized->capacity * sizeof(struct seized_task));
+    }
+
+    struct seized_task *task = &seized->tasks[seized->count++];
+    task->tid = tid;
+    task->status = 0;
+
+    return task;
+}
+
+int scan_new_tasks(int pid, struct seized_tasks *seized, _Bool stopped)
+{
+    char path[64];
+    int found = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+
+    DIR *dir = opendir(path);
+    if (dir == NULL) return -1;
+
+    struct dirent *entry;
+
+    while ((entry = readdir(dir)) != NULL) {
+        int tid = atoi(entry->d_name);
+
+        if (tid <= 0 || find_seized_task(seized, tid) != NULL) continue;
+
+        if (stopped) {
+            // Every task is traced by now, the new ones were attached on their creation and start stopped
+            struct seized_task *task = add_seized_task(seized, tid);
+            waitpid(tid, &task->status, __WALL);
+            found++;
+        } else if (!ptrace(PTRACE_SEIZE, tid, NULL, TRACE_OPTIONS)) {
+            add_seized_task(seized, tid);
+            found++;
+        } else if (errno == EPERM && seized->count) {
+            // The task was created by a seized one, so it is already ours, and it will stop on its own
+            struct seized_task *task = add_seized_task(seized, tid);
+            task->status = -1;
+            found++;
+        } else if (tid == pid) {
+            closedir(dir);
+            return -1;
+        }
+    }
+
+    closedir(dir);
+
+    return found;
+}
+
+int ptrace_seize_all(struct global_state *state, int pid)
+{
+    struct seized_tasks seized = {0};
+    int found;
+
+    // The main thread comes first, so that it is registered first and detached last
+    if (ptrace(PTRACE_SEIZE, pid, NULL, TRACE_OPTIONS)) return -1;
+
+    add_seized_task(&seized, pid);
+
+    // The threads created meanwhile by the seized ones are traced automatically, the others are found by scanning
+    // the tasks again, until no new one appears
+    do {
+        found = scan_new_tasks(pid, &seized, 0);
+    } while (found > 0);
+
+    // All the tasks are stopped at once, then their stops are collected
+    for (int i = 0; i < seized.count; i++)
+        if (!seized.tasks[i].status) ptrace(PTRACE_INTERRUPT, seized.tasks[i].tid, NULL, NULL);
+
+    for (int i = 0; i < seized.count; i++)
+        waitpid(seized.tasks[i].tid, &seized.tasks[i].status, __WALL);
+
+    // The threads created before the interruption reached their parent are attached and stopped as well
+    do {
+        found = scan_new_tasks(pid, &seized, 1);
+    } while (found > 0);
+
+    int count = 0;
 
-    ptrace(PTRACE_SETOPTIONS, pid, NULL, options);
+    for (int i = 0; i < seized.count; i++) {
+        struct seized_task *task = &seized.tasks[i];
+
+        // The task exited while it was being seized
+        if (!WIFSTOPPED(task->status)) continue;
+
+        register_thread(state, task->tid);
+        count++;
+
+        // A signal received meanwhile is delivered on the first resume
+        int signum = WSTOPSIG(task->status);
+        if (!(task->status >> 16) && signum != SIGTRAP && signum != (SIGTRAP | 0x80) && signum != SIGSTOP)
+            get_thread(state, task->tid)->signal_to_forward = signum;
+    }
+
+    free(seized.tasks);
+
+    if (!count) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    return count;
 }
 
 uint64_t ptrace_peekdata(int pid, uint64_t addr)
@@ -724,6 +860,459 @@ long singlestep(struct global_state *state, int tid)
 #endif
 }
 
+// The kinds of instructions the decoder tells apart, to find the end of the basic blocks
+#define INSTRUCTION_PLAIN 0
+#define INSTRUCTION_BRANCH 1
+#define INSTRUCTION_CALL 2
+#define INSTRUCTION_RETURN 3
+// Syscalls, traps and the other instructions that enter the kernel
+#define INSTRUCTION_SYSTEM 4
+#define INSTRUCTION_INVALID 5
+
+struct decoded_instruction {
+    int length;
+    int kind;
+};
+
+#ifdef ARCH_AMD64
+#define MAX_INSTRUCTION_SIZE 15
+
+int is_legacy_prefix(uint8_t byte)
+{
+    return byte == 0xF0 || byte == 0xF2 || byte == 0xF3 || byte == 0x2E || byte == 0x36 || byte == 0x3E ||
+           byte == 0x26 || byte == 0x64 || byte == 0x65 || byte == 0x66 || byte == 0x67;
+}
+
+int one_byte_has_modrm(uint8_t opcode)
+{
+    // The arithmetic instructions in the first four rows, e.g., add r/m, r
+    if (opcode < 0x40) return (opcode & 7) < 4;
+
+    if (opcode >= 0x80 && opcode <= 0x8F) return 1;
+    if (opcode >= 0xD0 && opcode <= 0xD3) return 1;
+    // x87
+    if (opcode >= 0xD8 && opcode <= 0xDF) return 1;
+
+    return opcode == 0x63 || opcode == 0x69 || opcode == 0x6B || opcode == 0xC0 || opcode == 0xC1 ||
+           opcode == 0xC6 || opcode == 0xC7 || opcode == 0xF6 || opcode == 0xF7 || opcode == 0xFE || opcode == 0xFF;
+}
+
+int one_byte_is_invalid(uint8_t opcode)
+{
+    // The instructions removed in 64-bit mode
+    return opcode == 0x06 || opcode == 0x07 || opcode == 0x0E || opcode == 0x16 || opcode == 0x17 || opcode == 0x1E ||
+           opcode == 0x1F || opcode == 0x27 || opcode == 0x2F || opcode == 0x37 || opcode == 0x3F || opcode == 0x60 ||
+           opcode == 0x61 || opcode == 0x82 || opcode == 0x9A || opcode == 0xCE || opcode == 0xD4 || opcode == 0xD5 ||
+           opcode == 0xD6 || opcode == 0xEA;
+}
+
+int one_byte_immediate_size(uint8_t opcode, uint8_t modrm, int operand_size, int rex_w, int address_size)
+{
+    if (opcode < 0x40) {
+        if ((opcode & 7) == 4) return 1;
+        if ((opcode & 7) == 5) return operand_size;
+        return 0;
+    }
+
+    // jcc rel8, mov r8, imm8, loop and jrcxz rel8, in and out imm8
+    if ((opcode >= 0x70 && opcode <= 0x7F) || (opcode >= 0xB0 && opcode <= 0xB7) || (opcode >= 0xE0 && opcode <= 0xE7))
+        return 1;
+
+    // mov r, imm, the only instruction with a 64-bit immediate
+    if (opcode >= 0xB8 && opcode <= 0xBF) return rex_w ? 8 : operand_size;
+
+    // mov with a memory offset
+    if (opcode >= 0xA0 && opcode <= 0xA3) return address_size;
+
+    switch (opcode) {
+    case 0x6A:
+    case 0x6B:
+    case 0x80:
+    case 0x83:
+    case 0xA8:
+    case 0xC0:
+    case 0xC1:
+    case 0xC6:
+    case 0xCD:
+    case 0xEB:
+        return 1;
+    case 0x68:
+    case 0x69:
+    case 0x81:
+    case 0xA9:
+    case 0xC7:
+        return operand_size;
+    case 0xE8:
+    case 0xE9:
+        // The relative offsets are not shortened by the operand size prefix in 64-bit mode
+        return 4;
+    case 0xC2:
+    case 0xCA:
+        return 2;
+    case 0xC8:
+        return 3;
+    case 0xF6:
+        // Only test has an immediate in the group
+        return ((modrm >> 3) & 7) < 2 ? 1 : 0;
+    case 0xF7:
+        return ((modrm >> 3) & 7) < 2 ? operand_size : 0;
+    }
+
+    return 0;
+}
+
+int one_byte_kind(uint8_t opcode, uint8_t modrm)
+{
+    if ((opcode >= 0x70 && opcode <= 0x7F) || (opcode >= 0xE0 && opcode <= 0xE3) || opcode == 0xE9 || opcode == 0xEB)
+        return INSTRUCTION_BRANCH;
+
+    if (opcode == 0xE8) return INSTRUCTION_CALL;
+
+    if (opcode == 0xC2 || opcode == 0xC3 || opcode == 0xCA || opcode == 0xCB) return INSTRUCTION_RETURN;
+
+    // int3, int n, iret, int1 and hlt
+    if (opcode == 0xCC || opcode == 0xCD || opcode == 0xCF || opcode == 0xF1 || opcode == 0xF4)
+        return INSTRUCTION_SYSTEM;
+
+    if (opcode == 0xFF) {
+        // call and jmp, near and far, through a register or the memory
+        int reg = (modrm >> 3) & 7;
+
+        if (reg == 2 || reg == 3) return INSTRUCTION_CALL;
+        if (reg == 4 || reg == 5) return INSTRUCTION_BRANCH;
+    }
+
+    return INSTRUCTION_PLAIN;
+}
+
+int two_byte_has_modrm(uint8_t opcode)
+{
+    // jcc rel32, bswap and the system instructions, e.g., rdtsc
+    if ((opcode >= 0x80 && opcode <= 0x8F) || (opcode >= 0xC8 && opcode <= 0xCF) || (opcode >= 0x30 && opcode <= 0x37))
+        return 0;
+
+    return !(opcode == 0x05 || opcode == 0x06 || opcode == 0x07 || opcode == 0x08 || opcode == 0x09 ||
+             opcode == 0x0B || opcode == 0x0E || opcode == 0x77 || opcode == 0xA0 || opcode == 0xA1 ||
+             opcode == 0xA2 || opcode == 0xA8 || opcode == 0xA9 || opcode == 0xAA);
+}
+
+int two_byte_immediate_size(uint8_t opcode)
+{
+    if (opcode >= 0x80 && opcode <= 0x8F) return 4;
+
+    // The shuffles and shifts by an immediate, shld, shrd, the bit tests and the vector comparisons
+    if ((opcode >= 0x70 && opcode <= 0x73) || opcode == 0x0F || opcode == 0xA4 || opcode == 0xAC || opcode == 0xBA ||
+        (opcode >= 0xC2 && opcode <= 0xC6 && opcode != 0xC3))
+        return 1;
+
+    return 0;
+}
+
+int two_byte_kind(uint8_t opcode)
+{
+    if (opcode >= 0x80 && opcode <= 0x8F) return INSTRUCTION_BRANCH;
+
+    // syscall, sysret, sysenter, sysexit and the undefined instructions
+    if (opcode == 0x05 || opcode == 0x07 || opcode == 0x34 || opcode == 0x35 || opcode == 0x0B || opcode == 0xB9 ||
+        opcode == 0xFF)
+        return INSTRUCTION_SYSTEM;
+
+    return INSTRUCTION_PLAIN;
+}
+
+int modrm_size(const uint8_t *code, size_t size)
+{
+    // The size of the ModRM byte, with the SIB byte and the displacement that follow it, 0 if it is truncated
+    if (size < 1) return 0;
+
+    int mod = code[0] >> 6, rm = code[0] & 7, length = 1;
+
+    if (mod == 3) return 1;
+
+    if (rm == 4) {
+        if (size < 2) return 0;
+
+        length++;
+
+        // No base register, only a displacement
+        if (mod == 0 && (code[1] & 7) == 5) length += 4;
+    } else if (mod == 0 && rm == 5) {
+        // rip-relative
+        length += 4;
+    }
+
+    if (mod == 1) length += 1;
+    else if (mod == 2) length += 4;
+
+    return length;
+}
+
+int decode_instruction(const uint8_t *code, size_t size, struct decoded_instruction *instruction)
+{
+    // Decodes the length and the kind of the x86-64 instruction at the start of the code
+    // Returns -1 if the code ends before the instruction does
+    size_t i = 0;
+    int operand_size = 4, address_size = 8, rex_w = 0;
+
+    if (size > MAX_INSTRUCTION_SIZE) size = MAX_INSTRUCTION_SIZE;
+
+    while (i < size && is_legacy_prefix(code[i])) {
+        if (code[i] == 0x66) operand_size = 2;
+        if (code[i] == 0x67) address_size = 4;
+        i++;
+    }
+
+    if (i < size && (code[i] & 0xF0) == 0x40) {
+        rex_w = (code[i] >> 3) & 1;
+        i++;
+    }
+
+    if (i >= size) return -1;
+
+    uint8_t opcode = code[i++];
+    int kind = INSTRUCTION_PLAIN, has_modrm, immediate_size;
+
+    if (opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62) {
+        // VEX and EVEX, whose payload selects the opcode map
+        size_t payload = opcode == 0xC5 ? 1 : (opcode == 0xC4 ? 2 : 3);
+
+        if (i + payload >= size) return -1;
+
+        int map = opcode == 0xC5 ? 1 : (opcode == 0xC4 ? code[i] & 0x1F : code[i] & 0x7);
+
+        i += payload;
+        opcode = code[i++];
+
+        if (map < 1 || map > 6 || map == 4) {
+            instruction->length = i;
+            instruction->kind = INSTRUCTION_INVALID;
+            return 0;
+        }
+
+        // vzeroupper and vzeroall have no operands
+        has_modrm = !(map == 1 && opcode == 0x77);
+        immediate_size = map == 3 || (map == 1 && two_byte_immediate_size(opcode) == 1) ? 1 : 0;
+    } else if (opcode == 0x0F) {
+        if (i >= size) return -1;
+
+        opcode = code[i++];
+
+        if (opcode == 0x38 || opcode == 0x3A) {
+            // The three-byte opcodes always have a ModRM byte, and the 0F 3A ones an imm8
+            if (i >= size) return -1;
+
+            i++;
+            has_modrm = 1;
+            immediate_size = opcode == 0x3A ? 1 : 0;
+        } else {
+            has_modrm = two_byte_has_modrm(opcode);
+            immediate_size = two_byte_immediate_size(opcode);
+            kind = two_byte_kind(opcode);
+        }
+    } else {
+        if (one_byte_is_invalid(opcode)) {
+            instruction->length = i;
+            instruction->kind = INSTRUCTION_INVALID;
+            return 0;
+        }
+
+        has_modrm = one_byte_has_modrm(opcode);
+
+        if (has_modrm && i >= size) return -1;
+
+        uint8_t modrm = has_modrm ? code[i] : 0;
+
+        immediate_size = one_byte_immediate_size(opcode, modrm, operand_size, rex_w, address_size);
+        kind = one_byte_kind(opcode, modrm);
+    }
+
+    if (has_modrm) {
+        int length = modrm_size(code + i, size - i);
+
+        if (!length) return -1;
+
+        i += length;
+    }
+
+    i += immediate_size;
+
+    if (i > size) return -1;
+
+    instruction->length = i;
+    instruction->kind = kind;
+
+    return 0;
+}
+#endif
+
+#ifdef ARCH_AARCH64
+#define MAX_INSTRUCTION_SIZE 4
+
+int decode_instruction(const uint8_t *code, size_t size, struct decoded_instruction *instruction)
+{
+    // Classifies the AArch64 instruction at the start of the code
+    // Returns -1 if the code ends before the instruction does
+    uint32_t opcode;
+
+    if (size < sizeof(opcode)) return -1;
+
+    memcpy(&opcode, code, sizeof(opcode));
+
+    instruction->length = sizeof(opcode);
+
+    if ((opcode & 0xFC000000) == 0x94000000) {
+        // bl
+        instruction->kind = INSTRUCTION_CALL;
+    } else if ((opcode & 0xFC000000) == 0x14000000 || (opcode & 0xFF000000) == 0x54000000 ||
+               (opcode & 0x7E000000) == 0x34000000 || (opcode & 0x7E000000) == 0x36000000) {
+        // b, b.cond, cbz, cbnz, tbz and tbnz
+        instruction->kind = INSTRUCTION_BRANCH;
+    } else if ((opcode & 0xFE000000) == 0xD6000000) {
+        // The branches to a register, classified by their opc field, with or without pointer authentication
+        int opc = (opcode >> 21) & 0xF;
+
+        if (opc == 1)
+            instruction->kind = INSTRUCTION_CALL;
+        else if (opc == 2)
+            instruction->kind = INSTRUCTION_RETURN;
+        else if (opc == 0)
+            instruction->kind = INSTRUCTION_BRANCH;
+        else
+            // eret and drps
+            instruction->kind = INSTRUCTION_SYSTEM;
+    } else if ((opcode & 0xFF000000) == 0xD4000000) {
+        // svc, hvc, smc, brk and hlt
+        instruction->kind = INSTRUCTION_SYSTEM;
+    } else if ((opcode & 0xFFFF0000) == 0) {
+        // udf
+        instruction->kind = INSTRUCTION_INVALID;
+    } else {
+        instruction->kind = INSTRUCTION_PLAIN;
+    }
+
+    return 0;
+}
+#endif
+
+size_t read_code(int tid, uint64_t address, uint8_t *buffer, size_t size)
+{
+    // Reads the code at the address, up to the end of its mapping, returning the number of bytes read
+    struct iovec local = {buffer, size}, remote = {(void *)address, size};
+    ssize_t count = process_vm_readv(tid, &local, 1, &remote, 1, 0);
+
+    if (count > 0) return count;
+
+    // The code could be mapped without read permission, which ptrace ignores
+    size_t read = 0;
+
+    while (read + sizeof(uint64_t) <= size) {
+        errno = 0;
+        uint64_t word = ptrace(PTRACE_PEEKDATA, tid, (void *)(address + read), NULL);
+        if (errno) break;
+
+        memcpy(buffer + read, &word, sizeof(word));
+        read += sizeof(word);
+    }
+
+    return read;
+}
+
+// The code read at once to find the end of a basic block, plus the room for the word patched by the trap
+#define BLOCK_WINDOW_SIZE 256
+
+#define BLOCK_COMPLETED 0
+#define BLOCK_INTERRUPTED 1
+
+int run_basic_block(struct thread *t, uint64_t stop_address, int max_instructions, int *executed)
+{
+    // Runs the thread at full speed over the straight-line code from its current instruction, up to the next
+    // control-flow transfer, the stop address, or the maximum number of instructions (-1 for no limit),
+    // by placing a temporary trap there. Nothing is executed if the current instruction transfers control.
+    // Returns BLOCK_INTERRUPTED if something else stopped the thread in the block, e.g., a signal or a
+    // hardware breakpoint, -1 on errors. The number of executed instructions is stored in executed.
+    uint8_t code[BLOCK_WINDOW_SIZE + sizeof(uint64_t)];
+    uint64_t start = INSTRUCTION_POINTER(t->regs), end, instruction, ip;
+    struct decoded_instruction decoded;
+    size_t size = read_code(t->tid, start, code, sizeof(code)), offset = 0;
+    int count = 0, status, ret = BLOCK_COMPLETED;
+
+    *executed = 0;
+
+    while ((max_instructions == -1 || count < max_instructions) && offset < BLOCK_WINDOW_SIZE) {
+        if (count && start + offset == stop_address) break;
+
+        if (decode_instruction(code + offset, size - offset, &decoded) || decoded.kind != INSTRUCTION_PLAIN) break;
+
+        offset += decoded.length;
+        count++;
+    }
+
+    if (!count) return BLOCK_COMPLETED;
+
+    end = start + offset;
+
+    if (offset + sizeof(instruction) <= size) {
+        memcpy(&instruction, code + offset, sizeof(instruction));
+    } else {
+        errno = 0;
+        instruction = ptrace(PTRACE_PEEKDATA, t->tid, (void *)end, NULL);
+        if (errno) return -1;
+    }
+
+    if (ptrace(PTRACE_POKEDATA, t->tid, (void *)end, INSTALL_BREAKPOINT(instruction))) return -1;
+
+    if (ptrace(PTRACE_CONT, t->tid, NULL, NULL) || waitpid(t->tid, &status, __WALL) == -1) {
+        ret = -1;
+        goto restore;
+    }
+
+    if (!WIFSTOPPED(status)) {
+        // The thread was killed in the block
+        errno = ESRCH;
+        ret = -1;
+        goto restore;
+    }
+
+    if (getregs(t->tid, &t->regs)) {
+        ret = -1;
+        goto restore;
+    }
+
+    ip = INSTRUCTION_POINTER(t->regs);
+
+#ifdef ARCH_AMD64
+    // On amd64 the trap is reported after the int3 instruction
+    if (WSTOPSIG(status) == SIGTRAP && ip == end + BREAKPOINT_SIZE) {
+        t->regs.rip = ip = end;
+
+        if (setregs(t->tid, &t->regs)) ret = -1;
+    }
+#endif
+
+    if (WSTOPSIG(status) == SIGTRAP && ip == end) {
+        *executed = count;
+        goto restore;
+    }
+
+    // The signals that stopped the thread in the block are forwarded on the next resume
+    if (WSTOPSIG(status) != SIGTRAP && WSTOPSIG(status) != SIGSTOP && !t->signal_to_forward)
+        t->signal_to_forward = WSTOPSIG(status);
+
+    // Count the instructions before the one the thread stopped at
+    for (offset = 0; start + offset < ip && offset < size; offset += decoded.length) {
+        if (decode_instruction(code + offset, size - offset, &decoded)) break;
+
+        (*executed)++;
+    }
+
+    ret = BLOCK_INTERRUPTED;
+
+restore:
+    if (ptrace(PTRACE_POKEDATA, t->tid, (void *)end, instruction)) ret = -1;
+
+    return ret;
+}
+
 int step_until(struct global_state *state, int tid, uint64_t addr, int max_steps)
 {
     // flush any register changes
@@ -740,7 +1329,7 @@ int step_until(struct global_state *state, int tid, uint64_t addr, int max_steps
         t = t->next;
     }
 
-    int count = 0, status = 0;
+    int count = 0, status = 0, executed;
     uint64_t previous_ip;
 
     if (!stepping_thread) {
@@ -759,6 +1348,18 @@ int step_until(struct global_state *state, int tid, uint64_t addr, int max_steps
     }
 
     while (max_steps == -1 || count < max_steps) {
+        // The straight-line code is run at once, up to the instruction that transfers control
+        if (run_basic_block(stepping_thread, addr, max_steps == -1 ? -1 : max_steps - count, &executed) == -1)
+            return -1;
+
+        if (executed) {
+            count += executed;
+
+            if (INSTRUCTION_POINTER(stepping_thread->regs) == addr) break;
+
+            continue;
+        }
+
         if (ptrace(PTRACE_SINGLESTEP, tid, NULL, NULL)) return -1;
 
         // wait for the child
@@ -886,13 +1487,15 @@ int prepare_for_run(struct global_state *state, int pid)
     // Reset any software breakpoint
     b = state->sw_b_HEAD;
     while (b != NULL) {
-        if (b->enabled) {
+        if (is_sw_breakpoint_armed(state, b)) {
             ptrace(PTRACE_POKEDATA, pid, (void *)b->addr,
                    b->patched_instruction);
         }
         b = b->next;
     }
 
+    state->sw_breakpoints_installed = 1;
+
     return status;
 }
 
@@ -900,6 +1503,10 @@ int cont_all_and_set_bps(struct global_state *state, int pid)
 {
     int status = prepare_for_run(state, pid);
 
+    // The profiler only samples while the process runs freely, and the budget is only enforced meanwhile
+    set_profiler_process_running(state, 1);
+    set_budget_process_running(state, 1);
+
     // continue the execution of all the threads
     struct thread *t = state->t_HEAD;
     while (t != NULL) {
@@ -914,22 +1521,62 @@ int cont_all_and_set_bps(struct global_state *state, int pid)
     return status;
 }
 
-struct thread_status *wait_all_and_update_regs(struct global_state *state, int pid)
+void free_thread_status_list(struct thread_status *head)
 {
-    // Allocate the head of the list
-    struct thread_status *head;
-    head = malloc(sizeof(struct thread_status));
-    head->next = NULL;
-
-    // The first element is the first status we get from polling with waitpid
-    head->tid = waitpid(-getpgid(pid), &head->status, 0);
+    struct thread_status *next;
 
-    if (head->tid == -1) {
+    while (head) {
+        next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+int wait_for_first_stop(struct global_state *state, int pid, int *status)
+{
+    int pgid = -getpgid(pid);
+
+    // In latency mode the stop is polled for a while, as sleeping and waking up costs more than a short stop
+    if (state->wait_spin_ns) {
+        uint64_t deadline = monotonic_time() + state->wait_spin_ns;
+
+        do {
+            int tid = waitpid(pgid, status, WNOHANG);
+            if (tid) return tid;
+        } while (monotonic_time() < deadline);
+    }
+
+    return waitpid(pgid, status, 0);
+}
+
+int normalize_stop_status(int status)
+{
+    // The seized threads report their first stop, and the ones requested with PTRACE_INTERRUPT, as event stops:
+    // they are the SIGSTOP stops of the attached threads for the rest of the debugger
+    if (WIFSTOPPED(status) && (status >> 16) == PTRACE_EVENT_STOP) return (SIGSTOP << 8) | 0x7f;
+
+    return status;
+}
+
+struct thread_status *wait_and_interrupt_all(struct global_state *state, int pid)
+{
+    // Allocate the head of the list
+    struct thread_status *head;
+    head = malloc(sizeof(struct thread_status));
+    head->interrupted = 0;
+    head->next = NULL;
+
+    // The first element is the first status we get from polling with waitpid
+    head->tid = wait_for_first_stop(state, pid, &head->status);
+
+    if (head->tid == -1) {
         free(head);
         perror("waitpid");
         return NULL;
     }
 
+    head->status = normalize_stop_status(head->status);
+
     // We must interrupt all the other threads with a SIGSTOP
     struct thread *t = state->t_HEAD;
     int temp_tid, temp_status;
@@ -942,12 +1589,14 @@ struct thread_status *wait_all_and_update_regs(struct global_state *state, int p
                 tgkill(pid, t->tid, SIGSTOP);
                 // Wait for the thread to stop
                 temp_tid = waitpid(t->tid, &temp_status, 0);
+                temp_status = normalize_stop_status(temp_status);
 
                 // Register the status of the thread, as it might contain useful
                 // information
                 struct thread_status *ts = malloc(sizeof(struct thread_status));
                 ts->tid = temp_tid;
                 ts->status = temp_status;
+                ts->interrupted = WIFSTOPPED(temp_status) && WSTOPSIG(temp_status) == SIGSTOP;
                 ts->next = head;
                 head = ts;
             }
@@ -959,7 +1608,8 @@ struct thread_status *wait_all_and_update_regs(struct global_state *state, int p
     while ((temp_tid = waitpid(-getpgid(pid), &temp_status, WNOHANG)) > 0) {
         struct thread_status *ts = malloc(sizeof(struct thread_status));
         ts->tid = temp_tid;
-        ts->status = temp_status;
+        ts->status = normalize_stop_status(temp_status);
+        ts->interrupted = 0;
         ts->next = head;
         head = ts;
     }
@@ -971,88 +1621,298 @@ struct thread_status *wait_all_and_update_regs(struct global_state *state, int p
         t = t->next;
     }
 
-    // Restore any software breakpoint
-    struct software_breakpoint *b = state->sw_b_HEAD;
+    return head;
+}
 
-    while (b != NULL) {
-        if (b->enabled) {
-            ptrace(PTRACE_POKEDATA, pid, (void *)b->addr, b->instruction);
+int is_hw_breakpoint_hit_on_thread(struct global_state *state, int tid)
+{
+    struct hardware_breakpoint *bp = state->hw_b_HEAD;
+
+    while (bp != NULL) {
+        if (bp->tid == tid && bp->enabled && is_breakpoint_hit(bp))
+            return 1;
+
+        bp = bp->next;
+    }
+
+    return 0;
+}
+
+void repatch_sw_breakpoints(struct global_state *state, int tid, struct software_breakpoint *b)
+{
+    // Patch the breakpoint, together with the breakpoints whose word overlaps with it,
+    // as writing the word of the first one might have removed them
+    struct software_breakpoint *cursor = b;
+    while (cursor != NULL && cursor->addr < b->addr + sizeof(uint64_t)) {
+        if (is_sw_breakpoint_armed(state, cursor))
+            ptrace(PTRACE_POKEDATA, tid, (void *)cursor->addr, cursor->patched_instruction);
+
+        cursor = cursor->next;
+    }
+}
+
+void step_over_native_trap(struct global_state *state, struct thread *t, struct software_breakpoint *b)
+{
+    int status;
+
+    // The handler moved the thread away from the trap, there is nothing to step over
+    if (INSTRUCTION_POINTER(t->regs) != b->addr) {
+        if (setregs(t->tid, &t->regs))
+            fprintf(stderr, "ptrace_setregs failed for thread %d: %s\\n", t->tid, strerror(errno));
+        return;
+    }
+
+    // Restore the original instruction only for the duration of the step
+    ptrace(PTRACE_POKEDATA, t->tid, (void *)b->addr, b->instruction);
+
+    if (setregs(t->tid, &t->regs))
+        fprintf(stderr, "ptrace_setregs failed for thread %d: %s\\n", t->tid, strerror(errno));
+
+    if (!ptrace(PTRACE_SINGLESTEP, t->tid, NULL, NULL)) {
+        waitpid(t->tid, &status, 0);
+
+        // A pending SIGSTOP might be delivered instead of the step, see prepare_for_run
+        if (status == 4991) {
+            ptrace(PTRACE_SINGLESTEP, t->tid, NULL, NULL);
+            waitpid(t->tid, &status, 0);
         }
-        b = b->next;
     }
 
-    return head;
+    getregs(t->tid, &t->regs);
+
+    repatch_sw_breakpoints(state, t->tid, b);
 }
 
-void free_thread_status_list(struct thread_status *head)
+int dispatch_native_traps(struct global_state *state, struct thread_status **head)
 {
-    struct thread_status *next;
+    struct thread_status *ts = *head, *prev = NULL, *next;
+    struct software_breakpoint *b;
+    struct thread *t;
+    uint64_t addr;
+    int visible = 0, consumed;
 
-    while (head) {
-        next = head->next;
-        free(head);
-        head = next;
+    while (ts != NULL) {
+        next = ts->next;
+        consumed = 0;
+
+        if (ts->interrupted) {
+            prev = ts;
+            ts = next;
+            continue;
+        }
+
+        // Only plain SIGTRAP stops (no ptrace events, no syscall stops) can come from a trap
+        if (WIFSTOPPED(ts->status) && WSTOPSIG(ts->status) == SIGTRAP && !(ts->status >> 16) &&
+            (t = get_thread(state, ts->tid)) != NULL && !is_hw_breakpoint_hit_on_thread(state, ts->tid)) {
+            addr = INSTRUCTION_POINTER(t->regs);
+
+#ifdef ARCH_AMD64
+            // On amd64 the trap is reported after the int3 instruction
+            addr -= BREAKPOINT_SIZE;
+#endif
+
+            b = state->sw_b_HEAD;
+            while (b != NULL && b->addr < addr)
+                b = b->next;
+
+            // The breakpoints scoped to other threads are stepped over as the native traps
+            int selected = b != NULL && b->addr == addr && sw_breakpoint_selects_thread(b, t->tid);
+
+            if (b != NULL && b->addr == addr &&
+                ((b->native_traps & state->native_traps_enabled) || (b->enabled && !selected))) {
+                uint64_t reported = INSTRUCTION_POINTER(t->regs);
+
+                // The handlers see the thread stopped on the trap, and they can move it elsewhere
+                INSTRUCTION_POINTER(t->regs) = addr;
+
+                int action = handle_native_trap(state, t, b);
+
+                // A user breakpoint on the same address is always reported
+                if (!b->enabled || !selected) {
+                    if (action == NATIVE_TRAP_RESUME) {
+                        step_over_native_trap(state, t, b);
+                        consumed = 1;
+                    }
+                } else if (INSTRUCTION_POINTER(t->regs) == addr) {
+                    INSTRUCTION_POINTER(t->regs) = reported;
+                }
+            }
+        }
+
+        if (consumed) {
+            if (prev == NULL)
+                *head = next;
+            else
+                prev->next = next;
+
+            free(ts);
+        } else {
+            visible = 1;
+            prev = ts;
+        }
+
+        ts = next;
     }
+
+    return visible;
 }
 
-void register_breakpoint(struct global_state *state, int pid, uint64_t address)
+void resume_after_native_traps(struct global_state *state)
+{
+    // The registers were flushed while stepping over the traps, we only need to continue
+    struct thread *t = state->t_HEAD;
+
+    while (t != NULL) {
+        if (ptrace(state->handle_syscall_enabled ? PTRACE_SYSCALL : PTRACE_CONT, t->tid, NULL, t->signal_to_forward))
+            fprintf(stderr, "ptrace_cont failed for thread %d with signal %d: %s\\n", t->tid, t->signal_to_forward,
+                    strerror(errno));
+        t->signal_to_forward = 0;
+        t = t->next;
+    }
+}
+
+int has_visible_status(struct thread_status *head)
 {
-    uint64_t instruction, patched_instruction;
+    while (head != NULL) {
+        if (!head->interrupted) return 1;
+        head = head->next;
+    }
+
+    return 0;
+}
+
+struct thread_status *wait_all_and_update_regs(struct global_state *state, int pid)
+{
+    struct thread_status *head;
+    int visible;
 
-    instruction = ptrace(PTRACE_PEEKDATA, pid, (void *)address, NULL);
+    while (1) {
+        head = wait_and_interrupt_all(state, pid);
 
-    patched_instruction = INSTALL_BREAKPOINT(instruction);
+        if (head == NULL) break;
 
-    ptrace(PTRACE_POKEDATA, pid, (void *)address, patched_instruction);
+        // The stops requested by the profiler are sampled and consumed here
+        dispatch_profiler_sample(state, pid, &head);
 
+        // The syscalls are fast-forwarded by the virtual clock before anyone else sees them
+        dispatch_virtual_clock(state, head);
+
+        // The syscall latencies are measured between the entry and the exit stops
+        dispatch_syscall_profiler(state, head);
+
+        // The descriptors created and closed by the syscalls are kept in the native table
+        dispatch_fd_table(state, head);
+
+        // The stops are accounted to the budget, and the run is interrupted when it is exhausted
+        int exhausted = dispatch_budget(state, pid, &head);
+
+        // The syscall stops requested only by the native code are not reported
+        if (state->consume_syscall_stops) drop_syscall_stops(&head);
+
+        // Every stop caused by a native trap is handled here, and it is reported only
+        // if it has something to say, or if other events have to be reported anyway
+        if (state->sw_breakpoints_installed && (state->native_traps_enabled || state->scoped_sw_breakpoints))
+            visible = dispatch_native_traps(state, &head);
+        else
+            visible = has_visible_status(head);
+
+        if (visible || exhausted) break;
+
+        // Only our own SIGSTOPs can be left in the list at this point
+        free_thread_status_list(head);
+
+        resume_after_native_traps(state);
+    }
+
+    set_profiler_process_running(state, 0);
+    set_budget_process_running(state, 0);
+
+    // Restore any software breakpoint
     struct software_breakpoint *b = state->sw_b_HEAD;
 
     while (b != NULL) {
-        if (b->addr == address) {
-            b->enabled = 1;
-            return;
+        if (is_sw_breakpoint_armed(state, b)) {
+            ptrace(PTRACE_POKEDATA, pid, (void *)b->addr, b->instruction);
         }
         b = b->next;
     }
 
-    b = malloc(sizeof(struct software_breakpoint));
-    b->addr = address;
-    b->instruction = instruction;
-    b->patched_instruction = patched_instruction;
-    b->enabled = 1;
+    state->sw_breakpoints_installed = 0;
+
+    return head;
+}
+
+struct software_breakpoint *get_or_create_sw_breakpoint(struct global_state *state, int pid, uint64_t address)
+{
+    struct software_breakpoint *b = state->sw_b_HEAD;
+    struct software_breakpoint *prev = NULL;
+
+    while (b != NULL && b->addr < address) {
+        prev = b;
+        b = b->next;
+    }
+
+    if (b != NULL && b->addr == address)
+        return b;
+
+    uint64_t instruction = ptrace(PTRACE_PEEKDATA, pid, (void *)address, NULL);
+
+    // Breakpoints that are currently patched inside the word we just read must not
+    // end up in the original instruction, or they would be written back on restore
+    struct software_breakpoint *neighbor = b;
+    uint8_t *bytes = (uint8_t *)&instruction;
+    while (neighbor != NULL && neighbor->addr < address + sizeof(uint64_t)) {
+        uint64_t offset = neighbor->addr - address;
+        uint8_t *original = (uint8_t *)&neighbor->instruction;
+
+        for (uint64_t i = 0; i < BREAKPOINT_SIZE && offset + i < sizeof(uint64_t); i++)
+            bytes[offset + i] = original[i];
+
+        neighbor = neighbor->next;
+    }
+
+    struct software_breakpoint *new_b = malloc(sizeof(struct software_breakpoint));
+    new_b->addr = address;
+    new_b->instruction = instruction;
+    new_b->patched_instruction = INSTALL_BREAKPOINT(instruction);
+    new_b->enabled = 0;
+    new_b->native_traps = 0;
+    new_b->threads = NULL;
+    new_b->thread_count = 0;
 
     // Breakpoints should be inserted ordered by address, increasing
     // This is important, because we don't want a breakpoint patching another
-    if (state->sw_b_HEAD == NULL || state->sw_b_HEAD->addr > address) {
-        b->next = state->sw_b_HEAD;
-        state->sw_b_HEAD = b;
-        return;
-    } else {
-        struct software_breakpoint *prev = state->sw_b_HEAD;
-        struct software_breakpoint *next = state->sw_b_HEAD->next;
+    new_b->next = b;
+    if (prev == NULL)
+        state->sw_b_HEAD = new_b;
+    else
+        prev->next = new_b;
 
-        while (next != NULL && next->addr < address) {
-            prev = next;
-            next = next->next;
-        }
+    return new_b;
+}
 
-        b->next = next;
-        prev->next = b;
-    }
+void clear_sw_breakpoint_threads(struct global_state *state, struct software_breakpoint *b)
+{
+    if (b->thread_count) state->scoped_sw_breakpoints--;
+
+    free(b->threads);
+    b->threads = NULL;
+    b->thread_count = 0;
 }
 
-void unregister_breakpoint(struct global_state *state, uint64_t address)
+void delete_sw_breakpoint(struct global_state *state, struct software_breakpoint *target)
 {
     struct software_breakpoint *b = state->sw_b_HEAD;
     struct software_breakpoint *prev = NULL;
 
     while (b != NULL) {
-        if (b->addr == address) {
+        if (b == target) {
             if (prev == NULL) {
                 state->sw_b_HEAD = b->next;
             } else {
                 prev->next = b->next;
             }
+            clear_sw_breakpoint_threads(state, b);
             free(b);
             return;
         }
@@ -1061,6 +1921,54 @@ void unregister_breakpoint(struct global_state *state, uint64_t address)
     }
 }
 
+void register_breakpoint(struct global_state *state, int pid, uint64_t address)
+{
+    struct software_breakpoint *b = get_or_create_sw_breakpoint(state, pid, address);
+
+    b->enabled = 1;
+
+    ptrace(PTRACE_POKEDATA, pid, (void *)address, b->patched_instruction);
+}
+
+void unregister_breakpoint(struct global_state *state, uint64_t address)
+{
+    struct software_breakpoint *b = state->sw_b_HEAD;
+
+    while (b != NULL) {
+        if (b->addr == address) {
+            // Native traps on the same address keep the entry alive
+            if (b->native_traps) {
+                b->enabled = 0;
+                clear_sw_breakpoint_threads(state, b);
+            } else {
+                delete_sw_breakpoint(state, b);
+            }
+            return;
+        }
+        b = b->next;
+    }
+}
+
+void set_breakpoint_threads(struct global_state *state, uint64_t address, int *tids, int count)
+{
+    struct software_breakpoint *b = state->sw_b_HEAD;
+
+    while (b != NULL && b->addr != address)
+        b = b->next;
+
+    if (b == NULL) return;
+
+    clear_sw_breakpoint_threads(state, b);
+
+    if (count <= 0) return;
+
+    b->threads = malloc(count * sizeof(int));
+    memcpy(b->threads, tids, count * sizeof(int));
+    b->thread_count = count;
+
+    state->scoped_sw_breakpoints++;
+}
+
 void enable_breakpoint(struct global_state *state, uint64_t address)
 {
     struct software_breakpoint *b = state->sw_b_HEAD;
@@ -1091,8 +1999,8 @@ void disable_breakpoint(struct global_state *state, uint64_t address)
         b = b->next;
     }
 
-    // Restore the original instruction
-    if (b != NULL) {
+    // Restore the original instruction, unless a native trap still needs it
+    if (b != NULL && !is_sw_breakpoint_armed(state, b)) {
         ptrace(PTRACE_POKEDATA, state->t_HEAD->tid, (void *)address, b->instruction);
     }
 }
@@ -1104,11 +2012,13 @@ void free_breakpoints(struct global_state *state)
 
     while (b != NULL) {
         next = b->next;
+        free(b->threads);
         free(b);
         b = next;
     }
 
     state->sw_b_HEAD = NULL;
+    state->scoped_sw_breakpoints = 0;
 
     struct hardware_breakpoint *h = state->hw_b_HEAD;
     struct hardware_breakpoint *next_h;
@@ -1126,6 +2036,26 @@ int stepping_finish(struct global_state *state, int tid)
 {
     int status = prepare_for_run(state, tid);
 
+    // Native traps are not handled while stepping, so we must not execute them
+    struct software_breakpoint *b = state->sw_b_HEAD;
+    int native_only = 0;
+    while (b != NULL) {
+        if (!b->enabled && is_sw_breakpoint_armed(state, b)) {
+            ptrace(PTRACE_POKEDATA, tid, (void *)b->addr, b->instruction);
+            native_only = 1;
+        }
+        b = b->next;
+    }
+
+    // Restoring a word might have removed a neighboring user breakpoint
+    b = native_only ? state->sw_b_HEAD : NULL;
+    while (b != NULL) {
+        if (b->enabled) {
+            ptrace(PTRACE_POKEDATA, tid, (void *)b->addr, b->patched_instruction);
+        }
+        b = b->next;
+    }
+
     struct thread *stepping_thread = state->t_HEAD;
     while (stepping_thread != NULL) {
         if (stepping_thread->tid == tid) {
@@ -1140,8 +2070,13 @@ int stepping_finish(struct global_state *state, int tid)
         return -1;
     }
 
-    uint64_t previous_ip, current_ip;
-    uint64_t opcode_window, opcode;
+    uint64_t previous_ip, current_ip, opcode;
+    uint8_t code[MAX_INSTRUCTION_SIZE];
+    struct decoded_instruction instruction;
+    int executed;
+
+    // The thread could have stepped over a breakpoint
+    getregs(tid, &stepping_thread->regs);
 
     // We need to keep track of the nested calls
     int nested_call_counter = 1;
@@ -1157,30 +2092,38 @@ int stepping_finish(struct global_state *state, int tid)
         // update the registers
         getregs(tid, &stepping_thread->regs);
 
-        current_ip = INSTRUCTION_POINTER(stepping_thread->regs);
+        // if the instruction pointer didn't change, we return
+        // because we hit a hardware breakpoint
+        if (INSTRUCTION_POINTER(stepping_thread->regs) == previous_ip)
+            goto cleanup;
 
-        // Get value at current instruction pointer
-        opcode_window = ptrace(PTRACE_PEEKDATA, tid, (void *)current_ip, NULL);
+        // The straight-line code cannot change the nesting, it is run at once up to the next control-flow transfer
+        // The installed software breakpoints end the block as well
+        status = run_basic_block(stepping_thread, 0, -1, &executed);
 
-#ifdef ARCH_AMD64
-        // on amd64 we care only about the first byte
-        opcode = opcode_window & 0xFF;
-#endif
+        if (status == -1) return -1;
 
-#ifdef ARCH_AARCH64
-        opcode = opcode_window & 0xFFFFFFFF;
-#endif
+        if (status == BLOCK_INTERRUPTED)
+            goto cleanup;
 
-        // if the instruction pointer didn't change, we return
-        // because we hit a hardware breakpoint
-        // we do the same if we hit a software breakpoint
-        if (current_ip == previous_ip || IS_SW_BREAKPOINT(opcode))
+        current_ip = INSTRUCTION_POINTER(stepping_thread->regs);
+
+        memset(code, 0, sizeof(code));
+        read_code(tid, current_ip, code, sizeof(code));
+
+        opcode = 0;
+        memcpy(&opcode, code, BREAKPOINT_SIZE);
+
+        // we return if we hit a software breakpoint
+        if (IS_SW_BREAKPOINT(opcode))
             goto cleanup;
 
+        if (decode_instruction(code, sizeof(code), &instruction)) continue;
+
         // If we hit a call instruction, we increment the counter
-        if (IS_CALL_INSTRUCTION((uint8_t*) &opcode_window))
+        if (instruction.kind == INSTRUCTION_CALL)
             nested_call_counter++;
-        else if (IS_RET_INSTRUCTION(opcode))
+        else if (instruction.kind == INSTRUCTION_RETURN)
             nested_call_counter--;
 
     } while (nested_call_counter > 0);
@@ -1196,7 +2139,7 @@ int stepping_finish(struct global_state *state, int tid)
 
 cleanup:
     // remove any installed breakpoint
-    struct software_breakpoint *b = state->sw_b_HEAD;
+    b = state->sw_b_HEAD;
     while (b != NULL) {
         if (b->enabled) {
             ptrace(PTRACE_POKEDATA, tid, (void *)b->addr, b->instruction);
@@ -1204,6 +2147,8 @@ cleanup:
         b = b->next;
     }
 
+    state->sw_breakpoints_installed = 0;
+
     return 0;
 }
 
@@ -1303,3 +2248,4940 @@ unsigned long get_hit_hw_breakpoint(struct global_state *state, int tid)
 
     return 0;
 }
+
+struct ra_function {
+    uint64_t entry;
+    int64_t canary_offset;
+};
+
+struct ra_frame {
+    uint64_t function;
+    uint64_t slot;
+    uint64_t value;
+    int64_t canary_offset;
+};
+
+struct ra_shadow_stack {
+    int tid;
+    struct ra_frame *frames;
+    uint64_t depth;
+    uint64_t capacity;
+    struct ra_shadow_stack *next;
+};
+
+struct ra_monitor {
+    struct ra_function *functions;
+    uint64_t function_count;
+    uint64_t function_capacity;
+    _Bool sorted;
+    struct ra_shadow_stack *stacks;
+    struct ra_violation *violations;
+};
+
+struct ra_monitor *get_ra_monitor(struct global_state *state)
+{
+    if (state->ra_monitor == NULL) {
+        state->ra_monitor = calloc(1, sizeof(struct ra_monitor));
+    }
+
+    return state->ra_monitor;
+}
+
+int compare_ra_functions(const void *a, const void *b)
+{
+    uint64_t first = ((const struct ra_function *)a)->entry;
+    uint64_t second = ((const struct ra_function *)b)->entry;
+
+    return (first > second) - (first < second);
+}
+
+struct ra_function *find_ra_function(struct ra_monitor *monitor, uint64_t entry)
+{
+    if (!monitor->sorted) {
+        qsort(monitor->functions, monitor->function_count, sizeof(struct ra_function), compare_ra_functions);
+        monitor->sorted = 1;
+    }
+
+    struct ra_function key = {.entry = entry};
+
+    return bsearch(&key, monitor->functions, monitor->function_count, sizeof(struct ra_function),
+                   compare_ra_functions);
+}
+
+struct ra_shadow_stack *get_ra_shadow_stack(struct ra_monitor *monitor, int tid)
+{
+    struct ra_shadow_stack *stack = monitor->stacks;
+
+    while (stack != NULL) {
+        if (stack->tid == tid) return stack;
+        stack = stack->next;
+    }
+
+    stack = calloc(1, sizeof(struct ra_shadow_stack));
+    stack->tid = tid;
+    stack->next = monitor->stacks;
+    monitor->stacks = stack;
+
+    return stack;
+}
+
+void ra_forget_thread(struct global_state *state, int tid)
+{
+    if (state->ra_monitor == NULL) return;
+
+    struct ra_shadow_stack *stack = state->ra_monitor->stacks;
+    struct ra_shadow_stack *prev = NULL;
+
+    while (stack != NULL) {
+        if (stack->tid == tid) {
+            if (prev == NULL) {
+                state->ra_monitor->stacks = stack->next;
+            } else {
+                prev->next = stack->next;
+            }
+            free(stack->frames);
+            free(stack);
+            return;
+        }
+        prev = stack;
+        stack = stack->next;
+    }
+}
+
+int read_return_address(struct thread *t, uint64_t *value)
+{
+#ifdef ARCH_AMD64
+    // The return address is on top of the stack both at function entry and at the return
+    errno = 0;
+    *value = ptrace(PTRACE_PEEKDATA, t->tid, (void *)STACK_POINTER(t->regs), NULL);
+    return errno ? -1 : 0;
+#endif
+
+#ifdef ARCH_AARCH64
+    // The return address lives in the link register, and it is reloaded from the frame before the return
+    *value = t->regs.x30;
+    return 0;
+#endif
+}
+
+uint64_t read_stack_canary(struct thread *t)
+{
+#ifdef ARCH_AMD64
+    // glibc keeps the reference canary in the TCB, at fs:0x28
+    return ptrace(PTRACE_PEEKDATA, t->tid, (void *)(t->regs.fs_base + 0x28), NULL);
+#endif
+
+#ifdef ARCH_AARCH64
+    return 0;
+#endif
+}
+
+void pop_stale_ra_frames(struct ra_shadow_stack *stack, uint64_t sp)
+{
+    // The stack grows downwards: frames below the current stack pointer were unwound
+    // without passing through a monitored return (longjmp, exceptions, tail calls...)
+    while (stack->depth > 0 && stack->frames[stack->depth - 1].slot < sp)
+        stack->depth--;
+}
+
+void report_ra_violation(struct ra_monitor *monitor, struct thread *t, struct ra_frame *frame, uint64_t address,
+                         _Bool canary, uint64_t expected, uint64_t actual, uint64_t slot)
+{
+    struct ra_violation *violation = malloc(sizeof(struct ra_violation));
+
+    violation->tid = t->tid;
+    violation->canary = canary;
+    violation->function = frame->function;
+    violation->address = address;
+    violation->slot = slot;
+    violation->expected = expected;
+    violation->actual = actual;
+
+    // Violations are kept in order, the oldest one is the first to be popped
+    violation->next = NULL;
+
+    struct ra_violation **cursor = &monitor->violations;
+    while (*cursor != NULL)
+        cursor = &(*cursor)->next;
+
+    *cursor = violation;
+}
+
+int handle_ra_entry(struct ra_monitor *monitor, struct thread *t, uint64_t address)
+{
+    struct ra_shadow_stack *stack = get_ra_shadow_stack(monitor, t->tid);
+    struct ra_function *function = find_ra_function(monitor, address);
+    uint64_t sp = STACK_POINTER(t->regs), value;
+
+    if (read_return_address(t, &value)) return NATIVE_TRAP_RESUME;
+
+    pop_stale_ra_frames(stack, sp);
+
+    if (stack->depth == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 64;
+        stack->frames = realloc(stack->frames, stack->capacity * sizeof(struct ra_frame));
+    }
+
+    struct ra_frame *frame = &stack->frames[stack->depth++];
+    frame->function = address;
+    frame->slot = sp;
+    frame->value = value;
+    frame->canary_offset = function ? function->canary_offset : 0;
+
+    return NATIVE_TRAP_RESUME;
+}
+
+int handle_ra_return(struct ra_monitor *monitor, struct thread *t, uint64_t address)
+{
+    struct ra_shadow_stack *stack = get_ra_shadow_stack(monitor, t->tid);
+    uint64_t sp = STACK_POINTER(t->regs), value;
+
+    pop_stale_ra_frames(stack, sp);
+
+    // The frame was pushed before the monitor was enabled, nothing to compare
+    if (stack->depth == 0 || stack->frames[stack->depth - 1].slot != sp) return NATIVE_TRAP_RESUME;
+
+    struct ra_frame *frame = &stack->frames[--stack->depth];
+
+    if (read_return_address(t, &value) || value == frame->value) return NATIVE_TRAP_RESUME;
+
+    report_ra_violation(monitor, t, frame, address, 0, frame->value, value, frame->slot);
+
+    return NATIVE_TRAP_STOP;
+}
+
+int handle_ra_canary_check(struct ra_monitor *monitor, struct thread *t, uint64_t address)
+{
+    struct ra_shadow_stack *stack = get_ra_shadow_stack(monitor, t->tid);
+
+    // The function that failed the check is the one that called us
+    pop_stale_ra_frames(stack, STACK_POINTER(t->regs));
+
+    if (stack->depth == 0) return NATIVE_TRAP_RESUME;
+
+    struct ra_frame *frame = &stack->frames[stack->depth - 1];
+    uint64_t slot = 0, actual = 0;
+
+    if (frame->canary_offset) {
+        slot = frame->slot + frame->canary_offset;
+        actual = ptrace(PTRACE_PEEKDATA, t->tid, (void *)slot, NULL);
+    }
+
+    report_ra_violation(monitor, t, frame, address, 1, read_stack_canary(t), actual, slot);
+
+    return NATIVE_TRAP_STOP;
+}
+
+struct traced_function {
+    uint64_t entry;
+    uint32_t id;
+};
+
+struct trace_frame {
+    uint32_t function;
+    uint64_t slot;
+    uint64_t return_address;
+    uint64_t timestamp;
+    uint64_t args[TRACED_CALL_MAX_ARGS];
+};
+
+struct trace_stack {
+    int tid;
+    struct trace_frame *frames;
+    uint64_t depth;
+    uint64_t capacity;
+    struct trace_stack *next;
+};
+
+struct function_tracer {
+    struct traced_function *functions;
+    uint64_t function_count;
+    uint64_t function_capacity;
+    _Bool sorted;
+    struct traced_function_stats *stats;
+    uint64_t stats_count;
+    int args;
+    _Bool capture_return;
+    struct trace_stack *stacks;
+    struct traced_call *calls;
+    uint64_t calls_capacity;
+    uint64_t calls_start;
+    uint64_t calls_count;
+    uint64_t dropped;
+};
+
+uint64_t monotonic_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int compare_traced_functions(const void *a, const void *b)
+{
+    uint64_t first = ((const struct traced_function *)a)->entry;
+    uint64_t second = ((const struct traced_function *)b)->entry;
+
+    return (first > second) - (first < second);
+}
+
+struct traced_function *find_traced_function(struct function_tracer *tracer, uint64_t entry)
+{
+    if (!tracer->sorted) {
+        qsort(tracer->functions, tracer->function_count, sizeof(struct traced_function), compare_traced_functions);
+        tracer->sorted = 1;
+    }
+
+    struct traced_function key = {.entry = entry};
+
+    return bsearch(&key, tracer->functions, tracer->function_count, sizeof(struct traced_function),
+                   compare_traced_functions);
+}
+
+struct trace_stack *get_trace_stack(struct function_tracer *tracer, int tid)
+{
+    struct trace_stack *stack = tracer->stacks;
+
+    while (stack != NULL) {
+        if (stack->tid == tid) return stack;
+        stack = stack->next;
+    }
+
+    stack = calloc(1, sizeof(struct trace_stack));
+    stack->tid = tid;
+    stack->next = tracer->stacks;
+    tracer->stacks = stack;
+
+    return stack;
+}
+
+void capture_call_arguments(struct thread *t, uint64_t *args)
+{
+#ifdef ARCH_AMD64
+    args[0] = t->regs.rdi;
+    args[1] = t->regs.rsi;
+    args[2] = t->regs.rdx;
+    args[3] = t->regs.rcx;
+    args[4] = t->regs.r8;
+    args[5] = t->regs.r9;
+    args[6] = 0;
+    args[7] = 0;
+#endif
+
+#ifdef ARCH_AARCH64
+    args[0] = t->regs.x0;
+    args[1] = t->regs.x1;
+    args[2] = t->regs.x2;
+    args[3] = t->regs.x3;
+    args[4] = t->regs.x4;
+    args[5] = t->regs.x5;
+    args[6] = t->regs.x6;
+    args[7] = t->regs.x7;
+#endif
+}
+
+uint64_t read_call_return_value(struct thread *t)
+{
+#ifdef ARCH_AMD64
+    return t->regs.rax;
+#endif
+
+#ifdef ARCH_AARCH64
+    return t->regs.x0;
+#endif
+}
+
+struct traced_call *push_traced_call(struct function_tracer *tracer)
+{
+    // The buffer is a ring, the oldest calls are overwritten when it is full
+    if (tracer->calls_count == tracer->calls_capacity) {
+        tracer->calls_start = (tracer->calls_start + 1) % tracer->calls_capacity;
+        tracer->calls_count--;
+        tracer->dropped++;
+    }
+
+    struct traced_call *call =
+        &tracer->calls[(tracer->calls_start + tracer->calls_count) % tracer->calls_capacity];
+    tracer->calls_count++;
+
+    memset(call, 0, sizeof(struct traced_call));
+
+    return call;
+}
+
+void record_traced_call(struct function_tracer *tracer, int tid, struct trace_frame *frame, _Bool returned,
+                        uint64_t return_value, uint64_t now)
+{
+    struct traced_call *call = push_traced_call(tracer);
+
+    call->tid = tid;
+    call->function = frame->function;
+    call->returned = returned;
+    call->return_value = return_value;
+    call->timestamp = frame->timestamp;
+    memcpy(call->args, frame->args, tracer->args * sizeof(uint64_t));
+
+    if (!returned) return;
+
+    struct traced_function_stats *stats = &tracer->stats[frame->function];
+
+    call->duration = now - frame->timestamp;
+
+    stats->returns++;
+    stats->total_time += call->duration;
+
+    if (stats->returns == 1 || call->duration < stats->min_time) stats->min_time = call->duration;
+    if (call->duration > stats->max_time) stats->max_time = call->duration;
+}
+
+void pop_stale_trace_frames(struct function_tracer *tracer, struct trace_stack *stack, uint64_t sp)
+{
+    // Frames below the current stack pointer were unwound without returning (longjmp, exceptions...)
+    while (stack->depth > 0 && stack->frames[stack->depth - 1].slot < sp)
+        record_traced_call(tracer, stack->tid, &stack->frames[--stack->depth], 0, 0, 0);
+}
+
+void trace_forget_thread(struct global_state *state, int tid)
+{
+    struct function_tracer *tracer = state->function_tracer;
+
+    if (tracer == NULL) return;
+
+    struct trace_stack *stack = tracer->stacks;
+    struct trace_stack *prev = NULL;
+
+    while (stack != NULL) {
+        if (stack->tid == tid) {
+            // The pending calls will never return (e.g., exit)
+            while (stack->depth > 0)
+                record_traced_call(tracer, tid, &stack->frames[--stack->depth], 0, 0, 0);
+
+            if (prev == NULL) {
+                tracer->stacks = stack->next;
+            } else {
+                prev->next = stack->next;
+            }
+            free(stack->frames);
+            free(stack);
+            return;
+        }
+        prev = stack;
+        stack = stack->next;
+    }
+}
+
+int handle_trace_entry(struct global_state *state, struct thread *t, uint64_t address)
+{
+    struct function_tracer *tracer = state->function_tracer;
+    struct traced_function *function = find_traced_function(tracer, address);
+    uint64_t sp = STACK_POINTER(t->regs), return_address;
+
+    if (function == NULL || read_return_address(t, &return_address)) return NATIVE_TRAP_RESUME;
+
+    struct trace_stack *stack = get_trace_stack(tracer, t->tid);
+    pop_stale_trace_frames(tracer, stack, sp);
+
+    struct trace_frame frame = {.function = function->id, .slot = sp, .return_address = return_address};
+    frame.timestamp = monotonic_time();
+    capture_call_arguments(t, frame.args);
+
+    tracer->stats[function->id].calls++;
+
+    if (!tracer->capture_return) {
+        record_traced_call(tracer, t->tid, &frame, 0, 0, 0);
+        return NATIVE_TRAP_RESUME;
+    }
+
+    if (stack->depth == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 64;
+        stack->frames = realloc(stack->frames, stack->capacity * sizeof(struct trace_frame));
+    }
+
+    stack->frames[stack->depth++] = frame;
+
+    // Return traps are installed on demand and kept until the tracer is freed, as another
+    // thread might have already hit them by the time the last pending call returns
+    struct software_breakpoint *b = get_or_create_sw_breakpoint(state, t->tid, return_address);
+
+    if (!(b->native_traps & NATIVE_TRAP_TRACE_RETURN)) {
+        _Bool armed = is_sw_breakpoint_armed(state, b);
+
+        b->native_traps |= NATIVE_TRAP_TRACE_RETURN;
+
+        if (!armed && state->sw_breakpoints_installed)
+            repatch_sw_breakpoints(state, t->tid, b);
+    }
+
+    return NATIVE_TRAP_RESUME;
+}
+
+int handle_trace_return(struct function_tracer *tracer, struct thread *t, uint64_t address)
+{
+    struct trace_stack *stack = get_trace_stack(tracer, t->tid);
+    uint64_t sp = STACK_POINTER(t->regs), now = monotonic_time();
+
+    // On amd64 the return pops the slot of the frame, on aarch64 the stack pointer is restored
+    while (stack->depth > 0 && stack->frames[stack->depth - 1].slot <= sp) {
+        struct trace_frame *frame = &stack->frames[--stack->depth];
+
+        if (frame->return_address == address) {
+            record_traced_call(tracer, t->tid, frame, 1, read_call_return_value(t), now);
+            break;
+        }
+
+        record_traced_call(tracer, t->tid, frame, 0, 0, 0);
+    }
+
+    return NATIVE_TRAP_RESUME;
+}
+
+// The allocator functions tracked by the heap tracker
+#define HEAP_FUNCTION_MALLOC 0
+#define HEAP_FUNCTION_CALLOC 1
+#define HEAP_FUNCTION_REALLOC 2
+#define HEAP_FUNCTION_FREE 3
+#define HEAP_FUNCTION_MEMALIGN 4
+#define HEAP_FUNCTION_MMAP 5
+#define HEAP_FUNCTION_MUNMAP 6
+#define HEAP_FUNCTION_SBRK 7
+
+#define HEAP_SLOT_EMPTY 0
+#define HEAP_SLOT_USED 1
+#define HEAP_SLOT_DELETED 2
+
+struct heap_function {
+    uint64_t entry;
+    int role;
+};
+
+struct heap_frame {
+    int role;
+    uint64_t slot;
+    uint64_t return_address;
+    uint64_t args[3];
+    uint32_t backtrace_depth;
+    uint64_t backtrace[HEAP_BACKTRACE_MAX_DEPTH];
+};
+
+struct heap_stack {
+    int tid;
+    struct heap_frame *frames;
+    uint64_t depth;
+    uint64_t capacity;
+    struct heap_stack *next;
+};
+
+struct heap_slot {
+    uint8_t state;
+    struct heap_allocation allocation;
+};
+
+struct heap_region {
+    struct heap_allocation allocation;
+    struct heap_region *next;
+};
+
+struct heap_tracker {
+    struct heap_function *functions;
+    uint64_t function_count;
+    uint64_t function_capacity;
+    _Bool sorted;
+    uint32_t backtrace_depth;
+    struct heap_stack *stacks;
+    // Open addressing table of the live allocations, keyed by address
+    struct heap_slot *slots;
+    uint64_t slot_count;
+    uint64_t used_slots;
+    struct heap_region *regions;
+    struct heap_tracker_stats stats;
+};
+
+int compare_heap_functions(const void *a, const void *b)
+{
+    uint64_t first = ((const struct heap_function *)a)->entry;
+    uint64_t second = ((const struct heap_function *)b)->entry;
+
+    return (first > second) - (first < second);
+}
+
+struct heap_function *find_heap_function(struct heap_tracker *tracker, uint64_t entry)
+{
+    if (!tracker->sorted) {
+        qsort(tracker->functions, tracker->function_count, sizeof(struct heap_function), compare_heap_functions);
+        tracker->sorted = 1;
+    }
+
+    struct heap_function key = {.entry = entry};
+
+    return bsearch(&key, tracker->functions, tracker->function_count, sizeof(struct heap_function),
+                   compare_heap_functions);
+}
+
+struct heap_stack *get_heap_stack(struct heap_tracker *tracker, int tid)
+{
+    struct heap_stack *stack = tracker->stacks;
+
+    while (stack != NULL) {
+        if (stack->tid == tid) return stack;
+        stack = stack->next;
+    }
+
+    stack = calloc(1, sizeof(struct heap_stack));
+    stack->tid = tid;
+    stack->next = tracker->stacks;
+    tracker->stacks = stack;
+
+    return stack;
+}
+
+void heap_forget_thread(struct global_state *state, int tid)
+{
+    if (state->heap_tracker == NULL) return;
+
+    struct heap_stack *stack = state->heap_tracker->stacks;
+    struct heap_stack *prev = NULL;
+
+    while (stack != NULL) {
+        if (stack->tid == tid) {
+            if (prev == NULL) {
+                state->heap_tracker->stacks = stack->next;
+            } else {
+                prev->next = stack->next;
+            }
+            free(stack->frames);
+            free(stack);
+            return;
+        }
+        prev = stack;
+        stack = stack->next;
+    }
+}
+
+uint64_t hash_heap_address(uint64_t address)
+{
+    // Chunks are 16-byte aligned, mix the significant bits
+    address >>= 4;
+    address ^= address >> 33;
+    address *= 0xff51afd7ed558ccdull;
+    address ^= address >> 33;
+
+    return address;
+}
+
+struct heap_slot *find_heap_slot(struct heap_tracker *tracker, uint64_t address)
+{
+    if (tracker->slot_count == 0) return NULL;
+
+    uint64_t mask = tracker->slot_count - 1;
+    uint64_t index = hash_heap_address(address) & mask;
+
+    while (tracker->slots[index].state != HEAP_SLOT_EMPTY) {
+        if (tracker->slots[index].state == HEAP_SLOT_USED && tracker->slots[index].allocation.address == address)
+            return &tracker->slots[index];
+
+        index = (index + 1) & mask;
+    }
+
+    return NULL;
+}
+
+void insert_heap_slot(struct heap_tracker *tracker, struct heap_allocation *allocation);
+
+void resize_heap_slots(struct heap_tracker *tracker)
+{
+    struct heap_slot *old_slots = tracker->slots;
+    uint64_t old_count = tracker->slot_count;
+
+    // The table is resized when deleted slots pile up as well, keep it twice as large as the live entries
+    uint64_t count = 1024;
+    while (count < tracker->stats.live_count * 4)
+        count *= 2;
+
+    tracker->slots = calloc(count, sizeof(struct heap_slot));
+    tracker->slot_count = count;
+    tracker->used_slots = 0;
+
+    for (uint64_t i = 0; i < old_count; i++)
+        if (old_slots[i].state == HEAP_SLOT_USED)
+            insert_heap_slot(tracker, &old_slots[i].allocation);
+
+    free(old_slots);
+}
+
+void insert_heap_slot(struct heap_tracker *tracker, struct heap_allocation *allocation)
+{
+    uint64_t mask = tracker->slot_count - 1;
+    uint64_t index = hash_heap_address(allocation->address) & mask;
+
+    while (tracker->slots[index].state == HEAP_SLOT_USED)
+        index = (index + 1) & mask;
+
+    if (tracker->slots[index].state == HEAP_SLOT_EMPTY) tracker->used_slots++;
+
+    tracker->slots[index].state = HEAP_SLOT_USED;
+    tracker->slots[index].allocation = *allocation;
+}
+
+void track_heap_allocation(struct heap_tracker *tracker, struct heap_allocation *allocation)
+{
+    struct heap_slot *slot = find_heap_slot(tracker, allocation->address);
+
+    // The chunk was released without us noticing (e.g., while the tracker was disabled)
+    if (slot != NULL) {
+        tracker->stats.live_bytes -= slot->allocation.size;
+        slot->allocation = *allocation;
+    } else {
+        if ((tracker->used_slots + 1) * 4 > tracker->slot_count * 3) resize_heap_slots(tracker);
+
+        insert_heap_slot(tracker, allocation);
+        tracker->stats.live_count++;
+    }
+
+    tracker->stats.allocations++;
+    tracker->stats.live_bytes += allocation->size;
+
+    if (tracker->stats.live_bytes > tracker->stats.peak_bytes) tracker->stats.peak_bytes = tracker->stats.live_bytes;
+}
+
+int untrack_heap_allocation(struct heap_tracker *tracker, uint64_t address)
+{
+    struct heap_slot *slot = find_heap_slot(tracker, address);
+
+    if (slot == NULL) return 0;
+
+    slot->state = HEAP_SLOT_DELETED;
+    tracker->stats.live_count--;
+    tracker->stats.live_bytes -= slot->allocation.size;
+    tracker->stats.frees++;
+
+    return 1;
+}
+
+void track_heap_region(struct heap_tracker *tracker, struct heap_allocation *allocation)
+{
+    struct heap_region *region = malloc(sizeof(struct heap_region));
+
+    region->allocation = *allocation;
+    region->next = tracker->regions;
+    tracker->regions = region;
+
+    tracker->stats.mmap_count++;
+    tracker->stats.mmap_bytes += allocation->size;
+}
+
+void untrack_heap_regions(struct heap_tracker *tracker, uint64_t address, uint64_t length)
+{
+    struct heap_region **cursor = &tracker->regions;
+
+    while (*cursor != NULL) {
+        struct heap_region *region = *cursor;
+        uint64_t start = region->allocation.address, end = start + region->allocation.size;
+
+        if (start >= address && end <= address + length) {
+            // The whole mapping is gone
+            *cursor = region->next;
+            tracker->stats.mmap_count--;
+            tracker->stats.mmap_bytes -= region->allocation.size;
+            free(region);
+            continue;
+        }
+
+        if (start < address + length && end > address) {
+            // Only a part of the mapping is gone, keep the lowest remaining part
+            uint64_t remaining = start < address ? address - start : end - (address + length);
+
+            if (start >= address) region->allocation.address = address + length;
+
+            tracker->stats.mmap_bytes -= region->allocation.size - remaining;
+            region->allocation.size = remaining;
+        }
+
+        cursor = &region->next;
+    }
+}
+
+uint32_t capture_backtrace(struct thread *t, uint64_t *frames, uint32_t depth)
+{
+#ifdef ARCH_AMD64
+    uint64_t fp = t->regs.rbp;
+#endif
+
+#ifdef ARCH_AARCH64
+    uint64_t fp = t->regs.x29;
+#endif
+
+    uint64_t next, return_address;
+    uint32_t count = 0;
+
+    // At the entry point the frame pointer still belongs to the caller, follow the chain of saved frame pointers.
+    // Both on amd64 and aarch64 the return address is saved right above the frame pointer
+    while (count < depth && fp != 0 && !(fp & 7)) {
+        errno = 0;
+        next = ptrace(PTRACE_PEEKDATA, t->tid, (void *)fp, NULL);
+        return_address = ptrace(PTRACE_PEEKDATA, t->tid, (void *)(fp + 8), NULL);
+
+        if (errno || return_address == 0) break;
+
+        frames[count++] = return_address;
+
+        // The stack grows downwards, any other direction means the chain is broken
+        if (next <= fp) break;
+
+        fp = next;
+    }
+
+    return count;
+}
+
+int handle_heap_entry(struct global_state *state, struct thread *t, uint64_t address)
+{
+    struct heap_tracker *tracker = state->heap_tracker;
+    struct heap_function *function = find_heap_function(tracker, address);
+    uint64_t sp = STACK_POINTER(t->regs), return_address, args[TRACED_CALL_MAX_ARGS];
+
+    if (function == NULL || read_return_address(t, &return_address)) return NATIVE_TRAP_RESUME;
+
+    capture_call_arguments(t, args);
+
+    struct heap_stack *stack = get_heap_stack(tracker, t->tid);
+
+    // Frames below the current stack pointer were unwound without returning
+    while (stack->depth > 0 && stack->frames[stack->depth - 1].slot < sp)
+        stack->depth--;
+
+    // Calls performed by the allocator itself (e.g., the malloc of realloc(NULL, size), or the mmap of a large
+    // chunk) belong to the outer call, only the heap growth is worth recording
+    if (stack->depth > 0 && function->role != HEAP_FUNCTION_SBRK) return NATIVE_TRAP_RESUME;
+
+    // Releases are accounted immediately, there is nothing to learn from their return
+    if (function->role == HEAP_FUNCTION_FREE) {
+        if (args[0] && !untrack_heap_allocation(tracker, args[0])) tracker->stats.invalid_frees++;
+        return NATIVE_TRAP_RESUME;
+    }
+
+    if (function->role == HEAP_FUNCTION_MUNMAP) {
+        untrack_heap_regions(tracker, args[0], args[1]);
+        return NATIVE_TRAP_RESUME;
+    }
+
+    if (stack->depth == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 16;
+        stack->frames = realloc(stack->frames, stack->capacity * sizeof(struct heap_frame));
+    }
+
+    struct heap_frame *frame = &stack->frames[stack->depth++];
+    frame->role = function->role;
+    frame->slot = sp;
+    frame->return_address = return_address;
+    memcpy(frame->args, args, sizeof(frame->args));
+    frame->backtrace_depth = capture_backtrace(t, frame->backtrace, tracker->backtrace_depth);
+
+    // Just like for the function tracer, return traps are kept until the tracker is freed
+    struct software_breakpoint *b = get_or_create_sw_breakpoint(state, t->tid, return_address);
+
+    if (!(b->native_traps & NATIVE_TRAP_HEAP_RETURN)) {
+        _Bool armed = is_sw_breakpoint_armed(state, b);
+
+        b->native_traps |= NATIVE_TRAP_HEAP_RETURN;
+
+        if (!armed && state->sw_breakpoints_installed)
+            repatch_sw_breakpoints(state, t->tid, b);
+    }
+
+    return NATIVE_TRAP_RESUME;
+}
+
+void complete_heap_call(struct heap_tracker *tracker, struct thread *t, struct heap_frame *frame)
+{
+    uint64_t result = read_call_return_value(t);
+    struct heap_allocation allocation = {
+        .address = result,
+        .tid = t->tid,
+        .pc = frame->return_address,
+        .backtrace_depth = frame->backtrace_depth,
+    };
+
+    memcpy(allocation.backtrace, frame->backtrace, sizeof(allocation.backtrace));
+
+    switch (frame->role) {
+    case HEAP_FUNCTION_MALLOC:
+        allocation.size = frame->args[0];
+        break;
+    case HEAP_FUNCTION_CALLOC:
+        allocation.size = frame->args[0] * frame->args[1];
+        break;
+    case HEAP_FUNCTION_MEMALIGN:
+        allocation.size = frame->args[1];
+        break;
+    case HEAP_FUNCTION_REALLOC:
+        // A successful realloc releases the old chunk, and so does a realloc to zero bytes
+        if (frame->args[0] && (result || !frame->args[1])) untrack_heap_allocation(tracker, frame->args[0]);
+        allocation.size = frame->args[1];
+        break;
+    case HEAP_FUNCTION_MMAP:
+        if (result == (uint64_t)-1) return;
+        allocation.size = frame->args[1];
+        allocation.mmap = 1;
+        track_heap_region(tracker, &allocation);
+        return;
+    case HEAP_FUNCTION_SBRK:
+        if (result == (uint64_t)-1) return;
+        if (!tracker->stats.brk_start) tracker->stats.brk_start = result;
+        tracker->stats.brk_end = result + frame->args[0];
+        return;
+    }
+
+    if (result) track_heap_allocation(tracker, &allocation);
+}
+
+int handle_heap_return(struct heap_tracker *tracker, struct thread *t, uint64_t address)
+{
+    struct heap_stack *stack = get_heap_stack(tracker, t->tid);
+    uint64_t sp = STACK_POINTER(t->regs);
+
+    while (stack->depth > 0 && stack->frames[stack->depth - 1].slot <= sp) {
+        struct heap_frame *frame = &stack->frames[--stack->depth];
+
+        if (frame->return_address == address) {
+            complete_heap_call(tracker, t, frame);
+            break;
+        }
+    }
+
+    return NATIVE_TRAP_RESUME;
+}
+
+int handle_native_trap(struct global_state *state, struct thread *t, struct software_breakpoint *b)
+{
+    uint32_t traps = b->native_traps & state->native_traps_enabled;
+    int action = NATIVE_TRAP_RESUME;
+
+    // The native callbacks are breakpoints of the user, scoped as them
+    if (!sw_breakpoint_selects_thread(b, t->tid)) traps &= ~NATIVE_TRAP_CALLBACK;
+
+    if (traps & NATIVE_TRAP_RA_ENTRY)
+        action |= handle_ra_entry(state->ra_monitor, t, b->addr);
+
+    if (traps & NATIVE_TRAP_RA_RETURN)
+        action |= handle_ra_return(state->ra_monitor, t, b->addr);
+
+    if (traps & NATIVE_TRAP_RA_CANARY)
+        action |= handle_ra_canary_check(state->ra_monitor, t, b->addr);
+
+    if (traps & NATIVE_TRAP_TRACE_ENTRY)
+        action |= handle_trace_entry(state, t, b->addr);
+
+    if (traps & NATIVE_TRAP_TRACE_RETURN)
+        action |= handle_trace_return(state->function_tracer, t, b->addr);
+
+    if (traps & NATIVE_TRAP_HEAP_ENTRY)
+        action |= handle_heap_entry(state, t, b->addr);
+
+    if (traps & NATIVE_TRAP_HEAP_RETURN)
+        action |= handle_heap_return(state->heap_tracker, t, b->addr);
+
+    if (traps & NATIVE_TRAP_CALLBACK)
+        action |= handle_native_callback(state, t, b->addr);
+
+    return action;
+}
+
+void register_native_trap(struct global_state *state, int pid, uint64_t address, uint32_t kind)
+{
+    struct software_breakpoint *b = get_or_create_sw_breakpoint(state, pid, address);
+
+    b->native_traps |= kind;
+}
+
+void unregister_native_traps(struct global_state *state, uint32_t kinds)
+{
+    struct software_breakpoint *b = state->sw_b_HEAD, *next;
+
+    while (b != NULL) {
+        next = b->next;
+        b->native_traps &= ~kinds;
+
+        if (!b->native_traps && !b->enabled)
+            delete_sw_breakpoint(state, b);
+
+        b = next;
+    }
+
+    state->native_traps_enabled &= ~kinds;
+}
+
+void register_ra_function(struct global_state *state, int pid, uint64_t address, int64_t canary_offset)
+{
+    struct ra_monitor *monitor = get_ra_monitor(state);
+
+    if (find_ra_function(monitor, address) != NULL) return;
+
+    if (monitor->function_count == monitor->function_capacity) {
+        monitor->function_capacity = monitor->function_capacity ? monitor->function_capacity * 2 : 256;
+        monitor->functions = realloc(monitor->functions, monitor->function_capacity * sizeof(struct ra_function));
+    }
+
+    monitor->functions[monitor->function_count].entry = address;
+    monitor->functions[monitor->function_count].canary_offset = canary_offset;
+    monitor->function_count++;
+    monitor->sorted = 0;
+
+    register_native_trap(state, pid, address, NATIVE_TRAP_RA_ENTRY);
+}
+
+void register_ra_return(struct global_state *state, int pid, uint64_t address)
+{
+    get_ra_monitor(state);
+    register_native_trap(state, pid, address, NATIVE_TRAP_RA_RETURN);
+}
+
+void register_ra_canary_check(struct global_state *state, int pid, uint64_t address)
+{
+    get_ra_monitor(state);
+    register_native_trap(state, pid, address, NATIVE_TRAP_RA_CANARY);
+}
+
+void enable_ra_monitor(struct global_state *state)
+{
+    state->native_traps_enabled |= NATIVE_TRAP_RA_ENTRY | NATIVE_TRAP_RA_RETURN | NATIVE_TRAP_RA_CANARY;
+}
+
+void disable_ra_monitor(struct global_state *state)
+{
+    state->native_traps_enabled &= ~(NATIVE_TRAP_RA_ENTRY | NATIVE_TRAP_RA_RETURN | NATIVE_TRAP_RA_CANARY);
+
+    // The shadow stacks would be stale when the monitor is enabled again
+    while (state->ra_monitor != NULL && state->ra_monitor->stacks != NULL)
+        ra_forget_thread(state, state->ra_monitor->stacks->tid);
+}
+
+int pop_ra_violation(struct global_state *state, int tid, struct ra_violation *violation)
+{
+    if (state->ra_monitor == NULL) return 0;
+
+    struct ra_violation **cursor = &state->ra_monitor->violations;
+
+    while (*cursor != NULL) {
+        if ((*cursor)->tid == tid) {
+            struct ra_violation *found = *cursor;
+            *violation = *found;
+            violation->next = NULL;
+            *cursor = found->next;
+            free(found);
+            return 1;
+        }
+        cursor = &(*cursor)->next;
+    }
+
+    return 0;
+}
+
+void free_ra_monitor(struct global_state *state)
+{
+    struct ra_monitor *monitor = state->ra_monitor;
+
+    if (monitor == NULL) return;
+
+    unregister_native_traps(state, NATIVE_TRAP_RA_ENTRY | NATIVE_TRAP_RA_RETURN | NATIVE_TRAP_RA_CANARY);
+
+    while (monitor->stacks != NULL)
+        ra_forget_thread(state, monitor->stacks->tid);
+
+    struct ra_violation *violation = monitor->violations, *next;
+    while (violation != NULL) {
+        next = violation->next;
+        free(violation);
+        violation = next;
+    }
+
+    free(monitor->functions);
+    free(monitor);
+
+    state->ra_monitor = NULL;
+}
+
+void configure_function_tracer(struct global_state *state, int args, _Bool capture_return, uint64_t buffer_size)
+{
+    struct function_tracer *tracer = state->function_tracer;
+
+    if (tracer == NULL) {
+        tracer = calloc(1, sizeof(struct function_tracer));
+        state->function_tracer = tracer;
+    }
+
+    tracer->args = args < TRACED_CALL_MAX_ARGS ? args : TRACED_CALL_MAX_ARGS;
+    tracer->capture_return = capture_return;
+
+    free(tracer->calls);
+    tracer->calls = calloc(buffer_size, sizeof(struct traced_call));
+    tracer->calls_capacity = buffer_size;
+    tracer->calls_start = 0;
+    tracer->calls_count = 0;
+}
+
+void register_traced_function(struct global_state *state, int pid, uint64_t address, uint32_t id)
+{
+    struct function_tracer *tracer = state->function_tracer;
+
+    if (find_traced_function(tracer, address) != NULL) return;
+
+    if (tracer->function_count == tracer->function_capacity) {
+        tracer->function_capacity = tracer->function_capacity ? tracer->function_capacity * 2 : 256;
+        tracer->functions =
+            realloc(tracer->functions, tracer->function_capacity * sizeof(struct traced_function));
+    }
+
+    tracer->functions[tracer->function_count].entry = address;
+    tracer->functions[tracer->function_count].id = id;
+    tracer->function_count++;
+    tracer->sorted = 0;
+
+    if (id >= tracer->stats_count) {
+        tracer->stats = realloc(tracer->stats, (id + 1) * sizeof(struct traced_function_stats));
+        memset(tracer->stats + tracer->stats_count, 0,
+               (id + 1 - tracer->stats_count) * sizeof(struct traced_function_stats));
+        tracer->stats_count = id + 1;
+    }
+
+    register_native_trap(state, pid, address, NATIVE_TRAP_TRACE_ENTRY);
+}
+
+void enable_function_tracer(struct global_state *state)
+{
+    state->native_traps_enabled |= NATIVE_TRAP_TRACE_ENTRY | NATIVE_TRAP_TRACE_RETURN;
+}
+
+void disable_function_tracer(struct global_state *state)
+{
+    state->native_traps_enabled &= ~(NATIVE_TRAP_TRACE_ENTRY | NATIVE_TRAP_TRACE_RETURN);
+
+    // The pending calls would never be matched with their return
+    while (state->function_tracer != NULL && state->function_tracer->stacks != NULL)
+        trace_forget_thread(state, state->function_tracer->stacks->tid);
+}
+
+uint64_t pop_traced_calls(struct global_state *state, struct traced_call *buffer, uint64_t max_count)
+{
+    struct function_tracer *tracer = state->function_tracer;
+    uint64_t count = 0;
+
+    if (tracer == NULL) return 0;
+
+    while (count < max_count && tracer->calls_count > 0) {
+        buffer[count++] = tracer->calls[tracer->calls_start];
+        tracer->calls_start = (tracer->calls_start + 1) % tracer->calls_capacity;
+        tracer->calls_count--;
+    }
+
+    return count;
+}
+
+uint64_t pop_dropped_traced_calls(struct global_state *state)
+{
+    struct function_tracer *tracer = state->function_tracer;
+
+    if (tracer == NULL) return 0;
+
+    uint64_t dropped = tracer->dropped;
+    tracer->dropped = 0;
+
+    return dropped;
+}
+
+int get_traced_function_stats(struct global_state *state, uint32_t id, struct traced_function_stats *stats)
+{
+    struct function_tracer *tracer = state->function_tracer;
+
+    if (tracer == NULL || id >= tracer->stats_count) return 0;
+
+    *stats = tracer->stats[id];
+
+    return 1;
+}
+
+void free_function_tracer(struct global_state *state)
+{
+    struct function_tracer *tracer = state->function_tracer;
+
+    if (tracer == NULL) return;
+
+    unregister_native_traps(state, NATIVE_TRAP_TRACE_ENTRY | NATIVE_TRAP_TRACE_RETURN);
+
+    while (tracer->stacks != NULL) {
+        struct trace_stack *next = tracer->stacks->next;
+        free(tracer->stacks->frames);
+        free(tracer->stacks);
+        tracer->stacks = next;
+    }
+
+    free(tracer->functions);
+    free(tracer->stats);
+    free(tracer->calls);
+    free(tracer);
+
+    state->function_tracer = NULL;
+}
+
+void configure_heap_tracker(struct global_state *state, uint32_t backtrace_depth)
+{
+    struct heap_tracker *tracker = state->heap_tracker;
+
+    if (tracker == NULL) {
+        tracker = calloc(1, sizeof(struct heap_tracker));
+        state->heap_tracker = tracker;
+        resize_heap_slots(tracker);
+    }
+
+    tracker->backtrace_depth =
+        backtrace_depth < HEAP_BACKTRACE_MAX_DEPTH ? backtrace_depth : HEAP_BACKTRACE_MAX_DEPTH;
+}
+
+void register_heap_function(struct global_state *state, int pid, uint64_t address, int role)
+{
+    struct heap_tracker *tracker = state->heap_tracker;
+
+    if (find_heap_function(tracker, address) != NULL) return;
+
+    if (tracker->function_count == tracker->function_capacity) {
+        tracker->function_capacity = tracker->function_capacity ? tracker->function_capacity * 2 : 16;
+        tracker->functions = realloc(tracker->functions, tracker->function_capacity * sizeof(struct heap_function));
+    }
+
+    tracker->functions[tracker->function_count].entry = address;
+    tracker->functions[tracker->function_count].role = role;
+    tracker->function_count++;
+    tracker->sorted = 0;
+
+    register_native_trap(state, pid, address, NATIVE_TRAP_HEAP_ENTRY);
+}
+
+void enable_heap_tracker(struct global_state *state)
+{
+    state->native_traps_enabled |= NATIVE_TRAP_HEAP_ENTRY | NATIVE_TRAP_HEAP_RETURN;
+}
+
+void disable_heap_tracker(struct global_state *state)
+{
+    state->native_traps_enabled &= ~(NATIVE_TRAP_HEAP_ENTRY | NATIVE_TRAP_HEAP_RETURN);
+
+    while (state->heap_tracker != NULL && state->heap_tracker->stacks != NULL)
+        heap_forget_thread(state, state->heap_tracker->stacks->tid);
+}
+
+int get_heap_tracker_stats(struct global_state *state, struct heap_tracker_stats *stats)
+{
+    if (state->heap_tracker == NULL) return 0;
+
+    *stats = state->heap_tracker->stats;
+
+    return 1;
+}
+
+uint64_t get_heap_allocations(struct global_state *state, struct heap_allocation *buffer, uint64_t max_count)
+{
+    struct heap_tracker *tracker = state->heap_tracker;
+    uint64_t count = 0;
+
+    if (tracker == NULL) return 0;
+
+    for (uint64_t i = 0; i < tracker->slot_count && count < max_count; i++)
+        if (tracker->slots[i].state == HEAP_SLOT_USED)
+            buffer[count++] = tracker->slots[i].allocation;
+
+    for (struct heap_region *region = tracker->regions; region != NULL && count < max_count; region = region->next)
+        buffer[count++] = region->allocation;
+
+    return count;
+}
+
+int find_heap_allocation(struct global_state *state, uint64_t address, struct heap_allocation *allocation)
+{
+    struct heap_tracker *tracker = state->heap_tracker;
+
+    if (tracker == NULL) return 0;
+
+    struct heap_slot *slot = find_heap_slot(tracker, address);
+
+    if (slot != NULL) {
+        *allocation = slot->allocation;
+        return 1;
+    }
+
+    // Interior pointers need a full scan, the table is not ordered
+    for (uint64_t i = 0; i < tracker->slot_count; i++) {
+        struct heap_allocation *candidate = &tracker->slots[i].allocation;
+
+        if (tracker->slots[i].state == HEAP_SLOT_USED && candidate->address <= address &&
+            address < candidate->address + candidate->size) {
+            *allocation = *candidate;
+            return 1;
+        }
+    }
+
+    for (struct heap_region *region = tracker->regions; region != NULL; region = region->next) {
+        if (region->allocation.address <= address && address < region->allocation.address + region->allocation.size) {
+            *allocation = region->allocation;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void free_heap_tracker(struct global_state *state)
+{
+    struct heap_tracker *tracker = state->heap_tracker;
+
+    if (tracker == NULL) return;
+
+    unregister_native_traps(state, NATIVE_TRAP_HEAP_ENTRY | NATIVE_TRAP_HEAP_RETURN);
+
+    while (tracker->stacks != NULL)
+        heap_forget_thread(state, tracker->stacks->tid);
+
+    while (tracker->regions != NULL) {
+        struct heap_region *next = tracker->regions->next;
+        free(tracker->regions);
+        tracker->regions = next;
+    }
+
+    free(tracker->functions);
+    free(tracker->slots);
+    free(tracker);
+
+    state->heap_tracker = NULL;
+}
+
+// The chunk flags reported by the glibc heap walker. The lowest three bits are the ones of the size field.
+#define GLIBC_CHUNK_PREV_INUSE 0x1
+#define GLIBC_CHUNK_IS_MMAPPED 0x2
+#define GLIBC_CHUNK_NON_MAIN_ARENA 0x4
+#define GLIBC_CHUNK_IN_USE 0x8
+#define GLIBC_CHUNK_TOP 0x10
+#define GLIBC_CHUNK_TCACHE 0x20
+#define GLIBC_CHUNK_FASTBIN 0x40
+#define GLIBC_CHUNK_UNSORTED 0x80
+#define GLIBC_CHUNK_SMALLBIN 0x100
+#define GLIBC_CHUNK_LARGEBIN 0x200
+#define GLIBC_CHUNK_BINNED                                                                                           \
+    (GLIBC_CHUNK_TCACHE | GLIBC_CHUNK_FASTBIN | GLIBC_CHUNK_UNSORTED | GLIBC_CHUNK_SMALLBIN | GLIBC_CHUNK_LARGEBIN)
+
+#define GLIBC_CORRUPTION_INVALID_SIZE 1
+#define GLIBC_CORRUPTION_TOP_NOT_FOUND 2
+#define GLIBC_CORRUPTION_INVALID_BIN_ENTRY 3
+#define GLIBC_CORRUPTION_BIN_LOOP 4
+#define GLIBC_CORRUPTION_DOUBLE_FREE 5
+#define GLIBC_CORRUPTION_BAD_LINKS 6
+#define GLIBC_CORRUPTION_BIN_SIZE_MISMATCH 7
+#define GLIBC_CORRUPTION_PREV_SIZE_MISMATCH 8
+#define GLIBC_CORRUPTION_PREV_INUSE_SET 9
+#define GLIBC_CORRUPTION_FREE_NOT_IN_BIN 10
+#define GLIBC_CORRUPTION_TCACHE_COUNT_MISMATCH 11
+#define GLIBC_CORRUPTION_OUT_OF_HEAP 12
+
+// The ptmalloc constants of 64-bit targets
+#define GLIBC_MIN_CHUNK_SIZE 0x20
+#define GLIBC_CHUNK_ALIGNMENT 0x10
+#define GLIBC_NFASTBINS 10
+#define GLIBC_NBINS 128
+#define GLIBC_TCACHE_MAX_BINS 64
+
+struct glibc_heap_context {
+    struct glibc_heap_layout *layout;
+    uint8_t *heap;
+    uint8_t *arena;
+    struct glibc_heap_walk *walk;
+    uint64_t chunk_capacity;
+    uint64_t corruption_capacity;
+};
+
+int read_remote_memory(int pid, uint64_t address, void *buffer, uint64_t size)
+{
+    uint64_t done = 0;
+
+    while (done < size) {
+        struct iovec local = {.iov_base = (uint8_t *)buffer + done, .iov_len = size - done};
+        struct iovec remote = {.iov_base = (void *)(address + done), .iov_len = size - done};
+
+        ssize_t count = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+
+        if (count <= 0) return -1;
+
+        done += count;
+    }
+
+    return 0;
+}
+
+int write_remote_memory(int tid, uint64_t address, const void *buffer, uint64_t size)
+{
+    const uint8_t *bytes = buffer;
+    uint64_t done = 0;
+
+    // Whole words are written through ptrace, so that even the read-only pages can be changed
+    while (done < size) {
+        uint64_t word_address = (address + done) & ~(sizeof(uint64_t) - 1);
+        uint64_t offset = address + done - word_address;
+        uint64_t count = sizeof(uint64_t) - offset < size - done ? sizeof(uint64_t) - offset : size - done;
+        uint64_t word;
+
+        errno = 0;
+        word = ptrace(PTRACE_PEEKDATA, tid, (void *)word_address, NULL);
+        if (errno) return -1;
+
+        memcpy((uint8_t *)&word + offset, bytes + done, count);
+
+        if (ptrace(PTRACE_POKEDATA, tid, (void *)word_address, word)) return -1;
+
+        done += count;
+    }
+
+    return 0;
+}
+
+// Reads a word of the heap copy. Returns 0 if the word is not entirely inside the heap.
+_Bool read_glibc_heap_word(struct glibc_heap_context *context, uint64_t address, uint64_t *value)
+{
+    struct glibc_heap_layout *layout = context->layout;
+
+    if (address < layout->heap_start || address + sizeof(uint64_t) > layout->heap_end) return 0;
+
+    memcpy(value, context->heap + (address - layout->heap_start), sizeof(uint64_t));
+
+    return 1;
+}
+
+uint64_t read_glibc_arena_word(struct glibc_heap_context *context, uint64_t offset)
+{
+    uint64_t value;
+
+    memcpy(&value, context->arena + offset, sizeof(uint64_t));
+
+    return value;
+}
+
+void add_glibc_heap_chunk(struct glibc_heap_context *context, uint64_t address, uint64_t size, uint32_t flags)
+{
+    struct glibc_heap_walk *walk = context->walk;
+
+    if (walk->chunk_count == context->chunk_capacity) {
+        context->chunk_capacity = context->chunk_capacity ? context->chunk_capacity * 2 : 1024;
+        walk->chunks = realloc(walk->chunks, context->chunk_capacity * sizeof(struct glibc_heap_chunk));
+    }
+
+    struct glibc_heap_chunk *chunk = &walk->chunks[walk->chunk_count++];
+    chunk->address = address;
+    chunk->size = size;
+    chunk->flags = flags;
+    chunk->bin = -1;
+}
+
+void add_glibc_heap_corruption(struct glibc_heap_context *context, uint32_t code, uint64_t address, uint64_t value,
+                               int32_t bin)
+{
+    struct glibc_heap_walk *walk = context->walk;
+
+    if (walk->corruption_count == context->corruption_capacity) {
+        context->corruption_capacity = context->corruption_capacity ? context->corruption_capacity * 2 : 16;
+        walk->corruptions =
+            realloc(walk->corruptions, context->corruption_capacity * sizeof(struct glibc_heap_corruption));
+    }
+
+    struct glibc_heap_corruption *corruption = &walk->corruptions[walk->corruption_count++];
+    corruption->address = address;
+    corruption->value = value;
+    corruption->code = code;
+    corruption->bin = bin;
+}
+
+int64_t find_glibc_heap_chunk(struct glibc_heap_walk *walk, uint64_t address)
+{
+    int64_t low = 0, high = (int64_t)walk->chunk_count - 1;
+
+    while (low <= high) {
+        int64_t middle = low + (high - low) / 2;
+
+        if (walk->chunks[middle].address == address) return middle;
+
+        if (walk->chunks[middle].address < address)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    return -1;
+}
+
+int64_t glibc_largebin_index(uint64_t size)
+{
+    if ((size >> 6) <= 48) return 48 + (size >> 6);
+    if ((size >> 9) <= 20) return 91 + (size >> 9);
+    if ((size >> 12) <= 10) return 110 + (size >> 12);
+    if ((size >> 15) <= 4) return 119 + (size >> 15);
+    if ((size >> 18) <= 2) return 124 + (size >> 18);
+    return 126;
+}
+
+// Marks a chunk as a member of a bin. Returns its index, or -1 if the list must not be followed further.
+int64_t bin_glibc_heap_chunk(struct glibc_heap_context *context, uint64_t address, uint32_t kind, int32_t bin)
+{
+    struct glibc_heap_walk *walk = context->walk;
+    int64_t index = find_glibc_heap_chunk(walk, address);
+
+    if (index < 0 || walk->chunks[index].flags & GLIBC_CHUNK_TOP) {
+        add_glibc_heap_corruption(context, GLIBC_CORRUPTION_INVALID_BIN_ENTRY, address, 0, bin);
+        return -1;
+    }
+
+    struct glibc_heap_chunk *chunk = &walk->chunks[index];
+
+    // Every chunk is binned at most once, which also bounds the length of corrupted lists
+    if (chunk->flags & GLIBC_CHUNK_BINNED) {
+        _Bool loop = (chunk->flags & GLIBC_CHUNK_BINNED) == kind && chunk->bin == bin;
+
+        add_glibc_heap_corruption(context, loop ? GLIBC_CORRUPTION_BIN_LOOP : GLIBC_CORRUPTION_DOUBLE_FREE, address,
+                                  0, bin);
+        return -1;
+    }
+
+    chunk->flags = (chunk->flags & ~GLIBC_CHUNK_IN_USE) | kind;
+    chunk->bin = bin;
+
+    return index;
+}
+
+void walk_glibc_heap_chunks(struct glibc_heap_context *context, uint64_t top)
+{
+    struct glibc_heap_layout *layout = context->layout;
+    struct glibc_heap_walk *walk = context->walk;
+    uint64_t address = (layout->heap_start + GLIBC_CHUNK_ALIGNMENT - 1) & ~(uint64_t)(GLIBC_CHUNK_ALIGNMENT - 1);
+    uint64_t field;
+
+    while (read_glibc_heap_word(context, address + sizeof(uint64_t), &field)) {
+        uint64_t size = field & ~(uint64_t)7;
+
+        if (address == top) {
+            add_glibc_heap_chunk(context, address, size, (field & 7) | GLIBC_CHUNK_TOP);
+            break;
+        }
+
+        if (size < GLIBC_MIN_CHUNK_SIZE || size % GLIBC_CHUNK_ALIGNMENT || address + size > layout->heap_end) {
+            add_glibc_heap_corruption(context, GLIBC_CORRUPTION_INVALID_SIZE, address, field, -1);
+            break;
+        }
+
+        add_glibc_heap_chunk(context, address, size, (field & 7) | GLIBC_CHUNK_IN_USE);
+        address += size;
+    }
+
+    if (!walk->chunk_count || !(walk->chunks[walk->chunk_count - 1].flags & GLIBC_CHUNK_TOP))
+        add_glibc_heap_corruption(context, GLIBC_CORRUPTION_TOP_NOT_FOUND, top, 0, -1);
+
+    // A chunk is free when the next one says so, binned chunks are sorted out later
+    for (uint64_t i = 0; i + 1 < walk->chunk_count; i++)
+        if (!(walk->chunks[i + 1].flags & GLIBC_CHUNK_PREV_INUSE)) walk->chunks[i].flags &= ~GLIBC_CHUNK_IN_USE;
+}
+
+uint64_t reveal_glibc_pointer(struct glibc_heap_context *context, uint64_t position, uint64_t pointer)
+{
+    return context->layout->safe_linking ? (position >> 12) ^ pointer : pointer;
+}
+
+void walk_glibc_tcache(struct glibc_heap_context *context)
+{
+    struct glibc_heap_layout *layout = context->layout;
+    struct glibc_heap_walk *walk = context->walk;
+    uint64_t counts_size = layout->tcache_counts_size;
+
+    if (!counts_size || !walk->chunk_count) return;
+
+    // The tcache of the main thread is the first chunk of the main heap
+    uint64_t tcache = walk->chunks[0].address + 2 * sizeof(uint64_t);
+    uint64_t struct_size = GLIBC_TCACHE_MAX_BINS * (counts_size + sizeof(uint64_t));
+    uint64_t chunk_size = (struct_size + sizeof(uint64_t) + GLIBC_CHUNK_ALIGNMENT - 1) & ~(uint64_t)15;
+
+    if (walk->chunks[0].size != chunk_size) return;
+
+    for (int32_t bin = 0; bin < GLIBC_TCACHE_MAX_BINS; bin++) {
+        uint64_t count = 0, expected = 0, entry = 0;
+        uint64_t head = tcache + GLIBC_TCACHE_MAX_BINS * counts_size + bin * sizeof(uint64_t);
+
+        if (!read_glibc_heap_word(context, head, &entry)) {
+            add_glibc_heap_corruption(context, GLIBC_CORRUPTION_OUT_OF_HEAP, head, 0, bin);
+            break;
+        }
+
+        memcpy(&expected, context->heap + (tcache - layout->heap_start) + bin * counts_size, counts_size);
+
+        while (entry) {
+            int64_t index = bin_glibc_heap_chunk(context, entry - 2 * sizeof(uint64_t), GLIBC_CHUNK_TCACHE, bin);
+
+            if (index < 0) break;
+
+            count++;
+
+            if (walk->chunks[index].size != GLIBC_MIN_CHUNK_SIZE + (uint64_t)bin * GLIBC_CHUNK_ALIGNMENT)
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_BIN_SIZE_MISMATCH, walk->chunks[index].address,
+                                          walk->chunks[index].size, bin);
+
+            uint64_t next = 0;
+
+            if (!read_glibc_heap_word(context, entry, &next)) {
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_OUT_OF_HEAP, entry, 0, bin);
+                break;
+            }
+
+            entry = reveal_glibc_pointer(context, entry, next);
+        }
+
+        if (count != expected)
+            add_glibc_heap_corruption(context, GLIBC_CORRUPTION_TCACHE_COUNT_MISMATCH, tcache, count, bin);
+    }
+}
+
+void walk_glibc_fastbins(struct glibc_heap_context *context)
+{
+    struct glibc_heap_walk *walk = context->walk;
+
+    for (int32_t bin = 0; bin < GLIBC_NFASTBINS; bin++) {
+        uint64_t chunk = read_glibc_arena_word(context, context->layout->fastbins_offset + bin * sizeof(uint64_t));
+
+        while (chunk) {
+            int64_t index = bin_glibc_heap_chunk(context, chunk, GLIBC_CHUNK_FASTBIN, bin);
+
+            if (index < 0) break;
+
+            if (walk->chunks[index].size != GLIBC_MIN_CHUNK_SIZE + (uint64_t)bin * GLIBC_CHUNK_ALIGNMENT)
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_BIN_SIZE_MISMATCH, chunk,
+                                          walk->chunks[index].size, bin);
+
+            uint64_t next = 0;
+
+            if (!read_glibc_heap_word(context, chunk + 2 * sizeof(uint64_t), &next)) {
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_OUT_OF_HEAP, chunk, 0, bin);
+                break;
+            }
+
+            chunk = reveal_glibc_pointer(context, chunk + 2 * sizeof(uint64_t), next);
+        }
+    }
+}
+
+void check_glibc_free_chunk(struct glibc_heap_context *context, int64_t index)
+{
+    struct glibc_heap_walk *walk = context->walk;
+    struct glibc_heap_chunk *chunk = &walk->chunks[index];
+
+    if ((uint64_t)index + 1 >= walk->chunk_count) return;
+
+    struct glibc_heap_chunk *next = &walk->chunks[index + 1];
+    uint64_t prev_size = 0;
+
+    if (!read_glibc_heap_word(context, next->address, &prev_size)) {
+        add_glibc_heap_corruption(context, GLIBC_CORRUPTION_OUT_OF_HEAP, next->address, 0, chunk->bin);
+        return;
+    }
+
+    if (prev_size != chunk->size)
+        add_glibc_heap_corruption(context, GLIBC_CORRUPTION_PREV_SIZE_MISMATCH, next->address, prev_size, chunk->bin);
+
+    if (next->flags & GLIBC_CHUNK_PREV_INUSE)
+        add_glibc_heap_corruption(context, GLIBC_CORRUPTION_PREV_INUSE_SET, next->address, 0, chunk->bin);
+}
+
+void walk_glibc_bins(struct glibc_heap_context *context)
+{
+    struct glibc_heap_layout *layout = context->layout;
+    struct glibc_heap_walk *walk = context->walk;
+
+    for (int32_t bin = 1; bin < GLIBC_NBINS; bin++) {
+        uint64_t offset = layout->bins_offset + (bin - 1) * 2 * sizeof(uint64_t);
+        uint64_t header = layout->arena + offset - 2 * sizeof(uint64_t);
+        uint64_t previous = header, chunk = read_glibc_arena_word(context, offset);
+        uint32_t kind = bin == 1 ? GLIBC_CHUNK_UNSORTED : bin < 64 ? GLIBC_CHUNK_SMALLBIN : GLIBC_CHUNK_LARGEBIN;
+
+        while (chunk != header) {
+            int64_t index = bin_glibc_heap_chunk(context, chunk, kind, bin);
+
+            if (index < 0) break;
+
+            uint64_t size = walk->chunks[index].size, bk = 0, fd = 0;
+
+            if ((kind == GLIBC_CHUNK_SMALLBIN && (int64_t)(size >> 4) != bin) ||
+                (kind == GLIBC_CHUNK_LARGEBIN && glibc_largebin_index(size) != bin))
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_BIN_SIZE_MISMATCH, chunk, size, bin);
+
+            if (!read_glibc_heap_word(context, chunk + 3 * sizeof(uint64_t), &bk)) {
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_OUT_OF_HEAP, chunk, 0, bin);
+                break;
+            }
+
+            if (bk != previous) add_glibc_heap_corruption(context, GLIBC_CORRUPTION_BAD_LINKS, chunk, bk, bin);
+
+            check_glibc_free_chunk(context, index);
+
+            if (!read_glibc_heap_word(context, chunk + 2 * sizeof(uint64_t), &fd)) {
+                add_glibc_heap_corruption(context, GLIBC_CORRUPTION_OUT_OF_HEAP, chunk, 0, bin);
+                break;
+            }
+
+            previous = chunk;
+            chunk = fd;
+        }
+
+        if (chunk == header && read_glibc_arena_word(context, offset + sizeof(uint64_t)) != previous)
+            add_glibc_heap_corruption(context, GLIBC_CORRUPTION_BAD_LINKS, header,
+                                      read_glibc_arena_word(context, offset + sizeof(uint64_t)), bin);
+    }
+}
+
+struct glibc_heap_walk *walk_glibc_heap(int pid, struct glibc_heap_layout *layout)
+{
+    uint64_t heap_size = layout->heap_end - layout->heap_start;
+    uint64_t arena_size = layout->bins_offset + (GLIBC_NBINS - 1) * 2 * sizeof(uint64_t);
+    struct glibc_heap_context context = {.layout = layout};
+
+    // The whole heap is read at once, then parsed locally
+    context.heap = malloc(heap_size);
+    context.arena = malloc(arena_size);
+
+    if (read_remote_memory(pid, layout->heap_start, context.heap, heap_size) ||
+        read_remote_memory(pid, layout->arena, context.arena, arena_size)) {
+        free(context.heap);
+        free(context.arena);
+        return NULL;
+    }
+
+    context.walk = calloc(1, sizeof(struct glibc_heap_walk));
+
+    walk_glibc_heap_chunks(&context, read_glibc_arena_word(&context, layout->top_offset));
+    walk_glibc_tcache(&context);
+    walk_glibc_fastbins(&context);
+    walk_glibc_bins(&context);
+
+    struct glibc_heap_walk *walk = context.walk;
+
+    for (uint64_t i = 0; i < walk->chunk_count; i++) {
+        uint32_t flags = walk->chunks[i].flags;
+
+        if (!(flags & (GLIBC_CHUNK_IN_USE | GLIBC_CHUNK_BINNED | GLIBC_CHUNK_TOP)))
+            add_glibc_heap_corruption(&context, GLIBC_CORRUPTION_FREE_NOT_IN_BIN, walk->chunks[i].address,
+                                      walk->chunks[i].size, -1);
+    }
+
+    free(context.heap);
+    free(context.arena);
+
+    return walk;
+}
+
+void free_glibc_heap_walk(struct glibc_heap_walk *walk)
+{
+    if (walk == NULL) return;
+
+    free(walk->chunks);
+    free(walk->corruptions);
+    free(walk);
+}
+
+// The maximum depth of the stacks collected by the profiler
+#define PROFILER_MAX_DEPTH 256
+
+// The amount of stack read at once when unwinding a thread
+#define PROFILER_STACK_WINDOW 0x4000
+
+struct profiler_entry {
+    uint64_t hash;
+    int tid;
+    uint32_t depth;
+    uint64_t count;
+    uint64_t frames_offset;
+};
+
+struct profiler {
+    int pid;
+    uint64_t interval;
+    uint32_t max_depth;
+    pthread_t sampler;
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+    _Bool sampler_alive;
+    _Bool process_running;
+    _Bool pending;
+    int sequence;
+    struct profiler_entry *entries;
+    uint64_t entry_capacity;
+    uint64_t *frames;
+    uint64_t frame_capacity;
+    struct profiler_stats stats;
+    uint8_t window[PROFILER_STACK_WINDOW];
+};
+
+// Sends a SIGSTOP tagged with the sequence number of the request, so that its stop can be told apart from the others
+int send_profiler_request(struct profiler *profiler)
+{
+    siginfo_t info;
+
+    memset(&info, 0, sizeof(info));
+    info.si_signo = SIGSTOP;
+    info.si_code = SI_QUEUE;
+    info.si_pid = getpid();
+    info.si_uid = getuid();
+    info.si_value.sival_int = profiler->sequence + 1;
+
+    if (syscall(SYS_rt_tgsigqueueinfo, profiler->pid, profiler->pid, SIGSTOP, &info)) return -1;
+
+    profiler->sequence++;
+
+    return 0;
+}
+
+void *run_profiler_sampler(void *arg)
+{
+    struct profiler *profiler = arg;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    pthread_mutex_lock(&profiler->lock);
+
+    while (profiler->sampler_alive) {
+        uint64_t nanoseconds = deadline.tv_nsec + profiler->interval;
+        deadline.tv_sec += nanoseconds / 1000000000;
+        deadline.tv_nsec = nanoseconds % 1000000000;
+
+        while (profiler->sampler_alive &&
+               pthread_cond_timedwait(&profiler->wakeup, &profiler->lock, &deadline) != ETIMEDOUT)
+            ;
+
+        if (!profiler->sampler_alive || !profiler->process_running) continue;
+
+        // A single request is in flight at any time, the stop might be delayed by other events
+        if (profiler->pending) {
+            profiler->stats.missed++;
+        } else if (!send_profiler_request(profiler)) {
+            profiler->pending = 1;
+            profiler->stats.requested++;
+        }
+    }
+
+    pthread_mutex_unlock(&profiler->lock);
+
+    return NULL;
+}
+
+void set_profiler_process_running(struct global_state *state, _Bool running)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL) return;
+
+    pthread_mutex_lock(&profiler->lock);
+    profiler->process_running = running;
+
+    // A request whose stop was swallowed while stepping is never answered, a late stop carries a stale sequence number
+    if (running) profiler->pending = 0;
+
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+uint32_t unwind_profiled_thread(struct profiler *profiler, struct thread *t, uint64_t *frames)
+{
+    uint64_t sp = STACK_POINTER(t->regs), pair[2];
+    uint32_t depth = 0;
+
+#ifdef ARCH_AMD64
+    uint64_t fp = t->regs.rbp;
+#endif
+
+#ifdef ARCH_AARCH64
+    uint64_t fp = t->regs.x29;
+#endif
+
+    frames[depth++] = INSTRUCTION_POINTER(t->regs);
+
+    // Most frames are close to the stack pointer, read them all at once
+    struct iovec local = {.iov_base = profiler->window, .iov_len = PROFILER_STACK_WINDOW};
+    struct iovec remote = {.iov_base = (void *)sp, .iov_len = PROFILER_STACK_WINDOW};
+    ssize_t window_size = process_vm_readv(t->tid, &local, 1, &remote, 1, 0);
+
+    if (window_size < 0) window_size = 0;
+
+    while (depth < profiler->max_depth && fp != 0 && !(fp & 7)) {
+        if (fp >= sp && fp + sizeof(pair) <= sp + window_size) {
+            memcpy(pair, profiler->window + (fp - sp), sizeof(pair));
+        } else {
+            local.iov_base = pair;
+            local.iov_len = sizeof(pair);
+            remote.iov_base = (void *)fp;
+            remote.iov_len = sizeof(pair);
+
+            if (process_vm_readv(t->tid, &local, 1, &remote, 1, 0) != sizeof(pair)) break;
+        }
+
+        if (pair[1] == 0) break;
+
+        frames[depth++] = pair[1];
+
+        // The stack grows downwards, any other direction means the chain is broken
+        if (pair[0] <= fp) break;
+
+        fp = pair[0];
+    }
+
+    if (depth == profiler->max_depth && fp != 0) profiler->stats.truncated++;
+
+    return depth;
+}
+
+uint64_t hash_profiled_stack(int tid, uint64_t *frames, uint32_t depth)
+{
+    uint64_t hash = 0xcbf29ce484222325 ^ (uint64_t)tid;
+
+    for (uint32_t i = 0; i < depth; i++) {
+        hash ^= frames[i];
+        hash *= 0x100000001b3;
+    }
+
+    return hash ? hash : 1;
+}
+
+struct profiler_entry *find_profiler_entry(struct profiler *profiler, uint64_t hash, int tid, uint64_t *frames,
+                                           uint32_t depth)
+{
+    uint64_t mask = profiler->entry_capacity - 1;
+    uint64_t index = hash & mask;
+
+    while (profiler->entries[index].hash) {
+        struct profiler_entry *entry = &profiler->entries[index];
+
+        if (entry->hash == hash && entry->tid == tid && entry->depth == depth &&
+            !memcmp(profiler->frames + entry->frames_offset, frames, depth * sizeof(uint64_t)))
+            return entry;
+
+        index = (index + 1) & mask;
+    }
+
+    return &profiler->entries[index];
+}
+
+void resize_profiler_entries(struct profiler *profiler)
+{
+    struct profiler_entry *old_entries = profiler->entries;
+    uint64_t old_capacity = profiler->entry_capacity;
+
+    profiler->entry_capacity = old_capacity ? old_capacity * 2 : 1024;
+    profiler->entries = calloc(profiler->entry_capacity, sizeof(struct profiler_entry));
+
+    for (uint64_t i = 0; i < old_capacity; i++) {
+        if (!old_entries[i].hash) continue;
+
+        uint64_t index = old_entries[i].hash & (profiler->entry_capacity - 1);
+
+        while (profiler->entries[index].hash)
+            index = (index + 1) & (profiler->entry_capacity - 1);
+
+        profiler->entries[index] = old_entries[i];
+    }
+
+    free(old_entries);
+}
+
+void record_profiled_stack(struct profiler *profiler, int tid, uint64_t *frames, uint32_t depth)
+{
+    uint64_t hash = hash_profiled_stack(tid, frames, depth);
+    struct profiler_entry *entry = find_profiler_entry(profiler, hash, tid, frames, depth);
+
+    if (entry->hash) {
+        entry->count++;
+        return;
+    }
+
+    if ((profiler->stats.stacks + 1) * 4 > profiler->entry_capacity * 3) {
+        resize_profiler_entries(profiler);
+        entry = find_profiler_entry(profiler, hash, tid, frames, depth);
+    }
+
+    if (profiler->stats.frames + depth > profiler->frame_capacity) {
+        while (profiler->stats.frames + depth > profiler->frame_capacity)
+            profiler->frame_capacity = profiler->frame_capacity ? profiler->frame_capacity * 2 : 4096;
+
+        profiler->frames = realloc(profiler->frames, profiler->frame_capacity * sizeof(uint64_t));
+    }
+
+    memcpy(profiler->frames + profiler->stats.frames, frames, depth * sizeof(uint64_t));
+
+    entry->hash = hash;
+    entry->tid = tid;
+    entry->depth = depth;
+    entry->count = 1;
+    entry->frames_offset = profiler->stats.frames;
+
+    profiler->stats.frames += depth;
+    profiler->stats.stacks++;
+}
+
+void dispatch_profiler_sample(struct global_state *state, int pid, struct thread_status **head)
+{
+    struct profiler *profiler = state->profiler;
+    struct thread_status *ts = *head, *prev = NULL;
+
+    if (profiler == NULL) return;
+
+    while (ts != NULL && !(ts->tid == pid && WIFSTOPPED(ts->status) && WSTOPSIG(ts->status) == SIGSTOP)) {
+        prev = ts;
+        ts = ts->next;
+    }
+
+    if (ts == NULL) return;
+
+    siginfo_t info;
+
+    // Any other SIGSTOP, sent by the process or by someone else, is left to the caller
+    if (ptrace(PTRACE_GETSIGINFO, pid, NULL, &info) || info.si_code != SI_QUEUE || info.si_pid != getpid()) return;
+
+    pthread_mutex_lock(&profiler->lock);
+
+    // Only the stop of the outstanding request is sampled, a late one is dropped
+    _Bool running = profiler->process_running;
+    _Bool requested = running && profiler->pending && info.si_value.sival_int == profiler->sequence;
+
+    if (requested) profiler->pending = 0;
+
+    pthread_mutex_unlock(&profiler->lock);
+
+    // A late stop, received while stepping, is left to the caller as a spurious SIGSTOP
+    if (!running) return;
+
+    if (requested) {
+        uint64_t frames[PROFILER_MAX_DEPTH];
+
+        for (struct thread *t = state->t_HEAD; t != NULL; t = t->next)
+            record_profiled_stack(profiler, t->tid, frames, unwind_profiled_thread(profiler, t, frames));
+
+        profiler->stats.samples++;
+    }
+
+    // Our request might have been merged with the SIGSTOP used to interrupt the other threads
+    if (ts->interrupted) return;
+
+    if (prev == NULL)
+        *head = ts->next;
+    else
+        prev->next = ts->next;
+
+    free(ts);
+}
+
+void configure_profiler(struct global_state *state, int pid, uint32_t frequency, uint32_t max_depth)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL) {
+        profiler = calloc(1, sizeof(struct profiler));
+        pthread_mutex_init(&profiler->lock, NULL);
+
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&profiler->wakeup, &attributes);
+        pthread_condattr_destroy(&attributes);
+
+        resize_profiler_entries(profiler);
+        state->profiler = profiler;
+    }
+
+    profiler->pid = pid;
+    profiler->interval = 1000000000 / (frequency ? frequency : 1);
+    profiler->max_depth = max_depth && max_depth < PROFILER_MAX_DEPTH ? max_depth : PROFILER_MAX_DEPTH;
+}
+
+void enable_profiler(struct global_state *state)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL || profiler->sampler_alive) return;
+
+    profiler->sampler_alive = 1;
+
+    if (pthread_create(&profiler->sampler, NULL, run_profiler_sampler, profiler)) {
+        perror("pthread_create");
+        profiler->sampler_alive = 0;
+    }
+}
+
+void disable_profiler(struct global_state *state)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL || !profiler->sampler_alive) return;
+
+    pthread_mutex_lock(&profiler->lock);
+    profiler->sampler_alive = 0;
+    pthread_cond_signal(&profiler->wakeup);
+    pthread_mutex_unlock(&profiler->lock);
+
+    pthread_join(profiler->sampler, NULL);
+}
+
+int get_profiler_stats(struct global_state *state, struct profiler_stats *stats)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL) return 0;
+
+    pthread_mutex_lock(&profiler->lock);
+    *stats = profiler->stats;
+    pthread_mutex_unlock(&profiler->lock);
+
+    return 1;
+}
+
+uint64_t get_profiled_stacks(struct global_state *state, struct profiled_stack *buffer, uint64_t max_count)
+{
+    struct profiler *profiler = state->profiler;
+    uint64_t count = 0;
+
+    if (profiler == NULL) return 0;
+
+    for (uint64_t i = 0; i < profiler->entry_capacity && count < max_count; i++) {
+        struct profiler_entry *entry = &profiler->entries[i];
+
+        if (!entry->hash) continue;
+
+        buffer[count].tid = entry->tid;
+        buffer[count].depth = entry->depth;
+        buffer[count].count = entry->count;
+        buffer[count].frames_offset = entry->frames_offset;
+        count++;
+    }
+
+    return count;
+}
+
+uint64_t get_profiled_frames(struct global_state *state, uint64_t *buffer, uint64_t max_count)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL) return 0;
+
+    uint64_t count = profiler->stats.frames < max_count ? profiler->stats.frames : max_count;
+
+    memcpy(buffer, profiler->frames, count * sizeof(uint64_t));
+
+    return count;
+}
+
+void reset_profiler(struct global_state *state)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL) return;
+
+    pthread_mutex_lock(&profiler->lock);
+
+    memset(profiler->entries, 0, profiler->entry_capacity * sizeof(struct profiler_entry));
+    memset(&profiler->stats, 0, sizeof(profiler->stats));
+
+    pthread_mutex_unlock(&profiler->lock);
+}
+
+void free_profiler(struct global_state *state)
+{
+    struct profiler *profiler = state->profiler;
+
+    if (profiler == NULL) return;
+
+    disable_profiler(state);
+
+    pthread_mutex_destroy(&profiler->lock);
+    pthread_cond_destroy(&profiler->wakeup);
+
+    free(profiler->entries);
+    free(profiler->frames);
+    free(profiler);
+
+    state->profiler = NULL;
+}
+
+// The maximum number of frames, threads and interpreters visited by the CPython walker, to survive broken lists
+#define CPYTHON_MAX_FRAMES 4096
+#define CPYTHON_MAX_THREADS 4096
+
+// The maximum size of the strings and of the line tables read by the CPython walker
+#define CPYTHON_MAX_STRING 4096
+#define CPYTHON_MAX_LINETABLE 0x100000
+
+// The location codes of the line tables of CPython 3.11+
+#define CPYTHON_LOCATION_ONE_LINE0 10
+#define CPYTHON_LOCATION_ONE_LINE2 12
+#define CPYTHON_LOCATION_NO_COLUMNS 13
+#define CPYTHON_LOCATION_LONG 14
+#define CPYTHON_LOCATION_NONE 15
+
+struct cpython_code {
+    uint64_t address;
+    int32_t firstlineno;
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint32_t filename_offset;
+    uint32_t filename_size;
+    uint8_t name_kind;
+    uint8_t filename_kind;
+    uint8_t *linetable;
+    uint64_t linetable_size;
+};
+
+struct cpython_walk_context {
+    int pid;
+    struct cpython_layout *layout;
+    struct cpython_stack *stack;
+    uint64_t strings_capacity;
+    uint64_t frame_capacity;
+    struct cpython_code *codes;
+    uint64_t code_count;
+    uint64_t code_capacity;
+};
+
+_Bool read_cpython_pointer(int pid, uint64_t address, uint64_t *value)
+{
+    return !read_remote_memory(pid, address, value, sizeof(uint64_t));
+}
+
+uint32_t read_cpython_varint(uint8_t **cursor, uint8_t *limit)
+{
+    uint32_t value = 0, shift = 0;
+    uint8_t byte;
+
+    do {
+        if (*cursor >= limit || shift > 30) return value;
+
+        byte = *(*cursor)++;
+        value |= (uint32_t)(byte & 63) << shift;
+        shift += 6;
+    } while (byte & 64);
+
+    return value;
+}
+
+int32_t read_cpython_signed_varint(uint8_t **cursor, uint8_t *limit)
+{
+    uint32_t value = read_cpython_varint(cursor, limit);
+
+    return value & 1 ? -(int32_t)(value >> 1) : (int32_t)(value >> 1);
+}
+
+int32_t find_cpython_line(struct cpython_code *code, int64_t offset)
+{
+    uint8_t *cursor = code->linetable, *limit = code->linetable + code->linetable_size;
+    int32_t computed = code->firstlineno;
+    int64_t start = 0;
+
+    // The frame has not started executing yet
+    if (offset < 0) return code->firstlineno;
+
+    while (cursor < limit) {
+        uint8_t header = *cursor;
+        uint8_t *entry = cursor + 1;
+        int kind = (header >> 3) & 15;
+        int64_t end = start + ((header & 7) + 1) * 2;
+
+        if (kind == CPYTHON_LOCATION_NO_COLUMNS || kind == CPYTHON_LOCATION_LONG)
+            computed += read_cpython_signed_varint(&entry, limit);
+        else if (kind >= CPYTHON_LOCATION_ONE_LINE0 && kind <= CPYTHON_LOCATION_ONE_LINE2)
+            computed += kind - CPYTHON_LOCATION_ONE_LINE0;
+
+        if (start <= offset && offset < end) return kind == CPYTHON_LOCATION_NONE ? -1 : computed;
+
+        start = end;
+
+        // Each entry starts with the highest bit set
+        do {
+            cursor++;
+        } while (cursor < limit && !(*cursor & 128));
+    }
+
+    return -1;
+}
+
+_Bool read_cpython_string(struct cpython_walk_context *context, uint64_t address, uint32_t *offset, uint32_t *size,
+                          uint8_t *kind)
+{
+    struct cpython_layout *layout = context->layout;
+    struct cpython_stack *stack = context->stack;
+    uint8_t header[128];
+    int64_t length;
+    uint32_t state;
+    uint64_t data;
+
+    *offset = *size = *kind = 0;
+
+    if (layout->unicode_compact_data + sizeof(uint64_t) > sizeof(header) ||
+        read_remote_memory(context->pid, address, header, layout->unicode_compact_data + sizeof(uint64_t)))
+        return 0;
+
+    memcpy(&length, header + layout->unicode_length, sizeof(length));
+    memcpy(&state, header + layout->unicode_state, sizeof(state));
+
+    uint8_t string_kind = (state >> 2) & 7;
+    _Bool compact = (state >> 5) & 1, ascii = (state >> 6) & 1;
+
+    if (string_kind != 1 && string_kind != 2 && string_kind != 4) return 0;
+
+    if (compact && ascii)
+        data = address + layout->unicode_ascii_data;
+    else if (compact)
+        data = address + layout->unicode_compact_data;
+    else
+        memcpy(&data, header + layout->unicode_compact_data, sizeof(data));
+
+    if (length < 0) return 0;
+
+    uint64_t data_size = (uint64_t)length * string_kind;
+    if (data_size > CPYTHON_MAX_STRING) data_size = CPYTHON_MAX_STRING - CPYTHON_MAX_STRING % string_kind;
+
+    if (stack->strings_size + data_size > context->strings_capacity) {
+        while (stack->strings_size + data_size > context->strings_capacity)
+            context->strings_capacity = context->strings_capacity ? context->strings_capacity * 2 : 4096;
+
+        stack->strings = realloc(stack->strings, context->strings_capacity);
+    }
+
+    if (read_remote_memory(context->pid, data, stack->strings + stack->strings_size, data_size)) return 0;
+
+    *offset = stack->strings_size;
+    *size = data_size;
+    *kind = string_kind;
+    stack->strings_size += data_size;
+
+    return 1;
+}
+
+struct cpython_code *read_cpython_code(struct cpython_walk_context *context, uint64_t address)
+{
+    struct cpython_layout *layout = context->layout;
+    uint8_t header[512];
+    uint64_t type, name, filename, linetable, linetable_size;
+
+    // Recursive functions share their code object, read it only once
+    for (uint64_t i = 0; i < context->code_count; i++)
+        if (context->codes[i].address == address) return &context->codes[i];
+
+    if (layout->code_adaptive > sizeof(header) || read_remote_memory(context->pid, address, header, layout->code_adaptive))
+        return NULL;
+
+    memcpy(&type, header + sizeof(uint64_t), sizeof(type));
+
+    if (layout->code_type && type != layout->code_type) return NULL;
+
+    if (context->code_count == context->code_capacity) {
+        context->code_capacity = context->code_capacity ? context->code_capacity * 2 : 64;
+        context->codes = realloc(context->codes, context->code_capacity * sizeof(struct cpython_code));
+    }
+
+    struct cpython_code *code = &context->codes[context->code_count++];
+    memset(code, 0, sizeof(*code));
+
+    code->address = address;
+    memcpy(&code->firstlineno, header + layout->code_firstlineno, sizeof(code->firstlineno));
+    memcpy(&name, header + layout->code_qualname, sizeof(name));
+    memcpy(&filename, header + layout->code_filename, sizeof(filename));
+    memcpy(&linetable, header + layout->code_linetable, sizeof(linetable));
+
+    read_cpython_string(context, name, &code->name_offset, &code->name_size, &code->name_kind);
+    read_cpython_string(context, filename, &code->filename_offset, &code->filename_size, &code->filename_kind);
+
+    if (read_cpython_pointer(context->pid, linetable + layout->bytes_size, &linetable_size) &&
+        linetable_size <= CPYTHON_MAX_LINETABLE) {
+        code->linetable = malloc(linetable_size ? linetable_size : 1);
+
+        if (!read_remote_memory(context->pid, linetable + layout->bytes_data, code->linetable, linetable_size))
+            code->linetable_size = linetable_size;
+    }
+
+    return code;
+}
+
+uint64_t find_cpython_thread_state(int pid, struct cpython_layout *layout, int tid)
+{
+    uint64_t interpreter, thread_state, native_thread_id;
+    uint32_t visited = 0;
+
+    if (!read_cpython_pointer(pid, layout->runtime + layout->runtime_interpreters, &interpreter)) return 0;
+
+    while (interpreter && visited < CPYTHON_MAX_THREADS) {
+        if (!read_cpython_pointer(pid, interpreter + layout->interp_threads, &thread_state)) return 0;
+
+        while (thread_state && visited++ < CPYTHON_MAX_THREADS) {
+            if (!read_cpython_pointer(pid, thread_state + layout->tstate_native_thread_id, &native_thread_id))
+                return 0;
+
+            if (native_thread_id == (uint64_t)tid) return thread_state;
+
+            if (!read_cpython_pointer(pid, thread_state + layout->tstate_next, &thread_state)) return 0;
+        }
+
+        if (!read_cpython_pointer(pid, interpreter + layout->interp_next, &interpreter)) return 0;
+    }
+
+    return 0;
+}
+
+struct cpython_stack *walk_cpython_stack(int pid, struct cpython_layout *layout, int tid)
+{
+    struct cpython_walk_context context = {.pid = pid, .layout = layout};
+    uint64_t thread_state = find_cpython_thread_state(pid, layout, tid), frame = 0;
+    uint8_t buffer[128];
+
+    context.stack = calloc(1, sizeof(struct cpython_stack));
+
+    // A thread that never ran Python code has no thread state
+    if (!thread_state) return context.stack;
+
+    if (layout->tstate_cframe) {
+        uint64_t cframe;
+
+        if (read_cpython_pointer(pid, thread_state + layout->tstate_cframe, &cframe) && cframe)
+            read_cpython_pointer(pid, cframe + layout->tstate_frame, &frame);
+    } else {
+        read_cpython_pointer(pid, thread_state + layout->tstate_frame, &frame);
+    }
+
+    uint32_t frame_size = layout->frame_owner + 1;
+    if (layout->frame_is_entry >= (int32_t)frame_size) frame_size = layout->frame_is_entry + 1;
+
+    struct cpython_stack *stack = context.stack;
+
+    while (frame && stack->frame_count < CPYTHON_MAX_FRAMES && frame_size <= sizeof(buffer)) {
+        uint64_t code_address, previous, instruction;
+
+        if (read_remote_memory(pid, frame, buffer, frame_size)) break;
+
+        memcpy(&code_address, buffer + layout->frame_code, sizeof(code_address));
+        memcpy(&previous, buffer + layout->frame_previous, sizeof(previous));
+        memcpy(&instruction, buffer + layout->frame_instr, sizeof(instruction));
+
+        // The frames pushed by the C stack mark the start of a call to the evaluation loop
+        if (layout->cstack_owner >= 0 && buffer[layout->frame_owner] == layout->cstack_owner) {
+            if (stack->frame_count) stack->frames[stack->frame_count - 1].entry = 1;
+
+            frame = previous;
+            continue;
+        }
+
+        struct cpython_code *code = read_cpython_code(&context, code_address);
+
+        if (code != NULL) {
+            if (stack->frame_count == context.frame_capacity) {
+                context.frame_capacity = context.frame_capacity ? context.frame_capacity * 2 : 64;
+                stack->frames = realloc(stack->frames, context.frame_capacity * sizeof(struct cpython_frame));
+            }
+
+            struct cpython_frame *entry = &stack->frames[stack->frame_count++];
+
+            entry->address = frame;
+            entry->code = code_address;
+            entry->line = find_cpython_line(code, (int64_t)(instruction - (code_address + layout->code_adaptive)));
+            entry->entry = layout->frame_is_entry >= 0 && buffer[layout->frame_is_entry];
+            entry->name_offset = code->name_offset;
+            entry->name_size = code->name_size;
+            entry->name_kind = code->name_kind;
+            entry->filename_offset = code->filename_offset;
+            entry->filename_size = code->filename_size;
+            entry->filename_kind = code->filename_kind;
+        }
+
+        frame = previous;
+    }
+
+    for (uint64_t i = 0; i < context.code_count; i++) free(context.codes[i].linetable);
+    free(context.codes);
+
+    return stack;
+}
+
+void free_cpython_stack(struct cpython_stack *stack)
+{
+    if (stack == NULL) return;
+
+    free(stack->frames);
+    free(stack->strings);
+    free(stack);
+}
+
+// The kinds of the pieces of a DWARF location
+#define DWARF_PIECE_EMPTY 0
+#define DWARF_PIECE_MEMORY 1
+#define DWARF_PIECE_REGISTER 2
+#define DWARF_PIECE_VALUE 3
+
+#define DWARF_STACK_SIZE 64
+
+// The DWARF operations supported by the evaluator
+#define DW_OP_addr 0x03
+#define DW_OP_deref 0x06
+#define DW_OP_const1u 0x08
+#define DW_OP_const8s 0x0f
+#define DW_OP_constu 0x10
+#define DW_OP_consts 0x11
+#define DW_OP_dup 0x12
+#define DW_OP_drop 0x13
+#define DW_OP_over 0x14
+#define DW_OP_pick 0x15
+#define DW_OP_swap 0x16
+#define DW_OP_rot 0x17
+#define DW_OP_abs 0x19
+#define DW_OP_and 0x1a
+#define DW_OP_div 0x1b
+#define DW_OP_minus 0x1c
+#define DW_OP_mod 0x1d
+#define DW_OP_mul 0x1e
+#define DW_OP_neg 0x1f
+#define DW_OP_not 0x20
+#define DW_OP_or 0x21
+#define DW_OP_plus 0x22
+#define DW_OP_plus_uconst 0x23
+#define DW_OP_shl 0x24
+#define DW_OP_shr 0x25
+#define DW_OP_shra 0x26
+#define DW_OP_xor 0x27
+#define DW_OP_bra 0x28
+#define DW_OP_eq 0x29
+#define DW_OP_ge 0x2a
+#define DW_OP_gt 0x2b
+#define DW_OP_le 0x2c
+#define DW_OP_lt 0x2d
+#define DW_OP_ne 0x2e
+#define DW_OP_skip 0x2f
+#define DW_OP_lit0 0x30
+#define DW_OP_lit31 0x4f
+#define DW_OP_reg0 0x50
+#define DW_OP_reg31 0x6f
+#define DW_OP_breg0 0x70
+#define DW_OP_breg31 0x8f
+#define DW_OP_regx 0x90
+#define DW_OP_fbreg 0x91
+#define DW_OP_bregx 0x92
+#define DW_OP_piece 0x93
+#define DW_OP_deref_size 0x94
+#define DW_OP_nop 0x96
+#define DW_OP_call_frame_cfa 0x9c
+#define DW_OP_bit_piece 0x9d
+#define DW_OP_implicit_value 0x9e
+#define DW_OP_stack_value 0x9f
+#define DW_OP_entry_value 0xa3
+#define DW_OP_GNU_entry_value 0xf3
+
+struct dwarf_evaluation {
+    struct thread *thread;
+    struct dwarf_frame *frame;
+    uint64_t cfa;
+    uint64_t frame_base;
+    _Bool cfa_valid;
+    _Bool frame_base_valid;
+};
+
+// Reads a register of the thread, by its DWARF number. Vector registers are truncated to their lowest 8 bytes.
+int read_dwarf_register(struct thread *t, uint64_t number, uint64_t *value)
+{
+#ifdef ARCH_AMD64
+    switch (number) {
+        case 0: *value = t->regs.rax; return 0;
+        case 1: *value = t->regs.rdx; return 0;
+        case 2: *value = t->regs.rcx; return 0;
+        case 3: *value = t->regs.rbx; return 0;
+        case 4: *value = t->regs.rsi; return 0;
+        case 5: *value = t->regs.rdi; return 0;
+        case 6: *value = t->regs.rbp; return 0;
+        case 7: *value = t->regs.rsp; return 0;
+        case 8: *value = t->regs.r8; return 0;
+        case 9: *value = t->regs.r9; return 0;
+        case 10: *value = t->regs.r10; return 0;
+        case 11: *value = t->regs.r11; return 0;
+        case 12: *value = t->regs.r12; return 0;
+        case 13: *value = t->regs.r13; return 0;
+        case 14: *value = t->regs.r14; return 0;
+        case 15: *value = t->regs.r15; return 0;
+        case 16: *value = t->regs.rip; return 0;
+    }
+
+    if (number >= 17 && number <= 32) {
+        if (!t->fpregs.fresh) get_fp_regs(t->tid, &t->fpregs);
+
+        memcpy(value, t->fpregs.xmm0[number - 17].data, sizeof(*value));
+        return 0;
+    }
+#endif
+
+#ifdef ARCH_AARCH64
+    if (number <= 30) {
+        *value = (&t->regs.x0)[number];
+        return 0;
+    }
+
+    if (number == 31) {
+        *value = t->regs.sp;
+        return 0;
+    }
+
+    if (number >= 64 && number <= 95) {
+        if (!t->fpregs.fresh) get_fp_regs(t->tid, &t->fpregs);
+
+        memcpy(value, t->fpregs.vregs[number - 64].data, sizeof(*value));
+        return 0;
+    }
+#endif
+
+    return -1;
+}
+
+// Evaluates a DWARF location expression. Returns the number of pieces, 0 if the location is empty
+// (i.e., the value is optimized out), -1 if the expression cannot be evaluated.
+int evaluate_dwarf_expression(struct dwarf_evaluation *evaluation, struct dwarf_expression *expression)
+{
+    uint64_t stack[DWARF_STACK_SIZE];
+    uint32_t depth = 0;
+    uint8_t location_kind = DWARF_PIECE_EMPTY;
+    uint64_t location_value = 0;
+    int32_t piece_count = 0;
+    uint64_t a, b;
+
+    expression->piece_count = -1;
+
+#define DWARF_PUSH(x) do { uint64_t _v = (x); if (depth == DWARF_STACK_SIZE) return -1; stack[depth++] = _v; } while (0)
+#define DWARF_POP(x) do { if (!depth) return -1; (x) = stack[--depth]; } while (0)
+
+    for (uint32_t i = 0; i < expression->op_count; i++) {
+        struct dwarf_op *op = &expression->ops[i];
+        uint8_t atom = op->atom;
+
+        if (atom >= DW_OP_lit0 && atom <= DW_OP_lit31) {
+            DWARF_PUSH(atom - DW_OP_lit0);
+            continue;
+        }
+
+        if (atom >= DW_OP_reg0 && atom <= DW_OP_reg31) {
+            if (read_dwarf_register(evaluation->thread, atom - DW_OP_reg0, &location_value)) return -1;
+            location_kind = DWARF_PIECE_REGISTER;
+            continue;
+        }
+
+        if (atom >= DW_OP_breg0 && atom <= DW_OP_breg31) {
+            if (read_dwarf_register(evaluation->thread, atom - DW_OP_breg0, &a)) return -1;
+            DWARF_PUSH(a + (int64_t)op->op1);
+            continue;
+        }
+
+        // The constants are already sign-extended by the debug info reader
+        if (atom >= DW_OP_const1u && atom <= DW_OP_consts) {
+            DWARF_PUSH(op->op1);
+            continue;
+        }
+
+        switch (atom) {
+            case DW_OP_addr:
+                DWARF_PUSH(op->op1 + evaluation->frame->base_address);
+                break;
+            case DW_OP_dup:
+                if (!depth) return -1;
+                DWARF_PUSH(stack[depth - 1]);
+                break;
+            case DW_OP_drop:
+                DWARF_POP(a);
+                break;
+            case DW_OP_over:
+                if (depth < 2) return -1;
+                DWARF_PUSH(stack[depth - 2]);
+                break;
+            case DW_OP_pick:
+                if (op->op1 >= depth) return -1;
+                DWARF_PUSH(stack[depth - 1 - op->op1]);
+                break;
+            case DW_OP_swap:
+                if (depth < 2) return -1;
+                a = stack[depth - 1];
+                stack[depth - 1] = stack[depth - 2];
+                stack[depth - 2] = a;
+                break;
+            case DW_OP_rot:
+                // The top entry becomes the third one, and the other two move up
+                if (depth < 3) return -1;
+                a = stack[depth - 1];
+                stack[depth - 1] = stack[depth - 2];
+                stack[depth - 2] = stack[depth - 3];
+                stack[depth - 3] = a;
+                break;
+            case DW_OP_deref:
+                DWARF_POP(a);
+                if (read_remote_memory(evaluation->thread->tid, a, &b, sizeof(b))) return -1;
+                DWARF_PUSH(b);
+                break;
+            case DW_OP_deref_size:
+                DWARF_POP(a);
+                if (!op->op1 || op->op1 > sizeof(b)) return -1;
+                b = 0;
+                if (read_remote_memory(evaluation->thread->tid, a, &b, op->op1)) return -1;
+                DWARF_PUSH(b);
+                break;
+            case DW_OP_abs:
+                DWARF_POP(a);
+                DWARF_PUSH((int64_t)a < 0 ? -a : a);
+                break;
+            case DW_OP_neg:
+                DWARF_POP(a);
+                DWARF_PUSH(-a);
+                break;
+            case DW_OP_not:
+                DWARF_POP(a);
+                DWARF_PUSH(~a);
+                break;
+            case DW_OP_plus_uconst:
+                DWARF_POP(a);
+                DWARF_PUSH(a + op->op1);
+                break;
+            case DW_OP_and:
+            case DW_OP_div:
+            case DW_OP_minus:
+            case DW_OP_mod:
+            case DW_OP_mul:
+            case DW_OP_or:
+            case DW_OP_plus:
+            case DW_OP_shl:
+            case DW_OP_shr:
+            case DW_OP_shra:
+            case DW_OP_xor:
+            case DW_OP_eq:
+            case DW_OP_ge:
+            case DW_OP_gt:
+            case DW_OP_le:
+            case DW_OP_lt:
+            case DW_OP_ne:
+                // The second entry is the left operand
+                DWARF_POP(b);
+                DWARF_POP(a);
+
+                switch (atom) {
+                    case DW_OP_and: a &= b; break;
+                    case DW_OP_div: if (!b) return -1; a = (int64_t)a / (int64_t)b; break;
+                    case DW_OP_minus: a -= b; break;
+                    case DW_OP_mod: if (!b) return -1; a %= b; break;
+                    case DW_OP_mul: a *= b; break;
+                    case DW_OP_or: a |= b; break;
+                    case DW_OP_plus: a += b; break;
+                    case DW_OP_shl: a = b < 64 ? a << b : 0; break;
+                    case DW_OP_shr: a = b < 64 ? a >> b : 0; break;
+                    case DW_OP_shra: a = (int64_t)a >> (b < 64 ? b : 63); break;
+                    case DW_OP_xor: a ^= b; break;
+                    case DW_OP_eq: a = (int64_t)a == (int64_t)b; break;
+                    case DW_OP_ge: a = (int64_t)a >= (int64_t)b; break;
+                    case DW_OP_gt: a = (int64_t)a > (int64_t)b; break;
+                    case DW_OP_le: a = (int64_t)a <= (int64_t)b; break;
+                    case DW_OP_lt: a = (int64_t)a < (int64_t)b; break;
+                    case DW_OP_ne: a = (int64_t)a != (int64_t)b; break;
+                }
+
+                DWARF_PUSH(a);
+                break;
+            case DW_OP_skip:
+            case DW_OP_bra: {
+                if (atom == DW_OP_bra) {
+                    DWARF_POP(a);
+                    if (!a) break;
+                }
+
+                // The target is relative to the end of the 3-byte operation
+                uint64_t target = op->offset + 3 + (int16_t)op->op1;
+                uint32_t j = 0;
+
+                while (j < expression->op_count && expression->ops[j].offset != target) j++;
+
+                if (j == expression->op_count && target <= expression->ops[expression->op_count - 1].offset)
+                    return -1;
+
+                i = j - 1;
+                break;
+            }
+            case DW_OP_regx:
+                if (read_dwarf_register(evaluation->thread, op->op1, &location_value)) return -1;
+                location_kind = DWARF_PIECE_REGISTER;
+                break;
+            case DW_OP_bregx:
+                if (read_dwarf_register(evaluation->thread, op->op1, &a)) return -1;
+                DWARF_PUSH(a + (int64_t)op->op2);
+                break;
+            case DW_OP_fbreg:
+                if (!evaluation->frame_base_valid) return -1;
+                DWARF_PUSH(evaluation->frame_base + (int64_t)op->op1);
+                break;
+            case DW_OP_call_frame_cfa:
+                if (!evaluation->cfa_valid) return -1;
+                DWARF_PUSH(evaluation->cfa);
+                break;
+            case DW_OP_stack_value:
+                DWARF_POP(location_value);
+                location_kind = DWARF_PIECE_VALUE;
+                break;
+            case DW_OP_implicit_value:
+                // The debug info reader keeps the value inline when it fits
+                if (op->op1 > sizeof(location_value)) return -1;
+                location_value = op->op2;
+                location_kind = DWARF_PIECE_VALUE;
+                break;
+            case DW_OP_entry_value:
+            case DW_OP_GNU_entry_value:
+                // The registers hold their entry value only before the first instruction of the function
+                if (!evaluation->frame->at_entry) return -1;
+                if (read_dwarf_register(evaluation->thread, op->op1, &a)) return -1;
+                DWARF_PUSH(a);
+                break;
+            case DW_OP_piece:
+            case DW_OP_bit_piece: {
+                if (piece_count == DWARF_MAX_PIECES) return -1;
+
+                // Bit pieces are only supported when aligned to the start of the location
+                if (atom == DW_OP_bit_piece && op->op2) return -1;
+
+                struct dwarf_piece *piece = &expression->pieces[piece_count++];
+                piece->size = atom == DW_OP_piece ? op->op1 : (op->op1 + 7) / 8;
+
+                if (location_kind != DWARF_PIECE_EMPTY) {
+                    piece->kind = location_kind;
+                    piece->value = location_value;
+                } else if (depth) {
+                    piece->kind = DWARF_PIECE_MEMORY;
+                    piece->value = stack[--depth];
+                } else {
+                    piece->kind = DWARF_PIECE_EMPTY;
+                    piece->value = 0;
+                }
+
+                location_kind = DWARF_PIECE_EMPTY;
+                break;
+            }
+            case DW_OP_nop:
+                break;
+            default:
+                return -1;
+        }
+    }
+
+#undef DWARF_PUSH
+#undef DWARF_POP
+
+    if (!piece_count) {
+        struct dwarf_piece *piece = &expression->pieces[0];
+        piece->size = 0;
+
+        if (location_kind != DWARF_PIECE_EMPTY) {
+            piece->kind = location_kind;
+            piece->value = location_value;
+        } else if (depth) {
+            piece->kind = DWARF_PIECE_MEMORY;
+            piece->value = stack[depth - 1];
+        } else {
+            // An empty expression describes a value that is not available at all
+            expression->piece_count = 0;
+            return 0;
+        }
+
+        piece_count = 1;
+    }
+
+    expression->piece_count = piece_count;
+    return piece_count;
+}
+
+void evaluate_dwarf_expressions(struct global_state *state, int tid, struct dwarf_frame *frame, struct dwarf_expression *expressions, uint32_t count)
+{
+    struct dwarf_evaluation evaluation = {0};
+    uint64_t value;
+
+    for (uint32_t i = 0; i < count; i++) expressions[i].piece_count = -1;
+
+    evaluation.thread = get_thread(state, tid);
+    evaluation.frame = frame;
+
+    if (evaluation.thread == NULL) return;
+
+    if (frame->cfa_register >= 0 && !read_dwarf_register(evaluation.thread, frame->cfa_register, &value)) {
+        evaluation.cfa = value + frame->cfa_offset;
+        evaluation.cfa_valid = 1;
+    }
+
+    // The frame base is the address left on the stack, or the content of the register it names
+    if (frame->frame_base.op_count && evaluate_dwarf_expression(&evaluation, &frame->frame_base) == 1 &&
+        frame->frame_base.pieces[0].kind != DWARF_PIECE_EMPTY) {
+        evaluation.frame_base = frame->frame_base.pieces[0].value;
+        evaluation.frame_base_valid = 1;
+    }
+
+    for (uint32_t i = 0; i < count; i++) evaluate_dwarf_expression(&evaluation, &expressions[i]);
+}
+
+struct native_memory_context {
+    struct native_memory memory;
+    struct global_state *state;
+};
+
+int read_native_memory(struct native_memory *memory, uint64_t address, void *buffer, uint64_t size)
+{
+    struct global_state *state = ((struct native_memory_context *)memory)->state;
+
+    if (read_remote_memory(memory->tid, address, buffer, size)) return -1;
+
+    // The process runs with the breakpoints installed, the callbacks see the original instructions
+    struct software_breakpoint *b = state->sw_b_HEAD;
+    uint8_t *bytes = buffer;
+
+    while (b != NULL && b->addr < address + size) {
+        if (b->addr + BREAKPOINT_SIZE > address && is_sw_breakpoint_armed(state, b)) {
+            uint8_t *original = (uint8_t *)&b->instruction;
+
+            for (uint64_t i = 0; i < BREAKPOINT_SIZE; i++)
+                if (b->addr + i >= address && b->addr + i < address + size)
+                    bytes[b->addr + i - address] = original[i];
+        }
+
+        b = b->next;
+    }
+
+    return 0;
+}
+
+int write_native_memory(struct native_memory *memory, uint64_t address, const void *buffer, uint64_t size)
+{
+    return write_remote_memory(memory->tid, address, buffer, size);
+}
+
+struct native_callback *find_native_callback(struct global_state *state, uint64_t address)
+{
+    struct native_callback *callback = state->native_callbacks;
+
+    while (callback != NULL && callback->addr != address)
+        callback = callback->next;
+
+    return callback;
+}
+
+int handle_native_callback(struct global_state *state, struct thread *t, uint64_t address)
+{
+    struct native_callback *callback = find_native_callback(state, address);
+
+    if (callback == NULL) return NATIVE_TRAP_RESUME;
+
+    struct native_memory_context context = {
+        .memory = {.tid = t->tid, .read = read_native_memory, .write = write_native_memory},
+        .state = state,
+    };
+
+    callback->hit_count++;
+
+    return callback->callback(t, &context.memory, callback->user_data) ? NATIVE_TRAP_STOP : NATIVE_TRAP_RESUME;
+}
+
+void register_native_callback(struct global_state *state, int pid, uint64_t address, uint64_t callback, uint64_t user_data)
+{
+    struct native_callback *entry = find_native_callback(state, address);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(struct native_callback));
+        entry->addr = address;
+        entry->next = state->native_callbacks;
+        state->native_callbacks = entry;
+    }
+
+    entry->callback = (native_breakpoint_callback)callback;
+    entry->user_data = (void *)user_data;
+
+    register_native_trap(state, pid, address, NATIVE_TRAP_CALLBACK);
+
+    // Each callback is enabled on its own trap, the kind is always enabled
+    state->native_traps_enabled |= NATIVE_TRAP_CALLBACK;
+}
+
+void enable_native_callback(struct global_state *state, uint64_t address, _Bool enabled)
+{
+    struct software_breakpoint *b = state->sw_b_HEAD;
+
+    while (b != NULL && b->addr != address)
+        b = b->next;
+
+    if (b == NULL || find_native_callback(state, address) == NULL) return;
+
+    if (enabled)
+        b->native_traps |= NATIVE_TRAP_CALLBACK;
+    else
+        b->native_traps &= ~NATIVE_TRAP_CALLBACK;
+}
+
+void unregister_native_callback(struct global_state *state, uint64_t address)
+{
+    struct native_callback **cursor = &state->native_callbacks;
+
+    while (*cursor != NULL && (*cursor)->addr != address)
+        cursor = &(*cursor)->next;
+
+    if (*cursor == NULL) return;
+
+    struct native_callback *found = *cursor;
+    *cursor = found->next;
+    free(found);
+
+    struct software_breakpoint *b = state->sw_b_HEAD;
+
+    while (b != NULL && b->addr != address)
+        b = b->next;
+
+    if (b != NULL) {
+        b->native_traps &= ~NATIVE_TRAP_CALLBACK;
+
+        if (!b->native_traps && !b->enabled)
+            delete_sw_breakpoint(state, b);
+        else
+            clear_sw_breakpoint_threads(state, b);
+    }
+}
+
+uint64_t get_native_callback_hits(struct global_state *state, uint64_t address)
+{
+    struct native_callback *callback = find_native_callback(state, address);
+
+    return callback != NULL ? callback->hit_count : 0;
+}
+
+void free_native_callbacks(struct global_state *state)
+{
+    if (state->native_callbacks == NULL) return;
+
+    unregister_native_traps(state, NATIVE_TRAP_CALLBACK);
+
+    struct native_callback *callback = state->native_callbacks, *next;
+
+    while (callback != NULL) {
+        next = callback->next;
+        free(callback);
+        callback = next;
+    }
+
+    state->native_callbacks = NULL;
+}
+
+// The longest sleep of the watchdog while a CPU time budget is enforced, as the CPU clock cannot be waited on
+#define BUDGET_CPU_POLL_INTERVAL 10000000
+
+struct execution_budget {
+    int pid;
+    struct budget_usage limits;
+    struct budget_usage usage;
+    uint64_t start_time;
+    uint64_t start_cpu_time;
+    pthread_t watchdog;
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+    _Bool watchdog_alive;
+    _Bool process_running;
+    _Bool pending;
+    int exceeded;
+};
+
+uint64_t read_process_cpu_time(int pid)
+{
+    clockid_t clock;
+    struct timespec now;
+
+    if (clock_getcpuclockid(pid, &clock) || clock_gettime(clock, &now)) return 0;
+
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+int check_budget_time(struct execution_budget *budget, uint64_t *sleep)
+{
+    uint64_t now = monotonic_time();
+
+    *sleep = 0;
+
+    if (budget->limits.wall_time) {
+        uint64_t elapsed = now - budget->start_time;
+
+        if (elapsed >= budget->limits.wall_time) return BUDGET_WALL_TIME;
+
+        *sleep = budget->limits.wall_time - elapsed;
+    }
+
+    if (budget->limits.cpu_time) {
+        uint64_t cpu_time = read_process_cpu_time(budget->pid);
+
+        // The clock is gone with the process
+        if (cpu_time < budget->start_cpu_time) return 0;
+
+        uint64_t used = cpu_time - budget->start_cpu_time;
+
+        if (used >= budget->limits.cpu_time) return BUDGET_CPU_TIME;
+
+        // The CPU time cannot grow faster than the wall time on a single CPU, a shorter poll covers the others
+        uint64_t remaining = budget->limits.cpu_time - used;
+        if (remaining > BUDGET_CPU_POLL_INTERVAL) remaining = BUDGET_CPU_POLL_INTERVAL;
+        if (!*sleep || remaining < *sleep) *sleep = remaining;
+    }
+
+    return 0;
+}
+
+void read_budget_time(struct execution_budget *budget, struct budget_usage *usage)
+{
+    uint64_t cpu_time = read_process_cpu_time(budget->pid);
+
+    usage->wall_time = monotonic_time() - budget->start_time;
+    usage->cpu_time = cpu_time > budget->start_cpu_time ? cpu_time - budget->start_cpu_time : 0;
+}
+
+void *run_budget_watchdog(void *arg)
+{
+    struct execution_budget *budget = arg;
+    struct timespec deadline;
+    uint64_t sleep;
+
+    pthread_mutex_lock(&budget->lock);
+
+    while (budget->watchdog_alive) {
+        // The budget is only enforced while the process runs, and a single stop is requested
+        if (!budget->process_running || budget->exceeded || budget->usage.exhausted) {
+            pthread_cond_wait(&budget->wakeup, &budget->lock);
+            continue;
+        }
+
+        int kind = check_budget_time(budget, &sleep);
+
+        if (kind) {
+            budget->exceeded = kind;
+
+            if (!tgkill(budget->pid, budget->pid, SIGSTOP)) budget->pending = 1;
+
+            continue;
+        }
+
+        if (!sleep) {
+            pthread_cond_wait(&budget->wakeup, &budget->lock);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+        uint64_t nanoseconds = deadline.tv_nsec + sleep;
+        deadline.tv_sec += nanoseconds / 1000000000;
+        deadline.tv_nsec = nanoseconds % 1000000000;
+
+        pthread_cond_timedwait(&budget->wakeup, &budget->lock, &deadline);
+    }
+
+    pthread_mutex_unlock(&budget->lock);
+
+    return NULL;
+}
+
+void set_budget_process_running(struct global_state *state, _Bool running)
+{
+    struct execution_budget *budget = state->budget;
+
+    if (budget == NULL) return;
+
+    pthread_mutex_lock(&budget->lock);
+    budget->process_running = running;
+    pthread_cond_signal(&budget->wakeup);
+    pthread_mutex_unlock(&budget->lock);
+}
+
+int is_syscall_entry(int tid)
+{
+    struct __ptrace_syscall_info info;
+
+    if (ptrace(PTRACE_GET_SYSCALL_INFO, tid, (void *)sizeof(info), &info) <= 0) return 0;
+
+    return info.op == PTRACE_SYSCALL_INFO_ENTRY;
+}
+
+int is_breakpoint_stop(struct global_state *state, int tid)
+{
+    struct thread *t = get_thread(state, tid);
+
+    if (t == NULL) return 0;
+
+    if (is_hw_breakpoint_hit_on_thread(state, tid)) return 1;
+
+    if (!state->sw_breakpoints_installed) return 0;
+
+    uint64_t addr = INSTRUCTION_POINTER(t->regs);
+
+#ifdef ARCH_AMD64
+    // On amd64 the trap is reported after the int3 instruction
+    addr -= BREAKPOINT_SIZE;
+#endif
+
+    struct software_breakpoint *b = state->sw_b_HEAD;
+    while (b != NULL && b->addr < addr)
+        b = b->next;
+
+    // The internal traps of the monitors are not breakpoints of the user, nor the ones scoped to other threads
+    return b != NULL && b->addr == addr && sw_breakpoint_selects_thread(b, tid) &&
+           (b->enabled || (b->native_traps & state->native_traps_enabled & NATIVE_TRAP_CALLBACK));
+}
+
+void exhaust_budget(struct execution_budget *budget, int kind)
+{
+    pthread_mutex_lock(&budget->lock);
+
+    if (!budget->usage.exhausted) budget->usage.exhausted = kind;
+
+    pthread_mutex_unlock(&budget->lock);
+}
+
+int dispatch_budget(struct global_state *state, int pid, struct thread_status **head)
+{
+    struct execution_budget *budget = state->budget;
+    struct thread_status *ts = *head, *prev = NULL, *next;
+    int exhausted, consumed, kind = 0;
+
+    if (budget == NULL) return 0;
+
+    pthread_mutex_lock(&budget->lock);
+
+    exhausted = budget->usage.exhausted;
+    _Bool requested = budget->pending;
+
+    pthread_mutex_unlock(&budget->lock);
+
+    while (ts != NULL) {
+        next = ts->next;
+        consumed = 0;
+
+        if (!ts->interrupted && WIFSTOPPED(ts->status)) {
+            int signum = WSTOPSIG(ts->status);
+
+            // The usage is frozen once the budget is exhausted
+            if (signum == (SIGTRAP | 0x80)) {
+                if (!exhausted && is_syscall_entry(ts->tid)) {
+                    budget->usage.syscalls++;
+
+                    // The syscall is interrupted on its entry, before it is executed
+                    if (budget->limits.syscalls && budget->usage.syscalls > budget->limits.syscalls)
+                        kind = kind ? kind : BUDGET_SYSCALLS;
+                }
+            } else if (signum == SIGSTOP && ts->tid == pid && requested) {
+                // The stop requested by the watchdog is not a signal of the process
+                requested = 0;
+                consumed = 1;
+            } else if (signum == SIGTRAP && !(ts->status >> 16) && !exhausted &&
+                       is_breakpoint_stop(state, ts->tid)) {
+                budget->usage.breakpoint_hits++;
+
+                if (budget->limits.breakpoint_hits && budget->usage.breakpoint_hits > budget->limits.breakpoint_hits)
+                    kind = kind ? kind : BUDGET_BREAKPOINT_HITS;
+            }
+        }
+
+        if (consumed) {
+            if (prev == NULL)
+                *head = next;
+            else
+                prev->next = next;
+
+            free(ts);
+        } else {
+            prev = ts;
+        }
+
+        ts = next;
+    }
+
+    if (exhausted) return 0;
+
+    pthread_mutex_lock(&budget->lock);
+
+    // The watchdog might have been outrun by another stop, its request is then a spurious SIGSTOP
+    if (budget->exceeded) {
+        kind = budget->exceeded;
+        budget->pending = 0;
+    } else if (!requested) {
+        budget->pending = 0;
+    }
+
+    if (kind) {
+        budget->usage.exhausted = kind;
+        read_budget_time(budget, &budget->usage);
+    }
+
+    pthread_mutex_unlock(&budget->lock);
+
+    return kind != 0;
+}
+
+void configure_budget(struct global_state *state, int pid, struct budget_usage *limits)
+{
+    struct execution_budget *budget = state->budget;
+
+    if (budget == NULL) {
+        budget = calloc(1, sizeof(struct execution_budget));
+        pthread_mutex_init(&budget->lock, NULL);
+
+        pthread_condattr_t attributes;
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&budget->wakeup, &attributes);
+        pthread_condattr_destroy(&attributes);
+
+        state->budget = budget;
+    }
+
+    pthread_mutex_lock(&budget->lock);
+
+    budget->pid = pid;
+    budget->limits = *limits;
+    budget->limits.exhausted = 0;
+    memset(&budget->usage, 0, sizeof(budget->usage));
+    budget->start_time = monotonic_time();
+    budget->start_cpu_time = read_process_cpu_time(pid);
+    budget->exceeded = 0;
+
+    pthread_mutex_unlock(&budget->lock);
+
+    if ((limits->wall_time || limits->cpu_time) && !budget->watchdog_alive) {
+        budget->watchdog_alive = 1;
+
+        if (pthread_create(&budget->watchdog, NULL, run_budget_watchdog, budget)) {
+            perror("pthread_create");
+            budget->watchdog_alive = 0;
+        }
+    }
+}
+
+int get_budget_usage(struct global_state *state, struct budget_usage *usage)
+{
+    struct execution_budget *budget = state->budget;
+
+    if (budget == NULL) return 0;
+
+    pthread_mutex_lock(&budget->lock);
+
+    *usage = budget->usage;
+
+    // The time is still running until the budget is exhausted
+    if (!usage->exhausted) read_budget_time(budget, usage);
+
+    pthread_mutex_unlock(&budget->lock);
+
+    return 1;
+}
+
+void free_budget(struct global_state *state)
+{
+    struct execution_budget *budget = state->budget;
+
+    if (budget == NULL) return;
+
+    if (budget->watchdog_alive) {
+        pthread_mutex_lock(&budget->lock);
+        budget->watchdog_alive = 0;
+        pthread_cond_signal(&budget->wakeup);
+        pthread_mutex_unlock(&budget->lock);
+
+        pthread_join(budget->watchdog, NULL);
+    }
+
+    pthread_mutex_destroy(&budget->lock);
+    pthread_cond_destroy(&budget->wakeup);
+    free(budget);
+
+    state->budget = NULL;
+    state->consume_syscall_stops = 0;
+}
+
+// The virtual clock fast-forwards the time the process would wait: the timeouts of the sleeping syscalls are
+// cleared on their entry, and the time they would have waited is added to an offset of the clocks of the process
+// when they time out. The clocks read by the process are shifted by the same offset on the exit of the syscalls.
+
+// The state of the syscall of a thread, between its entry and its exit
+struct virtual_syscall {
+    int tid;
+    _Bool pending;
+    uint64_t number;
+    uint64_t args[6];
+    // The nanoseconds the syscall would have waited, if it times out
+    uint64_t timeout;
+    // The timeout cleared on the entry, either in an argument register or in memory
+    int cleared_argument;
+    uint64_t cleared_address;
+    int64_t cleared_value[2];
+    _Bool cleared_in_memory;
+    // Whether the syscall writes the remaining time over its timeout
+    _Bool reports_remaining;
+    struct virtual_syscall *next;
+};
+
+struct virtual_clock {
+    _Bool enabled;
+    int64_t offset;
+    uint64_t sleeps;
+    uint64_t clock_reads;
+    struct virtual_syscall *syscalls;
+};
+
+#define NANOSECONDS_PER_SECOND 1000000000ll
+
+int is_virtual_clock_id(uint64_t clock)
+{
+    // The CPU-time clocks are not shifted, the process does not spend any CPU time while waiting
+    switch ((int)clock) {
+    case CLOCK_REALTIME:
+    case CLOCK_MONOTONIC:
+    case CLOCK_MONOTONIC_RAW:
+    case CLOCK_REALTIME_COARSE:
+    case CLOCK_MONOTONIC_COARSE:
+    case CLOCK_BOOTTIME:
+    case CLOCK_TAI:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+int64_t read_virtual_time(struct virtual_clock *clock, int clock_id)
+{
+    struct timespec now;
+
+    clock_gettime(clock_id, &now);
+
+    return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec + clock->offset;
+}
+
+uint64_t *syscall_argument(struct ptrace_regs_struct *regs, int index)
+{
+#ifdef ARCH_AMD64
+    switch (index) {
+    case 0: return &regs->rdi;
+    case 1: return &regs->rsi;
+    case 2: return &regs->rdx;
+    case 3: return &regs->r10;
+    case 4: return &regs->r8;
+    default: return &regs->r9;
+    }
+#endif
+
+#ifdef ARCH_AARCH64
+    switch (index) {
+    case 0: return &regs->x0;
+    case 1: return &regs->x1;
+    case 2: return &regs->x2;
+    case 3: return &regs->x3;
+    case 4: return &regs->x4;
+    default: return &regs->x5;
+    }
+#endif
+}
+
+struct virtual_syscall *get_virtual_syscall(struct virtual_clock *clock, int tid)
+{
+    struct virtual_syscall *syscall = clock->syscalls;
+
+    while (syscall != NULL) {
+        if (syscall->tid == tid) return syscall;
+        syscall = syscall->next;
+    }
+
+    syscall = calloc(1, sizeof(struct virtual_syscall));
+    syscall->tid = tid;
+    syscall->next = clock->syscalls;
+    clock->syscalls = syscall;
+
+    return syscall;
+}
+
+void clear_timeout_argument(struct thread *t, struct virtual_syscall *syscall, int index)
+{
+    // The timeouts in registers are in milliseconds, the negative ones wait forever
+    int timeout = (int)syscall->args[index];
+
+    if (timeout <= 0) return;
+
+    *syscall_argument(&t->regs, index) = 0;
+
+    if (setregs(t->tid, &t->regs)) {
+        *syscall_argument(&t->regs, index) = syscall->args[index];
+        return;
+    }
+
+    syscall->cleared_argument = index;
+    syscall->timeout = timeout * 1000000ull;
+}
+
+void clear_timeout_struct(struct virtual_clock *clock, struct thread *t, struct virtual_syscall *syscall,
+                          uint64_t address, int64_t unit, int absolute_clock)
+{
+    static const int64_t zero[2] = {0, 0};
+    int64_t value[2];
+
+    // A null timeout waits forever
+    if (!address || read_remote_memory(t->tid, address, value, sizeof(value))) return;
+
+    // The invalid timeouts are left to the kernel, to fail as they would
+    if (value[0] < 0 || value[1] < 0 || value[1] >= NANOSECONDS_PER_SECOND / unit) return;
+
+    int64_t timeout = value[0] * NANOSECONDS_PER_SECOND + value[1] * unit;
+
+    // The absolute timeouts are deadlines on the virtual time, zero is always in the past
+    if (absolute_clock >= 0) timeout -= read_virtual_time(clock, absolute_clock);
+
+    if (timeout <= 0 || write_remote_memory(t->tid, address, zero, sizeof(zero))) return;
+
+    syscall->cleared_address = address;
+    syscall->cleared_value[0] = value[0];
+    syscall->cleared_value[1] = value[1];
+    syscall->cleared_in_memory = 1;
+    syscall->timeout = timeout;
+}
+
+void restore_cleared_timeout(struct thread *t, struct virtual_syscall *syscall, _Bool timed_out)
+{
+    int index = syscall->cleared_argument;
+
+    // The registers of the arguments are preserved across the syscall, the process expects them unchanged
+    if (index >= 0) {
+        *syscall_argument(&t->regs, index) = syscall->args[index];
+        setregs(t->tid, &t->regs);
+    }
+
+    // The remaining time of a syscall that timed out is zero, as the kernel wrote it
+    if (syscall->cleared_in_memory && !(timed_out && syscall->reports_remaining))
+        write_remote_memory(t->tid, syscall->cleared_address, syscall->cleared_value, sizeof(syscall->cleared_value));
+
+    syscall->cleared_argument = -1;
+    syscall->cleared_in_memory = 0;
+    syscall->timeout = 0;
+}
+
+void shift_time_struct(struct virtual_clock *clock, int tid, uint64_t address, int64_t unit)
+{
+    int64_t value[2];
+
+    if (!address || read_remote_memory(tid, address, value, sizeof(value))) return;
+
+    int64_t time = value[0] * NANOSECONDS_PER_SECOND + value[1] * unit + clock->offset;
+
+    value[0] = time / NANOSECONDS_PER_SECOND;
+    value[1] = time % NANOSECONDS_PER_SECOND / unit;
+
+    write_remote_memory(tid, address, value, sizeof(value));
+
+    clock->clock_reads++;
+}
+
+void virtual_syscall_entry(struct virtual_clock *clock, struct thread *t, struct __ptrace_syscall_info *info)
+{
+    struct virtual_syscall *syscall = get_virtual_syscall(clock, t->tid);
+    uint64_t *args = syscall->args;
+
+    syscall->pending = 1;
+    syscall->number = info->entry.nr;
+    syscall->timeout = 0;
+    syscall->cleared_argument = -1;
+    syscall->cleared_in_memory = 0;
+    syscall->reports_remaining = 0;
+
+    for (int i = 0; i < 6; i++) args[i] = info->entry.args[i];
+
+    switch (syscall->number) {
+    case SYS_nanosleep:
+        clear_timeout_struct(clock, t, syscall, args[0], 1, -1);
+        break;
+    case SYS_clock_nanosleep:
+        if (is_virtual_clock_id(args[0]))
+            clear_timeout_struct(clock, t, syscall, args[2], 1, args[1] & TIMER_ABSTIME ? (int)args[0] : -1);
+        break;
+#ifdef SYS_poll
+    case SYS_poll:
+        clear_timeout_argument(t, syscall, 2);
+        break;
+#endif
+#ifdef SYS_select
+    case SYS_select:
+        syscall->reports_remaining = 1;
+        clear_timeout_struct(clock, t, syscall, args[4], 1000, -1);
+        break;
+#endif
+#ifdef SYS_epoll_wait
+    case SYS_epoll_wait:
+#endif
+    case SYS_epoll_pwait:
+        clear_timeout_argument(t, syscall, 3);
+        break;
+#ifdef SYS_epoll_pwait2
+    case SYS_epoll_pwait2:
+        clear_timeout_struct(clock, t, syscall, args[3], 1, -1);
+        break;
+#endif
+    case SYS_ppoll:
+        syscall->reports_remaining = 1;
+        clear_timeout_struct(clock, t, syscall, args[2], 1, -1);
+        break;
+    case SYS_pselect6:
+        syscall->reports_remaining = 1;
+        clear_timeout_struct(clock, t, syscall, args[4], 1, -1);
+        break;
+    }
+}
+
+void virtual_syscall_exit(struct virtual_clock *clock, struct thread *t, struct __ptrace_syscall_info *info)
+{
+    struct virtual_syscall *syscall = get_virtual_syscall(clock, t->tid);
+    uint64_t *args = syscall->args;
+    int64_t result = info->exit.rval;
+
+    // The thread might have entered the syscall before the clock was enabled
+    if (!syscall->pending) return;
+
+    syscall->pending = 0;
+
+    if (syscall->timeout) {
+        // Only the syscalls that waited until their timeout advance the clock
+        if (!result) {
+            clock->offset += syscall->timeout;
+            clock->sleeps++;
+        }
+
+        restore_cleared_timeout(t, syscall, !result);
+        return;
+    }
+
+    if (result < 0) return;
+
+    switch (syscall->number) {
+    case SYS_clock_gettime:
+        if (is_virtual_clock_id(args[0])) shift_time_struct(clock, t->tid, args[1], 1);
+        break;
+    case SYS_gettimeofday:
+        shift_time_struct(clock, t->tid, args[0], 1000);
+        break;
+#ifdef SYS_time
+    case SYS_time: {
+        int64_t now = read_virtual_time(clock, CLOCK_REALTIME) / NANOSECONDS_PER_SECOND;
+
+        t->regs.rax = now;
+        setregs(t->tid, &t->regs);
+
+        if (args[0]) write_remote_memory(t->tid, args[0], &now, sizeof(now));
+
+        clock->clock_reads++;
+        break;
+    }
+#endif
+    }
+}
+
+void dispatch_virtual_clock(struct global_state *state, struct thread_status *head)
+{
+    struct virtual_clock *clock = state->virtual_clock;
+    struct __ptrace_syscall_info info;
+    struct thread *t;
+
+    if (clock == NULL || !clock->enabled) return;
+
+    // The stops are only inspected, they are consumed with the others that nobody wants to see
+    for (struct thread_status *ts = head; ts != NULL; ts = ts->next) {
+        if (ts->interrupted || !WIFSTOPPED(ts->status) || WSTOPSIG(ts->status) != (SIGTRAP | 0x80)) continue;
+
+        if ((t = get_thread(state, ts->tid)) == NULL) continue;
+
+        if (ptrace(PTRACE_GET_SYSCALL_INFO, t->tid, (void *)sizeof(info), &info) <= 0) continue;
+
+        if (info.op == PTRACE_SYSCALL_INFO_ENTRY)
+            virtual_syscall_entry(clock, t, &info);
+        else if (info.op == PTRACE_SYSCALL_INFO_EXIT)
+            virtual_syscall_exit(clock, t, &info);
+    }
+}
+
+void drop_syscall_stops(struct thread_status **head)
+{
+    struct thread_status *ts = *head, *prev = NULL, *next;
+
+    while (ts != NULL) {
+        next = ts->next;
+
+        if (!ts->interrupted && WIFSTOPPED(ts->status) && WSTOPSIG(ts->status) == (SIGTRAP | 0x80)) {
+            if (prev == NULL)
+                *head = next;
+            else
+                prev->next = next;
+
+            free(ts);
+        } else {
+            prev = ts;
+        }
+
+        ts = next;
+    }
+}
+
+void configure_virtual_clock(struct global_state *state, _Bool enabled)
+{
+    struct virtual_clock *clock = state->virtual_clock;
+
+    if (clock == NULL) {
+        if (!enabled) return;
+
+        clock = calloc(1, sizeof(struct virtual_clock));
+        state->virtual_clock = clock;
+    }
+
+    clock->enabled = enabled;
+
+    if (enabled) return;
+
+    // The threads stopped on the entry of a sleeping syscall wait for real, their exit will not be seen
+    for (struct virtual_syscall *syscall = clock->syscalls; syscall != NULL; syscall = syscall->next) {
+        struct thread *t = get_thread(state, syscall->tid);
+
+        if (t != NULL && syscall->pending) restore_cleared_timeout(t, syscall, 0);
+
+        syscall->pending = 0;
+    }
+}
+
+void advance_virtual_clock(struct global_state *state, int64_t nanoseconds)
+{
+    if (state->virtual_clock != NULL) state->virtual_clock->offset += nanoseconds;
+}
+
+int get_virtual_clock_stats(struct global_state *state, struct virtual_clock_stats *stats)
+{
+    struct virtual_clock *clock = state->virtual_clock;
+
+    if (clock == NULL) return 0;
+
+    stats->offset = clock->offset;
+    stats->sleeps = clock->sleeps;
+    stats->clock_reads = clock->clock_reads;
+
+    return 1;
+}
+
+void virtual_clock_forget_thread(struct global_state *state, int tid)
+{
+    if (state->virtual_clock == NULL) return;
+
+    struct virtual_syscall *syscall = state->virtual_clock->syscalls;
+    struct virtual_syscall *prev = NULL;
+
+    while (syscall != NULL) {
+        if (syscall->tid == tid) {
+            if (prev == NULL)
+                state->virtual_clock->syscalls = syscall->next;
+            else
+                prev->next = syscall->next;
+
+            free(syscall);
+            return;
+        }
+
+        prev = syscall;
+        syscall = syscall->next;
+    }
+}
+
+void free_virtual_clock(struct global_state *state)
+{
+    if (state->virtual_clock == NULL) return;
+
+    while (state->virtual_clock->syscalls != NULL)
+        virtual_clock_forget_thread(state, state->virtual_clock->syscalls->tid);
+
+    free(state->virtual_clock);
+    state->virtual_clock = NULL;
+}
+
+struct syscall_profiler_entry {
+    uint64_t hash;
+    struct profiled_syscall syscall;
+};
+
+// The syscall each thread is executing, from its entry stop to its exit stop
+struct syscall_profiler_thread {
+    int tid;
+    _Bool pending;
+    uint64_t number;
+    uint64_t call_site;
+    uint64_t entered;
+    struct syscall_profiler_thread *next;
+};
+
+struct syscall_profiler {
+    _Bool enabled;
+    _Bool call_sites;
+    struct syscall_profiler_entry *entries;
+    uint64_t entry_capacity;
+    struct syscall_profiler_thread *threads;
+    struct syscall_profiler_stats stats;
+};
+
+uint64_t hash_profiled_syscall(int tid, uint64_t number, uint64_t call_site)
+{
+    uint64_t hash = 0xcbf29ce484222325 ^ (uint64_t)tid;
+
+    hash = (hash ^ number) * 0x100000001b3;
+    hash = (hash ^ call_site) * 0x100000001b3;
+
+    return hash ? hash : 1;
+}
+
+struct syscall_profiler_entry *find_syscall_profiler_entry(struct syscall_profiler *profiler, uint64_t hash, int tid,
+                                                           uint64_t number, uint64_t call_site)
+{
+    uint64_t mask = profiler->entry_capacity - 1;
+    uint64_t index = hash & mask;
+
+    while (profiler->entries[index].hash) {
+        struct syscall_profiler_entry *entry = &profiler->entries[index];
+
+        if (entry->hash == hash && entry->syscall.tid == tid && entry->syscall.number == number &&
+            entry->syscall.call_site == call_site)
+            return entry;
+
+        index = (index + 1) & mask;
+    }
+
+    return &profiler->entries[index];
+}
+
+void resize_syscall_profiler_entries(struct syscall_profiler *profiler)
+{
+    struct syscall_profiler_entry *old_entries = profiler->entries;
+    uint64_t old_capacity = profiler->entry_capacity;
+
+    profiler->entry_capacity = old_capacity ? old_capacity * 2 : 256;
+    profiler->entries = calloc(profiler->entry_capacity, sizeof(struct syscall_profiler_entry));
+
+    for (uint64_t i = 0; i < old_capacity; i++) {
+        if (!old_entries[i].hash) continue;
+
+        uint64_t index = old_entries[i].hash & (profiler->entry_capacity - 1);
+
+        while (profiler->entries[index].hash)
+            index = (index + 1) & (profiler->entry_capacity - 1);
+
+        profiler->entries[index] = old_entries[i];
+    }
+
+    free(old_entries);
+}
+
+void record_profiled_syscall(struct syscall_profiler *profiler, struct syscall_profiler_thread *thread,
+                             uint64_t latency, _Bool failed)
+{
+    uint64_t call_site = profiler->call_sites ? thread->call_site : 0;
+    uint64_t hash = hash_profiled_syscall(thread->tid, thread->number, call_site);
+    struct syscall_profiler_entry *entry;
+
+    if ((profiler->stats.entries + 1) * 4 > profiler->entry_capacity * 3) resize_syscall_profiler_entries(profiler);
+
+    entry = find_syscall_profiler_entry(profiler, hash, thread->tid, thread->number, call_site);
+
+    if (!entry->hash) {
+        entry->hash = hash;
+        entry->syscall.tid = thread->tid;
+        entry->syscall.number = thread->number;
+        entry->syscall.call_site = call_site;
+        entry->syscall.min_time = latency;
+
+        profiler->stats.entries++;
+    }
+
+    struct profiled_syscall *syscall = &entry->syscall;
+
+    syscall->count++;
+    syscall->errors += failed;
+    syscall->total_time += latency;
+
+    if (latency < syscall->min_time) syscall->min_time = latency;
+    if (latency > syscall->max_time) syscall->max_time = latency;
+
+    // The bucket i counts the latencies in [2^i, 2^(i + 1)) nanoseconds
+    int bucket = latency ? 63 - __builtin_clzll(latency) : 0;
+
+    syscall->histogram[bucket < SYSCALL_HISTOGRAM_BUCKETS ? bucket : SYSCALL_HISTOGRAM_BUCKETS - 1]++;
+
+    profiler->stats.syscalls++;
+}
+
+struct syscall_profiler_thread *get_syscall_profiler_thread(struct syscall_profiler *profiler, int tid)
+{
+    struct syscall_profiler_thread *thread = profiler->threads;
+
+    while (thread != NULL && thread->tid != tid)
+        thread = thread->next;
+
+    if (thread == NULL) {
+        thread = calloc(1, sizeof(struct syscall_profiler_thread));
+        thread->tid = tid;
+        thread->next = profiler->threads;
+        profiler->threads = thread;
+    }
+
+    return thread;
+}
+
+void dispatch_syscall_profiler(struct global_state *state, struct thread_status *head)
+{
+    struct syscall_profiler *profiler = state->syscall_profiler;
+    struct syscall_profiler_thread *thread;
+    struct __ptrace_syscall_info info;
+
+    if (profiler == NULL || !profiler->enabled) return;
+
+    // The stops of a batch are timestamped together, when they are dispatched
+    uint64_t now = monotonic_time();
+
+    for (struct thread_status *ts = head; ts != NULL; ts = ts->next) {
+        if (ts->interrupted || !WIFSTOPPED(ts->status) || WSTOPSIG(ts->status) != (SIGTRAP | 0x80)) continue;
+
+        if (ptrace(PTRACE_GET_SYSCALL_INFO, ts->tid, (void *)sizeof(info), &info) <= 0) continue;
+
+        thread = get_syscall_profiler_thread(profiler, ts->tid);
+
+        if (info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+            thread->pending = 1;
+            thread->number = info.entry.nr;
+            thread->call_site = info.instruction_pointer;
+            thread->entered = now;
+        } else if (info.op == PTRACE_SYSCALL_INFO_EXIT && thread->pending) {
+            thread->pending = 0;
+            record_profiled_syscall(profiler, thread, now - thread->entered, info.exit.is_error);
+        }
+    }
+}
+
+void configure_syscall_profiler(struct global_state *state, _Bool enabled, _Bool call_sites)
+{
+    struct syscall_profiler *profiler = state->syscall_profiler;
+
+    if (profiler == NULL) {
+        if (!enabled) return;
+
+        profiler = calloc(1, sizeof(struct syscall_profiler));
+        resize_syscall_profiler_entries(profiler);
+        state->syscall_profiler = profiler;
+    }
+
+    profiler->enabled = enabled;
+    profiler->call_sites = call_sites;
+
+    // The syscalls entered while the profiler was disabled are not measured
+    if (!enabled)
+        for (struct syscall_profiler_thread *thread = profiler->threads; thread != NULL; thread = thread->next)
+            thread->pending = 0;
+}
+
+int get_syscall_profiler_stats(struct global_state *state, struct syscall_profiler_stats *stats)
+{
+    if (state->syscall_profiler == NULL) return 0;
+
+    *stats = state->syscall_profiler->stats;
+
+    return 1;
+}
+
+uint64_t get_profiled_syscalls(struct global_state *state, struct profiled_syscall *buffer, uint64_t max_count)
+{
+    struct syscall_profiler *profiler = state->syscall_profiler;
+    uint64_t count = 0;
+
+    if (profiler == NULL) return 0;
+
+    for (uint64_t i = 0; i < profiler->entry_capacity && count < max_count; i++)
+        if (profiler->entries[i].hash) buffer[count++] = profiler->entries[i].syscall;
+
+    return count;
+}
+
+void reset_syscall_profiler(struct global_state *state)
+{
+    struct syscall_profiler *profiler = state->syscall_profiler;
+
+    if (profiler == NULL) return;
+
+    memset(profiler->entries, 0, profiler->entry_capacity * sizeof(struct syscall_profiler_entry));
+    memset(&profiler->stats, 0, sizeof(profiler->stats));
+}
+
+void syscall_profiler_forget_thread(struct global_state *state, int tid)
+{
+    struct syscall_profiler_thread **cursor;
+
+    if (state->syscall_profiler == NULL) return;
+
+    for (cursor = &state->syscall_profiler->threads; *cursor != NULL; cursor = &(*cursor)->next) {
+        if ((*cursor)->tid == tid) {
+            struct syscall_profiler_thread *thread = *cursor;
+
+            *cursor = thread->next;
+            free(thread);
+            return;
+        }
+    }
+}
+
+void free_syscall_profiler(struct global_state *state)
+{
+    if (state->syscall_profiler == NULL) return;
+
+    while (state->syscall_profiler->threads != NULL)
+        syscall_profiler_forget_thread(state, state->syscall_profiler->threads->tid);
+
+    free(state->syscall_profiler->entries);
+    free(state->syscall_profiler);
+    state->syscall_profiler = NULL;
+}
+
+#ifndef CLOSE_RANGE_CLOEXEC
+#define CLOSE_RANGE_CLOEXEC (1U << 2)
+#endif
+
+// The control data of a received message inspected for the descriptors passed with it
+#define FD_TABLE_CONTROL_SIZE 4096
+
+// The syscall each thread is executing, from its entry stop to its exit stop
+struct fd_table_thread {
+    int tid;
+    _Bool pending;
+    uint64_t number;
+    uint64_t args[6];
+    struct fd_table_thread *next;
+};
+
+// The file descriptors of the process, indexed by number, with the target of their link in /proc.
+// The table is seeded from /proc once, and then kept up to date from the results of the syscalls
+// that create and close descriptors.
+struct fd_table {
+    _Bool enabled;
+    int pid;
+    char **paths;
+    uint32_t capacity;
+    struct fd_table_thread *threads;
+};
+
+void set_fd_path(struct fd_table *table, uint64_t fd, char *path)
+{
+    if (fd >= table->capacity) {
+        if (path == NULL || fd >= INT32_MAX) return;
+
+        uint32_t capacity = table->capacity ? table->capacity : 64;
+
+        while (fd >= capacity) capacity *= 2;
+
+        table->paths = realloc(table->paths, capacity * sizeof(char *));
+        memset(table->paths + table->capacity, 0, (capacity - table->capacity) * sizeof(char *));
+        table->capacity = capacity;
+    }
+
+    free(table->paths[fd]);
+    table->paths[fd] = path;
+}
+
+void resolve_fd_path(struct fd_table *table, uint64_t fd)
+{
+    char link[64], target[PATH_MAX];
+
+    snprintf(link, sizeof(link), "/proc/%d/fd/%lu", table->pid, fd);
+
+    ssize_t length = readlink(link, target, sizeof(target) - 1);
+
+    if (length < 0) {
+        set_fd_path(table, fd, NULL);
+        return;
+    }
+
+    target[length] = 0;
+    set_fd_path(table, fd, strdup(target));
+}
+
+void seed_fd_table(struct fd_table *table)
+{
+    struct dirent *entry;
+    DIR *directory;
+    char path[64];
+
+    for (uint32_t fd = 0; fd < table->capacity; fd++) set_fd_path(table, fd, NULL);
+
+    snprintf(path, sizeof(path), "/proc/%d/fd", table->pid);
+
+    if ((directory = opendir(path)) == NULL) return;
+
+    while ((entry = readdir(directory)) != NULL)
+        if (entry->d_name[0] != '.') resolve_fd_path(table, strtoull(entry->d_name, NULL, 10));
+
+    closedir(directory);
+}
+
+void resolve_received_fds(struct fd_table *table, int tid, uint64_t address)
+{
+    // The descriptors passed over a UNIX socket are in the control data of the message
+    uint8_t control[FD_TABLE_CONTROL_SIZE];
+    struct msghdr message;
+    struct cmsghdr *header;
+
+    if (read_remote_memory(tid, address, &message, sizeof(message)) || !message.msg_controllen) return;
+
+    if (message.msg_controllen > sizeof(control)) message.msg_controllen = sizeof(control);
+
+    if (read_remote_memory(tid, (uint64_t)message.msg_control, control, message.msg_controllen)) return;
+
+    message.msg_control = control;
+
+    for (header = CMSG_FIRSTHDR(&message); header != NULL; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) continue;
+
+        int *fds = (int *)CMSG_DATA(header);
+        size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+        for (size_t i = 0; i < count; i++) resolve_fd_path(table, fds[i]);
+    }
+}
+
+void resolve_fd_pair(struct fd_table *table, int tid, uint64_t address)
+{
+    int fds[2];
+
+    if (read_remote_memory(tid, address, fds, sizeof(fds))) return;
+
+    resolve_fd_path(table, fds[0]);
+    resolve_fd_path(table, fds[1]);
+}
+
+void apply_fd_syscall(struct fd_table *table, struct fd_table_thread *thread, int64_t result, _Bool failed)
+{
+    uint64_t *args = thread->args;
+
+    switch (thread->number) {
+    // The syscalls that return a new descriptor
+#ifdef SYS_open
+    case SYS_open:
+#endif
+#ifdef SYS_creat
+    case SYS_creat:
+#endif
+#ifdef SYS_dup2
+    case SYS_dup2:
+#endif
+#ifdef SYS_epoll_create
+    case SYS_epoll_create:
+#endif
+#ifdef SYS_eventfd
+    case SYS_eventfd:
+#endif
+#ifdef SYS_signalfd
+    case SYS_signalfd:
+#endif
+#ifdef SYS_inotify_init
+    case SYS_inotify_init:
+#endif
+    case SYS_openat:
+    case SYS_openat2:
+    case SYS_open_by_handle_at:
+    case SYS_socket:
+    case SYS_accept:
+    case SYS_accept4:
+    case SYS_dup:
+    case SYS_dup3:
+    case SYS_epoll_create1:
+    case SYS_eventfd2:
+    case SYS_signalfd4:
+    case SYS_timerfd_create:
+    case SYS_inotify_init1:
+    case SYS_fanotify_init:
+    case SYS_memfd_create:
+    case SYS_userfaultfd:
+    case SYS_perf_event_open:
+    case SYS_pidfd_open:
+    case SYS_pidfd_getfd:
+    case SYS_io_uring_setup:
+        if (!failed) resolve_fd_path(table, result);
+        break;
+    case SYS_fcntl:
+        if (!failed && (args[1] == F_DUPFD || args[1] == F_DUPFD_CLOEXEC)) resolve_fd_path(table, result);
+        break;
+#ifdef SYS_pipe
+    case SYS_pipe:
+#endif
+    case SYS_pipe2:
+        if (!failed) resolve_fd_pair(table, thread->tid, args[0]);
+        break;
+    case SYS_socketpair:
+        if (!failed) resolve_fd_pair(table, thread->tid, args[3]);
+        break;
+    case SYS_recvmsg:
+        if (!failed) resolve_received_fds(table, thread->tid, args[1]);
+        break;
+    case SYS_close:
+        // The descriptor is released even if the close fails, unless it was not open
+        if (result != -EBADF) set_fd_path(table, args[0], NULL);
+        break;
+    case SYS_close_range:
+        if (failed || args[2] & CLOSE_RANGE_CLOEXEC) break;
+
+        for (uint64_t fd = args[0]; fd <= args[1] && fd < table->capacity; fd++) set_fd_path(table, fd, NULL);
+        break;
+    case SYS_execve:
+    case SYS_execveat:
+        // The descriptors marked close-on-exec are gone
+        if (!failed) seed_fd_table(table);
+        break;
+    }
+}
+
+struct fd_table_thread *get_fd_table_thread(struct fd_table *table, int tid)
+{
+    struct fd_table_thread *thread = table->threads;
+
+    while (thread != NULL && thread->tid != tid)
+        thread = thread->next;
+
+    if (thread == NULL) {
+        thread = calloc(1, sizeof(struct fd_table_thread));
+        thread->tid = tid;
+        thread->next = table->threads;
+        table->threads = thread;
+    }
+
+    return thread;
+}
+
+void dispatch_fd_table(struct global_state *state, struct thread_status *head)
+{
+    struct fd_table *table = state->fd_table;
+    struct fd_table_thread *thread;
+    struct __ptrace_syscall_info info;
+
+    if (table == NULL || !table->enabled) return;
+
+    for (struct thread_status *ts = head; ts != NULL; ts = ts->next) {
+        if (ts->interrupted || !WIFSTOPPED(ts->status) || WSTOPSIG(ts->status) != (SIGTRAP | 0x80)) continue;
+
+        if (ptrace(PTRACE_GET_SYSCALL_INFO, ts->tid, (void *)sizeof(info), &info) <= 0) continue;
+
+        thread = get_fd_table_thread(table, ts->tid);
+
+        if (info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+            thread->pending = 1;
+            thread->number = info.entry.nr;
+            memcpy(thread->args, info.entry.args, sizeof(thread->args));
+        } else if (info.op == PTRACE_SYSCALL_INFO_EXIT && thread->pending) {
+            thread->pending = 0;
+            apply_fd_syscall(table, thread, info.exit.rval, info.exit.is_error);
+        }
+    }
+}
+
+void configure_fd_table(struct global_state *state, int pid, _Bool enabled)
+{
+    struct fd_table *table = state->fd_table;
+
+    if (table == NULL) {
+        if (!enabled) return;
+
+        table = calloc(1, sizeof(struct fd_table));
+        state->fd_table = table;
+    }
+
+    // The changes missed while the table was disabled are read from /proc again
+    if (enabled && (!table->enabled || table->pid != pid)) {
+        table->pid = pid;
+        seed_fd_table(table);
+    }
+
+    table->enabled = enabled;
+
+    if (!enabled)
+        for (struct fd_table_thread *thread = table->threads; thread != NULL; thread = thread->next)
+            thread->pending = 0;
+}
+
+void refresh_fd_table(struct global_state *state)
+{
+    if (state->fd_table != NULL && state->fd_table->enabled) seed_fd_table(state->fd_table);
+}
+
+int get_fd_path(struct global_state *state, int fd, char *buffer, uint32_t size)
+{
+    // Returns the length of the target of the descriptor, -1 if it is not open
+    struct fd_table *table = state->fd_table;
+
+    if (table == NULL || fd < 0 || (uint32_t)fd >= table->capacity || table->paths[fd] == NULL) return -1;
+
+    snprintf(buffer, size, "%s", table->paths[fd]);
+
+    return strlen(table->paths[fd]);
+}
+
+uint32_t get_open_fds(struct global_state *state, int *buffer, uint32_t max_count)
+{
+    struct fd_table *table = state->fd_table;
+    uint32_t count = 0;
+
+    if (table == NULL) return 0;
+
+    for (uint32_t fd = 0; fd < table->capacity && count < max_count; fd++)
+        if (table->paths[fd] != NULL) buffer[count++] = fd;
+
+    return count;
+}
+
+void fd_table_forget_thread(struct global_state *state, int tid)
+{
+    struct fd_table_thread **cursor;
+
+    if (state->fd_table == NULL) return;
+
+    for (cursor = &state->fd_table->threads; *cursor != NULL; cursor = &(*cursor)->next) {
+        if ((*cursor)->tid == tid) {
+            struct fd_table_thread *thread = *cursor;
+
+            *cursor = thread->next;
+            free(thread);
+            return;
+        }
+    }
+}
+
+void free_fd_table(struct global_state *state)
+{
+    struct fd_table *table = state->fd_table;
+
+    if (table == NULL) return;
+
+    while (table->threads != NULL)
+        fd_table_forget_thread(state, table->threads->tid);
+
+    for (uint32_t fd = 0; fd < table->capacity; fd++) free(table->paths[fd]);
+
+    free(table->paths);
+    free(table);
+    state->fd_table = NULL;
+}
+
+#ifdef ARCH_AMD64
+// syscall
+#define INSTALL_SYSCALL(instruction) ((instruction & 0xFFFFFFFFFFFF0000) | 0x050F)
+#define SYSCALL_SIZE 2
+#endif
+
+#ifdef ARCH_AARCH64
+// svc #0
+#define INSTALL_SYSCALL(instruction) ((instruction & 0xFFFFFFFF00000000) | 0xD4000001)
+#define SYSCALL_SIZE 4
+#endif
+
+void prepare_syscall_registers(struct ptrace_regs_struct *regs, uint64_t address, uint64_t number, uint64_t *args)
+{
+#ifdef ARCH_AMD64
+    regs->rip = address;
+    regs->rax = number;
+    // The syscall the thread could be stopped in must not be restarted over the injected one
+    regs->orig_rax = -1;
+    regs->rdi = args[0];
+    regs->rsi = args[1];
+    regs->rdx = args[2];
+    regs->r10 = args[3];
+    regs->r8 = args[4];
+    regs->r9 = args[5];
+#endif
+
+#ifdef ARCH_AARCH64
+    regs->pc = address;
+    regs->x8 = number;
+    regs->x0 = args[0];
+    regs->x1 = args[1];
+    regs->x2 = args[2];
+    regs->x3 = args[3];
+    regs->x4 = args[4];
+    regs->x5 = args[5];
+    regs->override_syscall_number = 0;
+#endif
+}
+
+void set_thread_hw_breakpoints(struct global_state *state, int tid, _Bool installed)
+{
+    struct hardware_breakpoint *bp = state->hw_b_HEAD;
+
+    while (bp != NULL) {
+        if (bp->tid == tid && bp->enabled) {
+            if (installed)
+                install_hardware_breakpoint(bp);
+            else
+                remove_hardware_breakpoint(bp);
+        }
+        bp = bp->next;
+    }
+}
+
+int inject_syscall(struct global_state *state, int tid, uint64_t gadget, uint64_t number, uint64_t *args,
+                   uint64_t *result)
+{
+    // The syscall is executed by a single step over a syscall instruction, either an existing one (the gadget),
+    // or one patched over the instruction at the current program counter
+    struct thread *t = get_thread(state, tid);
+
+    if (t == NULL) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    struct ptrace_regs_struct regs = t->regs;
+    uint64_t address = gadget ? gadget : INSTRUCTION_POINTER(t->regs);
+    uint64_t instruction = 0;
+    int status, ret = -1, saved_errno = 0;
+
+    if (!gadget) {
+        errno = 0;
+        instruction = ptrace(PTRACE_PEEKDATA, tid, (void *)address, NULL);
+        if (errno) return -1;
+
+        if (ptrace(PTRACE_POKEDATA, tid, (void *)address, INSTALL_SYSCALL(instruction))) return -1;
+    }
+
+    prepare_syscall_registers(&regs, address, number, args);
+
+    set_thread_hw_breakpoints(state, tid, 0);
+
+    if (setregs(tid, &regs)) goto restore;
+
+    while (1) {
+        if (ptrace(PTRACE_SINGLESTEP, tid, NULL, NULL)) goto restore;
+
+        if (waitpid(tid, &status, __WALL) == -1) goto restore;
+
+        if (!WIFSTOPPED(status)) {
+            // The syscall terminated the thread, there is nothing left to restore
+            errno = ESRCH;
+            return -1;
+        }
+
+        if (getregs(tid, &regs)) goto restore;
+
+        if (INSTRUCTION_POINTER(regs) == address + SYSCALL_SIZE) break;
+
+        // A signal stopped the thread before the syscall, it is forwarded on the next resume
+        if (WSTOPSIG(status) != SIGTRAP && WSTOPSIG(status) != SIGSTOP && !t->signal_to_forward)
+            t->signal_to_forward = WSTOPSIG(status);
+    }
+
+#ifdef ARCH_AMD64
+    *result = regs.rax;
+#endif
+
+#ifdef ARCH_AARCH64
+    *result = regs.x0;
+#endif
+
+    ret = 0;
+
+restore:
+    saved_errno = errno;
+
+    if (!gadget) ptrace(PTRACE_POKEDATA, tid, (void *)address, instruction);
+
+    setregs(tid, &t->regs);
+
+    set_thread_hw_breakpoints(state, tid, 1);
+
+    errno = saved_errno;
+
+    return ret;
+}
+
+#ifdef ARCH_AMD64
+// The arguments passed in registers by the System V ABI
+#define CALL_REGISTER_ARGS 6
+// The int3 of the return trap leaves the instruction pointer after it
+#define RETURN_TRAP_SIZE 1
+#endif
+
+#ifdef ARCH_AARCH64
+// The arguments passed in registers by the AAPCS64
+#define CALL_REGISTER_ARGS 8
+// The brk of the return trap leaves the program counter on it
+#define RETURN_TRAP_SIZE 0
+#endif
+
+int prepare_call_frame(int tid, struct ptrace_regs_struct *regs, uint64_t function, uint64_t trap, uint64_t *args,
+                       int count)
+{
+    int stack_args = count > CALL_REGISTER_ARGS ? count - CALL_REGISTER_ARGS : 0;
+
+    // The frame is built below the red zone, and the stack arguments start on a 16-byte boundary
+    uint64_t sp = (STACK_POINTER((*regs)) - 128 - stack_args * sizeof(uint64_t)) & ~0xFULL;
+
+    for (int i = 0; i < stack_args; i++)
+        if (ptrace(PTRACE_POKEDATA, tid, (void *)(sp + i * sizeof(uint64_t)), args[CALL_REGISTER_ARGS + i])) return -1;
+
+#ifdef ARCH_AMD64
+    uint64_t *registers[CALL_REGISTER_ARGS] = {&regs->rdi, &regs->rsi, &regs->rdx, &regs->rcx, &regs->r8, &regs->r9};
+
+    // The return address is pushed by the call
+    sp -= sizeof(uint64_t);
+    if (ptrace(PTRACE_POKEDATA, tid, (void *)sp, trap)) return -1;
+
+    regs->rip = function;
+    regs->rsp = sp;
+    // No vector registers are used by a variadic function
+    regs->rax = 0;
+    // The syscall the thread could be stopped in must not be restarted over the call
+    regs->orig_rax = -1;
+#endif
+
+#ifdef ARCH_AARCH64
+    uint64_t *registers[CALL_REGISTER_ARGS] = {&regs->x0, &regs->x1, &regs->x2, &regs->x3,
+                                               &regs->x4, &regs->x5, &regs->x6, &regs->x7};
+
+    regs->pc = function;
+    regs->sp = sp;
+    regs->x30 = trap;
+    regs->override_syscall_number = 0;
+#endif
+
+    for (int i = 0; i < CALL_REGISTER_ARGS; i++)
+        *registers[i] = i < count ? args[i] : 0;
+
+    return 0;
+}
+
+// Whether a syscall can change the files mapped in the process, e.g., when the function loads a library
+int is_mapping_syscall(uint64_t number)
+{
+    switch (number) {
+#ifdef SYS_mmap
+    case SYS_mmap:
+#endif
+#ifdef SYS_mmap2
+    case SYS_mmap2:
+#endif
+    case SYS_munmap:
+    case SYS_mremap:
+    case SYS_execve:
+    case SYS_execveat:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+int call_function(struct global_state *state, int tid, uint64_t function, uint64_t trap, uint64_t *args, int count,
+                  uint64_t *result, _Bool *mapped)
+{
+    // The thread runs alone from the function until it returns into the trap, while the others stay stopped
+    // Returns 0 on success, -1 on errors, or the number of the signal that interrupted the function,
+    // in which case the result is the address it was interrupted at.
+    // The syscalls of the function are watched until one of them changes the memory maps, which sets mapped
+    struct thread *t = get_thread(state, tid);
+
+    if (t == NULL) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    struct ptrace_regs_struct regs = t->regs;
+    struct fp_regs_struct fpregs;
+    struct __ptrace_syscall_info info;
+    int status, ret = -1, saved_errno = 0;
+    int request = PTRACE_SYSCALL;
+
+    *mapped = 0;
+
+    // The function can freely use the vector registers, whose state is saved as the caller would do
+    if (t->fpregs.dirty) set_fp_regs(tid, &t->fpregs);
+    get_fp_regs(tid, &fpregs);
+
+    if (prepare_call_frame(tid, &regs, function, trap, args, count)) return -1;
+
+    set_thread_hw_breakpoints(state, tid, 0);
+
+    if (setregs(tid, &regs)) goto restore;
+
+    while (1) {
+        if (ptrace(request, tid, NULL, NULL)) goto restore;
+
+        if (waitpid(tid, &status, __WALL) == -1) goto restore;
+
+        if (!WIFSTOPPED(status)) {
+            // The function terminated the thread, there is nothing left to restore
+            errno = ESRCH;
+            return -1;
+        }
+
+        // The ptrace events, e.g., of the threads created by the function, do not interrupt it
+        if (status >> 16) continue;
+
+        int signum = WSTOPSIG(status);
+
+        if (signum == (SIGTRAP | 0x80)) {
+            // Once the maps are known to be stale, the remaining syscalls are not stopped at
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, tid, (void *)sizeof(info), &info) > 0 &&
+                info.op == PTRACE_SYSCALL_INFO_ENTRY && is_mapping_syscall(info.entry.nr)) {
+                *mapped = 1;
+                request = PTRACE_CONT;
+            }
+
+            continue;
+        }
+
+        if (signum == SIGSTOP) continue;
+
+        if (signum == SIGTRAP || signum == SIGSEGV || signum == SIGBUS || signum == SIGILL || signum == SIGFPE ||
+            signum == SIGABRT || signum == SIGSYS) {
+            if (getregs(tid, &regs)) goto restore;
+
+            if (signum == SIGTRAP && INSTRUCTION_POINTER(regs) == trap + RETURN_TRAP_SIZE) break;
+
+            // The function crashed, its signal is not delivered to the process
+            *result = INSTRUCTION_POINTER(regs);
+            ret = signum;
+            goto restore;
+        }
+
+        // An asynchronous signal is forwarded on the next resume
+        if (!t->signal_to_forward) t->signal_to_forward = signum;
+    }
+
+#ifdef ARCH_AMD64
+    *result = regs.rax;
+#endif
+
+#ifdef ARCH_AARCH64
+    *result = regs.x0;
+#endif
+
+    ret = 0;
+
+restore:
+    saved_errno = errno;
+
+    setregs(tid, &t->regs);
+    set_fp_regs(tid, &fpregs);
+
+    set_thread_hw_breakpoints(state, tid, 1);
+
+    errno = saved_errno;
+
+    return ret;
+}
+
+// The lockstep runs two processes side by side, and compares their registers and memory after each step.
+// Each process is driven by a worker running in the thread that traces it, as ptrace requires:
+// the workers step their thread, take a snapshot, and wait for each other on a barrier, so that the first
+// one can compare the snapshots and decide whether both go on.
+#define LOCKSTEP_BLOCK 0
+#define LOCKSTEP_INSTRUCTION 1
+#define LOCKSTEP_SYSCALL 2
+#define LOCKSTEP_BREAKPOINT 3
+
+// The outcomes of a lockstep, and the reasons a process cannot take further steps
+#define LOCKSTEP_MAX_STEPS 0
+#define LOCKSTEP_DIVERGED 1
+#define LOCKSTEP_EXITED 2
+#define LOCKSTEP_EVENT 3
+#define LOCKSTEP_ERROR 4
+
+struct lockstep_side {
+    uint64_t *addresses;
+    uint8_t *memory;
+    struct ptrace_regs_struct regs;
+    int stopped;
+    int error;
+};
+
+struct lockstep {
+    int mode;
+    uint64_t max_steps;
+    uint32_t *offsets;
+    uint32_t register_count;
+    uint64_t *sizes;
+    uint32_t range_count;
+    uint64_t memory_size;
+    pthread_barrier_t barrier;
+    struct lockstep_side sides[2];
+    uint64_t steps;
+    int result;
+    _Bool done;
+};
+
+struct lockstep *create_lockstep(int mode, uint64_t max_steps, uint32_t *offsets, uint32_t register_count,
+                                 uint64_t *first_addresses, uint64_t *second_addresses, uint64_t *sizes,
+                                 uint32_t range_count)
+{
+    struct lockstep *lockstep = calloc(1, sizeof(struct lockstep));
+
+    lockstep->mode = mode;
+    lockstep->max_steps = max_steps;
+    lockstep->register_count = register_count;
+    lockstep->range_count = range_count;
+
+    lockstep->offsets = malloc(register_count * sizeof(uint32_t) + 1);
+    memcpy(lockstep->offsets, offsets, register_count * sizeof(uint32_t));
+
+    lockstep->sizes = malloc(range_count * sizeof(uint64_t) + 1);
+    memcpy(lockstep->sizes, sizes, range_count * sizeof(uint64_t));
+
+    for (uint32_t i = 0; i < range_count; i++) lockstep->memory_size += sizes[i];
+
+    for (int side = 0; side < 2; side++) {
+        lockstep->sides[side].addresses = malloc(range_count * sizeof(uint64_t) + 1);
+        memcpy(lockstep->sides[side].addresses, side ? second_addresses : first_addresses,
+               range_count * sizeof(uint64_t));
+
+        lockstep->sides[side].memory = calloc(1, lockstep->memory_size + 1);
+    }
+
+    pthread_barrier_init(&lockstep->barrier, NULL, 2);
+
+    return lockstep;
+}
+
+void take_lockstep_snapshot(struct lockstep *lockstep, struct lockstep_side *side, struct thread *t)
+{
+    uint8_t *memory = side->memory;
+
+    side->regs = t->regs;
+
+    for (uint32_t i = 0; i < lockstep->range_count; i++) {
+        // The unreadable ranges compare as zeroes
+        if (read_remote_memory(t->tid, side->addresses[i], memory, lockstep->sizes[i]))
+            memset(memory, 0, lockstep->sizes[i]);
+
+        memory += lockstep->sizes[i];
+    }
+}
+
+void judge_lockstep(struct lockstep *lockstep)
+{
+    struct lockstep_side *first = &lockstep->sides[0], *second = &lockstep->sides[1];
+
+    if (first->stopped == LOCKSTEP_ERROR || second->stopped == LOCKSTEP_ERROR) {
+        lockstep->result = LOCKSTEP_ERROR;
+        lockstep->done = 1;
+        return;
+    }
+
+    for (uint32_t i = 0; i < lockstep->register_count; i++) {
+        uint64_t a, b;
+
+        memcpy(&a, (uint8_t *)&first->regs + lockstep->offsets[i], sizeof(a));
+        memcpy(&b, (uint8_t *)&second->regs + lockstep->offsets[i], sizeof(b));
+
+        if (a != b) {
+            lockstep->result = LOCKSTEP_DIVERGED;
+            lockstep->done = 1;
+            return;
+        }
+    }
+
+    // A process that stops being able to step while the other can is a divergence as well
+    if (memcmp(first->memory, second->memory, lockstep->memory_size) || first->stopped != second->stopped) {
+        lockstep->result = LOCKSTEP_DIVERGED;
+        lockstep->done = 1;
+        return;
+    }
+
+    if (first->stopped) {
+        lockstep->result = first->stopped;
+        lockstep->done = 1;
+        return;
+    }
+
+    if (lockstep->steps >= lockstep->max_steps) {
+        lockstep->result = LOCKSTEP_MAX_STEPS;
+        lockstep->done = 1;
+        return;
+    }
+
+    lockstep->steps++;
+}
+
+int wait_lockstep_stop(struct thread *t, int expected_signal)
+{
+    // Waits for the thread to stop after a resume, returning why it cannot take further steps, 0 if it can
+    int status;
+
+    if (waitpid(t->tid, &status, __WALL) == -1) return LOCKSTEP_ERROR;
+
+    // The exit is reported by PTRACE_EVENT_EXIT first, unless the process was killed
+    if (!WIFSTOPPED(status)) return LOCKSTEP_EXITED;
+
+    if (status >> 16 == PTRACE_EVENT_EXIT) return LOCKSTEP_EXITED;
+
+    // The other events, e.g., a new thread or an exec, change what is compared
+    if (status >> 16) return LOCKSTEP_EVENT;
+
+    int signum = WSTOPSIG(status);
+
+    // The signals of the process are delivered on the next resume, as the one that stopped it
+    if (signum != expected_signal && signum != SIGTRAP && signum != SIGSTOP && !t->signal_to_forward)
+        t->signal_to_forward = signum;
+
+    return getregs(t->tid, &t->regs) ? LOCKSTEP_ERROR : 0;
+}
+
+int resume_lockstep_thread(struct thread *t, int request)
+{
+    int signal_to_forward = t->signal_to_forward;
+
+    t->signal_to_forward = 0;
+
+    return ptrace(request, t->tid, NULL, signal_to_forward) ? LOCKSTEP_ERROR : 0;
+}
+
+int run_to_lockstep_breakpoint(struct global_state *state, struct thread *t)
+{
+    struct software_breakpoint *b;
+    int stopped;
+
+    // A thread stopped on a breakpoint steps over it first
+    for (b = state->sw_b_HEAD; b != NULL; b = b->next) {
+        if (b->addr == INSTRUCTION_POINTER(t->regs) && b->enabled && sw_breakpoint_selects_thread(b, t->tid)) {
+            if ((stopped = resume_lockstep_thread(t, PTRACE_SINGLESTEP)) || (stopped = wait_lockstep_stop(t, 0)))
+                return stopped;
+
+            break;
+        }
+    }
+
+    for (b = state->sw_b_HEAD; b != NULL; b = b->next)
+        if (b->enabled && sw_breakpoint_selects_thread(b, t->tid))
+            ptrace(PTRACE_POKEDATA, t->tid, (void *)b->addr, b->patched_instruction);
+
+    if (!(stopped = resume_lockstep_thread(t, PTRACE_CONT))) stopped = wait_lockstep_stop(t, 0);
+
+    for (b = state->sw_b_HEAD; b != NULL; b = b->next) {
+        if (!b->enabled || !sw_breakpoint_selects_thread(b, t->tid)) continue;
+
+        ptrace(PTRACE_POKEDATA, t->tid, (void *)b->addr, b->instruction);
+
+#ifdef ARCH_AMD64
+        // On amd64 the trap is reported after the int3 instruction
+        if (!stopped && t->regs.rip == b->addr + BREAKPOINT_SIZE) {
+            t->regs.rip = b->addr;
+            setregs(t->tid, &t->regs);
+        }
+#endif
+    }
+
+    return stopped;
+}
+
+int take_lockstep_step(struct global_state *state, int mode, struct thread *t)
+{
+    // Executes a step of the thread, returning why it cannot take further steps, 0 if it can
+    int stopped, executed, result;
+
+    switch (mode) {
+    case LOCKSTEP_BLOCK:
+        // The straight-line code runs at once, then the instruction that transfers control is stepped
+        result = run_basic_block(t, 0, -1, &executed);
+
+        if (result == -1) return LOCKSTEP_ERROR;
+
+        if (result == BLOCK_INTERRUPTED) return 0;
+
+        // fallthrough
+    case LOCKSTEP_INSTRUCTION:
+        if ((stopped = resume_lockstep_thread(t, PTRACE_SINGLESTEP))) return stopped;
+
+        return wait_lockstep_stop(t, 0);
+    case LOCKSTEP_SYSCALL:
+        if ((stopped = resume_lockstep_thread(t, PTRACE_SYSCALL))) return stopped;
+
+        return wait_lockstep_stop(t, SIGTRAP | 0x80);
+    case LOCKSTEP_BREAKPOINT:
+        return run_to_lockstep_breakpoint(state, t);
+    default:
+        return LOCKSTEP_ERROR;
+    }
+}
+
+int run_lockstep(struct lockstep *lockstep, int side, struct global_state *state, int tid)
+{
+    struct lockstep_side *own = &lockstep->sides[side];
+    struct thread *t = state->t_HEAD, *stepping_thread = NULL;
+
+    // flush any register changes
+    while (t != NULL) {
+        if (setregs(t->tid, &t->regs))
+            perror("ptrace_setregs");
+
+        check_and_set_fp_regs(t);
+
+        if (t->tid == tid)
+            stepping_thread = t;
+
+        t = t->next;
+    }
+
+    if (stepping_thread == NULL) {
+        own->stopped = LOCKSTEP_ERROR;
+        own->error = ESRCH;
+    } else {
+        // The hardware breakpoints would stop the thread before it could execute their instruction
+        set_thread_hw_breakpoints(state, tid, 0);
+    }
+
+    // Both workers must always meet on the barrier, whatever happens to their process
+    while (1) {
+        if (!own->stopped) take_lockstep_snapshot(lockstep, own, stepping_thread);
+
+        pthread_barrier_wait(&lockstep->barrier);
+
+        if (side == 0) judge_lockstep(lockstep);
+
+        pthread_barrier_wait(&lockstep->barrier);
+
+        if (lockstep->done) break;
+
+        if ((own->stopped = take_lockstep_step(state, lockstep->mode, stepping_thread)) == LOCKSTEP_ERROR)
+            own->error = errno;
+    }
+
+    if (stepping_thread != NULL) set_thread_hw_breakpoints(state, tid, 1);
+
+    if (own->error) {
+        errno = own->error;
+        return -1;
+    }
+
+    return 0;
+}
+
+int get_lockstep_result(struct lockstep *lockstep, uint64_t *steps)
+{
+    *steps = lockstep->steps;
+
+    return lockstep->result;
+}
+
+void get_lockstep_state(struct lockstep *lockstep, int side, struct ptrace_regs_struct *regs, uint8_t *memory)
+{
+    *regs = lockstep->sides[side].regs;
+
+    memcpy(memory, lockstep->sides[side].memory, lockstep->memory_size);
+}
+
+void free_lockstep(struct lockstep *lockstep)
+{
+    pthread_barrier_destroy(&lockstep->barrier);
+
+    for (int side = 0; side < 2; side++) {
+        free(lockstep->sides[side].addresses);
+        free(lockstep->sides[side].memory);
+    }
+
+    free(lockstep->offsets);
+    free(lockstep->sizes);
+    free(lockstep);
+}
@@ -0,0 +1,152 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+"""Builds libdebug-core, the native core of libdebug as a standalone shared library, and its benchmarks.
+
+The library contains the ptrace engine and the reader of the symbols, which the cffi modules of the package link to.
+
+Usage: python3 libdebug/core/build_core.py [output directory]
+"""
+
+import runpy
+import subprocess
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parents[2]
+CORE_DIR = ROOT / "libdebug" / "core"
+CFFI_DIR = ROOT / "libdebug" / "cffi"
+
+CFLAGS = ["-O2", "-Wall", "-D_GNU_SOURCE"]
+
+DWARF_INCLUDE_DIRS = ["/usr/include/libdwarf/libdwarf-0", "/usr/include/libdwarf-0", "/usr/include/libiberty"]
+
+
+def generate_prefix() -> str:
+    """Returns the definitions that the ptrace engine expects for the architecture of the host.
+
+    They are the same ones prepended to the bindings by the cffi build script.
+    """
+    # Under this name, the cffi build script only generates the definitions, without building the library
+    build = runpy.run_path(str(CFFI_DIR / "ptrace_cffi_build.py"), run_name="libdebug_core")
+
+    return (
+        build["ptrace_regs_struct"]
+        + build["arch_define"]
+        + build["fp_regs_struct"]
+        + build["fpregs_define"]
+        + build["breakpoint_define"]
+    )
+
+
+def debug_sym_source() -> Path:
+    """Returns the source of the reader of the symbols that matches the libdwarf headers of the host."""
+    if Path("/usr/include/libdwarf/dwarf.h").is_file() and Path("/usr/include/libdwarf/libdwarf.h").is_file():
+        return CFFI_DIR / "debug_sym_cffi_source_legacy.c"
+
+    return CFFI_DIR / "debug_sym_cffi_source.c"
+
+
+def build_library(output_dir: Path, compiler: str = "cc") -> Path:
+    """Builds the shared library, unless it is newer than all of its sources.
+
+    Args:
+        output_dir (Path): The directory where the library is written.
+        compiler (str, optional): The C compiler. Defaults to "cc".
+
+    Returns:
+        Path: The path of the shared library.
+    """
+    output_dir.mkdir(parents=True, exist_ok=True)
+
+    library = output_dir / "libdebug-core.so"
+    prefix = output_dir / "ptrace_prefix.h"
+
+    # The definitions change with the features of the CPU, so the prefix is rewritten only when they do
+    definitions = generate_prefix()
+
+    if not prefix.is_file() or prefix.read_text() != definitions:
+        prefix.write_text(definitions)
+
+    engine = CFFI_DIR / "ptrace_cffi_source.c"
+    debug_sym = debug_sym_source()
+    core = CORE_DIR / "libdebug_core.c"
+
+    inputs = [
+        prefix,
+        engine,
+        CFFI_DIR / "ptrace_cffi_source.h",
+        debug_sym,
+        CFFI_DIR / "debug_sym_cffi_source.h",
+        core,
+        CORE_DIR / "libdebug_core.h",
+    ]
+
+    if library.is_file() and all(path.stat().st_mtime <= library.stat().st_mtime for path in inputs):
+        return library
+
+    includes = [f"-I{output_dir}", f"-I{CFFI_DIR}", f"-I{CORE_DIR}"]
+    dwarf_includes = [f"-I{path}" for path in DWARF_INCLUDE_DIRS]
+
+    # The engine and the reader are used by the cffi modules, while the core exports only its public header
+    units = [
+        (engine, ["-include", str(prefix)]),
+        (debug_sym, dwarf_includes),
+        (core, ["-fvisibility=hidden"]),
+    ]
+
+    objects = []
+
+    for source, flags in units:
+        target = output_dir / (source.stem + ".o")
+
+        subprocess.run(
+            [compiler, *CFLAGS, "-fPIC", *flags, *includes, "-c", str(source), "-o", str(target)],
+            check=True,
+        )
+
+        objects.append(str(target))
+
+    subprocess.run(
+        [compiler, "-shared", *objects, "-o", str(library), "-lelf", "-ldwarf", "-liberty"],
+        check=True,
+    )
+
+    return library
+
+
+def build(output_dir: Path, compiler: str = "cc") -> Path:
+    """Builds the shared library and the benchmarks.
+
+    Args:
+        output_dir (Path): The directory where the outputs are written.
+        compiler (str, optional): The C compiler. Defaults to "cc".
+
+    Returns:
+        Path: The path of the shared library.
+    """
+    library = build_library(output_dir, compiler)
+
+    subprocess.run(
+        [
+            compiler,
+            *CFLAGS,
+            f"-I{CORE_DIR}",
+            str(CORE_DIR / "core_bench.c"),
+            "-o",
+            str(output_dir / "core_bench"),
+            f"-L{output_dir}",
+            "-ldebug-core",
+            "-Wl,-rpath,$ORIGIN",
+        ],
+        check=True,
+    )
+
+    return library
+
+
+if __name__ == "__main__":
+    build(Path(sys.argv[1]) if len(sys.argv) > 1 else ROOT / "build" / "libdebug-core")
@@ -0,0 +1,129 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+// Benchmarks of libdebug-core, without any interpreter in the loop.
+// Usage: core_bench <program> <function> [memory reads]
+// The program is run with a breakpoint on the function, until it exits, then the memory of the process is read
+// in a loop.
+
+#include "libdebug_core.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define EVENTS_SIZE 16
+
+double elapsed_seconds(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <program> <function> [memory reads]\n", argv[0]);
+        return 2;
+    }
+
+    long reads = argc > 3 ? atol(argv[3]) : 100000;
+    struct ld_session *session = ld_session_new();
+    char *target_argv[] = {argv[1], NULL};
+    uint64_t address;
+
+    if (ld_run(session, argv[1], target_argv, NULL) == -1) {
+        fprintf(stderr, "ld_run: %s\n", strerror(errno));
+        return 1;
+    }
+
+    // Reach the entry point, so that the libraries are mapped
+    ld_step(session, ld_pid(session));
+
+    if (ld_resolve_symbol(session, NULL, argv[2], &address)) {
+        fprintf(stderr, "Symbol %s not found\n", argv[2]);
+        ld_session_free(session);
+        return 1;
+    }
+
+    ld_breakpoint_add(session, address);
+
+    struct ld_event events[EVENTS_SIZE];
+    struct timespec start;
+    long hits = 0;
+    int running = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (running) {
+        if (ld_cont(session)) break;
+
+        int count = ld_wait(session, events, EVENTS_SIZE);
+        if (count < 0) break;
+
+        for (int i = 0; i < count; i++) {
+            if (events[i].kind == LD_EVENT_BREAKPOINT) hits++;
+            if (events[i].kind == LD_EVENT_PROCESS_EXITED) running = 0;
+        }
+    }
+
+    double seconds = elapsed_seconds(&start);
+    printf("breakpoint hits: %ld in %.3f s (%.0f hits/s)\n", hits, seconds, hits / seconds);
+
+    ld_session_free(session);
+
+    // The memory is read from a new process, stopped on the function
+    session = ld_session_new();
+    ld_run(session, argv[1], target_argv, NULL);
+    ld_step(session, ld_pid(session));
+
+    // The address changes with ASLR
+    ld_resolve_symbol(session, NULL, argv[2], &address);
+    ld_breakpoint_add(session, address);
+
+    int hit_tid = 0;
+
+    while (!hit_tid && !ld_cont(session)) {
+        int count = ld_wait(session, events, EVENTS_SIZE);
+        if (count < 0) break;
+
+        for (int i = 0; i < count; i++)
+            if (events[i].kind == LD_EVENT_BREAKPOINT) hit_tid = events[i].tid;
+    }
+
+    if (!hit_tid) {
+        fprintf(stderr, "The breakpoint was not hit\n");
+        ld_session_free(session);
+        return 1;
+    }
+
+    uint8_t buffer[4096];
+    char name[256];
+    uint64_t offset;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (long i = 0; i < reads; i++) {
+        if (ld_read_memory(session, address & ~4095ul, buffer, sizeof(buffer))) {
+            fprintf(stderr, "ld_read_memory: %s\n", strerror(errno));
+            break;
+        }
+    }
+
+    seconds = elapsed_seconds(&start);
+    printf("memory reads: %ld pages in %.3f s (%.0f MB/s)\n", reads, seconds, reads * 4096 / seconds / 1e6);
+
+    if (!ld_symbolize(session, ld_get_pc(session, hit_tid), name, sizeof(name), &offset))
+        printf("stopped at: %s+%lu\n", name, offset);
+
+    ld_session_free(session);
+
+    return 0;
+}
@@ -0,0 +1,651 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The definitions generated for the architecture of the host, see build_core.py
+#include "ptrace_prefix.h"
+
+// The ptrace engine and the reader of the symbols are shared with the Python bindings
+#include "debug_sym_cffi_source.h"
+#include "ptrace_cffi_source.h"
+
+#include "libdebug_core.h"
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ptrace.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct ld_session {
+    struct global_state state;
+    int pid;
+    _Bool exited;
+    _Bool detached;
+    struct ld_event *pending;
+    int pending_count;
+    int pending_capacity;
+    int pending_next;
+};
+
+LD_API int ld_api_version(void)
+{
+    return LD_API_VERSION;
+}
+
+LD_API struct ld_session *ld_session_new(void)
+{
+    return calloc(1, sizeof(struct ld_session));
+}
+
+void release_process(struct ld_session *session)
+{
+    free_breakpoints(&session->state);
+    free_thread_list(&session->state);
+
+    session->pid = 0;
+    session->pending_count = 0;
+    session->pending_next = 0;
+}
+
+LD_API void ld_session_free(struct ld_session *session)
+{
+    if (session == NULL) return;
+
+    if (session->pid && !session->exited && !session->detached) ld_kill(session);
+
+    release_process(session);
+    free(session->pending);
+    free(session);
+}
+
+// Waits for the first stop of a new tracee, and prepares it for tracing
+int setup_tracee(struct ld_session *session, int pid)
+{
+    int status;
+
+    if (waitpid(pid, &status, 0) == -1) return -1;
+
+    if (!WIFSTOPPED(status)) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    ptrace_set_options(pid);
+
+    session->pid = pid;
+    session->exited = 0;
+    session->detached = 0;
+
+    register_thread(&session->state, pid);
+
+    return 0;
+}
+
+LD_API int ld_run(struct ld_session *session, const char *path, char *const argv[], char *const envp[])
+{
+    if (session->pid) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    int pid = fork();
+
+    if (pid == -1) return -1;
+
+    if (!pid) {
+        // The engine waits on the process group of the tracee
+        setpgid(0, 0);
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+
+        if (envp != NULL)
+            execve(path, argv, envp);
+        else
+            execv(path, argv);
+
+        _exit(127);
+    }
+
+    if (setup_tracee(session, pid)) return -1;
+
+    return pid;
+}
+
+LD_API int ld_attach(struct ld_session *session, int pid)
+{
+    if (session->pid) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    // Every thread is seized and stopped at once, and registered with the main one first
+    if (ptrace_seize_all(&session->state, pid) == -1) return -1;
+
+    session->pid = pid;
+    session->exited = 0;
+    session->detached = 0;
+
+    return 0;
+}
+
+LD_API int ld_detach(struct ld_session *session)
+{
+    if (!session->pid || session->exited) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    // The breakpoints are not installed while the process is stopped, so the code is already clean
+    ptrace_detach_and_cont(&session->state, session->pid);
+
+    session->detached = 1;
+    release_process(session);
+
+    return 0;
+}
+
+LD_API int ld_kill(struct ld_session *session)
+{
+    if (!session->pid) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    if (!session->exited) ptrace_detach_for_kill(&session->state, session->pid);
+
+    release_process(session);
+
+    return 0;
+}
+
+LD_API int ld_pid(struct ld_session *session)
+{
+    return session->pid;
+}
+
+LD_API int ld_threads(struct ld_session *session, int *tids, int max_count)
+{
+    int count = 0;
+
+    for (struct thread *t = session->state.t_HEAD; t != NULL; t = t->next) {
+        if (count < max_count) tids[count] = t->tid;
+        count++;
+    }
+
+    return count;
+}
+
+LD_API int ld_breakpoint_add(struct ld_session *session, uint64_t address)
+{
+    if (!session->pid) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    errno = 0;
+    ptrace(PTRACE_PEEKDATA, session->pid, (void *)address, NULL);
+    if (errno) return -1;
+
+    // The breakpoints are installed only while the process runs, so that reading the memory is transparent
+    struct software_breakpoint *b = get_or_create_sw_breakpoint(&session->state, session->pid, address);
+    b->enabled = 1;
+
+    return 0;
+}
+
+struct software_breakpoint *find_sw_breakpoint(struct ld_session *session, uint64_t address)
+{
+    struct software_breakpoint *b = session->state.sw_b_HEAD;
+
+    while (b != NULL && b->addr != address) b = b->next;
+
+    return b;
+}
+
+LD_API int ld_breakpoint_remove(struct ld_session *session, uint64_t address)
+{
+    if (find_sw_breakpoint(session, address) == NULL) return -1;
+
+    unregister_breakpoint(&session->state, address);
+
+    return 0;
+}
+
+LD_API int ld_breakpoint_enable(struct ld_session *session, uint64_t address, int enabled)
+{
+    struct software_breakpoint *b = find_sw_breakpoint(session, address);
+
+    if (b == NULL) return -1;
+
+    b->enabled = enabled != 0;
+
+    return 0;
+}
+
+LD_API int ld_cont(struct ld_session *session)
+{
+    if (!session->pid || session->exited) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    return cont_all_and_set_bps(&session->state, session->pid) < 0 ? -1 : 0;
+}
+
+LD_API int ld_step(struct ld_session *session, int tid)
+{
+    struct thread *t = get_thread(&session->state, tid);
+    int status;
+
+    if (t == NULL) {
+        errno = ESRCH;
+        return -1;
+    }
+
+    if (singlestep(&session->state, tid)) return -1;
+
+    if (waitpid(tid, &status, __WALL) == -1) return -1;
+
+    getregs(tid, &t->regs);
+    t->fpregs.fresh = 0;
+
+    return 0;
+}
+
+void push_event(struct ld_session *session, struct ld_event *event)
+{
+    if (session->pending_count == session->pending_capacity) {
+        int capacity = session->pending_capacity ? session->pending_capacity * 2 : 16;
+        struct ld_event *pending = realloc(session->pending, capacity * sizeof(struct ld_event));
+
+        if (pending == NULL) return;
+
+        session->pending = pending;
+        session->pending_capacity = capacity;
+    }
+
+    session->pending[session->pending_count++] = *event;
+}
+
+int has_status(struct thread_status *head, int tid)
+{
+    for (struct thread_status *ts = head; ts != NULL; ts = ts->next)
+        if (ts->tid == tid) return 1;
+
+    return 0;
+}
+
+// Turns the stop of a thread into an event, handling internally the ones that report nothing
+void decode_status(struct ld_session *session, struct thread_status *head, struct thread_status *ts)
+{
+    struct ld_event event = {.tid = ts->tid};
+    struct thread *t = get_thread(&session->state, ts->tid);
+    int status = ts->status;
+
+    if (WIFEXITED(status) || WIFSIGNALED(status)) {
+        event.kind = ts->tid == session->pid ? LD_EVENT_PROCESS_EXITED : LD_EVENT_THREAD_EXITED;
+        event.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 0;
+        event.signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+
+        if (t != NULL) unregister_thread(&session->state, ts->tid);
+        if (ts->tid == session->pid) session->exited = 1;
+
+        push_event(session, &event);
+        return;
+    }
+
+    if (!WIFSTOPPED(status) || t == NULL) return;
+
+    int signal = WSTOPSIG(status);
+    int ptrace_event = status >> 16;
+
+    if (signal == SIGTRAP && ptrace_event) {
+        uint64_t message = ptrace_geteventmsg(ts->tid);
+
+        switch (ptrace_event) {
+            case PTRACE_EVENT_CLONE:
+                // The new thread starts with a SIGSTOP, which might not have been collected yet
+                if (!has_status(head, message)) waitpid(message, NULL, __WALL);
+                register_thread(&session->state, message);
+
+                event.kind = LD_EVENT_THREAD_CREATED;
+                event.value = message;
+                break;
+            case PTRACE_EVENT_FORK:
+            case PTRACE_EVENT_VFORK:
+                event.kind = LD_EVENT_FORK;
+                event.value = message;
+                break;
+            case PTRACE_EVENT_EXEC:
+                event.kind = LD_EVENT_EXEC;
+                break;
+            default:
+                // The exit of the thread is reported when it is complete
+                return;
+        }
+
+        push_event(session, &event);
+        return;
+    }
+
+    // Our own SIGSTOPs, and the syscall stops, report nothing
+    if ((signal == SIGSTOP && ts->interrupted) || signal == (SIGTRAP | 0x80)) return;
+
+    if (signal == SIGTRAP) {
+        uint64_t pc = INSTRUCTION_POINTER(t->regs);
+
+#ifdef ARCH_AMD64
+        // The trap is reported after the breakpoint instruction
+        pc -= BREAKPOINT_SIZE;
+#endif
+
+        struct software_breakpoint *b = find_sw_breakpoint(session, pc);
+
+        if (b != NULL && b->enabled) {
+            INSTRUCTION_POINTER(t->regs) = pc;
+
+            event.kind = LD_EVENT_BREAKPOINT;
+            event.address = pc;
+            push_event(session, &event);
+            return;
+        }
+    }
+
+    t->signal_to_forward = signal;
+
+    event.kind = LD_EVENT_SIGNAL;
+    event.signal = signal;
+    push_event(session, &event);
+}
+
+LD_API int ld_wait(struct ld_session *session, struct ld_event *events, int max_count)
+{
+    if (session->pending_next == session->pending_count) {
+        session->pending_count = 0;
+        session->pending_next = 0;
+
+        if (!session->pid || session->exited) {
+            errno = ESRCH;
+            return -1;
+        }
+
+        while (1) {
+            struct thread_status *head = wait_all_and_update_regs(&session->state, session->pid);
+
+            if (head == NULL) return -1;
+
+            for (struct thread_status *ts = head; ts != NULL; ts = ts->next) {
+                if (ts->tid != -1) decode_status(session, head, ts);
+            }
+
+            free_thread_status_list(head);
+
+            if (session->pending_count || session->exited) break;
+
+            // Nothing to report, the process is resumed as if it never stopped
+            if (cont_all_and_set_bps(&session->state, session->pid) < 0) return -1;
+        }
+
+        // Each stop refreshes the register files, the floating point ones are fetched again on demand
+        for (struct thread *t = session->state.t_HEAD; t != NULL; t = t->next) t->fpregs.fresh = 0;
+    }
+
+    int count = session->pending_count - session->pending_next;
+    if (count > max_count) count = max_count;
+
+    memcpy(events, session->pending + session->pending_next, count * sizeof(struct ld_event));
+    session->pending_next += count;
+
+    return count;
+}
+
+LD_API int ld_read_memory(struct ld_session *session, uint64_t address, void *buffer, size_t size)
+{
+    return read_remote_memory(session->pid, address, buffer, size);
+}
+
+LD_API int ld_write_memory(struct ld_session *session, uint64_t address, const void *buffer, size_t size)
+{
+    const uint8_t *source = buffer;
+    size_t done = 0;
+
+    // Through ptrace, so that read-only mappings such as the code can be patched
+    while (done < size) {
+        uint64_t word_address = (address + done) & ~(uint64_t)(sizeof(uint64_t) - 1);
+        uint64_t offset = address + done - word_address;
+        uint64_t count = sizeof(uint64_t) - offset;
+        uint64_t word;
+
+        if (count > size - done) count = size - done;
+
+        if (count < sizeof(uint64_t)) {
+            errno = 0;
+            word = ptrace(PTRACE_PEEKDATA, session->pid, (void *)word_address, NULL);
+            if (errno) return -1;
+        }
+
+        memcpy((uint8_t *)&word + offset, source + done, count);
+
+        if (ptrace(PTRACE_POKEDATA, session->pid, (void *)word_address, word)) return -1;
+
+        done += count;
+    }
+
+    return 0;
+}
+
+LD_API void *ld_registers(struct ld_session *session, int tid)
+{
+    struct thread *t = get_thread(&session->state, tid);
+
+    return t != NULL ? &t->regs : NULL;
+}
+
+LD_API uint64_t ld_get_pc(struct ld_session *session, int tid)
+{
+    struct thread *t = get_thread(&session->state, tid);
+
+    return t != NULL ? INSTRUCTION_POINTER(t->regs) : 0;
+}
+
+LD_API int ld_set_pc(struct ld_session *session, int tid, uint64_t pc)
+{
+    struct thread *t = get_thread(&session->state, tid);
+
+    if (t == NULL) return -1;
+
+    INSTRUCTION_POINTER(t->regs) = pc;
+
+    return 0;
+}
+
+// The symbols are read from the ELF files mapped in memory, through the reader of the Python bindings
+
+struct mapped_file {
+    char path[PATH_MAX];
+    uint64_t base;
+    uint64_t end;
+};
+
+// Finds the first mapping of a file in the process, whose path contains the specified one, or is equal to it
+int find_mapped_file(int pid, const char *file, _Bool exact, struct mapped_file *result)
+{
+    char maps_path[64];
+    snprintf(maps_path, sizeof(maps_path), "/proc/%d/maps", pid);
+
+    FILE *maps = fopen(maps_path, "r");
+    if (maps == NULL) return -1;
+
+    char line[PATH_MAX + 128];
+    char path[PATH_MAX];
+    uint64_t start, end;
+    int found = 0;
+
+    while (fgets(line, sizeof(line), maps) != NULL) {
+        if (sscanf(line, "%lx-%lx %*s %*s %*s %*s %4095[^\n]", &start, &end, path) < 3 || path[0] != '/') continue;
+
+        if (found) {
+            // The mappings of the same file are contiguous
+            if (strcmp(path, result->path)) break;
+
+            result->end = end;
+            continue;
+        }
+
+        if (exact ? strcmp(path, file) : strstr(path, file) == NULL) continue;
+
+        strcpy(result->path, path);
+        result->base = start;
+        result->end = end;
+        found = 1;
+    }
+
+    fclose(maps);
+
+    return found ? 0 : -1;
+}
+
+// Finds the path of the file mapped at the specified address
+int find_file_at(int pid, uint64_t address, char *path)
+{
+    char maps_path[64];
+    snprintf(maps_path, sizeof(maps_path), "/proc/%d/maps", pid);
+
+    FILE *maps = fopen(maps_path, "r");
+    if (maps == NULL) return -1;
+
+    char line[PATH_MAX + 128];
+    uint64_t start, end;
+    int found = 0;
+
+    while (!found && fgets(line, sizeof(line), maps) != NULL) {
+        if (sscanf(line, "%lx-%lx %*s %*s %*s %*s %4095[^\n]", &start, &end, path) < 3 || path[0] != '/') continue;
+
+        found = start <= address && address < end;
+    }
+
+    fclose(maps);
+
+    return found ? 0 : -1;
+}
+
+int executable_path(int pid, char *path, size_t size)
+{
+    char link_path[64];
+    snprintf(link_path, sizeof(link_path), "/proc/%d/exe", pid);
+
+    ssize_t length = readlink(link_path, path, size - 1);
+    if (length <= 0) return -1;
+
+    path[length] = 0;
+    return 0;
+}
+
+// Whether the file is position independent, i.e., its symbols are relative to the base of its mapping
+int is_dynamic_file(const char *path)
+{
+    Elf64_Ehdr header;
+    int fd = open(path, O_RDONLY);
+
+    if (fd == -1) return 0;
+
+    int dynamic = read(fd, &header, sizeof(header)) == sizeof(header) && header.e_type == ET_DYN;
+    close(fd);
+
+    return dynamic;
+}
+
+// Reads the symbol tables of a file, without its debug info
+SymbolInfo *read_symbols(const char *path)
+{
+    SymbolInfo *symbols = read_elf_info(path, 1);
+
+    // The reader keeps the build ID and the debug link of the last file until the Python bindings ask for them
+    free(get_build_id());
+    free(get_debug_file());
+
+    return symbols;
+}
+
+LD_API int ld_resolve_symbol(struct ld_session *session, const char *file, const char *name, uint64_t *address)
+{
+    struct mapped_file mapping;
+    char path[PATH_MAX];
+
+    if (file == NULL) {
+        if (executable_path(session->pid, path, sizeof(path))) return -1;
+        file = path;
+    }
+
+    if (find_mapped_file(session->pid, file, 0, &mapping)) return -1;
+
+    int found = 0;
+    uint64_t value = 0;
+
+    // The symbol tables are read first, the debug info only for the names missing from them
+    SymbolInfo *symbols = read_symbols(mapping.path);
+
+    for (SymbolInfo *symbol = symbols; symbol != NULL && !found; symbol = symbol->next) {
+        if (!symbol->low_pc || strcmp(symbol->name, name)) continue;
+
+        value = symbol->low_pc;
+        found = 1;
+    }
+
+    free_symbol_info(symbols);
+
+    if (!found) {
+        symbols = lookup_dwarf_symbol(mapping.path, name);
+
+        for (SymbolInfo *symbol = symbols; symbol != NULL && !found; symbol = symbol->next) {
+            if (strcmp(symbol->name, name)) continue;
+
+            value = symbol->low_pc;
+            found = 1;
+        }
+
+        free_symbol_info(symbols);
+    }
+
+    if (!found) return -1;
+
+    *address = value + (is_dynamic_file(mapping.path) ? mapping.base : 0);
+    return 0;
+}
+
+LD_API int ld_symbolize(struct ld_session *session, uint64_t address, char *name, size_t size, uint64_t *offset)
+{
+    struct mapped_file mapping;
+    char path[PATH_MAX];
+
+    if (find_file_at(session->pid, address, path) || find_mapped_file(session->pid, path, 1, &mapping)) return -1;
+
+    // Position independent files are looked up by their relative addresses
+    uint64_t relative = address - (is_dynamic_file(mapping.path) ? mapping.base : 0);
+    SymbolInfo *symbols = read_symbols(mapping.path);
+    SymbolInfo *match = NULL;
+
+    for (SymbolInfo *symbol = symbols; symbol != NULL && match == NULL; symbol = symbol->next)
+        if (symbol->low_pc <= relative && relative < symbol->high_pc) match = symbol;
+
+    if (match != NULL) {
+        snprintf(name, size, "%s", match->name);
+        if (offset != NULL) *offset = relative - match->low_pc;
+    }
+
+    free_symbol_info(symbols);
+
+    return match != NULL ? 0 : -1;
+}
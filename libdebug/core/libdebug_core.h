@@ -0,0 +1,122 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#ifndef LIBDEBUG_CORE_H
+#define LIBDEBUG_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LD_API __attribute__((visibility("default")))
+
+// The version of the API, bumped on every incompatible change
+#define LD_API_VERSION 1
+
+// The kinds of the events reported by ld_wait
+enum ld_event_kind {
+    LD_EVENT_BREAKPOINT = 1,    // a software breakpoint was hit, at the address of the event
+    LD_EVENT_SIGNAL = 2,        // a signal was delivered, and it will be forwarded on the next resume
+    LD_EVENT_THREAD_CREATED = 3, // a new thread was created, with the thread ID in the value of the event
+    LD_EVENT_THREAD_EXITED = 4, // a thread exited, with its exit code or terminating signal
+    LD_EVENT_PROCESS_EXITED = 5, // the process exited, with its exit code or terminating signal
+    LD_EVENT_FORK = 6,          // the process forked, with the child left stopped and not traced
+    LD_EVENT_EXEC = 7,          // the process executed a new program
+};
+
+struct ld_event {
+    int kind;
+    int tid;
+    int signal;     // the signal delivered, or the one that terminated the thread, 0 if none
+    int exit_code;  // the exit code of the thread, valid if signal is 0
+    uint64_t address; // the address of the breakpoint hit
+    uint64_t value;   // the thread ID of the new thread, or the process ID of the forked child
+};
+
+// A debugging session, tracing a single process
+struct ld_session;
+
+// Creates a new session. Returns NULL on failure.
+LD_API struct ld_session *ld_session_new(void);
+
+// Releases the session, killing the process if it is still traced.
+LD_API void ld_session_free(struct ld_session *session);
+
+// Returns LD_API_VERSION of the library.
+LD_API int ld_api_version(void);
+
+// Runs a new process, stopped before its first instruction. The environment of the caller is used if envp is NULL.
+// Returns the process ID, or -1 on failure with errno set.
+LD_API int ld_run(struct ld_session *session, const char *path, char *const argv[], char *const envp[]);
+
+// Attaches to a running process, which is stopped. Returns 0 on success, -1 on failure with errno set.
+LD_API int ld_attach(struct ld_session *session, int pid);
+
+// Detaches from the process, which keeps running. Breakpoints are removed. Returns 0 on success, -1 on failure.
+LD_API int ld_detach(struct ld_session *session);
+
+// Kills the process. Returns 0 on success, -1 on failure.
+LD_API int ld_kill(struct ld_session *session);
+
+// Returns the process ID of the traced process, 0 if none.
+LD_API int ld_pid(struct ld_session *session);
+
+// Copies the IDs of the live threads into tids. Returns the number of threads, which can exceed max_count.
+LD_API int ld_threads(struct ld_session *session, int *tids, int max_count);
+
+// Sets an enabled software breakpoint. Returns 0 on success, -1 on failure.
+LD_API int ld_breakpoint_add(struct ld_session *session, uint64_t address);
+
+// Removes a software breakpoint. Returns 0 on success, -1 if not found.
+LD_API int ld_breakpoint_remove(struct ld_session *session, uint64_t address);
+
+// Enables or disables a software breakpoint. Returns 0 on success, -1 if not found.
+LD_API int ld_breakpoint_enable(struct ld_session *session, uint64_t address, int enabled);
+
+// Resumes all the threads of the process. Returns 0 on success, -1 on failure.
+LD_API int ld_cont(struct ld_session *session);
+
+// Executes a single instruction of a thread, stepping over the breakpoints. Returns 0 on success, -1 on failure.
+LD_API int ld_step(struct ld_session *session, int tid);
+
+// Waits for the process to stop, and copies the events into the buffer. The stops that report nothing, e.g.,
+// the ones of the other threads, are handled internally. Returns the number of events copied, at least 1, or -1 on
+// failure. The events that do not fit in the buffer are returned by the following calls, without waiting.
+LD_API int ld_wait(struct ld_session *session, struct ld_event *events, int max_count);
+
+// Reads the memory of the process. Returns 0 on success, -1 on failure.
+LD_API int ld_read_memory(struct ld_session *session, uint64_t address, void *buffer, size_t size);
+
+// Writes the memory of the process, even if it is not writable. Returns 0 on success, -1 on failure.
+LD_API int ld_write_memory(struct ld_session *session, uint64_t address, const void *buffer, size_t size);
+
+// Returns the register file of a stopped thread, laid out as the struct user_regs_struct of the kernel, NULL if the
+// thread is not traced. The changes are written back when the process is resumed.
+LD_API void *ld_registers(struct ld_session *session, int tid);
+
+// Returns the program counter of a thread, 0 if the thread is not traced.
+LD_API uint64_t ld_get_pc(struct ld_session *session, int tid);
+
+// Sets the program counter of a thread. Returns 0 on success, -1 if the thread is not traced.
+LD_API int ld_set_pc(struct ld_session *session, int tid, uint64_t pc);
+
+// Resolves a symbol of an ELF file mapped in the process, or of the executable if file is NULL. The file can be
+// a substring of the path of the mapping. The address is absolute, i.e., relocated for position independent files.
+// Returns 0 on success, -1 if not found.
+LD_API int ld_resolve_symbol(struct ld_session *session, const char *file, const char *name, uint64_t *address);
+
+// Resolves an absolute address to the symbol containing it, among the ELF files mapped in the process.
+// Returns 0 on success, with the offset from the start of the symbol, -1 if not found.
+LD_API int ld_symbolize(struct ld_session *session, uint64_t address, char *name, size_t size, uint64_t *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
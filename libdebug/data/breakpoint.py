@@ -30,6 +30,9 @@ class Breakpoint:
         condition (str): The breakpoint condition. Available values are "X", "W", "RW". Supported only for hardware breakpoints.
         length (int): The length of the breakpoint area. Supported only for hardware breakpoints.
         enabled (bool): Whether the breakpoint is enabled or not.
+        native_callback (object): The C function handling the breakpoint without leaving the native code, if any.
+        native_data (object): The pointer passed to the native callback.
+        threads (list[int] | None): The IDs of the threads the breakpoint is hit by, None if it is hit by every thread.
     """
 
     address: int = 0
@@ -40,6 +43,9 @@ class Breakpoint:
     condition: str = "x"
     length: int = 1
     enabled: bool = True
+    native_callback: object = None
+    native_data: object = None
+    threads: list[int] | None = None
 
     _linked_thread_ids: list[int] = field(default_factory=list)
     # The thread ID that hit the breakpoint
@@ -61,7 +67,15 @@ class Breakpoint:
 
     def hit_on(self: Breakpoint, thread_context: ThreadContext) -> bool:
         """Returns whether the breakpoint has been hit on the given thread context."""
-        return self.enabled and thread_context.instruction_pointer == self.address
+        return (
+            self.enabled
+            and thread_context.instruction_pointer == self.address
+            and self.selects_thread(thread_context.thread_id)
+        )
+
+    def selects_thread(self: Breakpoint, thread_id: int) -> bool:
+        """Returns whether the breakpoint can be hit by the given thread."""
+        return self.threads is None or thread_id in self.threads
 
     def __hash__(self: Breakpoint) -> int:
         """Hash the breakpoint by its address, so that it can be used in sets and maps correctly."""
@@ -0,0 +1,167 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from bisect import bisect_right
+from dataclasses import dataclass, field
+
+
+@dataclass(frozen=True)
+class DwarfLocation:
+    """A DWARF location expression, valid in a range of program counters.
+
+    Attributes:
+        low_pc (int): The first program counter the expression is valid at.
+        high_pc (int): The first program counter after the range.
+        ops (tuple[tuple[int, int, int, int], ...]): The operations of the expression, as (atom, first operand,
+        second operand, offset in the expression).
+    """
+
+    low_pc: int
+    high_pc: int
+    ops: tuple[tuple[int, int, int, int], ...]
+
+    def covers(self: DwarfLocation, address: int) -> bool:
+        """Returns whether the expression is valid at the specified address."""
+        return self.low_pc <= address < self.high_pc
+
+
+@dataclass(frozen=True)
+class DwarfVariable:
+    """A variable or a parameter of a function, as described by the DWARF debug info.
+
+    Attributes:
+        name (str): The name of the variable.
+        type_offset (int): The offset of the DIE of its type, 0 if unknown.
+        low_pc (int): The first program counter of the scope of the variable.
+        high_pc (int): The first program counter after the scope of the variable.
+        is_parameter (bool): Whether the variable is a parameter of the function.
+        locations (tuple[DwarfLocation, ...]): The locations of the variable, empty if it is optimized out.
+    """
+
+    name: str
+    type_offset: int
+    low_pc: int
+    high_pc: int
+    is_parameter: bool
+    locations: tuple[DwarfLocation, ...]
+
+    def location_at(self: DwarfVariable, address: int) -> DwarfLocation | None:
+        """Returns the location of the variable at the specified address, None if it is not available."""
+        return next((location for location in self.locations if location.covers(address)), None)
+
+
+@dataclass(frozen=True)
+class DwarfFunction:
+    """A function described by the DWARF debug info.
+
+    Attributes:
+        name (str): The name of the function.
+        low_pc (int): The first program counter of the function.
+        high_pc (int): The first program counter after the function.
+        frame_base (tuple[DwarfLocation, ...]): The locations of the frame base of the function.
+        variables (tuple[DwarfVariable, ...]): The parameters and the variables of the function, in declaration order.
+    """
+
+    name: str
+    low_pc: int
+    high_pc: int
+    frame_base: tuple[DwarfLocation, ...]
+    variables: tuple[DwarfVariable, ...] = field(repr=False)
+
+    def frame_base_at(self: DwarfFunction, address: int) -> DwarfLocation | None:
+        """Returns the frame base of the function at the specified address, None if it is not available."""
+        return next((location for location in self.frame_base if location.covers(address)), None)
+
+    def variables_at(self: DwarfFunction, address: int) -> list[DwarfVariable]:
+        """Returns the variables in scope at the specified address, the innermost ones shadowing the outer ones."""
+        visible = {}
+
+        for variable in self.variables:
+            if not variable.low_pc <= address < variable.high_pc:
+                continue
+
+            current = visible.get(variable.name)
+
+            # Nested scopes are narrower than the ones containing them
+            if current is None or variable.high_pc - variable.low_pc <= current.high_pc - current.low_pc:
+                visible[variable.name] = variable
+
+        return list(visible.values())
+
+    def __repr__(self: DwarfFunction) -> str:
+        """Return the string representation of the function."""
+        return f"DwarfFunction({self.name}, {self.low_pc:#x}-{self.high_pc:#x}, variables={len(self.variables)})"
+
+
+@dataclass(frozen=True)
+class CfaRule:
+    """The rule computing the canonical frame address in a range of program counters.
+
+    Attributes:
+        low_pc (int): The first program counter the rule is valid at.
+        high_pc (int): The first program counter after the range.
+        register (int): The DWARF number of the base register, -1 if the rule is not a register plus an offset.
+        offset (int): The offset added to the base register.
+    """
+
+    low_pc: int
+    high_pc: int
+    register: int
+    offset: int
+
+
+class DwarfFunctionTable:
+    """The functions described by the DWARF debug info of an ELF file, with the rules of their call frames."""
+
+    def __init__(self: DwarfFunctionTable, functions: list[DwarfFunction], cfa_rules: list[CfaRule]) -> None:
+        """Initializes the table.
+
+        Args:
+            functions (list[DwarfFunction]): The functions of the ELF file.
+            cfa_rules (list[CfaRule]): The rules of the call frames of the ELF file.
+        """
+        self._functions = sorted(functions, key=lambda function: function.low_pc)
+        self._function_starts = [function.low_pc for function in self._functions]
+        self._cfa_rules = sorted(cfa_rules, key=lambda rule: rule.low_pc)
+        self._cfa_starts = [rule.low_pc for rule in self._cfa_rules]
+
+    def function_at(self: DwarfFunctionTable, address: int) -> DwarfFunction | None:
+        """Returns the function containing the specified address, None if not found.
+
+        Args:
+            address (int): The address, relative to the base of the ELF file.
+        """
+        index = bisect_right(self._function_starts, address) - 1
+
+        # Functions might be nested into each other, look for the innermost one containing the address
+        while index >= 0:
+            function = self._functions[index]
+
+            if function.low_pc <= address < function.high_pc:
+                return function
+
+            index -= 1
+
+        return None
+
+    def cfa_rule_at(self: DwarfFunctionTable, address: int) -> CfaRule | None:
+        """Returns the rule of the canonical frame address at the specified address, None if not found.
+
+        Args:
+            address (int): The address, relative to the base of the ELF file.
+        """
+        index = bisect_right(self._cfa_starts, address) - 1
+
+        if index >= 0 and address < self._cfa_rules[index].high_pc:
+            return self._cfa_rules[index]
+
+        return None
+
+    def __len__(self: DwarfFunctionTable) -> int:
+        """Return the number of functions in the table."""
+        return len(self._functions)
@@ -0,0 +1,390 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import re
+from dataclasses import dataclass, field
+
+# The DWARF tags of the types, as reported by the native type collector
+TYPE_KINDS = {
+    0x01: "array",
+    0x02: "class",
+    0x04: "enum",
+    0x0F: "pointer",
+    0x10: "reference",
+    0x13: "struct",
+    0x16: "typedef",
+    0x17: "union",
+    0x24: "base",
+    0x26: "const",
+    0x35: "volatile",
+    0x37: "restrict",
+    0x3B: "unspecified",
+    0x42: "reference",
+    0x47: "atomic",
+}
+
+# The DWARF tags of the parts of a type
+TAG_MEMBER = 0x0D
+TAG_SUBRANGE = 0x21
+TAG_ENUMERATOR = 0x28
+
+# The kinds of types that only qualify the type they refer to
+QUALIFIER_KINDS = ("typedef", "const", "volatile", "restrict", "atomic")
+
+# The kinds of types that can be looked up through a tag name, e.g., "struct foo"
+TAGGED_KINDS = ("struct", "union", "enum", "class")
+
+# The DWARF encodings of the base types
+ENCODING_BOOLEAN = 0x02
+ENCODING_COMPLEX_FLOAT = 0x03
+ENCODING_FLOAT = 0x04
+ENCODING_SIGNED = 0x05
+ENCODING_SIGNED_CHAR = 0x06
+ENCODING_UNSIGNED_CHAR = 0x08
+
+# The suffix of a type name that builds a derived type, e.g., "*" or "[4]"
+DECLARATOR_SUFFIX = re.compile(r"^(.*?)\s*(\*|\[\s*(\d+)\s*\])$")
+
+
+@dataclass(eq=False, repr=False)
+class DwarfField:
+    """A member of a structure or of a union.
+
+    Attributes:
+        name (str | None): The name of the member, None for anonymous structures and unions.
+        offset (int): The offset of the member in the enclosing type.
+        type (DwarfType): The type of the member.
+        bit_size (int): The size of the member in bits, 0 if it is not a bit-field.
+        bit_offset (int): The offset of the bit-field in bits, from the start of the enclosing type.
+    """
+
+    name: str | None
+    offset: int
+    type: DwarfType
+    bit_size: int = 0
+    bit_offset: int = 0
+
+    def __repr__(self: DwarfField) -> str:
+        """Return the string representation of the member."""
+        return f"DwarfField({self.name}, offset={self.offset:#x}, type={self.type})"
+
+
+@dataclass(eq=False, repr=False)
+class DwarfType:
+    """A type described by the DWARF debug info.
+
+    Attributes:
+        kind (str): The kind of the type, e.g., base, struct, union, enum, pointer, array or typedef.
+        name (str | None): The name of the type, None for anonymous and derived types.
+        size (int): The size of the type in bytes.
+        target (DwarfType | None): The referenced type of pointers, arrays, enums and qualifiers, if any.
+        fields (list[DwarfField]): The members of structures and unions.
+        count (int): The number of elements of arrays.
+        encoding (int): The DWARF encoding of base types.
+        enumerators (dict[int, str]): The values of enums.
+    """
+
+    kind: str
+    name: str | None
+    size: int = 0
+    target: DwarfType | None = None
+    fields: list[DwarfField] = field(default_factory=list)
+    count: int = 0
+    encoding: int = 0
+    enumerators: dict[int, str] = field(default_factory=dict)
+
+    @property
+    def resolved(self: DwarfType) -> DwarfType:
+        """The type without typedefs and qualifiers."""
+        dwarf_type = self
+
+        while dwarf_type.kind in QUALIFIER_KINDS and dwarf_type.target is not None:
+            dwarf_type = dwarf_type.target
+
+        return dwarf_type
+
+    @property
+    def is_signed(self: DwarfType) -> bool:
+        """Whether the type is a signed integer."""
+        resolved = self.resolved
+
+        if resolved.kind == "enum":
+            return resolved.target is not None and resolved.target.is_signed
+
+        return resolved.kind == "base" and resolved.encoding in (ENCODING_SIGNED, ENCODING_SIGNED_CHAR)
+
+    @property
+    def is_char(self: DwarfType) -> bool:
+        """Whether the type is a single-byte character."""
+        resolved = self.resolved
+        return resolved.kind == "base" and resolved.size == 1 and resolved.encoding != ENCODING_BOOLEAN
+
+    def member(self: DwarfType, name: str) -> DwarfField | None:
+        """Returns the member with the specified name, looking into anonymous structures and unions.
+
+        Args:
+            name (str): The name of the member.
+
+        Returns:
+            DwarfField | None: The member, with the offset from the start of this type, None if not found.
+        """
+        for member in self.resolved.fields:
+            if member.name == name:
+                return member
+
+            if member.name is None and (inner := member.type.member(name)) is not None:
+                return DwarfField(
+                    inner.name,
+                    member.offset + inner.offset,
+                    inner.type,
+                    inner.bit_size,
+                    inner.bit_offset + member.offset * 8,
+                )
+
+        return None
+
+    def __str__(self: DwarfType) -> str:
+        """Return the C name of the type."""
+        if self.kind in TAGGED_KINDS:
+            return f"{self.kind} {self.name or '<anonymous>'}"
+
+        if self.kind == "pointer":
+            return f"{self.target or 'void'} *"
+
+        if self.kind == "array":
+            # The outermost dimension comes first, e.g., int[2][3] is an array of 2 arrays of 3 integers
+            dimensions, element = "", self
+
+            while element is not None and element.kind == "array":
+                dimensions += f"[{element.count}]"
+                element = element.target
+
+            return f"{element}{dimensions}"
+
+        if self.kind in QUALIFIER_KINDS and self.name is None:
+            return f"{self.kind} {self.target or 'void'}"
+
+        return self.name or "<anonymous>"
+
+    def __repr__(self: DwarfType) -> str:
+        """Return the string representation of the type."""
+        return f"DwarfType({self}, size={self.size:#x})"
+
+
+class DwarfTypeTable:
+    """The types described by the DWARF debug info of an ELF file.
+
+    The table keeps the compact records collected natively, and builds each type on its first lookup.
+    """
+
+    def __init__(self: DwarfTypeTable, records: list[tuple]) -> None:
+        """Initializes the table from the native records.
+
+        Args:
+            records (list[tuple]): The records of the types, in the order of the debug info. Each record holds the
+            offset, the referenced type, the parent, the name, the size, the value, the tag, the encoding, the bit
+            size, the bit offset and the declaration flag of the DIE.
+        """
+        self._records = {}
+        self._children = {}
+        self._names = {}
+        self._base_names = {}
+        self._types = {}
+        self._pointer_size = 8
+
+        for record in records:
+            offset, _, parent, name, size, _, tag, _, _, _, declaration = record
+            self._records[offset] = record
+
+            if tag in (TAG_MEMBER, TAG_SUBRANGE, TAG_ENUMERATOR):
+                self._children.setdefault(parent, []).append(offset)
+                continue
+
+            kind = TYPE_KINDS.get(tag)
+
+            if kind == "pointer" and size:
+                self._pointer_size = size
+
+            if not name or kind is None:
+                continue
+
+            key = f"{kind} {name}" if kind in TAGGED_KINDS else name
+
+            # Prefer the complete definition over the forward declarations
+            if key not in self._names or (self._records[self._names[key]][10] and not declaration):
+                self._names[key] = offset
+
+            if kind == "base":
+                self._base_names.setdefault(normalize_base_name(name), offset)
+
+    def lookup(self: DwarfTypeTable, name: str) -> DwarfType:
+        """Returns the type with the specified name.
+
+        Args:
+            name (str): The C name of the type, e.g., "struct foo", "foo_t", "unsigned long", "char *" or "int[4]".
+
+        Returns:
+            DwarfType: The type.
+
+        Raises:
+            ValueError: If the type is not described by the debug info.
+        """
+        suffixes = []
+        base_name = name.strip()
+
+        while match := DECLARATOR_SUFFIX.match(base_name):
+            base_name = match.group(1)
+            suffixes.append(match.group(2))
+
+        base_name = " ".join(base_name.split())
+
+        if base_name == "void":
+            dwarf_type = None
+        else:
+            dwarf_type = self._build(self._find(base_name, name))
+
+        # Pointers bind before the array dimensions, and the rightmost dimension is the innermost one
+        for suffix in reversed(suffixes):
+            if suffix == "*":
+                dwarf_type = self.pointer_to(dwarf_type)
+
+        for suffix in suffixes:
+            if suffix != "*":
+                dwarf_type = self.array_of(dwarf_type, int(suffix[1:-1]))
+
+        if dwarf_type is None:
+            raise ValueError("The void type has no size.")
+
+        return dwarf_type
+
+    def type_at(self: DwarfTypeTable, offset: int) -> DwarfType:
+        """Returns the type described by the DIE at the specified offset of the debug info.
+
+        Args:
+            offset (int): The offset of the DIE.
+        """
+        return self._build(offset)
+
+    def pointer_to(self: DwarfTypeTable, dwarf_type: DwarfType | None) -> DwarfType:
+        """Returns a pointer to the specified type.
+
+        Args:
+            dwarf_type (DwarfType | None): The type, None for void.
+        """
+        return DwarfType("pointer", None, self._pointer_size, dwarf_type)
+
+    def array_of(self: DwarfTypeTable, dwarf_type: DwarfType | None, count: int) -> DwarfType:
+        """Returns an array of the specified type.
+
+        Args:
+            dwarf_type (DwarfType | None): The type of the elements.
+            count (int): The number of elements.
+        """
+        if dwarf_type is None:
+            raise ValueError("Cannot build an array of void.")
+
+        if count < 0:
+            raise ValueError("The number of elements must be positive.")
+
+        return DwarfType("array", None, dwarf_type.size * count, dwarf_type, count=count)
+
+    def _find(self: DwarfTypeTable, base_name: str, name: str) -> int:
+        """Returns the offset of the DIE of the type with the specified name."""
+        if base_name in self._names:
+            return self._names[base_name]
+
+        # C++ types can be named without their tag
+        for kind in TAGGED_KINDS:
+            if f"{kind} {base_name}" in self._names:
+                return self._names[f"{kind} {base_name}"]
+
+        # Base types have many spellings, e.g., "unsigned long" is "long unsigned int"
+        if (normalized := normalize_base_name(base_name)) in self._base_names:
+            return self._base_names[normalized]
+
+        raise ValueError(f"Type {name} not found in the debug info.")
+
+    def _build(self: DwarfTypeTable, offset: int) -> DwarfType:
+        """Builds the type described by the DIE at the specified offset."""
+        if offset in self._types:
+            return self._types[offset]
+
+        record = self._records.get(offset)
+        if record is None:
+            raise ValueError(f"Invalid reference to the type at offset {offset:#x} of the debug info.")
+
+        _, type_reference, _, name, size, _, tag, encoding, _, _, declaration = record
+        kind = TYPE_KINDS.get(tag, "unspecified")
+
+        # Forward declarations are replaced by the definition, if any, which can live in another compilation unit
+        if declaration and kind in TAGGED_KINDS and name:
+            definition = self._names.get(f"{kind} {name}", offset)
+
+            if definition != offset:
+                dwarf_type = self._build(definition)
+                self._types[offset] = dwarf_type
+                return dwarf_type
+
+        dwarf_type = DwarfType(kind, name, size, encoding=encoding)
+
+        # Register the type before its references are built, as types can be recursive
+        self._types[offset] = dwarf_type
+
+        if type_reference:
+            dwarf_type.target = self._build(type_reference)
+
+        children = [self._records[child] for child in self._children.get(offset, [])]
+
+        if kind in ("struct", "union", "class"):
+            dwarf_type.fields = [
+                DwarfField(child[3], child[5], self._build(child[1]), child[8], child[9])
+                for child in children
+                if child[6] == TAG_MEMBER and not child[10] and child[1]
+            ]
+        elif kind == "enum":
+            dwarf_type.enumerators = {child[5]: child[3] for child in children if child[6] == TAG_ENUMERATOR}
+        elif kind == "array":
+            dimensions = [child[5] for child in children if child[6] == TAG_SUBRANGE] or [0]
+
+            element = dwarf_type.target
+            for dimension in reversed(dimensions[1:]):
+                element = self.array_of(element, dimension)
+
+            dwarf_type.target = element
+            dwarf_type.count = dimensions[0]
+            dwarf_type.size = element.size * dwarf_type.count if element is not None else 0
+        elif kind == "pointer" and not size:
+            dwarf_type.size = self._pointer_size
+
+        if not dwarf_type.size and kind in (*QUALIFIER_KINDS, "enum") and dwarf_type.target is not None:
+            dwarf_type.size = dwarf_type.target.size
+
+        return dwarf_type
+
+    def __len__(self: DwarfTypeTable) -> int:
+        """Returns the number of named types."""
+        return len(self._names)
+
+    def __contains__(self: DwarfTypeTable, name: str) -> bool:
+        """Returns whether the table describes a type with the specified name."""
+        try:
+            self.lookup(name)
+        except ValueError:
+            return False
+
+        return True
+
+
+def normalize_base_name(name: str) -> tuple[str, ...]:
+    """Returns the canonical spelling of the name of a base type, e.g., "unsigned long" for "long unsigned int"."""
+    words = name.split()
+
+    if len(words) > 1 and "int" in words:
+        words.remove("int")
+
+    return tuple(sorted(words))
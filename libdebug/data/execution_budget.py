@@ -0,0 +1,77 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+
+# The kinds of budget, in the order used by the native code
+BUDGET_KINDS = ("wall_time", "cpu_time", "syscalls", "breakpoint_hits")
+
+
+@dataclass
+class BudgetUsage:
+    """The resources used by the process since the budget was set.
+
+    Attributes:
+        wall_time (float): The elapsed real time, in seconds.
+        cpu_time (float): The CPU time used by all the threads of the process, in seconds.
+        syscalls (int): The number of syscalls entered.
+        breakpoint_hits (int): The number of breakpoints hit, including the hardware ones and the native callbacks.
+    """
+
+    wall_time: float
+    cpu_time: float
+    syscalls: int
+    breakpoint_hits: int
+
+
+@dataclass
+class ExecutionBudget:
+    """The resources a run of the process can use before it is interrupted.
+
+    The limits are enforced natively while the process runs: a watchdog thread stops the process when a time limit
+    expires, and the syscalls and the breakpoint hits are counted as the stops are collected. When any limit is
+    exceeded, the process is stopped, whatever the breakpoints and the handlers would have done, and the budget is
+    disarmed.
+
+    Attributes:
+        wall_time (float | None): The seconds of real time, since the budget was set.
+        cpu_time (float | None): The seconds of CPU time used by the process, since the budget was set.
+        syscalls (int | None): The number of syscalls the process can enter. The next one is interrupted on its entry.
+        breakpoint_hits (int | None): The number of breakpoints the process can hit. The next hit is handled, and the
+        process stops right after.
+        exhausted (str | None): The limit that interrupted the run, i.e., "wall_time", "cpu_time", "syscalls" or
+        "breakpoint_hits", None if the process is still within the budget.
+    """
+
+    wall_time: float | None = None
+    cpu_time: float | None = None
+    syscalls: int | None = None
+    breakpoint_hits: int | None = None
+    exhausted: str | None = None
+
+    _final_usage: BudgetUsage | None = None
+
+    def usage(self: ExecutionBudget) -> BudgetUsage:
+        """Returns the resources used by the process since the budget was set, until it was exhausted."""
+        if self._final_usage is not None:
+            return self._final_usage
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_budget_usage()
+
+    def _freeze(self: ExecutionBudget, usage: BudgetUsage) -> None:
+        """Keeps the final usage of the budget, once the native one is released."""
+        self._final_usage = usage
+
+    def __hash__(self: ExecutionBudget) -> int:
+        """Return the hash of the budget. There is at most one budget per process."""
+        return id(self)
@@ -0,0 +1,80 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+
+
+@dataclass
+class FdInfo:
+    """An open file descriptor of the process.
+
+    Attributes:
+        fd (int): The number of the file descriptor.
+        path (str): The target of the file descriptor, as in /proc/pid/fd, e.g., "/etc/passwd" or "socket:[1234]".
+    """
+
+    fd: int
+    path: str
+
+    @property
+    def kind(self: FdInfo) -> str:
+        """The kind of the file descriptor: "file", "socket", "pipe" or "anon_inode", e.g., for an eventfd."""
+        for kind in ("socket", "pipe", "anon_inode"):
+            if self.path.startswith(f"{kind}:"):
+                return kind
+
+        return "file"
+
+
+@dataclass
+class FdTracker:
+    """The tracker of the file descriptors of the target process.
+
+    The file descriptors are read from /proc once, and a native table is then kept up to date from the results of the
+    syscalls that create and close them, so that each lookup is served without reading /proc.
+
+    Attributes:
+        enabled (bool): Whether the tracker is enabled or not.
+    """
+
+    enabled: bool = True
+
+    def enable(self: FdTracker) -> None:
+        """Enable the tracker. The file descriptors are read from /proc again."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        self.enabled = True
+        internal_debugger.debugging_interface.set_fd_tracker(self)
+
+    def disable(self: FdTracker) -> None:
+        """Disable the tracker. The lookups read /proc again."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        self.enabled = False
+        internal_debugger.debugging_interface.set_fd_tracker(self)
+
+    def refresh(self: FdTracker) -> None:
+        """Reads the file descriptors from /proc again, e.g., after they were passed in ways the tracker misses."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+        internal_debugger.debugging_interface.refresh_fd_table()
+
+    def fds(self: FdTracker) -> dict[int, FdInfo]:
+        """Returns the open file descriptors of the process, by number."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_fd_table()
+
+    def __hash__(self: FdTracker) -> int:
+        """Return the hash of the tracker. There is at most one tracker per process."""
+        return id(self)
@@ -0,0 +1,147 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+from libdebug.utils.print_style import PrintStyle
+
+
+@dataclass
+class TracedCall:
+    """A call to a traced function.
+
+    Attributes:
+        thread_id (int): The thread that performed the call.
+        function (str): The name of the called function.
+        args (list[int]): The arguments of the call.
+        return_value (int | None): The return value, None if the call did not return.
+        timestamp (float): The monotonic time of the call, in seconds.
+        duration (float | None): The duration of the call, in seconds. None if the call did not return.
+    """
+
+    thread_id: int
+    function: str
+    args: list[int]
+    return_value: int | None
+    timestamp: float
+    duration: float | None
+
+    def __repr__(self: TracedCall) -> str:
+        """Return the ltrace-like representation of the call."""
+        args = ", ".join(hex(arg) for arg in self.args)
+
+        if self.return_value is None:
+            return f"[{self.thread_id}] {self.function}({args}) <unfinished>"
+
+        return f"[{self.thread_id}] {self.function}({args}) = {self.return_value:#x} <{self.duration:.6f}>"
+
+
+@dataclass
+class TracedFunctionStats:
+    """The statistics of a traced function.
+
+    Attributes:
+        function (str): The name of the function.
+        calls (int): The number of calls to the function.
+        returns (int): The number of calls that returned.
+        total_time (float): The total time spent in the calls that returned, in seconds.
+        min_time (float): The duration of the shortest call, in seconds.
+        max_time (float): The duration of the longest call, in seconds.
+    """
+
+    function: str
+    calls: int
+    returns: int
+    total_time: float
+    min_time: float
+    max_time: float
+
+    @property
+    def average_time(self: TracedFunctionStats) -> float:
+        """The average duration of the calls that returned, in seconds."""
+        return self.total_time / self.returns if self.returns else 0.0
+
+
+@dataclass
+class FunctionTracer:
+    """The function tracer of the target process.
+
+    The entry points of the traced functions are trapped natively: the arguments of each call are captured
+    together with the return value and the duration of the call, and are stored in a native ring buffer that is
+    drained every time the process stops.
+
+    Attributes:
+        functions (dict[int, str]): The traced functions. Key: the entry point of the function.
+        args (int): The number of arguments captured for each call.
+        capture_return (bool): Whether the return value and the duration of each call are captured.
+        buffer_size (int): The size of the native ring buffer.
+        calls (list[TracedCall]): The calls traced so far, in order of completion.
+        dropped (int): The number of calls lost because the native ring buffer was full.
+        enabled (bool): Whether the tracer is enabled or not.
+    """
+
+    functions: dict[int, str] = field(default_factory=dict)
+    args: int = 0
+    capture_return: bool = True
+    buffer_size: int = 65536
+    calls: list[TracedCall] = field(default_factory=list)
+    dropped: int = 0
+    enabled: bool = True
+
+    _changed: bool = False
+
+    def enable(self: FunctionTracer) -> None:
+        """Enable the tracer."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = True
+        self._changed = True
+
+    def disable(self: FunctionTracer) -> None:
+        """Disable the tracer. The pending calls are reported as unfinished."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = False
+        self._changed = True
+
+    def stats(self: FunctionTracer) -> dict[str, TracedFunctionStats]:
+        """Returns the call count and latency statistics of each traced function.
+
+        The statistics are collected natively, so they also account for the calls lost when the ring buffer is full.
+        """
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_traced_function_stats()
+
+    def pprint(self: FunctionTracer) -> None:
+        """Prints the traced calls, in a ltrace-like format."""
+        for call in self.calls:
+            color = PrintStyle.GREEN if call.return_value is not None else PrintStyle.YELLOW
+            print(f"{color}{call!r}{PrintStyle.RESET}")
+
+        if self.dropped:
+            print(f"{PrintStyle.RED}... {self.dropped} calls lost{PrintStyle.RESET}")
+
+    def pprint_stats(self: FunctionTracer) -> None:
+        """Prints the call count and latency statistics of each traced function, sorted by total time."""
+        stats = sorted(self.stats().values(), key=lambda entry: entry.total_time, reverse=True)
+
+        print(f"{'calls':>10} {'total (s)':>12} {'avg (us)':>10} {'min (us)':>10} {'max (us)':>10}  function")
+
+        for entry in stats:
+            if not entry.calls:
+                continue
+
+            print(
+                f"{entry.calls:>10} {entry.total_time:>12.6f} {entry.average_time * 1e6:>10.1f} "
+                f"{entry.min_time * 1e6:>10.1f} {entry.max_time * 1e6:>10.1f}  {entry.function}",
+            )
+
+    def __hash__(self: FunctionTracer) -> int:
+        """Return the hash of the tracer. There is at most one tracer per process."""
+        return id(self)
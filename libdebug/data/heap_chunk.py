@@ -0,0 +1,196 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import struct
+from collections.abc import Iterator, Sequence
+from dataclasses import dataclass
+
+# The flags of a chunk, as reported by the native heap walker
+CHUNK_PREV_INUSE = 0x1
+CHUNK_IS_MMAPPED = 0x2
+CHUNK_NON_MAIN_ARENA = 0x4
+CHUNK_IN_USE = 0x8
+CHUNK_TOP = 0x10
+
+CHUNK_BIN_KINDS = {
+    0x20: "tcache",
+    0x40: "fastbin",
+    0x80: "unsorted",
+    0x100: "smallbin",
+    0x200: "largebin",
+}
+
+CORRUPTION_KINDS = {
+    1: "invalid chunk size",
+    2: "top chunk not found",
+    3: "bin entry is not a chunk",
+    4: "loop in bin",
+    5: "chunk in multiple bins",
+    6: "broken bin links",
+    7: "chunk size does not match bin",
+    8: "prev_size does not match the size of the free chunk",
+    9: "PREV_INUSE set after a free chunk",
+    10: "free chunk not in any bin",
+    11: "tcache count does not match the bin",
+    12: "bin pointer outside of the heap",
+}
+
+# The layout of the native chunk structure
+CHUNK_STRUCT = struct.Struct("<QQIi")
+
+
+@dataclass(frozen=True)
+class HeapChunk:
+    """A chunk of the glibc heap.
+
+    Attributes:
+        address (int): The address of the chunk header.
+        size (int): The size of the chunk, without the flag bits.
+        flags (int): The flags of the chunk, the lowest three bits being the ones of the size field.
+        bin (int): The index of the bin the chunk is in, -1 if it is not in any bin.
+    """
+
+    address: int
+    size: int
+    flags: int
+    bin: int
+
+    @property
+    def user_address(self: HeapChunk) -> int:
+        """The address returned by the allocator for this chunk."""
+        return self.address + 0x10
+
+    @property
+    def in_use(self: HeapChunk) -> bool:
+        """Whether the chunk is allocated."""
+        return bool(self.flags & CHUNK_IN_USE)
+
+    @property
+    def prev_inuse(self: HeapChunk) -> bool:
+        """Whether the PREV_INUSE bit is set."""
+        return bool(self.flags & CHUNK_PREV_INUSE)
+
+    @property
+    def is_mmapped(self: HeapChunk) -> bool:
+        """Whether the IS_MMAPPED bit is set."""
+        return bool(self.flags & CHUNK_IS_MMAPPED)
+
+    @property
+    def non_main_arena(self: HeapChunk) -> bool:
+        """Whether the NON_MAIN_ARENA bit is set."""
+        return bool(self.flags & CHUNK_NON_MAIN_ARENA)
+
+    @property
+    def is_top(self: HeapChunk) -> bool:
+        """Whether the chunk is the top chunk of the arena."""
+        return bool(self.flags & CHUNK_TOP)
+
+    @property
+    def bin_kind(self: HeapChunk) -> str | None:
+        """The kind of bin the chunk is in (tcache, fastbin, unsorted, smallbin or largebin), if any."""
+        for flag, kind in CHUNK_BIN_KINDS.items():
+            if self.flags & flag:
+                return kind
+
+        return None
+
+    def __contains__(self: HeapChunk, address: int) -> bool:
+        """Returns whether the address belongs to the chunk."""
+        return self.address <= address < self.address + self.size
+
+    def __repr__(self: HeapChunk) -> str:
+        """Return the string representation of the chunk."""
+        if self.is_top:
+            state = "top"
+        elif self.bin_kind is not None:
+            state = f"{self.bin_kind}[{self.bin}]"
+        else:
+            state = "in use" if self.in_use else "free"
+
+        return f"HeapChunk({self.address:#x}, size={self.size:#x}, {state})"
+
+
+class HeapChunkList(Sequence):
+    """The chunks of a heap, sorted by address.
+
+    The chunks are kept in the compact array produced by the native heap walker, and are unpacked on access.
+    """
+
+    def __init__(self: HeapChunkList, buffer: bytes) -> None:
+        """Initializes the list from the native array of chunks."""
+        self._buffer = buffer
+
+    def __len__(self: HeapChunkList) -> int:
+        """Returns the number of chunks."""
+        return len(self._buffer) // CHUNK_STRUCT.size
+
+    def __getitem__(self: HeapChunkList, index: int | slice) -> HeapChunk | list[HeapChunk]:
+        """Returns the chunk at the specified index, or a list of chunks for a slice."""
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(len(self)))]
+
+        if index < 0:
+            index += len(self)
+
+        if not 0 <= index < len(self):
+            raise IndexError("Chunk index out of range.")
+
+        return HeapChunk(*CHUNK_STRUCT.unpack_from(self._buffer, index * CHUNK_STRUCT.size))
+
+    def __iter__(self: HeapChunkList) -> Iterator[HeapChunk]:
+        """Iterates over the chunks."""
+        for fields in CHUNK_STRUCT.iter_unpack(self._buffer):
+            yield HeapChunk(*fields)
+
+    def find(self: HeapChunkList, address: int) -> HeapChunk | None:
+        """Returns the chunk containing the specified address, if any.
+
+        Args:
+            address (int): The address to look up.
+        """
+        low, high = 0, len(self) - 1
+
+        while low <= high:
+            middle = (low + high) // 2
+            start, size, _, _ = CHUNK_STRUCT.unpack_from(self._buffer, middle * CHUNK_STRUCT.size)
+
+            if address < start:
+                high = middle - 1
+            elif address >= start + size:
+                low = middle + 1
+            else:
+                return self[middle]
+
+        return None
+
+
+@dataclass(frozen=True)
+class HeapCorruption:
+    """An inconsistency found while walking the glibc heap.
+
+    Attributes:
+        code (int): The code of the inconsistency.
+        address (int): The address of the offending chunk, or of the offending bin entry.
+        value (int): The offending value (e.g., the size field of the chunk), if any.
+        bin (int): The index of the bin where the inconsistency was found, -1 if not related to a bin.
+    """
+
+    code: int
+    address: int
+    value: int
+    bin: int
+
+    @property
+    def kind(self: HeapCorruption) -> str:
+        """The description of the inconsistency."""
+        return CORRUPTION_KINDS.get(self.code, "unknown")
+
+    def __repr__(self: HeapCorruption) -> str:
+        """Return the string representation of the inconsistency."""
+        location = f" (bin {self.bin})" if self.bin >= 0 else ""
+        return f"HeapCorruption({self.kind} at {self.address:#x}{location}, value={self.value:#x})"
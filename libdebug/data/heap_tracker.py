@@ -0,0 +1,193 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+from libdebug.utils.print_style import PrintStyle
+
+
+@dataclass
+class HeapAllocation:
+    """A live allocation tracked by the heap tracker.
+
+    Attributes:
+        address (int): The address returned by the allocator.
+        size (int): The requested size.
+        thread_id (int): The thread that performed the allocation.
+        pc (int): The return address of the allocation call, i.e., the allocation site.
+        backtrace (list[int]): The return addresses of the callers of the allocation site, innermost first.
+        mmap (bool): Whether the allocation is a memory mapping instead of a heap chunk.
+    """
+
+    address: int
+    size: int
+    thread_id: int
+    pc: int
+    backtrace: list[int] = field(default_factory=list)
+    mmap: bool = False
+
+    def __contains__(self: HeapAllocation, address: int) -> bool:
+        """Returns whether the address belongs to the allocation."""
+        return self.address <= address < self.address + self.size
+
+    def __repr__(self: HeapAllocation) -> str:
+        """Return the string representation of the allocation."""
+        kind = "mmap" if self.mmap else "chunk"
+        return f"HeapAllocation({kind} {self.address:#x}, size={self.size:#x}, thread={self.thread_id}, pc={self.pc:#x})"
+
+
+@dataclass
+class HeapStats:
+    """The statistics of the heap tracker.
+
+    Attributes:
+        allocations (int): The number of allocations performed.
+        frees (int): The number of allocations released.
+        invalid_frees (int): The number of releases of pointers that were not allocated (e.g., double frees).
+        live_count (int): The number of live allocations.
+        live_bytes (int): The number of bytes in the live allocations.
+        peak_bytes (int): The maximum number of bytes allocated at the same time.
+        mmap_count (int): The number of live memory mappings.
+        mmap_bytes (int): The number of bytes in the live memory mappings.
+        brk_start (int): The start of the heap segment grown through sbrk, 0 if unknown.
+        brk_end (int): The end of the heap segment grown through sbrk, 0 if unknown.
+    """
+
+    allocations: int
+    frees: int
+    invalid_frees: int
+    live_count: int
+    live_bytes: int
+    peak_bytes: int
+    mmap_count: int
+    mmap_bytes: int
+    brk_start: int
+    brk_end: int
+
+
+@dataclass
+class HeapTracker:
+    """The heap tracker of the target process.
+
+    The allocator functions are trapped natively, and a table of the live allocations is kept in the native core,
+    together with the allocation site of each of them. When the process is gone, the tracker keeps the allocations
+    that were still live at exit, i.e., the leaks.
+
+    Attributes:
+        functions (dict[int, str]): The trapped allocator functions. Key: the entry point of the function.
+        backtrace (int): The number of callers recorded for each allocation, besides the allocation site.
+        report_on_exit (bool): Whether the leak report is printed when the process exits.
+        enabled (bool): Whether the tracker is enabled or not.
+    """
+
+    functions: dict[int, str] = field(default_factory=dict)
+    backtrace: int = 0
+    report_on_exit: bool = False
+    enabled: bool = True
+
+    _changed: bool = False
+
+    _final_allocations: list[HeapAllocation] | None = None
+    _final_stats: HeapStats | None = None
+
+    def enable(self: HeapTracker) -> None:
+        """Enable the tracker."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = True
+        self._changed = True
+
+    def disable(self: HeapTracker) -> None:
+        """Disable the tracker. The allocations performed while disabled are not tracked."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = False
+        self._changed = True
+
+    def stats(self: HeapTracker) -> HeapStats:
+        """Returns the statistics of the heap tracker."""
+        if self._final_stats is not None:
+            return self._final_stats
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_heap_stats()
+
+    def allocations(self: HeapTracker) -> list[HeapAllocation]:
+        """Returns the live allocations, sorted by address."""
+        if self._final_allocations is not None:
+            return self._final_allocations
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_heap_allocations()
+
+    def owner(self: HeapTracker, address: int) -> HeapAllocation | None:
+        """Returns the live allocation containing the specified address, if any.
+
+        Args:
+            address (int): The address to look up. Pointers inside the allocation are allowed.
+        """
+        if self._final_allocations is not None:
+            return next((allocation for allocation in self._final_allocations if address in allocation), None)
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.find_heap_allocation(address)
+
+    def live_bytes_by_call_site(self: HeapTracker) -> dict[int, int]:
+        """Returns the number of live bytes allocated by each allocation site, largest first."""
+        sites = {}
+
+        for allocation in self.allocations():
+            if not allocation.mmap:
+                sites[allocation.pc] = sites.get(allocation.pc, 0) + allocation.size
+
+        return dict(sorted(sites.items(), key=lambda site: site[1], reverse=True))
+
+    def pprint_report(self: HeapTracker, top: int = 10) -> None:
+        """Prints the live allocations grouped by allocation site. At exit, these are the leaks.
+
+        Args:
+            top (int, optional): The number of allocation sites to print. Defaults to 10.
+        """
+        stats = self.stats()
+        allocations = [allocation for allocation in self.allocations() if not allocation.mmap]
+
+        print(
+            f"{PrintStyle.BLUE}{stats.live_bytes} bytes in {stats.live_count} allocations still live "
+            f"({stats.allocations} allocations, {stats.frees} frees, peak {stats.peak_bytes} bytes){PrintStyle.RESET}",
+        )
+
+        if stats.invalid_frees:
+            print(f"{PrintStyle.RED}{stats.invalid_frees} frees of untracked pointers{PrintStyle.RESET}")
+
+        sites = {}
+        for allocation in allocations:
+            sites.setdefault(allocation.pc, []).append(allocation)
+
+        ranked = sorted(sites.items(), key=lambda site: sum(a.size for a in site[1]), reverse=True)
+
+        for pc, site_allocations in ranked[:top]:
+            size = sum(allocation.size for allocation in site_allocations)
+            print(f"{PrintStyle.YELLOW}{size} bytes in {len(site_allocations)} allocations from {pc:#x}{PrintStyle.RESET}")
+
+            backtrace = site_allocations[0].backtrace
+            for return_address in backtrace:
+                print(f"    called from {return_address:#x}")
+
+    def _freeze(self: HeapTracker, allocations: list[HeapAllocation], stats: HeapStats) -> None:
+        """Keeps the final state of the tracker, once the native one is released."""
+        self._final_allocations = allocations
+        self._final_stats = stats
+
+    def __hash__(self: HeapTracker) -> int:
+        """Return the hash of the tracker. There is at most one tracker per process."""
+        return id(self)
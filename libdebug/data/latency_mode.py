@@ -0,0 +1,27 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+
+@dataclass
+class LatencyMode:
+    """The placement of the debugger and of the process on the CPUs, chosen to reduce the latency of the stops.
+
+    Attributes:
+        policy (str): "same-core" runs the polling thread and the process on the same CPU, "sibling-core" on two
+        CPUs sharing the same physical core, or at least the same package.
+        tracer_cpu (int): The CPU of the polling thread of the debugger.
+        tracee_cpu (int): The CPU of the threads of the process.
+        spin_time (float): The seconds the polling thread busy-waits for a stop before sleeping.
+    """
+
+    policy: str
+    tracer_cpu: int
+    tracee_cpu: int
+    spin_time: float = 0.0
@@ -0,0 +1,51 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+
+@dataclass
+class LockstepState:
+    """The state of a process at the last step of a lockstep.
+
+    Attributes:
+        registers (dict[str, int]): The values of the compared registers.
+        memory (list[bytes]): The content of the compared memory ranges, in the order they were given. The unreadable
+            ranges are filled with zeroes.
+    """
+
+    registers: dict[str, int]
+    memory: list[bytes]
+
+
+@dataclass
+class LockstepResult:
+    """The result of the lockstep of two processes.
+
+    Attributes:
+        outcome (str): Why the lockstep stopped: "diverged" at the first divergence, "max_steps" once the steps were
+            taken, "exited" when both processes exited, "event" when both reported a ptrace event, e.g., a new thread.
+        steps (int): The number of steps both processes took.
+        first (LockstepState): The state of the first process at the last step.
+        second (LockstepState): The state of the second process at the last step.
+        registers (dict[str, tuple[int, int]]): The registers that differ, with the values in the first and in the
+            second process.
+        memory (list[int]): The indices of the memory ranges that differ.
+    """
+
+    outcome: str
+    steps: int
+    first: LockstepState
+    second: LockstepState
+    registers: dict[str, tuple[int, int]]
+    memory: list[int]
+
+    @property
+    def diverged(self: LockstepResult) -> bool:
+        """Whether the processes diverged."""
+        return self.outcome == "diverged"
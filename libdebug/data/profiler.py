@@ -0,0 +1,183 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import TYPE_CHECKING
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+from libdebug.utils.debugging_utils import resolve_address_in_maps
+from libdebug.utils.pprof_utils import encode_pprof
+
+if TYPE_CHECKING:
+    from libdebug.data.memory_map import MemoryMap
+
+
+@dataclass
+class ProfiledStack:
+    """A stack collected by the profiler.
+
+    Attributes:
+        thread_id (int): The thread the stack belongs to.
+        frames (list[int]): The program counter, followed by the return addresses of the callers, innermost first.
+        count (int): The number of samples that collected this stack.
+    """
+
+    thread_id: int
+    frames: list[int]
+    count: int
+
+
+@dataclass
+class ProfilerStats:
+    """The statistics of the profiler.
+
+    Attributes:
+        samples (int): The number of times the threads of the process were sampled.
+        requested (int): The number of stops requested by the timer of the profiler.
+        missed (int): The number of timer ticks skipped because the previous stop was still pending.
+        truncated (int): The number of stacks truncated at the maximum depth.
+    """
+
+    samples: int
+    requested: int
+    missed: int
+    truncated: int
+
+
+@dataclass
+class Profiler:
+    """The sampling profiler of the target process.
+
+    A native timer stops the process at the configured frequency while it runs: at each stop, the stacks of all
+    threads are unwound natively through the frame pointers, counted in a native table, and the process is resumed
+    immediately.
+
+    Attributes:
+        frequency (int): The sampling frequency, in Hz.
+        max_depth (int): The maximum number of frames collected for each stack.
+        enabled (bool): Whether the profiler is enabled or not.
+    """
+
+    frequency: int = 99
+    max_depth: int = 64
+    enabled: bool = True
+
+    _changed: bool = False
+
+    _maps: list[MemoryMap] = field(default_factory=list)
+    _final_stacks: list[ProfiledStack] | None = None
+    _final_stats: ProfilerStats | None = None
+
+    def enable(self: Profiler) -> None:
+        """Enable the profiler."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = True
+        self._changed = True
+
+    def disable(self: Profiler) -> None:
+        """Disable the profiler. The collected samples are kept."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = False
+        self._changed = True
+
+    def reset(self: Profiler) -> None:
+        """Discards the collected samples."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+        internal_debugger.debugging_interface.reset_profiler()
+
+    def stats(self: Profiler) -> ProfilerStats:
+        """Returns the statistics of the profiler."""
+        if self._final_stats is not None:
+            return self._final_stats
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_profiler_stats()
+
+    def stacks(self: Profiler) -> list[ProfiledStack]:
+        """Returns the stacks collected so far, with their sample count."""
+        if self._final_stacks is not None:
+            return self._final_stacks
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_profiled_stacks()
+
+    def folded(self: Profiler, threads: bool = False) -> str:
+        """Returns the collected stacks in the folded format used by flame graph tools.
+
+        Args:
+            threads (bool, optional): Whether to keep the stacks of each thread separated, with the thread ID as the
+            outermost frame. Defaults to False.
+        """
+        counts = {}
+        cache = {}
+
+        for stack in self.stacks():
+            names = list(reversed(self._symbolize(stack.frames, cache)))
+
+            if threads:
+                names.insert(0, f"thread-{stack.thread_id}")
+
+            line = ";".join(names)
+            counts[line] = counts.get(line, 0) + stack.count
+
+        return "".join(f"{line} {count}\n" for line, count in sorted(counts.items()))
+
+    def write_folded(self: Profiler, path: str, threads: bool = False) -> None:
+        """Writes the collected stacks to a file, in the folded format used by flame graph tools.
+
+        Args:
+            path (str): The path of the file.
+            threads (bool, optional): Whether to keep the stacks of each thread separated. Defaults to False.
+        """
+        Path(path).write_text(self.folded(threads))
+
+    def write_pprof(self: Profiler, path: str) -> None:
+        """Writes the collected stacks to a file, in the gzipped protobuf format of pprof.
+
+        Args:
+            path (str): The path of the file.
+        """
+        cache = {}
+        samples = [
+            (stack.frames, self._symbolize(stack.frames, cache), stack.thread_id, stack.count)
+            for stack in self.stacks()
+        ]
+
+        Path(path).write_bytes(encode_pprof(samples, 1_000_000_000 // self.frequency))
+
+    def _symbolize(self: Profiler, frames: list[int], cache: dict[int, str]) -> list[str]:
+        """Resolves the functions of the frames of a stack, innermost first."""
+        names = []
+
+        for index, address in enumerate(frames):
+            # Return addresses point after the call, which might be the start of the next function
+            if index:
+                address -= 1
+
+            if address not in cache:
+                symbol = resolve_address_in_maps(address, self._maps)
+                cache[address] = symbol.rpartition("+")[0] or symbol
+
+            names.append(cache[address])
+
+        return names
+
+    def _freeze(self: Profiler, stacks: list[ProfiledStack], stats: ProfilerStats) -> None:
+        """Keeps the final state of the profiler, once the native one is released."""
+        self._final_stacks = stacks
+        self._final_stats = stats
+
+    def __hash__(self: Profiler) -> int:
+        """Return the hash of the profiler. There is at most one profiler per process."""
+        return id(self)
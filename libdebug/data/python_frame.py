@@ -0,0 +1,38 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+
+@dataclass(frozen=True)
+class PythonFrame:
+    """A frame of the Python code executed by a CPython interpreter.
+
+    Attributes:
+        function (str): The qualified name of the function.
+        filename (str): The file the function is defined in.
+        line (int): The line being executed, -1 if unknown.
+        code_address (int): The address of the code object.
+        frame_address (int): The address of the interpreter frame.
+        entry (bool): Whether the frame is the first one executed by its call to the evaluation loop.
+    """
+
+    function: str
+    filename: str
+    line: int
+    code_address: int
+    frame_address: int
+    entry: bool = False
+
+    def __str__(self: PythonFrame) -> str:
+        """Return the frame as a traceback entry."""
+        return f"{self.function} ({self.filename}:{self.line})"
+
+    def __repr__(self: PythonFrame) -> str:
+        """Return the string representation of the frame."""
+        return f"PythonFrame({self.function}, {self.filename}:{self.line}, frame={self.frame_address:#x})"
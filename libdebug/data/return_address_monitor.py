@@ -0,0 +1,110 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+
+if TYPE_CHECKING:
+    from collections.abc import Callable
+
+    from libdebug.state.thread_context import ThreadContext
+
+
+@dataclass
+class ReturnAddressViolation:
+    """A corrupted return address (or stack canary) detected by the return address monitor.
+
+    Attributes:
+        thread_id (int): The thread that was about to use the corrupted value.
+        function (str): The symbol of the function owning the corrupted frame.
+        function_address (int): The entry point of the function owning the corrupted frame.
+        address (int): The address of the return instruction (or of the stack check failure handler) where the
+        corruption was detected.
+        slot (int): The address of the corrupted stack slot, 0 if unknown.
+        expected (int): The value recorded when the function was entered.
+        actual (int): The value found when the function returned.
+        canary (bool): Whether the corruption was detected on the stack canary instead of the return address.
+    """
+
+    thread_id: int
+    function: str
+    function_address: int
+    address: int
+    slot: int
+    expected: int
+    actual: int
+    canary: bool = False
+
+    def __repr__(self: ReturnAddressViolation) -> str:
+        """Return the string representation of the violation."""
+        kind = "Stack canary" if self.canary else "Return address"
+        return (
+            f"{kind} of {self.function} corrupted at {self.address:#x} in thread {self.thread_id}: "
+            f"slot {self.slot:#x}, expected {self.expected:#x}, found {self.actual:#x}"
+        )
+
+
+@dataclass
+class ReturnAddressMonitor:
+    """The return address monitor of the target process.
+
+    The monitor keeps a native shadow stack for each thread: every monitored function records its return address
+    when it is entered, and the value is compared when the function returns. Clean returns never leave the native
+    code, while a mismatch stops the process on the return instruction.
+
+    Attributes:
+        functions (dict[int, str]): The monitored functions. Key: the entry point of the function.
+        canary (bool): Whether the failures of the stack canary check are reported as violations.
+        callback (Callable[[ThreadContext, ReturnAddressViolation], None]): The callback defined by the user to
+        execute when a violation is detected.
+        violations (list[ReturnAddressViolation]): The violations detected so far.
+        hit_count (int): The number of violations detected so far.
+        enabled (bool): Whether the monitor is enabled or not.
+    """
+
+    functions: dict[int, str] = field(default_factory=dict)
+    canary: bool = False
+    callback: None | Callable[[ThreadContext, ReturnAddressViolation], None] = None
+    violations: list[ReturnAddressViolation] = field(default_factory=list)
+    hit_count: int = 0
+    enabled: bool = True
+
+    _changed: bool = False
+
+    def enable(self: ReturnAddressMonitor) -> None:
+        """Enable the monitor."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = True
+        self._changed = True
+
+    def disable(self: ReturnAddressMonitor) -> None:
+        """Disable the monitor. The shadow stacks are discarded."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = False
+        self._changed = True
+
+    @property
+    def last_violation(self: ReturnAddressMonitor) -> ReturnAddressViolation | None:
+        """The last violation detected by the monitor, if any."""
+        return self.violations[-1] if self.violations else None
+
+    def hit_on(self: ReturnAddressMonitor, thread_context: ThreadContext) -> bool:
+        """Returns whether the monitor stopped the given thread context on a violation."""
+        violation = self.last_violation
+        return (
+            self.enabled
+            and violation is not None
+            and violation.thread_id == thread_context.thread_id
+            and thread_context.instruction_pointer == violation.address
+        )
+
+    def __hash__(self: ReturnAddressMonitor) -> int:
+        """Return the hash of the monitor. There is at most one monitor per process."""
+        return id(self)
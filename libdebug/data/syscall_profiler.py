@@ -0,0 +1,166 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+
+
+@dataclass
+class SyscallStats:
+    """The latencies of a syscall, measured by the syscall profiler.
+
+    Attributes:
+        syscall (str): The name of the syscall.
+        number (int): The number of the syscall.
+        thread_id (int | None): The thread that executed the syscall, None if the threads are merged.
+        call_site (int | None): The address the syscall returned to, None if the call sites are merged or not
+            collected.
+        count (int): The number of completed calls.
+        errors (int): The number of calls that returned an error.
+        total_time (float): The seconds spent in the syscall.
+        min_time (float): The shortest call, in seconds.
+        max_time (float): The longest call, in seconds.
+        histogram (list[int]): The number of calls for each bucket of latency: the bucket i counts the calls that
+            lasted between 2^i and 2^(i + 1) nanoseconds, the last one counts the longer calls as well.
+    """
+
+    syscall: str
+    number: int
+    thread_id: int | None
+    call_site: int | None
+    count: int
+    errors: int
+    total_time: float
+    min_time: float
+    max_time: float
+    histogram: list[int]
+
+    @property
+    def mean_time(self: SyscallStats) -> float:
+        """The mean duration of a call, in seconds."""
+        return self.total_time / self.count if self.count else 0.0
+
+    def percentile(self: SyscallStats, percentile: float) -> float:
+        """Estimates a percentile of the duration of the calls, from the histogram.
+
+        Args:
+            percentile (float): The percentile, between 0 and 100.
+
+        Returns:
+            float: The upper bound of the bucket of the percentile, in seconds, capped by the longest call.
+        """
+        if not 0 <= percentile <= 100:
+            raise ValueError("The percentile must be between 0 and 100.")
+
+        target = self.count * percentile / 100
+        seen = 0
+
+        for bucket, count in enumerate(self.histogram):
+            seen += count
+
+            if count and seen >= target:
+                return min(2 ** (bucket + 1) / 1e9, self.max_time)
+
+        return self.max_time
+
+    def _merge(self: SyscallStats, other: SyscallStats) -> None:
+        """Adds the calls of another entry of the same syscall."""
+        self.min_time = min(self.min_time, other.min_time) if self.count else other.min_time
+        self.max_time = max(self.max_time, other.max_time)
+        self.count += other.count
+        self.errors += other.errors
+        self.total_time += other.total_time
+        self.histogram = [a + b for a, b in zip(self.histogram, other.histogram, strict=True)]
+
+
+@dataclass
+class SyscallProfiler:
+    """The syscall profiler of the target process.
+
+    The entry and the exit stops of the syscalls are timestamped natively, and the latency of each call is accounted
+    to a native table, per syscall, per thread and optionally per call site, without any Python code in the loop.
+
+    Attributes:
+        call_sites (bool): Whether the calls are also accounted per call site.
+        enabled (bool): Whether the profiler is enabled or not.
+    """
+
+    call_sites: bool = False
+    enabled: bool = True
+
+    _changed: bool = False
+    _final_syscalls: list[SyscallStats] | None = None
+
+    def enable(self: SyscallProfiler) -> None:
+        """Enable the syscall profiler."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = True
+        self._changed = True
+
+    def disable(self: SyscallProfiler) -> None:
+        """Disable the syscall profiler. The collected latencies are kept."""
+        provide_internal_debugger(self)._ensure_process_stopped()
+        self.enabled = False
+        self._changed = True
+
+    def reset(self: SyscallProfiler) -> None:
+        """Discards the collected latencies."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+        internal_debugger.debugging_interface.reset_syscall_profiler()
+
+    def stats(self: SyscallProfiler, per_thread: bool = False, per_call_site: bool = False) -> list[SyscallStats]:
+        """Returns the latencies of the syscalls, the ones that took the most time first.
+
+        Args:
+            per_thread (bool, optional): Whether to keep the calls of each thread separated. Defaults to False.
+            per_call_site (bool, optional): Whether to keep the calls of each call site separated. Defaults to False.
+        """
+        merged = {}
+
+        for entry in self._syscalls():
+            thread_id = entry.thread_id if per_thread else None
+            call_site = entry.call_site if per_call_site and self.call_sites else None
+            key = (entry.number, thread_id, call_site)
+
+            if key not in merged:
+                merged[key] = SyscallStats(
+                    entry.syscall,
+                    entry.number,
+                    thread_id,
+                    call_site,
+                    0,
+                    0,
+                    0.0,
+                    0.0,
+                    0.0,
+                    [0] * len(entry.histogram),
+                )
+
+            merged[key]._merge(entry)
+
+        return sorted(merged.values(), key=lambda stats: stats.total_time, reverse=True)
+
+    def _syscalls(self: SyscallProfiler) -> list[SyscallStats]:
+        """Returns the entries of the native table."""
+        if self._final_syscalls is not None:
+            return self._final_syscalls
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_profiled_syscalls()
+
+    def _freeze(self: SyscallProfiler, syscalls: list[SyscallStats]) -> None:
+        """Keeps the latencies collected until the end of the process, once the native table is released."""
+        self._final_syscalls = syscalls
+
+    def __hash__(self: SyscallProfiler) -> int:
+        """Return the hash of the syscall profiler. There is at most one syscall profiler per process."""
+        return id(self)
@@ -0,0 +1,103 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass, field
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+
+
+@dataclass
+class VirtualClockStats:
+    """The statistics of the virtual clock.
+
+    Attributes:
+        offset (float): The seconds the clocks of the process are ahead of the real ones.
+        sleeps (int): The number of waits fast-forwarded until their timeout.
+        clock_reads (int): The number of clock reads shifted by the offset.
+    """
+
+    offset: float
+    sleeps: int
+    clock_reads: int
+
+
+@dataclass
+class VirtualClock:
+    """The virtual clock of the target process.
+
+    The sleeping syscalls, i.e., nanosleep, clock_nanosleep and the timeouts of poll, select and epoll, return
+    immediately: their timeout is cleared on their entry, and the time they would have waited is added to the offset
+    of the clocks of the process when they time out. The clock syscalls return the real time shifted by the same
+    offset, and the clock functions of the vDSO are patched to execute them, so that no clock read is missed.
+
+    Attributes:
+        enabled (bool): Whether the virtual clock is enabled or not.
+    """
+
+    enabled: bool = True
+
+    _changed: bool = False
+    _vdso_patches: dict[int, bytes] = field(default_factory=dict)
+    _final_stats: VirtualClockStats | None = None
+
+    def enable(self: VirtualClock) -> None:
+        """Enable the virtual clock. The offset accumulated so far is kept."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        if not self._vdso_patches:
+            self._vdso_patches = internal_debugger._patch_vdso_clocks()
+
+        self.enabled = True
+        self._changed = True
+
+    def disable(self: VirtualClock) -> None:
+        """Disable the virtual clock. The process sees the real time again."""
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        internal_debugger._restore_vdso_clocks(self._vdso_patches)
+        self._vdso_patches = {}
+
+        self.enabled = False
+        self._changed = True
+
+    def advance(self: VirtualClock, seconds: float) -> None:
+        """Moves the clocks of the process forward, e.g., to expire a timer without waiting for it.
+
+        Args:
+            seconds (float): The seconds to add to the offset of the clocks.
+        """
+        if seconds < 0:
+            raise ValueError("The virtual clock cannot go backwards.")
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+        internal_debugger.debugging_interface.advance_virtual_clock(int(seconds * 1e9))
+
+    def offset(self: VirtualClock) -> float:
+        """Returns the seconds the clocks of the process are ahead of the real ones."""
+        return self.stats().offset
+
+    def stats(self: VirtualClock) -> VirtualClockStats:
+        """Returns the statistics of the virtual clock."""
+        if self._final_stats is not None:
+            return self._final_stats
+
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        return internal_debugger.debugging_interface.get_virtual_clock_stats()
+
+    def _freeze(self: VirtualClock, stats: VirtualClockStats) -> None:
+        """Keeps the final statistics of the virtual clock, once the native one is released."""
+        self._final_stats = stats
+
+    def __hash__(self: VirtualClock) -> int:
+        """Return the hash of the virtual clock. There is at most one virtual clock per process."""
+        return id(self)
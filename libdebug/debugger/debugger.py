@@ -23,10 +23,22 @@ if TYPE_CHECKING:
     from collections.abc import Callable
 
     from libdebug.data.breakpoint import Breakpoint
+    from libdebug.data.execution_budget import ExecutionBudget
+    from libdebug.data.fd_table import FdTracker
+    from libdebug.data.function_tracer import FunctionTracer
+    from libdebug.data.heap_tracker import HeapTracker
+    from libdebug.data.latency_mode import LatencyMode
     from libdebug.data.memory_map import MemoryMap
+    from libdebug.data.profiler import Profiler
+    from libdebug.data.registers import Registers
+    from libdebug.data.return_address_monitor import ReturnAddressMonitor, ReturnAddressViolation
     from libdebug.data.signal_catcher import SignalCatcher
     from libdebug.data.syscall_handler import SyscallHandler
+    from libdebug.data.syscall_profiler import SyscallProfiler, SyscallStats
+    from libdebug.data.virtual_clock import VirtualClock
+    from libdebug.debugger.gdb_server import GdbServer
     from libdebug.debugger.internal_debugger import InternalDebugger
+    from libdebug.memory.glibc_heap import GlibcHeap
     from libdebug.state.thread_context import ThreadContext
     from libdebug.utils.pipe_manager import PipeManager
 
@@ -80,14 +92,30 @@ class Debugger:
         """Interrupts the process."""
         self._internal_debugger.interrupt()
 
-    def wait(self: Debugger) -> None:
-        """Waits for the process to stop."""
-        self._internal_debugger.wait()
+    def wait(self: Debugger, timeout: float | None = None) -> bool:
+        """Waits for the process to stop.
+
+        Args:
+            timeout (float, optional): The seconds to wait before interrupting the process. Defaults to None (no
+            timeout).
+
+        Returns:
+            bool: True if the process stopped by itself, False if it was interrupted because of the timeout.
+        """
+        return self._internal_debugger.wait(timeout)
 
     def maps(self: Debugger) -> list[MemoryMap]:
         """Returns the memory maps of the process."""
         return self._internal_debugger.maps()
 
+    @property
+    def heap(self: Debugger) -> GlibcHeap:
+        """The glibc heap of the process.
+
+        The main heap is parsed natively, together with the tcache of the main thread and the bins of the main arena.
+        """
+        return self._internal_debugger.heap
+
     def print_maps(self: Debugger) -> None:
         """Prints the memory maps of the process."""
         self._internal_debugger.print_maps()
@@ -100,6 +128,9 @@ class Debugger:
         length: int = 1,
         callback: None | Callable[[ThreadContext, Breakpoint], None] = None,
         file: str = "hybrid",
+        native_callback: object = None,
+        native_data: object = None,
+        threads: list[int | ThreadContext] | None = None,
     ) -> Breakpoint:
         """Sets a breakpoint at the specified location.
 
@@ -114,8 +145,25 @@ class Debugger:
             file (str, optional): The user-defined backing file to resolve the address in. Defaults to "hybrid"
             (libdebug will first try to solve the address as an absolute address, then as a relative address w.r.t.
             the "binary" map file).
+            native_callback (object, optional): A C function handling the breakpoint without leaving the native code,
+            as a cffi or ctypes function pointer, or as an address. It returns 0 to resume the process, any other value
+            to stop it. Defaults to None.
+            native_data (object, optional): A pointer passed to the native callback, as a cffi or ctypes object, or as
+            an address. Defaults to None.
+            threads (list[int | ThreadContext], optional): The threads the breakpoint is hit by. The hits from the
+            other threads are stepped over without leaving the native code. Defaults to None (every thread).
         """
-        return self._internal_debugger.breakpoint(position, hardware, condition, length, callback, file)
+        return self._internal_debugger.breakpoint(
+            position,
+            hardware,
+            condition,
+            length,
+            callback,
+            file,
+            native_callback,
+            native_data,
+            threads,
+        )
 
     def watchpoint(
         self: Debugger,
@@ -147,6 +195,196 @@ class Debugger:
             file=file,
         )
 
+    def monitor_return_addresses(
+        self: Debugger,
+        functions: list[int | str] | None = None,
+        canary: bool = False,
+        callback: None | Callable[[ThreadContext, ReturnAddressViolation], None] = None,
+        file: str = "binary",
+    ) -> ReturnAddressMonitor:
+        """Monitors the integrity of the return addresses of the specified functions.
+
+        Every monitored function records its return address when it is entered, and the value is checked natively
+        when the function returns. The process stops (or the callback is called) only when a mismatch is detected.
+
+        Args:
+            functions (list[int | str], optional): The functions to monitor, as symbols or entry points. Defaults to
+            None (all the functions of the backing file).
+            canary (bool, optional): Whether to report the failures of the stack canary check as violations. Defaults
+            to False.
+            callback (Callable[[ThreadContext, ReturnAddressViolation], None], optional): A callback to be called when
+            a violation is detected. Defaults to None.
+            file (str, optional): The backing file containing the functions. Defaults to "binary".
+
+        Returns:
+            ReturnAddressMonitor: The ReturnAddressMonitor object.
+        """
+        return self._internal_debugger.monitor_return_addresses(functions, canary, callback, file)
+
+    def trace_functions(
+        self: Debugger,
+        functions: list[int | str],
+        args: int = 0,
+        capture_return: bool = True,
+        buffer_size: int = 65536,
+    ) -> FunctionTracer:
+        """Traces the calls to the specified functions, in a ltrace-like fashion.
+
+        Calls are captured natively, without running any Python code, and they are collected in the tracer every
+        time the process stops.
+
+        Args:
+            functions (list[int | str]): The functions to trace. Symbols are resolved on the PLT of the binary first,
+            then in every loaded file. A `file:pattern` string traces every function of the backing file matching
+            the glob pattern (e.g., "libc.so:str*").
+            args (int, optional): The number of arguments to capture for each call. Defaults to 0.
+            capture_return (bool, optional): Whether to capture the return value and the duration of each call.
+            Defaults to True.
+            buffer_size (int, optional): The size of the native ring buffer of traced calls. Defaults to 65536.
+
+        Returns:
+            FunctionTracer: The FunctionTracer object.
+        """
+        return self._internal_debugger.trace_functions(functions, args, capture_return, buffer_size)
+
+    def track_heap(
+        self: Debugger,
+        backtrace: int = 0,
+        mmap: bool = True,
+        report_on_exit: bool = False,
+    ) -> HeapTracker:
+        """Tracks the heap allocations of the process, to find leaks and the owner of heap pointers.
+
+        The allocator functions of libc are trapped natively, so the allocations are tracked without running any
+        Python code.
+
+        Args:
+            backtrace (int, optional): The number of callers to record for each allocation, besides the allocation
+            site. Up to 8 callers are supported, walking the frame pointers. Defaults to 0.
+            mmap (bool, optional): Whether to track the memory mappings and the heap growth as well. Defaults to True.
+            report_on_exit (bool, optional): Whether to print the leak report when the process exits. Defaults to
+            False.
+
+        Returns:
+            HeapTracker: The HeapTracker object.
+        """
+        return self._internal_debugger.track_heap(backtrace, mmap, report_on_exit)
+
+    def profile(self: Debugger, frequency: int = 99, max_depth: int = 64) -> Profiler:
+        """Samples the stacks of the threads of the process at a fixed frequency, while it runs.
+
+        The process is stopped by a native timer, the stacks are unwound natively through the frame pointers and the
+        process is resumed immediately, so breakpoints and handlers keep working as usual.
+
+        Args:
+            frequency (int, optional): The sampling frequency, in Hz, up to 10000. Defaults to 99.
+            max_depth (int, optional): The maximum number of frames collected for each stack, up to 256. Defaults
+            to 64.
+
+        Returns:
+            Profiler: The Profiler object.
+        """
+        return self._internal_debugger.profile(frequency, max_depth)
+
+    def budget(
+        self: Debugger,
+        wall_time: float | None = None,
+        cpu_time: float | None = None,
+        syscalls: int | None = None,
+        breakpoint_hits: int | None = None,
+    ) -> ExecutionBudget:
+        """Limits the resources the process can use before it is interrupted, replacing the previous budget.
+
+        The limits are counted from this call and enforced natively while the process runs. When one of them is
+        exceeded, the process is stopped and the exhausted attribute of the budget tells which one. The budget ends
+        with the process.
+
+        Args:
+            wall_time (float, optional): The seconds of real time. Defaults to None (unlimited).
+            cpu_time (float, optional): The seconds of CPU time used by all the threads. Defaults to None (unlimited).
+            syscalls (int, optional): The number of syscalls the process can enter. Defaults to None (unlimited).
+            breakpoint_hits (int, optional): The number of breakpoints the process can hit. Defaults to None
+            (unlimited).
+
+        Returns:
+            ExecutionBudget: The ExecutionBudget object.
+        """
+        return self._internal_debugger.budget(wall_time, cpu_time, syscalls, breakpoint_hits)
+
+    def virtual_time(self: Debugger) -> VirtualClock:
+        """Runs the process on a virtual clock, which fast-forwards its sleeps and the timeouts of its waits.
+
+        The sleeping syscalls return immediately, and the time they would have waited is added to the clocks seen by
+        the process, including the ones read through the vDSO. The process sees time flow as it would, without waiting
+        for it. The virtual clock ends with the process.
+
+        Returns:
+            VirtualClock: The VirtualClock object.
+        """
+        return self._internal_debugger.virtual_time()
+
+    def profile_syscalls(self: Debugger, call_sites: bool = False) -> SyscallProfiler:
+        """Measures the latency of every syscall of the process, while it runs.
+
+        The entry and the exit stops of the syscalls are timestamped natively, and the latencies are accounted to
+        log-scale histograms per syscall and per thread, without stopping in Python. The profiler ends with the
+        process, and its results are kept.
+
+        Args:
+            call_sites (bool, optional): Whether to also account the calls per call site. Defaults to False.
+
+        Returns:
+            SyscallProfiler: The SyscallProfiler object.
+        """
+        return self._internal_debugger.profile_syscalls(call_sites)
+
+    def syscall_stats(self: Debugger, per_thread: bool = False, per_call_site: bool = False) -> list[SyscallStats]:
+        """Returns the latencies of the profiled syscalls, the ones that took the most time first.
+
+        Args:
+            per_thread (bool, optional): Whether to keep the calls of each thread separated. Defaults to False.
+            per_call_site (bool, optional): Whether to keep the calls of each call site separated, if the profiler
+            collects them. Defaults to False.
+
+        Returns:
+            list[SyscallStats]: The latencies of the syscalls.
+        """
+        return self._internal_debugger.syscall_stats(per_thread, per_call_site)
+
+    def track_fds(self: Debugger) -> FdTracker:
+        """Tracks the file descriptors of the process natively, so that each lookup is served without reading /proc.
+
+        The file descriptors are read from /proc once, and a native table is then kept up to date from the results of
+        the syscalls that create and close them. The tracker ends with the process.
+
+        Returns:
+            FdTracker: The FdTracker object.
+        """
+        return self._internal_debugger.track_fds()
+
+    def set_latency_mode(
+        self: Debugger,
+        policy: str | None,
+        cpu: int | None = None,
+        spin_time: float = 0.0,
+    ) -> LatencyMode | None:
+        """Pins the debugger and the process to chosen CPUs, to reduce the latency of each stop.
+
+        The placement is kept for the following runs of the debugger, and the new threads of the process inherit it.
+
+        Args:
+            policy (str | None): "same-core" to run the debugger and the process on the same CPU, "sibling-core" to
+            run them on two CPUs sharing the same physical core (or at least the same package), None to restore the
+            default placement.
+            cpu (int, optional): The CPU of the debugger. Defaults to None (the first CPU available).
+            spin_time (float, optional): The seconds the debugger busy-waits for a stop before sleeping. Useful only
+            with the "sibling-core" policy. Defaults to 0.
+
+        Returns:
+            LatencyMode | None: The resolved placement.
+        """
+        return self._internal_debugger.set_latency_mode(policy, cpu, spin_time)
+
     def catch_signal(
         self: Debugger,
         signal: int | str,
@@ -230,9 +468,47 @@ class Debugger:
         """
         return self._internal_debugger.hijack_syscall(original_syscall, new_syscall, recursive, **kwargs)
 
-    def gdb(self: Debugger, open_in_new_process: bool = True) -> None:
-        """Migrates the current debugging session to GDB."""
-        self._internal_debugger.gdb(open_in_new_process)
+    def alloc(self: Debugger, size: int, protection: str | int = "rw") -> int:
+        """Allocates scratch memory in the process.
+
+        The memory is carved out of arenas mapped by syscalls injected in the process, so that most allocations do not
+        interact with the process at all. It is never freed, and is unmapped with the process.
+
+        Args:
+            size (int): The number of bytes to allocate.
+            protection (str | int, optional): The protection of the memory, e.g., "rw" or "rwx". Defaults to "rw".
+
+        Returns:
+            int: The address of the allocated memory.
+        """
+        return self._internal_debugger.alloc(size, protection)
+
+    def gdb(self: Debugger, open_in_new_process: bool = True, migrate: bool = False) -> None:
+        """Opens GDB on the current debugging session, until GDB detaches.
+
+        By default, libdebug stays the tracer of the process and serves it to GDB through the remote protocol.
+
+        Args:
+            open_in_new_process (bool, optional): Whether to open GDB in a new terminal, following the configuration
+            in libcontext.terminal, instead of the current shell. Defaults to True.
+            migrate (bool, optional): Whether to detach from the process and let GDB attach to it, instead of serving
+            it to GDB. Defaults to False.
+        """
+        self._internal_debugger.gdb(open_in_new_process, migrate)
+
+    def gdb_server(self: Debugger, host: str = "127.0.0.1", port: int = 0) -> GdbServer:
+        """Serves the process to the clients of the GDB remote serial protocol, e.g., GDB, IDA or Ghidra.
+
+        The clients connect with `target remote <host>:<port>`, while libdebug stays the tracer of the process.
+
+        Args:
+            host (str, optional): The address to listen on. Defaults to "127.0.0.1".
+            port (int, optional): The port to listen on. Defaults to 0 (any free port).
+
+        Returns:
+            GdbServer: The server, already accepting the clients.
+        """
+        return self._internal_debugger.gdb_server(host, port)
 
     def r(self: Debugger) -> None:
         """Alias for the `run` method.
@@ -270,6 +546,8 @@ class Debugger:
         length: int = 1,
         callback: None | Callable[[ThreadContext, Breakpoint], None] = None,
         file: str = "hybrid",
+        native_callback: object = None,
+        native_data: object = None,
     ) -> Breakpoint:
         """Alias for the `breakpoint` method.
 
@@ -284,8 +562,22 @@ class Debugger:
             file (str, optional): The user-defined backing file to resolve the address in. Defaults to "hybrid"
             (libdebug will first try to solve the address as an absolute address, then as a relative address w.r.t.
             the "binary" map file).
+            native_callback (object, optional): A C function handling the breakpoint without leaving the native code,
+            as a cffi or ctypes function pointer, or as an address. It returns 0 to resume the process, any other value
+            to stop it. Defaults to None.
+            native_data (object, optional): A pointer passed to the native callback, as a cffi or ctypes object, or as
+            an address. Defaults to None.
         """
-        return self._internal_debugger.breakpoint(position, hardware, condition, length, callback, file)
+        return self._internal_debugger.breakpoint(
+            position,
+            hardware,
+            condition,
+            length,
+            callback,
+            file,
+            native_callback,
+            native_data,
+        )
 
     def wp(
         self: Debugger,
@@ -341,11 +633,44 @@ class Debugger:
 
         self._internal_debugger.kill_on_exit = value
 
+    @property
+    def execution_budget(self: Debugger) -> ExecutionBudget | None:
+        """Get the execution budget of the process, if any."""
+        return self._internal_debugger.execution_budget
+
+    @property
+    def virtual_clock(self: Debugger) -> VirtualClock | None:
+        """Get the virtual clock of the process, if any."""
+        return self._internal_debugger.virtual_clock
+
+    @property
+    def fd_tracker(self: Debugger) -> FdTracker | None:
+        """Get the tracker of the file descriptors of the process, if any."""
+        return self._internal_debugger.fd_tracker
+
+    @property
+    def syscall_profiler(self: Debugger) -> SyscallProfiler | None:
+        """Get the syscall profiler of the process, if any."""
+        return self._internal_debugger.syscall_profiler
+
+    @property
+    def latency_mode(self: Debugger) -> LatencyMode | None:
+        """Get the placement of the debugger and of the process on the CPUs, if any."""
+        return self._internal_debugger.latency_mode
+
     @property
     def threads(self: Debugger) -> list[ThreadContext]:
         """Get the list of threads in the process."""
         return self._internal_debugger.threads
 
+    @property
+    def regs(self: Debugger) -> Registers:
+        """Get the registers of the main thread, without the lookup of the attributes forwarded to it."""
+        if not self._internal_debugger.threads:
+            raise AttributeError("'Debugger' object has no attribute 'regs'")
+
+        return self._internal_debugger.threads[0].regs
+
     @property
     def breakpoints(self: Debugger) -> dict[int, Breakpoint]:
         """Get the breakpoints set on the process."""
@@ -0,0 +1,625 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import socket
+from pathlib import Path
+from select import select
+from signal import SIGINT, SIGTRAP
+from threading import Condition, Event, Thread
+from typing import TYPE_CHECKING
+
+from libdebug.debugger.internal_debugger_instance_manager import extend_internal_debugger, provide_internal_debugger
+from libdebug.liblog import liblog
+from libdebug.ptrace.ptrace_register_holder import register_index
+from libdebug.utils.gdb_remote_utils import (
+    GDB_REGISTERS,
+    frame_packet,
+    from_gdb_signal,
+    parse_packets,
+    to_gdb_signal,
+    unescape_binary,
+)
+
+if TYPE_CHECKING:
+    from libdebug.data.breakpoint import Breakpoint
+    from libdebug.state.thread_context import ThreadContext
+
+# The seconds between two checks of the client, of the process and of the server state
+POLL_INTERVAL = 0.05
+
+# The features advertised to the clients
+SUPPORTED_FEATURES = (
+    b"PacketSize=4000;QStartNoAckMode+;swbreak+;hwbreak+;vContSupported+;qXfer:auxv:read+;qXfer:exec-file:read+"
+)
+
+# The kinds of watchpoint of the Z packets, and the conditions of the corresponding breakpoints
+WATCHPOINT_CONDITIONS = {2: "w", 3: "r", 4: "rw"}
+
+# The stop reasons of the watchpoints, for each condition
+WATCHPOINT_REASONS = {"w": "watch", "r": "rwatch", "rw": "awatch"}
+
+
+class GdbServer:
+    """A server of the GDB remote serial protocol, serving the process of a debugger.
+
+    GDB, or any other client of the protocol, e.g., IDA or Ghidra, drives the process through libdebug, which stays its
+    tracer: the registers, the memory, the breakpoints and the execution requests of the client are forwarded to the
+    debugger, and the breakpoints and the handlers of the script keep working while the client is connected. The
+    clients are served one at a time, until the server is stopped. While a client is connected, the script should not
+    drive the process itself, and should rather wait for the client to detach.
+
+    Attributes:
+        host (str): The address the server listens on.
+        port (int): The port the server listens on.
+    """
+
+    def __init__(self: GdbServer, host: str, port: int) -> None:
+        """Initializes the server, listening on the given address.
+
+        Args:
+            host (str): The address to listen on.
+            port (int): The port to listen on, 0 to pick a free one.
+        """
+        self.host = host
+
+        self._listener = socket.create_server((host, port))
+        self.port = self._listener.getsockname()[1]
+
+        self._client: socket.socket | None = None
+        self._buffer = bytearray()
+        self._pending: list[bytes | None] = []
+        self._acknowledge = True
+        self._session_over = False
+        self._last_stop = b""
+
+        # The index in the register file and the size of each register of the g packet
+        self._registers: list[tuple[int, int]] = []
+
+        # The thread of the register and memory requests, and the one of the execution requests
+        self._general_thread: ThreadContext | None = None
+        self._resume_thread: ThreadContext | None = None
+
+        # The breakpoints inserted by the clients, by address
+        self._breakpoints: dict[int, Breakpoint] = {}
+
+        self._stopping = Event()
+        self._accepted_sessions = 0
+        self._finished_sessions = 0
+        self._session_finished = Condition()
+        self._thread = Thread(target=self._serve, name="libdebug-gdb-server", daemon=True)
+
+    @property
+    def address(self: GdbServer) -> str:
+        """The address of the server, as expected by the `target remote` command of GDB."""
+        return f"{self.host}:{self.port}"
+
+    @property
+    def connected(self: GdbServer) -> bool:
+        """Whether a client is connected to the server."""
+        return self._client is not None
+
+    @property
+    def serving(self: GdbServer) -> bool:
+        """Whether the server accepts clients."""
+        return self._thread.is_alive()
+
+    def start(self: GdbServer) -> None:
+        """Starts serving the clients, in a background thread."""
+        self._thread.start()
+
+    def wait(self: GdbServer, timeout: float | None = None) -> bool:
+        """Waits for the last client that connected, or for the first one, to detach.
+
+        Args:
+            timeout (float, optional): The seconds to wait. Defaults to None (no timeout).
+
+        Returns:
+            bool: True if the client detached, False if the timeout expired or the server was stopped.
+        """
+        with self._session_finished:
+            target = max(self._accepted_sessions, 1)
+
+            return self._session_finished.wait_for(
+                lambda: self._finished_sessions >= target or not self.serving,
+                timeout,
+            ) and self._finished_sessions >= target
+
+    def stop(self: GdbServer) -> None:
+        """Disconnects the client, if any, and stops the server. The process stays stopped."""
+        self._stopping.set()
+
+        if self._thread.is_alive():
+            self._thread.join()
+
+        self._listener.close()
+
+    def _serve(self: GdbServer) -> None:
+        """Serves the clients, until the server is stopped."""
+        with extend_internal_debugger(self):
+            while not self._stopping.is_set():
+                readable, _, _ = select([self._listener], [], [], POLL_INTERVAL)
+
+                if not readable:
+                    continue
+
+                client, address = self._listener.accept()
+                liblog.debugger("GDB client connected from %s.", address)
+
+                with self._session_finished:
+                    self._accepted_sessions += 1
+
+                with client:
+                    self._client = client
+
+                    try:
+                        self._serve_client()
+                    except OSError as e:
+                        liblog.debugger("GDB client disconnected: %s.", e)
+                    finally:
+                        self._client = None
+                        self._release_breakpoints()
+
+                with self._session_finished:
+                    self._finished_sessions += 1
+                    self._session_finished.notify_all()
+
+        with self._session_finished:
+            self._session_finished.notify_all()
+
+    def _serve_client(self: GdbServer) -> None:
+        """Serves the connected client, until it detaches."""
+        internal_debugger = provide_internal_debugger(self)
+
+        self._buffer.clear()
+        self._pending.clear()
+        self._acknowledge = True
+        self._session_over = False
+        self._general_thread = None
+        self._resume_thread = None
+        self._registers = [(register_index(name), size) for name, size in GDB_REGISTERS[internal_debugger.arch]]
+
+        # The clients expect the process to be stopped when they connect
+        if internal_debugger.running:
+            internal_debugger.interrupt()
+
+        self._last_stop = self._stop_reply({})
+
+        while not self._session_over:
+            if self._pending:
+                packet = self._pending.pop(0)
+            else:
+                packets = self._receive()
+
+                if packets is None:
+                    return
+
+                self._pending.extend(packet for packet in packets if packet != 0x03)
+                continue
+
+            if packet is None:
+                # The client sends the corrupted packets again
+                if self._acknowledge:
+                    self._client.sendall(b"-")
+                continue
+
+            if self._acknowledge:
+                self._client.sendall(b"+")
+
+            try:
+                reply = self._handle(packet)
+            except (OSError, RuntimeError, ValueError) as e:
+                liblog.debugger("GDB request %r failed: %s.", packet, e)
+                reply = b"E01"
+
+            if reply is not None:
+                self._client.sendall(frame_packet(reply))
+
+    def _receive(self: GdbServer) -> list[bytes | int | None] | None:
+        """Receives the packets sent by the client within a poll interval.
+
+        Returns:
+            list[bytes | int | None] | None: The packets, as returned by `parse_packets`, or None if the client
+            disconnected or the server is stopping.
+        """
+        if self._stopping.is_set():
+            return None
+
+        readable, _, _ = select([self._client], [], [], POLL_INTERVAL)
+
+        if not readable:
+            return []
+
+        data = self._client.recv(4096)
+
+        if not data:
+            return None
+
+        self._buffer += data
+
+        return parse_packets(self._buffer)
+
+    def _handle(self: GdbServer, packet: bytes) -> bytes | None:
+        """Handles a request of the client.
+
+        Args:
+            packet (bytes): The payload of the request.
+
+        Returns:
+            bytes | None: The payload of the reply, empty if the request is not supported, None if no reply is due.
+        """
+        internal_debugger = provide_internal_debugger(self)
+
+        command, arguments = packet[:1], packet[1:]
+
+        match command:
+            case b"?":
+                return self._last_stop
+            case b"g":
+                return self._read_registers()
+            case b"G":
+                return self._write_registers(arguments)
+            case b"p":
+                return self._read_register(int(arguments, 16))
+            case b"P":
+                number, value = arguments.split(b"=")
+                return self._write_register(int(number, 16), value)
+            case b"m":
+                address, length = (int(value, 16) for value in arguments.split(b","))
+                return internal_debugger.memory.read(address, length).hex().encode()
+            case b"M":
+                location, data = arguments.split(b":", 1)
+                internal_debugger.memory.write(int(location.split(b",")[0], 16), bytes.fromhex(data.decode()))
+                return b"OK"
+            case b"X":
+                location, data = arguments.split(b":", 1)
+                address, length = (int(value, 16) for value in location.split(b","))
+                if length:
+                    internal_debugger.memory.write(address, unescape_binary(data)[:length])
+                return b"OK"
+            case b"Z" | b"z":
+                kind, address, length = (int(value, 16) for value in arguments.split(b";")[0].split(b","))
+                return self._set_breakpoint(kind, address, length, command == b"Z")
+            case b"H":
+                return self._select_thread(arguments[:1], int(arguments[1:], 16))
+            case b"T":
+                thread = internal_debugger.get_thread_by_id(int(arguments, 16))
+                return b"OK" if thread is not None and not thread.dead else b"E01"
+            case b"c" | b"s":
+                return self._resume([(command.decode(), 0, None)])
+            case b"C" | b"S":
+                signal_number = int(arguments.split(b";")[0], 16)
+                return self._resume([(command.decode().lower(), signal_number, None)])
+            case b"v":
+                return self._handle_v(packet)
+            case b"q" | b"Q":
+                return self._handle_query(packet)
+            case b"D":
+                self._session_over = True
+                return b"OK"
+            case b"k":
+                self._session_over = True
+                internal_debugger.kill()
+                return None
+            case _:
+                return b""
+
+    def _handle_query(self: GdbServer, packet: bytes) -> bytes:
+        """Handles a general query of the client."""
+        internal_debugger = provide_internal_debugger(self)
+
+        name = packet.split(b":", 1)[0]
+
+        match name:
+            case b"qSupported":
+                return SUPPORTED_FEATURES
+            case b"QStartNoAckMode":
+                # The request itself has already been acknowledged
+                self._acknowledge = False
+                return b"OK"
+            case b"qAttached":
+                # The clients detach from the process when they quit, instead of killing it
+                return b"1"
+            case b"qC":
+                return f"QC{self._current_thread().thread_id:x}".encode()
+            case b"qfThreadInfo":
+                threads = [thread for thread in internal_debugger.threads if not thread.dead]
+                return b"m" + ",".join(f"{thread.thread_id:x}" for thread in threads).encode()
+            case b"qsThreadInfo":
+                return b"l"
+            case b"qXfer":
+                return self._transfer(packet)
+            case _:
+                return b""
+
+    def _handle_v(self: GdbServer, packet: bytes) -> bytes:
+        """Handles a multi-letter request of the client."""
+        if packet == b"vCont?":
+            return b"vCont;c;C;s;S"
+
+        if not packet.startswith(b"vCont;"):
+            return b""
+
+        actions = []
+
+        for action in packet[6:].split(b";"):
+            kind, _, thread_id = action.partition(b":")
+            signal_number = int(kind[1:], 16) if kind[1:] else 0
+            actions.append((kind[:1].decode().lower(), signal_number, int(thread_id, 16) if thread_id else None))
+
+        return self._resume(actions)
+
+    def _transfer(self: GdbServer, packet: bytes) -> bytes:
+        """Handles a qXfer request, reading the auxiliary vector or the path of the executable."""
+        internal_debugger = provide_internal_debugger(self)
+
+        _, obj, operation, _, window = packet.split(b":", 4)
+
+        if operation != b"read":
+            return b""
+
+        match obj:
+            case b"auxv":
+                data = Path(f"/proc/{internal_debugger.process_id}/auxv").read_bytes()
+            case b"exec-file":
+                data = internal_debugger._process_full_path.encode()
+            case _:
+                return b""
+
+        offset, length = (int(value, 16) for value in window.split(b","))
+        chunk = data[offset : offset + length]
+
+        return (b"m" if offset + length < len(data) else b"l") + chunk
+
+    def _current_thread(self: GdbServer) -> ThreadContext:
+        """Returns the thread of the register and memory requests."""
+        if self._general_thread is not None and not self._general_thread.dead:
+            return self._general_thread
+
+        internal_debugger = provide_internal_debugger(self)
+
+        return next(thread for thread in internal_debugger.threads if not thread.dead)
+
+    def _select_thread(self: GdbServer, operation: bytes, thread_id: int) -> bytes:
+        """Selects the thread of the following requests, any thread if the identifier is 0 or -1."""
+        if thread_id in (0, -1):
+            thread = None
+        else:
+            thread = provide_internal_debugger(self).get_thread_by_id(thread_id)
+
+            if thread is None or thread.dead:
+                return b"E01"
+
+        if operation == b"g":
+            self._general_thread = thread
+        else:
+            self._resume_thread = thread
+
+        return b"OK"
+
+    def _read_registers(self: GdbServer) -> bytes:
+        """Reads the registers of the current thread, in the layout of the g packet."""
+        return b"".join(self._read_register(number) for number in range(len(self._registers)))
+
+    def _write_registers(self: GdbServer, data: bytes) -> bytes:
+        """Writes the registers of the current thread, from the layout of the G packet."""
+        offset = 0
+
+        for number, (_, size) in enumerate(self._registers):
+            value = data[offset : offset + size * 2]
+            offset += size * 2
+
+            if len(value) < size * 2:
+                break
+
+            # The unavailable registers are sent as "xx"
+            if b"x" not in value:
+                self._write_register(number, value)
+
+        return b"OK"
+
+    def _read_register(self: GdbServer, number: int) -> bytes:
+        """Reads a register of the current thread, empty if the register is not served."""
+        if number >= len(self._registers):
+            return b""
+
+        index, size = self._registers[number]
+        value = self._current_thread()._register_view[index] & ((1 << (size * 8)) - 1)
+
+        return value.to_bytes(size, "little").hex().encode()
+
+    def _write_register(self: GdbServer, number: int, value: bytes) -> bytes:
+        """Writes a register of the current thread."""
+        if number >= len(self._registers):
+            return b"E01"
+
+        index, size = self._registers[number]
+        self._current_thread()._register_view[index] = int.from_bytes(bytes.fromhex(value.decode())[:size], "little")
+
+        return b"OK"
+
+    def _set_breakpoint(self: GdbServer, kind: int, address: int, length: int, insert: bool) -> bytes:
+        """Inserts or removes a breakpoint of the client.
+
+        Args:
+            kind (int): The kind of the breakpoint, i.e., 0 for software, 1 for hardware, 2-4 for watchpoints.
+            address (int): The address of the breakpoint.
+            length (int): The length of the watched memory, or the kind of breakpoint instruction.
+            insert (bool): Whether to insert or to remove the breakpoint.
+        """
+        internal_debugger = provide_internal_debugger(self)
+
+        if kind > 4:
+            return b""
+
+        bp = self._breakpoints.get(address)
+
+        if not insert:
+            if bp is not None and bp.enabled:
+                bp.disable()
+            return b"OK"
+
+        if address in internal_debugger.breakpoints and bp is None:
+            # The breakpoints of the script are reported as they are
+            return b"OK"
+
+        hardware = kind != 0
+        condition = WATCHPOINT_CONDITIONS.get(kind, "x")
+        length = length if kind >= 2 else 1
+
+        if bp is not None and (bp.hardware, bp.condition, bp.length) == (hardware, condition, length):
+            bp.enable()
+        else:
+            self._breakpoints[address] = internal_debugger.breakpoint(
+                address,
+                hardware=hardware,
+                condition=condition,
+                length=length,
+                file="absolute",
+            )
+
+        return b"OK"
+
+    def _release_breakpoints(self: GdbServer) -> None:
+        """Disables the breakpoints left by the client that detached."""
+        internal_debugger = provide_internal_debugger(self)
+
+        if not internal_debugger.instanced or internal_debugger.threads[0].dead:
+            self._breakpoints.clear()
+            return
+
+        if internal_debugger.running:
+            internal_debugger.interrupt()
+
+        for bp in self._breakpoints.values():
+            if bp.enabled:
+                bp.disable()
+
+    def _resume(self: GdbServer, actions: list[tuple[str, int, int | None]]) -> bytes | None:
+        """Resumes the process and waits for it to stop.
+
+        A thread is stepped if any action steps it, and the process is continued otherwise, as the other threads stay
+        stopped while a thread is stepped.
+
+        Args:
+            actions (list[tuple[str, int, int | None]]): The kind of each action, i.e., "c" or "s", the signal to
+            deliver, and the thread it applies to, None for the threads selected by the client.
+
+        Returns:
+            bytes | None: The stop reply, None if the client disconnected while the process was running.
+        """
+        internal_debugger = provide_internal_debugger(self)
+
+        stepped = None
+
+        for kind, signal_number, thread_id in actions:
+            if thread_id in (None, -1):
+                thread = self._resume_thread or self._current_thread()
+            else:
+                thread = internal_debugger.get_thread_by_id(thread_id)
+
+            if thread is None or thread.dead:
+                continue
+
+            if signal_number:
+                thread.signal = from_gdb_signal(signal_number)
+
+            if kind == "s" and stepped is None:
+                stepped = thread
+
+        if stepped is not None:
+            internal_debugger.step(stepped)
+            self._last_stop = self._stop_reply({}, stepped=stepped)
+            return self._last_stop
+
+        hit_counts = {
+            bp: bp.hit_count
+            for bp in internal_debugger.breakpoints.values()
+            if bp.enabled and bp.callback is None and bp.native_callback is None
+        }
+
+        internal_debugger.cont()
+
+        interrupted = False
+
+        while internal_debugger.running:
+            packets = self._receive()
+
+            if packets is None:
+                # The client is gone, the process is left stopped
+                internal_debugger.interrupt()
+                self._session_over = True
+                return None
+
+            if 0x03 in packets:
+                interrupted = True
+                internal_debugger.interrupt()
+
+            self._pending.extend(packet for packet in packets if packet != 0x03)
+
+        internal_debugger.wait()
+
+        self._last_stop = self._stop_reply(hit_counts, interrupted=interrupted)
+        return self._last_stop
+
+    def _stop_reply(
+        self: GdbServer,
+        hit_counts: dict[Breakpoint, int],
+        stepped: ThreadContext | None = None,
+        interrupted: bool = False,
+    ) -> bytes:
+        """Describes the last stop of the process, as a stop reply packet.
+
+        Args:
+            hit_counts (dict[Breakpoint, int]): The hit counts of the breakpoints stopping the process, before it was
+            resumed.
+            stepped (ThreadContext, optional): The thread that was stepped, if any. Defaults to None.
+            interrupted (bool, optional): Whether the client interrupted the process. Defaults to False.
+        """
+        internal_debugger = provide_internal_debugger(self)
+
+        main_thread = internal_debugger.threads[0]
+
+        if main_thread.dead:
+            if main_thread._exit_signal is not None:
+                return f"X{to_gdb_signal(main_thread._exit_signal):02x}".encode()
+            return f"W{(main_thread._exit_code or 0) & 0xFF:02x}".encode()
+
+        threads = [thread for thread in internal_debugger.threads if not thread.dead]
+
+        thread, signal_number, reason = None, SIGTRAP, ""
+
+        for bp, hit_count in hit_counts.items():
+            if bp.hit_count == hit_count:
+                continue
+
+            selected = [t for t in threads if bp.selects_thread(t.thread_id)]
+
+            if bp.condition == "x":
+                thread = next((t for t in selected if t.instruction_pointer == bp.address), None)
+                reason = "hwbreak:;" if bp.hardware else "swbreak:;"
+            else:
+                thread = next(iter(selected), None)
+                reason = f"{WATCHPOINT_REASONS[bp.condition]}:{bp.address:x};"
+
+            break
+
+        if thread is None:
+            reason = ""
+
+            if interrupted:
+                signal_number = SIGINT
+            elif stepped is None:
+                thread = next((t for t in threads if t._signal_number), None)
+                signal_number = thread._signal_number if thread is not None else SIGTRAP
+
+        thread = thread or stepped or self._current_thread()
+
+        # The requests that follow the stop apply to the stopped thread
+        self._general_thread = thread
+
+        return f"T{to_gdb_signal(signal_number):02x}thread:{thread.thread_id:x};{reason}".encode()
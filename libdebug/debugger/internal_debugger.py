@@ -8,9 +8,12 @@
 from __future__ import annotations
 
 import functools
+import mmap
 import os
 import signal
 import sys
+import time
+from fnmatch import fnmatchcase
 from pathlib import Path
 from queue import Queue
 from signal import SIGKILL, SIGSTOP, SIGTRAP
@@ -21,23 +24,38 @@ from typing import TYPE_CHECKING
 import psutil
 
 from libdebug.architectures.breakpoint_validator import validate_hardware_breakpoint
+from libdebug.architectures.call_utilities_provider import call_utilities_provider
 from libdebug.architectures.syscall_hijacker import SyscallHijacker
 from libdebug.builtin.antidebug_syscall_handler import on_enter_ptrace, on_exit_ptrace
 from libdebug.builtin.pretty_print_syscall_handler import pprint_on_enter, pprint_on_exit
 from libdebug.data.breakpoint import Breakpoint
+from libdebug.data.execution_budget import ExecutionBudget
+from libdebug.data.fd_table import FdInfo, FdTracker
+from libdebug.data.function_tracer import FunctionTracer
+from libdebug.data.heap_tracker import HeapTracker
+from libdebug.data.latency_mode import LatencyMode
+from libdebug.data.profiler import Profiler
+from libdebug.data.return_address_monitor import ReturnAddressMonitor, ReturnAddressViolation
 from libdebug.data.signal_catcher import SignalCatcher
 from libdebug.data.syscall_handler import SyscallHandler
+from libdebug.data.syscall_profiler import SyscallProfiler, SyscallStats
+from libdebug.data.virtual_clock import VirtualClock
+from libdebug.debugger.gdb_server import GdbServer
 from libdebug.debugger.internal_debugger_instance_manager import (
     extend_internal_debugger,
     link_to_internal_debugger,
+    register_internal_debugger,
 )
 from libdebug.interfaces.interface_helper import provide_debugging_interface
 from libdebug.liblog import liblog
 from libdebug.memory.chunked_memory_view import ChunkedMemoryView
 from libdebug.memory.direct_memory_view import DirectMemoryView
+from libdebug.memory.glibc_heap import GlibcHeap
 from libdebug.memory.process_memory_manager import ProcessMemoryManager
+from libdebug.memory.scratch_allocator import ScratchAllocator, parse_protection
 from libdebug.state.resume_context import ResumeContext
 from libdebug.utils.arch_mappings import map_arch
+from libdebug.utils.cpython_utils import resolve_cpython_layout
 from libdebug.utils.debugger_wrappers import (
     background_alias,
     change_state_function_process,
@@ -48,9 +66,12 @@ from libdebug.utils.debugging_utils import (
     normalize_and_validate_address,
     resolve_symbol_in_maps,
 )
+from libdebug.utils.elf_utils import get_image_dynamic_symbols, get_plt_entries, get_symbols, is_pie
+from libdebug.utils.latency_utils import resolve_latency_mode
 from libdebug.utils.libcontext import libcontext
 from libdebug.utils.platform_utils import get_platform_register_size
 from libdebug.utils.print_style import PrintStyle
+from libdebug.utils.process_utils import get_fd_target
 from libdebug.utils.signal_utils import (
     resolve_signal_name,
     resolve_signal_number,
@@ -69,11 +90,33 @@ if TYPE_CHECKING:
     from libdebug.interfaces.debugging_interface import DebuggingInterface
     from libdebug.memory.abstract_memory_view import AbstractMemoryView
     from libdebug.state.thread_context import ThreadContext
+    from libdebug.utils.cpython_utils import CPythonLayout
     from libdebug.utils.pipe_manager import PipeManager
 
 THREAD_TERMINATE = -1
 GDB_GOBACK_LOCATION = str((Path(__file__).parent.parent / "utils" / "gdb.py").resolve())
 
+# The arguments captured by the function tracer are the ones passed in registers
+FUNCTION_TRACER_MAX_ARGS = {"amd64": 6, "aarch64": 8}
+
+# The maximum number of callers recorded for each allocation by the heap tracker
+HEAP_TRACKER_MAX_BACKTRACE = 8
+
+# The allocator functions trapped by the heap tracker
+HEAP_TRACKER_FUNCTIONS = ["malloc", "calloc", "realloc", "free", "memalign", "aligned_alloc"]
+HEAP_TRACKER_MMAP_FUNCTIONS = ["mmap", "munmap", "sbrk"]
+
+# The limits of the sampling profiler
+PROFILER_MAX_FREQUENCY = 10000
+PROFILER_MAX_DEPTH = 256
+
+# The clock functions of the vDSO replaced by the virtual clock, by syscall, without the prefix of their symbols
+VDSO_CLOCK_FUNCTIONS = ("clock_gettime", "gettimeofday", "time")
+VDSO_SYMBOL_PREFIXES = ("__vdso_", "__kernel_")
+
+# The alignment of the functions of the vDSO, whose padding can be overwritten by the stubs
+VDSO_FUNCTION_ALIGNMENT = 16
+
 
 class InternalDebugger:
     """A class that holds the global debugging state."""
@@ -114,6 +157,54 @@ class InternalDebugger:
     """A dictionary of all the signals caught in the process.
     Key: the signal number."""
 
+    return_address_monitor: ReturnAddressMonitor | None
+    """The return address monitor of the process, if any."""
+
+    function_tracer: FunctionTracer | None
+    """The function tracer of the process, if any."""
+
+    heap_tracker: HeapTracker | None
+    """The heap tracker of the process, if any."""
+
+    profiler: Profiler | None
+    """The sampling profiler of the process, if any."""
+
+    latency_mode: LatencyMode | None
+    """The placement of the debugger and of the process on the CPUs, if any."""
+
+    execution_budget: ExecutionBudget | None
+    """The execution budget of the process, if any."""
+
+    virtual_clock: VirtualClock | None
+    """The virtual clock of the process, if any."""
+
+    syscall_profiler: SyscallProfiler | None
+    """The syscall profiler of the process, if any."""
+
+    fd_tracker: FdTracker | None
+    """The tracker of the file descriptors of the process, if any."""
+
+    _gdb_server: GdbServer | None
+    """The server of the process to GDB, if any."""
+
+    _syscall_gadget: int | None
+    """The address of a syscall instruction in the process, 0 if there is none, None if it was not searched yet."""
+
+    _scratch_allocator: ScratchAllocator | None
+    """The allocator of the scratch memory of the process, if any."""
+
+    _return_trap: int | None
+    """The address of the instruction that traps the return from the functions called in the process, if any."""
+
+    _call_targets: dict[tuple[str, str], int]
+    """The addresses of the functions called by symbol in the process, by symbol and backing file."""
+
+    _call_targets_images: tuple[tuple[int, str], ...]
+    """The load addresses of the files mapped in the process when the call targets were resolved."""
+
+    _call_targets_maps: list[MemoryMap] | None
+    """The memory maps the load addresses of the call targets were last checked against."""
+
     signals_to_block: list[int]
     """The signals to not forward to the process."""
 
@@ -162,12 +253,18 @@ class InternalDebugger:
     _is_running: bool
     """The overall state of the debugged process. True if the process is running, False otherwise."""
 
+    _polling_thread_ident: int | None
+    """The identifier of the background thread, for the checks that cannot afford a call to `current_thread()`."""
+
     _fast_memory: DirectMemoryView
     """The memory view of the debugged process using the fast memory access method."""
 
     _slow_memory: ChunkedMemoryView
     """The memory view of the debugged process using the slow memory access method."""
 
+    _heap: GlibcHeap
+    """The glibc heap of the debugged process."""
+
     def __init__(self: InternalDebugger) -> None:
         """Initialize the context."""
         # These must be reinitialized on every call to "debugger"
@@ -179,6 +276,22 @@ class InternalDebugger:
         self.breakpoints = {}
         self.handled_syscalls = {}
         self.caught_signals = {}
+        self.return_address_monitor = None
+        self.function_tracer = None
+        self.heap_tracker = None
+        self.profiler = None
+        self.latency_mode = None
+        self.execution_budget = None
+        self.virtual_clock = None
+        self.syscall_profiler = None
+        self.fd_tracker = None
+        self._gdb_server = None
+        self._syscall_gadget = None
+        self._scratch_allocator = None
+        self._return_trap = None
+        self._call_targets = {}
+        self._call_targets_images = ()
+        self._call_targets_maps = None
         self.syscalls_to_pprint = None
         self.syscalls_to_not_pprint = None
         self.signals_to_block = []
@@ -188,11 +301,14 @@ class InternalDebugger:
         self.threads = []
         self.instanced = False
         self._is_running = False
+        self._polling_thread_ident = None
         self.resume_context = ResumeContext()
         self.arch = map_arch(libcontext.platform)
         self.kill_on_exit = True
         self._process_memory_manager = ProcessMemoryManager()
         self.fast_memory = False
+        self._cpython_layout = None
+        self._dwarf_frame_plans = []
         self.__polling_thread_command_queue = Queue()
         self.__polling_thread_response_queue = Queue()
 
@@ -202,6 +318,20 @@ class InternalDebugger:
         self.breakpoints.clear()
         self.handled_syscalls.clear()
         self.caught_signals.clear()
+        self.return_address_monitor = None
+        self.function_tracer = None
+        self.heap_tracker = None
+        self.profiler = None
+        self.execution_budget = None
+        self.virtual_clock = None
+        self.syscall_profiler = None
+        self.fd_tracker = None
+        self._syscall_gadget = None
+        self._scratch_allocator = None
+        self._return_trap = None
+        self._call_targets.clear()
+        self._call_targets_images = ()
+        self._call_targets_maps = None
         self.syscalls_to_pprint = None
         self.syscalls_to_not_pprint = None
         self.signals_to_block.clear()
@@ -211,12 +341,15 @@ class InternalDebugger:
         self.threads.clear()
         self.instanced = False
         self._is_running = False
+        self._cpython_layout = None
+        self._dwarf_frame_plans = []
         self.resume_context.clear()
 
     def start_up(self: InternalDebugger) -> None:
         """Starts up the context."""
         # The context is linked to itself
         link_to_internal_debugger(self, self)
+        register_internal_debugger(self)
 
         self.start_processing_thread()
         with extend_internal_debugger(self):
@@ -227,6 +360,8 @@ class InternalDebugger:
                 self._poke_memory,
                 unit_size=get_platform_register_size(libcontext.platform),
             )
+            self._heap = GlibcHeap()
+            link_to_internal_debugger(self._heap, self)
 
     def start_processing_thread(self: InternalDebugger) -> None:
         """Starts the thread that will poll the traced process for state change."""
@@ -237,6 +372,7 @@ class InternalDebugger:
             daemon=True,
         )
         self.__polling_thread.start()
+        self._polling_thread_ident = self.__polling_thread.ident
 
     def _background_invalid_call(self: InternalDebugger, *_: ..., **__: ...) -> None:
         """Raises an error when an invalid call is made in background mode."""
@@ -341,6 +477,10 @@ class InternalDebugger:
         The debugger object will not be usable after this method is called.
         This method should only be called to free up resources when the debugger object is no longer needed.
         """
+        if self._gdb_server is not None:
+            self._gdb_server.stop()
+            self._gdb_server = None
+
         if self.instanced and self.running:
             self.interrupt()
 
@@ -354,6 +494,7 @@ class InternalDebugger:
             self.__polling_thread.join()
             del self.__polling_thread
             self.__polling_thread = None
+            self._polling_thread_ident = None
 
     @background_alias(_background_invalid_call)
     @change_state_function_process
@@ -388,21 +529,51 @@ class InternalDebugger:
         self.wait()
 
     @background_alias(_background_invalid_call)
-    def wait(self: InternalDebugger) -> None:
-        """Waits for the process to stop."""
+    def wait(self: InternalDebugger, timeout: float | None = None) -> bool:
+        """Waits for the process to stop.
+
+        Args:
+            timeout (float, optional): The seconds to wait before interrupting the process. Defaults to None (no
+            timeout).
+
+        Returns:
+            bool: True if the process stopped by itself, False if it was interrupted because of the timeout.
+        """
         if not self.instanced:
             raise RuntimeError("Process not running, cannot wait.")
 
-        self._join_and_check_status()
+        if timeout is not None and timeout < 0:
+            raise ValueError("The timeout must not be negative.")
+
+        deadline = time.monotonic() + timeout if timeout is not None else None
+
+        if not self._join_and_check_status(deadline):
+            return self._interrupt_after_timeout(timeout)
 
         if self.threads[0].dead or not self.running:
             # Most of the time the function returns here, as there was a wait already
             # queued by the previous command
-            return
+            return True
 
         self.__polling_thread_command_queue.put((self.__threaded_wait, ()))
 
-        self._join_and_check_status()
+        if not self._join_and_check_status(deadline):
+            return self._interrupt_after_timeout(timeout)
+
+        return True
+
+    def _interrupt_after_timeout(self: InternalDebugger, timeout: float) -> bool:
+        """Interrupts the process that did not stop before the timeout of a wait."""
+        if not self.running:
+            # The process stopped by itself right at the deadline
+            self._join_and_check_status()
+            return True
+
+        liblog.debugger("The process did not stop within %g seconds, interrupting it.", timeout)
+
+        self.interrupt()
+
+        return False
 
     def maps(self: InternalDebugger) -> list[MemoryMap]:
         """Returns the memory maps of the process."""
@@ -414,6 +585,11 @@ class InternalDebugger:
         """The memory view of the debugged process."""
         return self._fast_memory if self.fast_memory else self._slow_memory
 
+    @property
+    def heap(self: InternalDebugger) -> GlibcHeap:
+        """The glibc heap of the debugged process."""
+        return self._heap
+
     def print_maps(self: InternalDebugger) -> None:
         """Prints the memory maps of the process."""
         self._ensure_process_stopped()
@@ -438,6 +614,9 @@ class InternalDebugger:
         length: int = 1,
         callback: None | Callable[[ThreadContext, Breakpoint], None] = None,
         file: str = "hybrid",
+        native_callback: object = None,
+        native_data: object = None,
+        threads: list[int | ThreadContext] | None = None,
     ) -> Breakpoint:
         """Sets a breakpoint at the specified location.
 
@@ -452,6 +631,13 @@ class InternalDebugger:
             file (str, optional): The user-defined backing file to resolve the address in. Defaults to "hybrid"
             (libdebug will first try to solve the address as an absolute address, then as a relative address w.r.t.
             the "binary" map file).
+            native_callback (object, optional): A C function handling the breakpoint without leaving the native code,
+            as a cffi or ctypes function pointer, or as an address. It returns 0 to resume the process, any other value
+            to stop it. Defaults to None.
+            native_data (object, optional): A pointer passed to the native callback, as a cffi or ctypes object, or as
+            an address. Defaults to None.
+            threads (list[int | ThreadContext], optional): The threads the breakpoint is hit by. The hits from the
+            other threads are stepped over without leaving the native code. Defaults to None (every thread).
         """
         if isinstance(position, str):
             address = self.resolve_symbol(position, file)
@@ -462,7 +648,25 @@ class InternalDebugger:
         if condition != "x" and not hardware:
             raise ValueError("Breakpoint condition is supported only for hardware watchpoints.")
 
+        if native_callback is not None and (hardware or callback is not None):
+            raise ValueError("Native callbacks are supported only for software breakpoints without a Python callback.")
+
+        if threads is not None:
+            thread_ids = [thread if isinstance(thread, int) else thread.thread_id for thread in threads]
+
+            if not thread_ids:
+                raise ValueError("A breakpoint must be hit by at least one thread.")
+
+            for thread_id in thread_ids:
+                if self.get_thread_by_id(thread_id) is None:
+                    raise ValueError(f"Thread {thread_id} is not being debugged.")
+        else:
+            thread_ids = None
+
         bp = Breakpoint(address, position, 0, hardware, callback, condition.lower(), length)
+        bp.native_callback = native_callback
+        bp.native_data = native_data
+        bp.threads = thread_ids
 
         if hardware:
             validate_hardware_breakpoint(self.arch, bp)
@@ -479,6 +683,498 @@ class InternalDebugger:
 
         return bp
 
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def monitor_return_addresses(
+        self: InternalDebugger,
+        functions: list[int | str] | None = None,
+        canary: bool = False,
+        callback: None | Callable[[ThreadContext, ReturnAddressViolation], None] = None,
+        file: str = "binary",
+    ) -> ReturnAddressMonitor:
+        """Monitors the integrity of the return addresses of the specified functions.
+
+        Args:
+            functions (list[int | str], optional): The functions to monitor, as symbols or entry points. Defaults to
+            None (all the functions of the backing file).
+            canary (bool, optional): Whether to report the failures of the stack canary check as violations. Defaults
+            to False.
+            callback (Callable[[ThreadContext, ReturnAddressViolation], None], optional): A callback to be called when
+            a violation is detected. Defaults to None.
+            file (str, optional): The backing file containing the functions. Defaults to "binary".
+
+        Returns:
+            ReturnAddressMonitor: The ReturnAddressMonitor object.
+        """
+        if self.return_address_monitor is not None:
+            raise RuntimeError("The return addresses are already monitored in this process.")
+
+        backing_file, symbols = self._resolve_function_symbols(file)
+
+        if functions is None:
+            entries = list(symbols)
+        else:
+            entries = []
+            for function in functions:
+                if isinstance(function, str):
+                    address = self.resolve_symbol(function, backing_file)
+                else:
+                    address = self.resolve_address(function, backing_file)
+
+                if address not in symbols:
+                    raise ValueError(f"Cannot find the bounds of the function at {hex(address)}.")
+
+                entries.append(address)
+
+        call_utilities = call_utilities_provider(self.arch)
+
+        monitor = ReturnAddressMonitor(canary=canary, callback=callback)
+        returns = []
+        canary_offsets = {}
+
+        for entry in entries:
+            name, size = symbols[entry]
+            code = self.memory.read(entry, size)
+
+            monitor.functions[entry] = name
+            returns.extend(call_utilities.get_return_instructions(code, entry))
+
+            if canary and (offset := call_utilities.get_canary_offset(code, entry)):
+                canary_offsets[entry] = offset
+
+        canary_check = None
+        if canary:
+            # Statically linked binaries carry their own copy of the handler
+            for candidate in ("libc.so", backing_file):
+                try:
+                    canary_check = self.resolve_symbol("__stack_chk_fail", candidate)
+                    break
+                except ValueError:
+                    continue
+            else:
+                liblog.warning("Cannot find __stack_chk_fail in the process, the stack canary will not be monitored.")
+
+        link_to_internal_debugger(monitor, self)
+
+        self.__polling_thread_command_queue.put(
+            (self.__threaded_monitor_return_addresses, (monitor, returns, canary_offsets, canary_check)),
+        )
+
+        self._join_and_check_status()
+
+        return monitor
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def trace_functions(
+        self: InternalDebugger,
+        functions: list[int | str],
+        args: int = 0,
+        capture_return: bool = True,
+        buffer_size: int = 65536,
+    ) -> FunctionTracer:
+        """Traces the calls to the specified functions.
+
+        Args:
+            functions (list[int | str]): The functions to trace. Symbols are resolved on the PLT of the binary first,
+            then in every loaded file. A `file:pattern` string traces every function of the backing file matching
+            the glob pattern.
+            args (int, optional): The number of arguments to capture for each call. Defaults to 0.
+            capture_return (bool, optional): Whether to capture the return value and the duration of each call.
+            Defaults to True.
+            buffer_size (int, optional): The size of the native ring buffer of traced calls. Defaults to 65536.
+
+        Returns:
+            FunctionTracer: The FunctionTracer object.
+        """
+        if self.function_tracer is not None:
+            raise RuntimeError("The functions of this process are already traced.")
+
+        if not 0 <= args <= FUNCTION_TRACER_MAX_ARGS[self.arch]:
+            raise ValueError(f"Only up to {FUNCTION_TRACER_MAX_ARGS[self.arch]} arguments can be captured.")
+
+        if buffer_size <= 0:
+            raise ValueError("The buffer size must be positive.")
+
+        tracer = FunctionTracer(args=args, capture_return=capture_return, buffer_size=buffer_size)
+
+        for function in functions:
+            tracer.functions.update(self._resolve_traced_function(function))
+
+        link_to_internal_debugger(tracer, self)
+
+        self.__polling_thread_command_queue.put((self.__threaded_trace_functions, (tracer,)))
+
+        self._join_and_check_status()
+
+        return tracer
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def track_heap(
+        self: InternalDebugger,
+        backtrace: int = 0,
+        mmap: bool = True,
+        report_on_exit: bool = False,
+    ) -> HeapTracker:
+        """Tracks the heap allocations of the process.
+
+        Args:
+            backtrace (int, optional): The number of callers to record for each allocation, besides the allocation
+            site. Defaults to 0.
+            mmap (bool, optional): Whether to track the memory mappings and the heap growth as well. Defaults to True.
+            report_on_exit (bool, optional): Whether to print the leak report when the process exits. Defaults to
+            False.
+
+        Returns:
+            HeapTracker: The HeapTracker object.
+        """
+        if self.heap_tracker is not None:
+            raise RuntimeError("The heap of this process is already tracked.")
+
+        if not 0 <= backtrace <= HEAP_TRACKER_MAX_BACKTRACE:
+            raise ValueError(f"Only up to {HEAP_TRACKER_MAX_BACKTRACE} callers can be recorded.")
+
+        tracker = HeapTracker(backtrace=backtrace, report_on_exit=report_on_exit)
+
+        names = HEAP_TRACKER_FUNCTIONS + HEAP_TRACKER_MMAP_FUNCTIONS if mmap else HEAP_TRACKER_FUNCTIONS
+
+        for name in names:
+            # The allocator is usually the one of libc, but a statically linked binary brings its own
+            for backing_file in ["libc.so", "binary"]:
+                try:
+                    address = self.resolve_symbol(name, backing_file)
+                except ValueError:
+                    continue
+
+                tracker.functions[address] = name
+                break
+
+        if not any(name in ("malloc", "free") for name in tracker.functions.values()):
+            raise ValueError("Cannot find the allocator of the process.")
+
+        link_to_internal_debugger(tracker, self)
+
+        self.__polling_thread_command_queue.put((self.__threaded_track_heap, (tracker,)))
+
+        self._join_and_check_status()
+
+        return tracker
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def profile(self: InternalDebugger, frequency: int = 99, max_depth: int = 64) -> Profiler:
+        """Samples the stacks of the threads of the process at a fixed frequency.
+
+        Args:
+            frequency (int, optional): The sampling frequency, in Hz. Defaults to 99.
+            max_depth (int, optional): The maximum number of frames collected for each stack. Defaults to 64.
+
+        Returns:
+            Profiler: The Profiler object.
+        """
+        if self.profiler is not None:
+            raise RuntimeError("This process is already profiled.")
+
+        if not 1 <= frequency <= PROFILER_MAX_FREQUENCY:
+            raise ValueError(f"The sampling frequency must be between 1 and {PROFILER_MAX_FREQUENCY} Hz.")
+
+        if not 1 <= max_depth <= PROFILER_MAX_DEPTH:
+            raise ValueError(f"Only up to {PROFILER_MAX_DEPTH} frames can be collected.")
+
+        profiler = Profiler(frequency=frequency, max_depth=max_depth)
+
+        link_to_internal_debugger(profiler, self)
+
+        self.__polling_thread_command_queue.put((self.__threaded_profile, (profiler,)))
+
+        self._join_and_check_status()
+
+        return profiler
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def budget(
+        self: InternalDebugger,
+        wall_time: float | None = None,
+        cpu_time: float | None = None,
+        syscalls: int | None = None,
+        breakpoint_hits: int | None = None,
+    ) -> ExecutionBudget:
+        """Limits the resources the process can use before it is interrupted, replacing the previous budget.
+
+        Args:
+            wall_time (float, optional): The seconds of real time. Defaults to None (unlimited).
+            cpu_time (float, optional): The seconds of CPU time. Defaults to None (unlimited).
+            syscalls (int, optional): The number of syscalls. Defaults to None (unlimited).
+            breakpoint_hits (int, optional): The number of breakpoint hits. Defaults to None (unlimited).
+
+        Returns:
+            ExecutionBudget: The ExecutionBudget object.
+        """
+        limits = (wall_time, cpu_time, syscalls, breakpoint_hits)
+
+        if all(limit is None for limit in limits):
+            raise ValueError("At least one limit must be specified.")
+
+        if any(limit is not None and limit <= 0 for limit in limits):
+            raise ValueError("The limits must be positive.")
+
+        budget = ExecutionBudget(wall_time, cpu_time, syscalls, breakpoint_hits)
+
+        link_to_internal_debugger(budget, self)
+
+        self.__polling_thread_command_queue.put((self.__threaded_budget, (budget,)))
+
+        self._join_and_check_status()
+
+        return budget
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def profile_syscalls(self: InternalDebugger, call_sites: bool = False) -> SyscallProfiler:
+        """Measures the latency of the syscalls of the process.
+
+        Args:
+            call_sites (bool, optional): Whether to also account the calls per call site. Defaults to False.
+
+        Returns:
+            SyscallProfiler: The SyscallProfiler object.
+        """
+        if self.syscall_profiler is not None:
+            raise RuntimeError("The syscalls of this process are already profiled.")
+
+        profiler = SyscallProfiler(call_sites=call_sites)
+
+        link_to_internal_debugger(profiler, self)
+
+        self.__polling_thread_command_queue.put((self.__threaded_profile_syscalls, (profiler,)))
+
+        self._join_and_check_status()
+
+        return profiler
+
+    def syscall_stats(
+        self: InternalDebugger,
+        per_thread: bool = False,
+        per_call_site: bool = False,
+    ) -> list[SyscallStats]:
+        """Returns the latencies of the syscalls of the process, the ones that took the most time first.
+
+        Args:
+            per_thread (bool, optional): Whether to keep the calls of each thread separated. Defaults to False.
+            per_call_site (bool, optional): Whether to keep the calls of each call site separated. Defaults to False.
+
+        Returns:
+            list[SyscallStats]: The latencies of the syscalls.
+        """
+        if self.syscall_profiler is None:
+            raise RuntimeError("The syscalls of this process are not profiled. Did you call profile_syscalls()?")
+
+        return self.syscall_profiler.stats(per_thread, per_call_site)
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def track_fds(self: InternalDebugger) -> FdTracker:
+        """Tracks the file descriptors of the process natively.
+
+        Returns:
+            FdTracker: The FdTracker object.
+        """
+        if self.fd_tracker is not None:
+            raise RuntimeError("The file descriptors of this process are already tracked.")
+
+        tracker = FdTracker()
+
+        link_to_internal_debugger(tracker, self)
+
+        self.__polling_thread_command_queue.put((self.__threaded_track_fds, (tracker,)))
+
+        self._join_and_check_status()
+
+        return tracker
+
+    def fd_info(self: InternalDebugger, fd: int) -> FdInfo | None:
+        """Returns what a file descriptor of the process refers to.
+
+        Args:
+            fd (int): The file descriptor.
+
+        Returns:
+            FdInfo | None: The file descriptor, None if it is not open.
+        """
+        if not self.instanced:
+            raise RuntimeError("Process not running, cannot access the file descriptors.")
+
+        self._ensure_process_stopped()
+
+        if self.fd_tracker is not None and self.fd_tracker.enabled:
+            return self.debugging_interface.get_fd_info(fd)
+
+        path = get_fd_target(self.process_id, fd)
+
+        return FdInfo(fd, path) if path is not None else None
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def virtual_time(self: InternalDebugger) -> VirtualClock:
+        """Fast-forwards the sleeps and the timeouts of the process on a virtual clock.
+
+        Returns:
+            VirtualClock: The VirtualClock object.
+        """
+        if self.virtual_clock is not None:
+            raise RuntimeError("The virtual clock of this process is already installed.")
+
+        clock = VirtualClock()
+
+        link_to_internal_debugger(clock, self)
+
+        clock._vdso_patches = self._patch_vdso_clocks()
+
+        self.__polling_thread_command_queue.put((self.__threaded_virtual_time, (clock,)))
+
+        self._join_and_check_status()
+
+        return clock
+
+    def _patch_vdso_clocks(self: InternalDebugger) -> dict[int, bytes]:
+        """Replaces the clock functions of the vDSO with stubs that execute the syscalls, so that their reads are seen.
+
+        Returns:
+            dict[int, bytes]: The original code of each patched function, by address.
+        """
+        call_utilities = call_utilities_provider(self.arch)
+        patches = {}
+
+        vdso = [vmap for vmap in self.maps() if vmap.backing_file == "[vdso]"]
+
+        if not vdso:
+            return patches
+
+        start = min(vmap.start for vmap in vdso)
+        end = max(vmap.end for vmap in vdso)
+
+        symbols = get_image_dynamic_symbols(self.memory.read(start, end - start))
+        offsets = sorted({offset for offset, _ in symbols.values()})
+
+        for name, (offset, size) in symbols.items():
+            for prefix in VDSO_SYMBOL_PREFIXES:
+                name = name.removeprefix(prefix)
+
+            if name not in VDSO_CLOCK_FUNCTIONS or start + offset in patches:
+                continue
+
+            stub = call_utilities.get_syscall_stub(resolve_syscall_number(self.arch, name))
+
+            # The stub can overwrite the alignment padding, up to the next function
+            room = -(-(offset + size) // VDSO_FUNCTION_ALIGNMENT) * VDSO_FUNCTION_ALIGNMENT - offset
+            following = next((other for other in offsets if other > offset), None)
+
+            if following is not None:
+                room = min(room, following - offset)
+
+            if room < len(stub):
+                liblog.warning(f"The {name} function of the vDSO is too small to be patched, its reads are not seen.")
+                continue
+
+            patches[start + offset] = self.memory.read(start + offset, len(stub))
+            self.memory.write(start + offset, stub)
+
+        # The syscall instruction found in the vDSO might have been overwritten
+        self._syscall_gadget = None
+
+        return patches
+
+    def _restore_vdso_clocks(self: InternalDebugger, patches: dict[int, bytes]) -> None:
+        """Restores the clock functions of the vDSO patched for the virtual clock."""
+        for address, code in patches.items():
+            self.memory.write(address, code)
+
+        self._syscall_gadget = None
+
+    @background_alias(_background_invalid_call)
+    def _start_lockstep(self: InternalDebugger, lockstep: object, side: int) -> None:
+        """Starts a side of a lockstep in the polling thread, without waiting for it to complete.
+
+        The polling thread waits for the other side at each step, so both sides must be started before joining either,
+        and the process must be checked to be stopped and alive beforehand.
+
+        Args:
+            lockstep (object): The native lockstep, created by the debugging interface.
+            side (int): 0 if the process is the first of the lockstep, 1 if it is the second.
+        """
+        self.__polling_thread_command_queue.put((self.__threaded_lockstep, (self.threads[0], lockstep, side)))
+
+    @background_alias(_background_invalid_call)
+    def set_latency_mode(
+        self: InternalDebugger,
+        policy: str | None,
+        cpu: int | None = None,
+        spin_time: float = 0.0,
+    ) -> LatencyMode | None:
+        """Pins the polling thread and the process to chosen CPUs, to reduce the latency of the stops.
+
+        Args:
+            policy (str | None): "same-core" to run both on the same CPU, "sibling-core" to run them on two CPUs
+            sharing the same physical core or package, None to restore the default placement.
+            cpu (int, optional): The CPU of the polling thread. Defaults to None (the first CPU available).
+            spin_time (float, optional): The seconds the polling thread busy-waits for a stop before sleeping.
+            Defaults to 0.
+
+        Returns:
+            LatencyMode | None: The resolved placement.
+        """
+        mode = None
+
+        if policy is not None:
+            mode = resolve_latency_mode(policy, cpu, spin_time, os.sched_getaffinity(0))
+
+        if self.instanced:
+            self._ensure_process_stopped()
+
+        self.latency_mode = mode
+
+        self.__polling_thread_command_queue.put((self.__threaded_set_latency_mode, (mode,)))
+
+        self._join_and_check_status()
+
+        return mode
+
+    def _resolve_traced_function(self: InternalDebugger, function: int | str) -> dict[int, str]:
+        """Resolves the entry points of a function to trace.
+
+        Args:
+            function (int | str): The function, as an address, a symbol or a `file:pattern` string.
+
+        Returns:
+            dict[int, str]: The entry points of the matching functions, with their names.
+        """
+        if isinstance(function, int):
+            address = self.resolve_address(function, "hybrid")
+            return {address: hex(address)}
+
+        backing_file, separator, pattern = function.partition(":")
+
+        # Only an explicit file prefix makes a glob, a double colon belongs to a C++ symbol such as ns::operator[]
+        if separator and not pattern.startswith(":"):
+            _, symbols = self._resolve_function_symbols(backing_file)
+            matches = {address: name for address, (name, _) in symbols.items() if fnmatchcase(name, pattern)}
+
+            if not matches:
+                raise ValueError(f"No function matches {function}.")
+
+            return matches
+
+        # Imported functions are traced on the PLT of the binary, as ltrace does
+        full_path, base_address, _ = self._resolve_backing_file_maps("binary")
+        plt_entries = get_plt_entries(full_path)
+
+        if function in plt_entries:
+            return {plt_entries[function] + base_address: function}
+
+        return {resolve_symbol_in_maps(function, self.debugging_interface.maps()): function}
+
     @background_alias(_background_invalid_call)
     @change_state_function_process
     def catch_signal(
@@ -708,10 +1404,264 @@ class InternalDebugger:
 
         return handler
 
+    def _background_syscall(self: InternalDebugger, thread: ThreadContext, syscall: int | str, *args: int) -> int:
+        """Executes a syscall in a thread of the process, from a callback."""
+        number, arguments = self._prepare_syscall(syscall, args)
+
+        # The memory cannot be searched for a gadget from here
+        return self.debugging_interface.inject_syscall(thread, number, arguments, self._syscall_gadget or 0)
+
+    @background_alias(_background_syscall)
+    @change_state_function_thread
+    def syscall(self: InternalDebugger, thread: ThreadContext, syscall: int | str, *args: int) -> int:
+        """Executes a syscall in a thread of the process, restoring the state of the thread afterwards.
+
+        Args:
+            thread (ThreadContext): The thread that executes the syscall.
+            syscall (int | str): The syscall name or number.
+            *args (int): The arguments of the syscall, at most six.
+
+        Returns:
+            int: The return value of the syscall.
+        """
+        number, arguments = self._prepare_syscall(syscall, args)
+
+        if self._syscall_gadget is None:
+            self._syscall_gadget = self._find_syscall_gadget()
+
+        self.__polling_thread_command_queue.put(
+            (self.__threaded_inject_syscall, (thread, number, arguments, self._syscall_gadget)),
+        )
+
+        # We cannot call _join_and_check_status here, as we need the return value which might not be an exception
+        self.__polling_thread_command_queue.join()
+
+        value = self.__polling_thread_response_queue.get()
+        self.__polling_thread_response_queue.task_done()
+
+        if isinstance(value, BaseException):
+            raise value
+
+        return value
+
+    def _prepare_syscall(self: InternalDebugger, syscall: int | str, args: tuple[int, ...]) -> tuple[int, list[int]]:
+        """Resolves the number of a syscall to inject, and pads its arguments."""
+        if len(args) > 6:
+            raise ValueError("A syscall takes at most six arguments.")
+
+        number = resolve_syscall_number(self.arch, syscall) if isinstance(syscall, str) else syscall
+
+        return number, [*args, *([0] * (6 - len(args)))]
+
+    def _find_syscall_gadget(self: InternalDebugger) -> int:
+        """Finds a syscall instruction in the vDSO, so that no instruction must be patched to inject a syscall.
+
+        Returns:
+            int: The address of the instruction, 0 if there is none.
+        """
+        call_utilities = call_utilities_provider(self.arch)
+
+        for vmap in self.maps():
+            if vmap.backing_file != "[vdso]" or "x" not in vmap.permissions:
+                continue
+
+            gadget = call_utilities.find_syscall_instruction(self.memory.read(vmap.start, vmap.size), vmap.start)
+
+            if gadget is not None:
+                return gadget
+
+        return 0
+
+    @change_state_function_process
+    def alloc(self: InternalDebugger, size: int, protection: str | int = "rw") -> int:
+        """Allocates scratch memory in the process.
+
+        Args:
+            size (int): The number of bytes to allocate.
+            protection (str | int, optional): The protection of the memory, e.g., "rw" or "rwx". Defaults to "rw".
+
+        Returns:
+            int: The address of the allocated memory.
+        """
+        return self._get_scratch_allocator().alloc(size, parse_protection(protection))
+
+    def _get_scratch_allocator(self: InternalDebugger) -> ScratchAllocator:
+        """Returns the allocator of the scratch memory of the process, creating it on first use."""
+        if self._scratch_allocator is None:
+            self._scratch_allocator = ScratchAllocator()
+            link_to_internal_debugger(self._scratch_allocator, self)
+
+        return self._scratch_allocator
+
+    def _background_call(
+        self: InternalDebugger,
+        thread: ThreadContext,
+        function: int | str,
+        *args: int,
+        file: str = "hybrid",
+    ) -> int:
+        """Calls a function of the process in a thread, from a callback."""
+        address, arguments = self._prepare_call(function, args, file)
+
+        return self.debugging_interface.call_function(thread, address, self._get_return_trap(), arguments)
+
+    @background_alias(_background_call)
+    @change_state_function_thread
+    def call(
+        self: InternalDebugger,
+        thread: ThreadContext,
+        function: int | str,
+        *args: int,
+        file: str = "hybrid",
+    ) -> int:
+        """Calls a function of the process in a thread, restoring the state of the thread afterwards.
+
+        Args:
+            thread (ThreadContext): The thread that executes the function.
+            function (int | str): The address or the symbol of the function.
+            *args (int): The integer arguments of the function.
+            file (str, optional): The backing file to resolve the function in. Defaults to "hybrid".
+
+        Returns:
+            int: The return value of the function.
+        """
+        address, arguments = self._prepare_call(function, args, file)
+        trap = self._get_return_trap()
+
+        self.__polling_thread_command_queue.put(
+            (self.__threaded_call_function, (thread, address, trap, arguments)),
+        )
+
+        # We cannot call _join_and_check_status here, as we need the return value which might not be an exception
+        self.__polling_thread_command_queue.join()
+
+        value = self.__polling_thread_response_queue.get()
+        self.__polling_thread_response_queue.task_done()
+
+        if isinstance(value, BaseException):
+            raise value
+
+        return value
+
+    def _prepare_call(
+        self: InternalDebugger,
+        function: int | str,
+        args: tuple[int, ...],
+        file: str,
+    ) -> tuple[int, list[int]]:
+        """Resolves the address of a function to call, and validates its arguments."""
+        if not all(isinstance(arg, int) for arg in args):
+            raise TypeError("The arguments of a function must be integers, e.g., the addresses of the buffers.")
+
+        if not isinstance(function, str):
+            return self.resolve_address(function, file, skip_absolute_address_validation=True), list(args)
+
+        # The functions are usually called over and over, the addresses are resolved again only when
+        # the mapped files change, e.g., after a dlopen, a dlclose or an exec. The maps are cached until the
+        # process runs, or a called function maps or unmaps memory, so the images are compared only then.
+        maps = self.debugging_interface.maps()
+
+        if maps is not self._call_targets_maps:
+            images = tuple(
+                (vmap.start, vmap.backing_file)
+                for vmap in maps
+                if vmap.offset == 0 and vmap.backing_file.startswith("/")
+            )
+
+            if images != self._call_targets_images:
+                self._call_targets.clear()
+                self._call_targets_images = images
+
+            self._call_targets_maps = maps
+
+        if (function, file) not in self._call_targets:
+            self._call_targets[function, file] = self.resolve_symbol(function, file)
+
+        return self._call_targets[function, file], list(args)
+
+    def _get_return_trap(self: InternalDebugger) -> int:
+        """Returns the address of the instruction that traps the return from the called functions.
+
+        The instruction is written once in read-only scratch memory, so that it is never hit by the process.
+        """
+        if self._return_trap is None:
+            trap = call_utilities_provider(self.arch).get_return_trap()
+            address = self._get_scratch_allocator().alloc(len(trap), mmap.PROT_READ | mmap.PROT_EXEC)
+
+            self._poke_memory(address, trap)
+            self._return_trap = address
+
+        return self._return_trap
+
     @background_alias(_background_invalid_call)
     @change_state_function_process
-    def gdb(self: InternalDebugger, open_in_new_process: bool = True) -> None:
-        """Migrates the current debugging session to GDB."""
+    def gdb_server(self: InternalDebugger, host: str = "127.0.0.1", port: int = 0) -> GdbServer:
+        """Serves the process to the clients of the GDB remote serial protocol.
+
+        Args:
+            host (str, optional): The address to listen on. Defaults to "127.0.0.1".
+            port (int, optional): The port to listen on. Defaults to 0 (any free port).
+
+        Returns:
+            GdbServer: The server, already accepting the clients.
+        """
+        if self._gdb_server is not None and self._gdb_server.serving:
+            raise RuntimeError("The process is already served to GDB.")
+
+        server = GdbServer(host, port)
+
+        link_to_internal_debugger(server, self)
+
+        server.start()
+
+        liblog.debugger("Serving the process to GDB on %s.", server.address)
+
+        self._gdb_server = server
+
+        return server
+
+    @background_alias(_background_invalid_call)
+    @change_state_function_process
+    def gdb(self: InternalDebugger, open_in_new_process: bool = True, migrate: bool = False) -> None:
+        """Opens GDB on the current debugging session.
+
+        Args:
+            open_in_new_process (bool, optional): Whether to open GDB in a new terminal, following the configuration
+            in libcontext.terminal, instead of the current shell. Defaults to True.
+            migrate (bool, optional): Whether to detach from the process and let GDB attach to it, instead of serving
+            it to GDB. Defaults to False.
+        """
+        if migrate:
+            self._migrate_to_gdb(open_in_new_process)
+            return
+
+        server = self.gdb_server()
+
+        args = [
+            "/bin/gdb",
+            "-q",
+            self._process_full_path,
+            "-ex",
+            "target remote " + server.address,
+        ]
+
+        try:
+            if open_in_new_process and libcontext.terminal:
+                Popen(libcontext.terminal + args)
+
+                # GDB detaches from the server when it quits
+                server.wait()
+            else:
+                if open_in_new_process:
+                    liblog.warning(
+                        "Cannot open in a new process. Please configure the terminal in libcontext.terminal.",
+                    )
+                self._open_gdb_in_shell(args)
+        finally:
+            server.stop()
+
+    def _migrate_to_gdb(self: InternalDebugger, open_in_new_process: bool) -> None:
+        """Migrates the current debugging session to GDB, until GDB detaches from the process."""
         # TODO: not needed?
         self.interrupt()
 
@@ -726,7 +1676,7 @@ class InternalDebugger:
                 liblog.warning(
                     "Cannot open in a new process. Please configure the terminal in libcontext.terminal.",
                 )
-            self._open_gdb_in_shell()
+            self._open_gdb_in_shell(self._craft_gdb_migration_command())
 
         self.__polling_thread_command_queue.put((self.__threaded_migrate_from_gdb, ()))
 
@@ -796,11 +1746,14 @@ class InternalDebugger:
             # So we must keep polling it until it is no longer running
             pass
 
-    def _open_gdb_in_shell(self: InternalDebugger) -> None:
-        """Open GDB in the current shell."""
+    def _open_gdb_in_shell(self: InternalDebugger, args: list[str]) -> None:
+        """Open GDB in the current shell.
+
+        Args:
+            args (list[str]): The command line of GDB.
+        """
         gdb_pid = os.fork()
         if gdb_pid == 0:  # This is the child process.
-            args = self._craft_gdb_migration_command()
             os.execv("/bin/gdb", args)
         else:  # This is the parent process.
             # Parent ignores SIGINT, so only GDB (child) receives it
@@ -850,6 +1803,11 @@ class InternalDebugger:
             file (str, optional): The user-defined backing file to resolve the address in. Defaults to "hybrid"
             (libdebug will first try to solve the address as an absolute address, then as a relative address w.r.t.
             the "binary" map file).
+            native_callback (object, optional): A C function handling the breakpoint without leaving the native code,
+            as a cffi or ctypes function pointer, or as an address. It returns 0 to resume the process, any other value
+            to stop it. Defaults to None.
+            native_data (object, optional): A pointer passed to the native callback, as a cffi or ctypes object, or as
+            an address. Defaults to None.
         """
         if isinstance(position, str):
             address = self.resolve_symbol(position, file)
@@ -876,6 +1834,11 @@ class InternalDebugger:
             file (str, optional): The user-defined backing file to resolve the address in. Defaults to "hybrid"
             (libdebug will first try to solve the address as an absolute address, then as a relative address w.r.t.
             the "binary" map file).
+            native_callback (object, optional): A C function handling the breakpoint without leaving the native code,
+            as a cffi or ctypes function pointer, or as an address. It returns 0 to resume the process, any other value
+            to stop it. Defaults to None.
+            native_data (object, optional): A pointer passed to the native callback, as a cffi or ctypes object, or as
+            an address. Defaults to None.
         """
         if isinstance(position, str):
             address = self.resolve_symbol(position, file)
@@ -1124,16 +2087,61 @@ class InternalDebugger:
         Returns:
             int: The address of the symbol.
         """
-        maps = self.debugging_interface.maps()
-
         if backing_file == "absolute":
             raise ValueError("Cannot use `absolute` backing file with symbols.")
 
         if backing_file == "hybrid":
             # If no explicit backing file is specified, we have to assume it is in the main map
-            backing_file = self._process_full_path
-            liblog.debugger(f"No backing file specified for the symbol {symbol}. Assuming {backing_file}.")
-        elif backing_file == (full_backing_path := self._process_full_path) or backing_file in [
+            liblog.debugger(f"No backing file specified for the symbol {symbol}. Assuming {self._process_full_path}.")
+
+        _, _, filtered_maps = self._resolve_backing_file_maps(backing_file)
+
+        return resolve_symbol_in_maps(symbol, filtered_maps)
+
+    def _resolve_function_symbols(self: InternalDebugger, backing_file: str) -> tuple[str, dict[int, tuple[str, int]]]:
+        """Resolves the functions defined in the specified backing file.
+
+        Args:
+            backing_file (str): The backing file, or a substring of it.
+
+        Returns:
+            str: The full path of the backing file.
+            dict[int, tuple[str, int]]: The functions of the backing file. Key: the entry point of the function.
+            Value: the symbol and the size of the function.
+        """
+        full_path, base_address, maps = self._resolve_backing_file_maps(backing_file)
+
+        executable_maps = [vmap for vmap in maps if "x" in vmap.permissions]
+        symbols = {
+            low + base_address: (name, high - low)
+            for name, (low, high) in get_symbols(full_path).items()
+            if high > low and any(vmap.start <= low + base_address < vmap.end for vmap in executable_maps)
+        }
+
+        return full_path, symbols
+
+    def _resolve_cpython_layout(self: InternalDebugger) -> CPythonLayout:
+        """Returns the layout of the CPython interpreter running in the process, resolving it on first use."""
+        if self._cpython_layout is None:
+            self._cpython_layout = resolve_cpython_layout(self)
+
+        return self._cpython_layout
+
+    def _resolve_backing_file_maps(self: InternalDebugger, backing_file: str) -> tuple[str, int, list[MemoryMap]]:
+        """Resolves the specified backing file to the memory maps it is loaded in.
+
+        Args:
+            backing_file (str): The backing file, or a substring of it.
+
+        Returns:
+            str: The full path of the backing file.
+            int: The base address of the backing file, 0 if it is not position independent.
+            list[MemoryMap]: The memory maps of the backing file.
+        """
+        maps = self.debugging_interface.maps()
+
+        if backing_file == (full_backing_path := self._process_full_path) or backing_file in [
+            "hybrid",
             "binary",
             self._process_name,
         ]:
@@ -1157,7 +2165,10 @@ class InternalDebugger:
                 f"The specified string {backing_file} does not correspond to any backing file. The available backing files are: {', '.join(set(vmap.backing_file for vmap in maps))}.",
             )
 
-        return resolve_symbol_in_maps(symbol, filtered_maps)
+        full_path = filtered_maps[0].backing_file
+        base_address = filtered_maps[0].start if is_pie(full_path) else 0
+
+        return full_path, base_address, filtered_maps
 
     def _background_ensure_process_stopped(self: InternalDebugger) -> None:
         """Validates the state of the process."""
@@ -1203,10 +2214,23 @@ class InternalDebugger:
             if return_value is not None:
                 self.__polling_thread_response_queue.join()
 
-    def _join_and_check_status(self: InternalDebugger) -> None:
+    def _join_and_check_status(self: InternalDebugger, deadline: float | None = None) -> bool:
         # Wait for the background thread to signal "task done" before returning
         # We don't want any asynchronous behaviour here
-        self.__polling_thread_command_queue.join()
+        if deadline is None:
+            self.__polling_thread_command_queue.join()
+        else:
+            queue = self.__polling_thread_command_queue
+
+            with queue.all_tasks_done:
+                while queue.unfinished_tasks:
+                    remaining = deadline - time.monotonic()
+
+                    if remaining <= 0:
+                        # The command is still running, the caller decides what to do with it
+                        return False
+
+                    queue.all_tasks_done.wait(remaining)
 
         # Check for any exceptions raised by the background thread
         if not self.__polling_thread_response_queue.empty():
@@ -1215,6 +2239,8 @@ class InternalDebugger:
             if response is not None:
                 raise response
 
+        return True
+
     @functools.cached_property
     def _process_full_path(self: InternalDebugger) -> str:
         """Get the full path of the process.
@@ -1303,6 +2329,53 @@ class InternalDebugger:
         liblog.debugger("Setting breakpoint at 0x%x.", bp.address)
         self.debugging_interface.set_breakpoint(bp)
 
+    def __threaded_monitor_return_addresses(
+        self: InternalDebugger,
+        monitor: ReturnAddressMonitor,
+        returns: list[int],
+        canary_offsets: dict[int, int],
+        canary_check: int | None,
+    ) -> None:
+        liblog.debugger(f"Monitoring the return addresses of {len(monitor.functions)} functions.")
+        self.debugging_interface.set_return_address_monitor(monitor, returns, canary_offsets, canary_check)
+
+    def __threaded_trace_functions(self: InternalDebugger, tracer: FunctionTracer) -> None:
+        liblog.debugger(f"Tracing {len(tracer.functions)} functions.")
+        self.debugging_interface.set_function_tracer(tracer)
+
+    def __threaded_track_heap(self: InternalDebugger, tracker: HeapTracker) -> None:
+        liblog.debugger(f"Tracking the heap through {len(tracker.functions)} functions.")
+        self.debugging_interface.set_heap_tracker(tracker)
+
+    def __threaded_profile(self: InternalDebugger, profiler: Profiler) -> None:
+        liblog.debugger(f"Profiling the process at {profiler.frequency} Hz.")
+        self.debugging_interface.set_profiler(profiler)
+
+    def __threaded_budget(self: InternalDebugger, budget: ExecutionBudget) -> None:
+        liblog.debugger("Setting the execution budget of the process.")
+        self.debugging_interface.set_budget(budget)
+
+    def __threaded_profile_syscalls(self: InternalDebugger, profiler: SyscallProfiler) -> None:
+        liblog.debugger("Profiling the syscalls of the process.")
+        self.debugging_interface.set_syscall_profiler(profiler)
+
+    def __threaded_track_fds(self: InternalDebugger, tracker: FdTracker) -> None:
+        liblog.debugger("Tracking the file descriptors of the process.")
+        self.debugging_interface.set_fd_tracker(tracker)
+
+    def __threaded_virtual_time(self: InternalDebugger, clock: VirtualClock) -> None:
+        liblog.debugger("Installing the virtual clock of the process.")
+        self.debugging_interface.set_virtual_clock(clock)
+
+    def __threaded_lockstep(self: InternalDebugger, thread: ThreadContext, lockstep: object, side: int) -> None:
+        liblog.debugger("Running side %d of the lockstep in thread %d.", side, thread.thread_id)
+        self.debugging_interface.lockstep(thread, lockstep, side)
+
+    def __threaded_set_latency_mode(self: InternalDebugger, mode: LatencyMode | None) -> None:
+        if mode is not None:
+            liblog.debugger(f"Pinning the debugger to CPU {mode.tracer_cpu} and the process to CPU {mode.tracee_cpu}.")
+        self.debugging_interface.set_latency_mode(mode)
+
     def __threaded_catch_signal(self: InternalDebugger, catcher: SignalCatcher) -> None:
         liblog.debugger(
             f"Setting the catcher for signal {resolve_signal_name(catcher.signal_number)} ({catcher.signal_number}).",
@@ -1351,6 +2424,26 @@ class InternalDebugger:
     def __threaded_migrate_from_gdb(self: InternalDebugger) -> None:
         self.debugging_interface.migrate_from_gdb()
 
+    def __threaded_inject_syscall(
+        self: InternalDebugger,
+        thread: ThreadContext,
+        number: int,
+        arguments: list[int],
+        gadget: int,
+    ) -> int:
+        liblog.debugger("Injecting syscall %d in thread %d.", number, thread.thread_id)
+        return self.debugging_interface.inject_syscall(thread, number, arguments, gadget)
+
+    def __threaded_call_function(
+        self: InternalDebugger,
+        thread: ThreadContext,
+        function: int,
+        trap: int,
+        arguments: list[int],
+    ) -> int:
+        liblog.debugger("Calling the function at %#x in thread %d.", function, thread.thread_id)
+        return self.debugging_interface.call_function(thread, function, trap, arguments)
+
     def __threaded_peek_memory(self: InternalDebugger, address: int) -> bytes | BaseException:
         value = self.debugging_interface.peek_memory(address)
         return value.to_bytes(get_platform_register_size(libcontext.platform), sys.byteorder)
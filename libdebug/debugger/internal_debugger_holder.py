@@ -8,9 +8,9 @@ from __future__ import annotations
 
 import atexit
 from dataclasses import dataclass, field
-from threading import Lock
+from threading import local
 from typing import TYPE_CHECKING
-from weakref import WeakKeyDictionary
+from weakref import WeakSet
 
 from libdebug.liblog import liblog
 
@@ -20,11 +20,23 @@ if TYPE_CHECKING:
 
 @dataclass
 class InternalDebuggerHolder:
-    """A holder for internal debuggers."""
+    """A holder for internal debuggers.
 
-    internal_debuggers: WeakKeyDictionary = field(default_factory=WeakKeyDictionary)
-    global_internal_debugger = None
-    internal_debugger_lock = Lock()
+    The objects linked to an internal debugger keep a reference to it, so the holder only tracks the internal
+    debuggers themselves, for the cleanup at exit, and the one being extended by each thread.
+    """
+
+    internal_debuggers: WeakSet = field(default_factory=WeakSet)
+    _extended: local = field(default_factory=local)
+
+    @property
+    def global_internal_debugger(self: InternalDebuggerHolder) -> InternalDebugger | None:
+        """The internal debugger extended by the current thread, if any."""
+        return getattr(self._extended, "internal_debugger", None)
+
+    @global_internal_debugger.setter
+    def global_internal_debugger(self: InternalDebuggerHolder, internal_debugger: InternalDebugger | None) -> None:
+        self._extended.internal_debugger = internal_debugger
 
 
 internal_debugger_holder = InternalDebuggerHolder()
@@ -32,7 +44,7 @@ internal_debugger_holder = InternalDebuggerHolder()
 
 def _cleanup_internal_debugger() -> None:
     """Cleanup the internal debugger."""
-    for debugger in set(internal_debugger_holder.internal_debuggers.values()):
+    for debugger in set(internal_debugger_holder.internal_debuggers):
         debugger: InternalDebugger
 
         if debugger.instanced and debugger.kill_on_exit:
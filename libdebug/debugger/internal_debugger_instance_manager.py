@@ -31,14 +31,18 @@ def provide_internal_debugger(reference: object) -> InternalDebugger:
     Returns:
         InternalDebugger: the internal debugger.
     """
-    if reference in internal_debugger_holder.internal_debuggers:
-        return internal_debugger_holder.internal_debuggers[reference]
+    internal_debugger = getattr(reference, "_internal_debugger", None)
 
-    if internal_debugger_holder.global_internal_debugger is None:
+    if internal_debugger is not None:
+        return internal_debugger
+
+    internal_debugger = internal_debugger_holder.global_internal_debugger
+
+    if internal_debugger is None:
         raise RuntimeError("No internal debugger available")
 
-    internal_debugger_holder.internal_debuggers[reference] = internal_debugger_holder.global_internal_debugger
-    return internal_debugger_holder.global_internal_debugger
+    reference._internal_debugger = internal_debugger
+    return internal_debugger
 
 
 def link_to_internal_debugger(reference: object, internal_debugger: InternalDebugger) -> None:
@@ -48,23 +52,40 @@ def link_to_internal_debugger(reference: object, internal_debugger: InternalDebu
         reference (object): the object that needs the internal debugger.
         internal_debugger (InternalDebugger): the internal debugger.
     """
-    internal_debugger_holder.internal_debuggers[reference] = internal_debugger
+    # The reference points back to the internal debugger, there is no global registry to keep in sync
+    reference._internal_debugger = internal_debugger
+
+
+def register_internal_debugger(internal_debugger: InternalDebugger) -> None:
+    """Register an internal debugger, so that its process is cleaned up at exit.
+
+    Args:
+        internal_debugger (InternalDebugger): the internal debugger.
+    """
+    internal_debugger_holder.internal_debuggers.add(internal_debugger)
 
 
 @contextmanager
 def extend_internal_debugger(referrer: object) -> ...:
     """Extend the internal debugger.
 
+    The objects created by the current thread in the context are linked to the internal debugger of the referrer.
+
     Args:
         referrer (object): the referrer object.
 
     Yields:
         InternalDebugger: the internal debugger.
     """
-    with internal_debugger_holder.internal_debugger_lock:
-        if referrer not in internal_debugger_holder.internal_debuggers:
-            raise RuntimeError("Referrer isn't linked to any internal debugger.")
+    internal_debugger = getattr(referrer, "_internal_debugger", None)
+
+    if internal_debugger is None:
+        raise RuntimeError("Referrer isn't linked to any internal debugger.")
+
+    previous = internal_debugger_holder.global_internal_debugger
+    internal_debugger_holder.global_internal_debugger = internal_debugger
 
-        internal_debugger_holder.global_internal_debugger = internal_debugger_holder.internal_debuggers[referrer]
+    try:
         yield
-        internal_debugger_holder.global_internal_debugger = None
+    finally:
+        internal_debugger_holder.global_internal_debugger = previous
@@ -0,0 +1,145 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from libdebug.data.lockstep import LockstepResult, LockstepState
+from libdebug.liblog import liblog
+
+if TYPE_CHECKING:
+    from libdebug.debugger.debugger import Debugger
+    from libdebug.debugger.internal_debugger import InternalDebugger
+
+# What a step executes, and the corresponding native modes
+LOCKSTEP_MODES = {"block": 0, "instruction": 1, "syscall": 2, "breakpoint": 3}
+
+# The native outcomes of a lockstep
+LOCKSTEP_OUTCOMES = ["max_steps", "diverged", "exited", "event", "error"]
+
+# The registers compared by default, for each architecture
+LOCKSTEP_REGISTERS = {
+    "amd64": [
+        "rax",
+        "rbx",
+        "rcx",
+        "rdx",
+        "rsi",
+        "rdi",
+        "rbp",
+        "rsp",
+        "r8",
+        "r9",
+        "r10",
+        "r11",
+        "r12",
+        "r13",
+        "r14",
+        "r15",
+        "rip",
+        "eflags",
+    ],
+    "aarch64": [f"x{i}" for i in range(31)] + ["sp", "pc", "pstate"],
+}
+
+
+def _resolve_range(internal_debugger: InternalDebugger, address: int | str, file: str) -> int:
+    """Resolves the address of a compared memory range in a process."""
+    if isinstance(address, str):
+        return internal_debugger.resolve_symbol(address, file)
+
+    return internal_debugger.resolve_address(address, file)
+
+
+def run_lockstep(
+    first: Debugger,
+    second: Debugger,
+    mode: str,
+    registers: list[str] | None,
+    memory: list[tuple[int | str, int]],
+    max_steps: int | None,
+    file: str,
+) -> LockstepResult:
+    """Runs two processes in lockstep, comparing their state after each step, until they diverge.
+
+    Args:
+        first (Debugger): The debugger of the first process.
+        second (Debugger): The debugger of the second process.
+        mode (str): What a step executes.
+        registers (list[str] | None): The compared registers, None for the general purpose ones.
+        memory (list[tuple[int | str, int]]): The compared memory ranges, as an address or a symbol and a size.
+        max_steps (int | None): The maximum number of steps, None for no limit.
+        file (str): The backing file to resolve the memory ranges in.
+
+    Returns:
+        LockstepResult: The result of the lockstep.
+    """
+    if mode not in LOCKSTEP_MODES:
+        raise ValueError(f"Invalid lockstep mode {mode}. Valid modes are {', '.join(LOCKSTEP_MODES)}.")
+
+    debuggers = (first._internal_debugger, second._internal_debugger)
+
+    if debuggers[0] is debuggers[1]:
+        raise ValueError("The lockstep needs the debuggers of two different processes.")
+
+    if debuggers[0].arch != debuggers[1].arch:
+        raise ValueError("The processes of the lockstep must have the same architecture.")
+
+    if registers is None:
+        registers = LOCKSTEP_REGISTERS[debuggers[0].arch]
+
+    if max_steps is None:
+        max_steps = 2**64 - 1
+
+    # Once a side is started it waits for the other, so both are checked before starting either
+    for internal_debugger in debuggers:
+        if not internal_debugger.instanced:
+            raise RuntimeError("Process not running. Did you call run()?")
+
+        internal_debugger._ensure_process_stopped()
+
+        if internal_debugger.threads[0].dead:
+            raise RuntimeError("All threads are dead.")
+
+    sizes = [size for _, size in memory]
+
+    # Each process resolves the symbols of the ranges in its own memory
+    ranges = [
+        (_resolve_range(debuggers[0], address, file), _resolve_range(debuggers[1], address, file), size)
+        for address, size in memory
+    ]
+
+    native = debuggers[0].debugging_interface.create_lockstep(LOCKSTEP_MODES[mode], max_steps, registers, ranges)
+
+    liblog.debugger(f"Running the processes {debuggers[0].process_id} and {debuggers[1].process_id} in lockstep.")
+
+    # Each process is stepped by its own polling thread, which is its tracer, and the two wait for each other
+    debuggers[0]._start_lockstep(native, 0)
+    debuggers[1]._start_lockstep(native, 1)
+
+    try:
+        debuggers[0]._join_and_check_status()
+    finally:
+        try:
+            debuggers[1]._join_and_check_status()
+        finally:
+            outcome, steps, states = debuggers[0].debugging_interface.collect_lockstep(native, registers, sizes)
+
+    (first_registers, first_memory), (second_registers, second_memory) = states
+
+    return LockstepResult(
+        outcome=LOCKSTEP_OUTCOMES[outcome],
+        steps=steps,
+        first=LockstepState(first_registers, first_memory),
+        second=LockstepState(second_registers, second_memory),
+        registers={
+            name: (first_registers[name], second_registers[name])
+            for name in registers
+            if first_registers[name] != second_registers[name]
+        },
+        memory=[i for i in range(len(memory)) if first_memory[i] != second_memory[i]],
+    )
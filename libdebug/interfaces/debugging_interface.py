@@ -11,11 +11,25 @@ from typing import TYPE_CHECKING
 
 if TYPE_CHECKING:
     from libdebug.data.breakpoint import Breakpoint
+    from libdebug.data.execution_budget import BudgetUsage, ExecutionBudget
+    from libdebug.data.fd_table import FdInfo, FdTracker
+    from libdebug.data.function_tracer import FunctionTracer, TracedFunctionStats
+    from libdebug.data.heap_chunk import HeapChunkList, HeapCorruption
+    from libdebug.data.heap_tracker import HeapAllocation, HeapStats, HeapTracker
+    from libdebug.data.latency_mode import LatencyMode
+    from libdebug.data.profiler import ProfiledStack, Profiler, ProfilerStats
+    from libdebug.data.python_frame import PythonFrame
     from libdebug.data.memory_map import MemoryMap
     from libdebug.data.registers import Registers
+    from libdebug.data.return_address_monitor import ReturnAddressMonitor, ReturnAddressViolation
     from libdebug.data.signal_catcher import SignalCatcher
     from libdebug.data.syscall_handler import SyscallHandler
+    from libdebug.data.syscall_profiler import SyscallProfiler, SyscallStats
+    from libdebug.data.virtual_clock import VirtualClock, VirtualClockStats
+    from libdebug.memory.glibc_heap import GlibcHeapLayout
     from libdebug.state.thread_context import ThreadContext
+    from libdebug.utils.cpython_utils import CPythonLayout
+    from libdebug.utils.dwarf_location_utils import DwarfFramePlan
 
 
 class DebuggingInterface(ABC):
@@ -136,6 +150,103 @@ class DebuggingInterface(ABC):
             handler (HandledSyscall): The syscall to unset.
         """
 
+    @abstractmethod
+    def set_return_address_monitor(
+        self: DebuggingInterface,
+        monitor: ReturnAddressMonitor,
+        returns: list[int],
+        canary_offsets: dict[int, int],
+        canary_check: int | None,
+    ) -> None:
+        """Installs the return address monitor in the process.
+
+        Args:
+            monitor (ReturnAddressMonitor): The monitor to install.
+            returns (list[int]): The addresses of the return instructions of the monitored functions.
+            canary_offsets (dict[int, int]): The offset of the stack canary from the return address slot, for each
+            monitored function that stores one.
+            canary_check (int | None): The address of the stack check failure handler, if canary checks are monitored.
+        """
+
+    @abstractmethod
+    def get_return_address_violation(self: DebuggingInterface, thread_id: int) -> ReturnAddressViolation | None:
+        """Retrieves the oldest pending return address violation of the specified thread, if any.
+
+        Args:
+            thread_id (int): The thread to query.
+        """
+
+    @abstractmethod
+    def set_function_tracer(self: DebuggingInterface, tracer: FunctionTracer) -> None:
+        """Installs the function tracer in the process.
+
+        Args:
+            tracer (FunctionTracer): The tracer to install.
+        """
+
+    @abstractmethod
+    def get_traced_function_stats(self: DebuggingInterface) -> dict[str, TracedFunctionStats]:
+        """Returns the call count and latency statistics of each traced function."""
+
+    @abstractmethod
+    def set_heap_tracker(self: DebuggingInterface, tracker: HeapTracker) -> None:
+        """Installs the heap tracker in the process.
+
+        Args:
+            tracker (HeapTracker): The tracker to install.
+        """
+
+    @abstractmethod
+    def get_heap_stats(self: DebuggingInterface) -> HeapStats:
+        """Returns the statistics of the heap tracker."""
+
+    @abstractmethod
+    def get_heap_allocations(self: DebuggingInterface) -> list[HeapAllocation]:
+        """Returns the live allocations tracked by the heap tracker, sorted by address."""
+
+    @abstractmethod
+    def find_heap_allocation(self: DebuggingInterface, address: int) -> HeapAllocation | None:
+        """Returns the live allocation containing the specified address, if any.
+
+        Args:
+            address (int): The address to look up.
+        """
+
+    @abstractmethod
+    def set_profiler(self: DebuggingInterface, profiler: Profiler) -> None:
+        """Installs the sampling profiler in the process.
+
+        Args:
+            profiler (Profiler): The profiler to install.
+        """
+
+    @abstractmethod
+    def get_profiler_stats(self: DebuggingInterface) -> ProfilerStats:
+        """Returns the statistics of the profiler."""
+
+    @abstractmethod
+    def get_profiled_stacks(self: DebuggingInterface) -> list[ProfiledStack]:
+        """Returns the stacks collected by the profiler, with their sample count."""
+
+    @abstractmethod
+    def reset_profiler(self: DebuggingInterface) -> None:
+        """Discards the samples collected by the profiler."""
+
+    @abstractmethod
+    def walk_glibc_heap(
+        self: DebuggingInterface,
+        layout: GlibcHeapLayout,
+    ) -> tuple[HeapChunkList, list[HeapCorruption]]:
+        """Walks the main heap of glibc.
+
+        Args:
+            layout (GlibcHeapLayout): The layout of the main arena and the bounds of the main heap.
+
+        Returns:
+            HeapChunkList: The chunks of the main heap, sorted by address.
+            list[HeapCorruption]: The inconsistencies found in the chunks and in the bins.
+        """
+
     @abstractmethod
     def set_signal_catcher(self: DebuggingInterface, catcher: SignalCatcher) -> None:
         """Sets a catcher for a signal.
@@ -152,6 +263,200 @@ class DebuggingInterface(ABC):
             catcher (CaughtSignal): The signal to unset.
         """
 
+    @abstractmethod
+    def walk_python_stack(self: DebuggingInterface, layout: CPythonLayout, thread_id: int) -> list[PythonFrame]:
+        """Walks the frames of the Python code executed by a thread of a CPython interpreter.
+
+        Args:
+            layout (CPythonLayout): The layout of the interpreter.
+            thread_id (int): The thread to walk.
+
+        Returns:
+            list[PythonFrame]: The frames of the thread, innermost first.
+        """
+
+    @abstractmethod
+    def evaluate_dwarf_locations(
+        self: DebuggingInterface,
+        thread_id: int,
+        plan: DwarfFramePlan,
+    ) -> list[list[tuple[int, int, int]] | None]:
+        """Evaluates the locations of the variables of a frame against the registers of a thread.
+
+        Args:
+            thread_id (int): The thread whose registers are used.
+            plan (DwarfFramePlan): The locations to evaluate.
+
+        Returns:
+            list[list[tuple[int, int, int]] | None]: The pieces of each location, as (kind, size, value), None if the
+            location cannot be evaluated.
+        """
+
+    @abstractmethod
+    def set_budget(self: DebuggingInterface, budget: ExecutionBudget) -> None:
+        """Enforces an execution budget on the process, replacing the previous one.
+
+        Args:
+            budget (ExecutionBudget): The budget to enforce.
+        """
+
+    @abstractmethod
+    def get_budget_usage(self: DebuggingInterface) -> BudgetUsage:
+        """Returns the resources used by the process since the budget was set."""
+
+    @abstractmethod
+    def set_virtual_clock(self: DebuggingInterface, clock: VirtualClock) -> None:
+        """Installs the virtual clock in the process.
+
+        Args:
+            clock (VirtualClock): The virtual clock to install.
+        """
+
+    @abstractmethod
+    def advance_virtual_clock(self: DebuggingInterface, nanoseconds: int) -> None:
+        """Moves the virtual clock of the process forward.
+
+        Args:
+            nanoseconds (int): The nanoseconds to add to the offset of the clocks.
+        """
+
+    @abstractmethod
+    def get_virtual_clock_stats(self: DebuggingInterface) -> VirtualClockStats:
+        """Returns the statistics of the virtual clock."""
+
+    @abstractmethod
+    def set_syscall_profiler(self: DebuggingInterface, profiler: SyscallProfiler) -> None:
+        """Installs the syscall profiler in the process.
+
+        Args:
+            profiler (SyscallProfiler): The syscall profiler to install.
+        """
+
+    @abstractmethod
+    def get_profiled_syscalls(self: DebuggingInterface) -> list[SyscallStats]:
+        """Returns the latencies of the syscalls measured by the syscall profiler, per thread and call site."""
+
+    @abstractmethod
+    def reset_syscall_profiler(self: DebuggingInterface) -> None:
+        """Discards the latencies measured by the syscall profiler."""
+
+    @abstractmethod
+    def set_fd_tracker(self: DebuggingInterface, tracker: FdTracker) -> None:
+        """Installs the tracker of the file descriptors in the process, or applies its state.
+
+        Args:
+            tracker (FdTracker): The tracker to install.
+        """
+
+    @abstractmethod
+    def refresh_fd_table(self: DebuggingInterface) -> None:
+        """Reads the file descriptors of the process from /proc again."""
+
+    @abstractmethod
+    def get_fd_info(self: DebuggingInterface, fd: int) -> FdInfo | None:
+        """Returns a file descriptor of the process from the tracked table, None if it is not open.
+
+        Args:
+            fd (int): The file descriptor.
+        """
+
+    @abstractmethod
+    def get_fd_table(self: DebuggingInterface) -> dict[int, FdInfo]:
+        """Returns the open file descriptors of the process from the tracked table, by number."""
+
+    @abstractmethod
+    def set_latency_mode(self: DebuggingInterface, mode: LatencyMode | None) -> None:
+        """Pins the calling thread and the process to the CPUs of a latency mode.
+
+        Args:
+            mode (LatencyMode | None): The latency mode, None to restore the default placement.
+        """
+
+    @abstractmethod
+    def inject_syscall(self: DebuggingInterface, thread: ThreadContext, number: int, args: list[int], gadget: int) -> int:
+        """Executes a syscall in a stopped thread, restoring the state of the thread afterwards.
+
+        Args:
+            thread (ThreadContext): The thread that executes the syscall.
+            number (int): The number of the syscall.
+            args (list[int]): The arguments of the syscall, at most six.
+            gadget (int): The address of an existing syscall instruction, 0 to patch one at the program counter.
+
+        Returns:
+            int: The return value of the syscall.
+        """
+
+    @abstractmethod
+    def call_function(
+        self: DebuggingInterface,
+        thread: ThreadContext,
+        function: int,
+        trap: int,
+        args: list[int],
+    ) -> int:
+        """Calls a function of the process in a stopped thread, restoring the state of the thread afterwards.
+
+        Args:
+            thread (ThreadContext): The thread that executes the function.
+            function (int): The address of the function.
+            trap (int): The address of the instruction that traps the return from the function.
+            args (list[int]): The integer arguments of the function.
+
+        Returns:
+            int: The return value of the function.
+        """
+
+    @abstractmethod
+    def create_lockstep(
+        self: DebuggingInterface,
+        mode: int,
+        max_steps: int,
+        registers: list[str],
+        ranges: list[tuple[int, int, int]],
+    ) -> object:
+        """Creates the native state of a lockstep, shared by the debuggers of the two processes.
+
+        Args:
+            mode (int): What a step executes.
+            max_steps (int): The maximum number of steps.
+            registers (list[str]): The compared registers.
+            ranges (list[tuple[int, int, int]]): The compared memory ranges, as the address in the first process, the
+            address in the second process and the size.
+
+        Returns:
+            object: The native lockstep, to release with collect_lockstep.
+        """
+
+    @abstractmethod
+    def lockstep(self: DebuggingInterface, thread: ThreadContext, lockstep: object, side: int) -> None:
+        """Steps a thread in lockstep with the thread of another process, until the lockstep is over.
+
+        Args:
+            thread (ThreadContext): The thread to step.
+            lockstep (object): The native lockstep.
+            side (int): 0 if the process is the first of the lockstep, 1 if it is the second.
+        """
+
+    @abstractmethod
+    def collect_lockstep(
+        self: DebuggingInterface,
+        lockstep: object,
+        registers: list[str],
+        sizes: list[int],
+    ) -> tuple[int, int, list[tuple[dict[str, int], list[bytes]]]]:
+        """Collects the result of a lockstep, and releases its native state.
+
+        Args:
+            lockstep (object): The native lockstep.
+            registers (list[str]): The compared registers.
+            sizes (list[int]): The sizes of the compared memory ranges.
+
+        Returns:
+            int: Why the lockstep stopped.
+            int: The number of steps taken.
+            list[tuple[dict[str, int], list[bytes]]]: The registers and the memory ranges of both processes.
+        """
+
     @abstractmethod
     def peek_memory(self: DebuggingInterface, address: int) -> int:
         """Reads the memory at the specified address.
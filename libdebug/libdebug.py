@@ -5,10 +5,16 @@
 
 from __future__ import annotations
 
+from typing import TYPE_CHECKING
+
 from libdebug.debugger.debugger import Debugger
 from libdebug.debugger.internal_debugger import InternalDebugger
+from libdebug.debugger.lockstep import run_lockstep
 from libdebug.utils.elf_utils import elf_architecture
 
+if TYPE_CHECKING:
+    from libdebug.data.lockstep import LockstepResult
+
 
 def debugger(
     argv: str | list[str] = [],
@@ -56,3 +62,35 @@ def debugger(
         debugger.arch = elf_architecture(argv[0])
 
     return debugger
+
+
+def lockstep(
+    first: Debugger,
+    second: Debugger,
+    mode: str = "block",
+    registers: list[str] | None = None,
+    memory: list[tuple[int | str, int]] = [],
+    max_steps: int | None = None,
+    file: str = "hybrid",
+) -> LockstepResult:
+    """Runs the processes of two debuggers side by side, and stops them at their first divergence.
+
+    Both processes are stepped together, from where they are stopped, and their registers and memory are compared
+    after each step natively. Only the first thread of each process is stepped.
+
+    Args:
+        first (Debugger): The debugger of the first process.
+        second (Debugger): The debugger of the second process.
+        mode (str, optional): What a step executes: "block" runs a basic block, "instruction" a single instruction,
+        "syscall" up to the next syscall entry or exit, "breakpoint" up to the next enabled breakpoint. Defaults to
+        "block".
+        registers (list[str], optional): The compared registers. Defaults to None (the general purpose registers).
+        memory (list[tuple[int | str, int]], optional): The compared memory ranges, as an address or a symbol and a
+        size. Defaults to [].
+        max_steps (int, optional): The maximum number of steps. Defaults to None (no limit).
+        file (str, optional): The backing file to resolve the memory ranges in. Defaults to "hybrid".
+
+    Returns:
+        LockstepResult: The result of the lockstep, with the state of both processes at the last step.
+    """
+    return run_lockstep(first, second, mode, registers, memory, max_steps, file)
@@ -11,6 +11,8 @@ from collections.abc import MutableSequence
 
 from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
 from libdebug.liblog import liblog
+from libdebug.memory.typed_value import TypedValue
+from libdebug.utils.elf_utils import get_type_table
 
 
 class AbstractMemoryView(MutableSequence, ABC):
@@ -45,6 +47,53 @@ class AbstractMemoryView(MutableSequence, ABC):
             data (bytes): The data to write.
         """
 
+    def typed(
+        self: AbstractMemoryView,
+        address: int | str,
+        type_name: str,
+        count: int | None = None,
+        file: str = "hybrid",
+    ) -> TypedValue:
+        """Reads a value of the specified type, decoding it through the DWARF debug info.
+
+        The whole value is read in a single access, and its members are decoded lazily. Pointers are followed on
+        member access, as the `->` operator of C does.
+
+        Args:
+            address (int | str): The address of the value, or a symbol.
+            type_name (str): The C name of the type, e.g., "struct foo", "foo_t", "char *" or "int[4]".
+            count (int, optional): The number of consecutive values to read, as an array. Defaults to None.
+            file (str, optional): The backing file to resolve the address in, whose debug info describes the type.
+            Defaults to "hybrid" (libdebug will first try to solve the address as an absolute address, then as a
+            relative address w.r.t. the "binary" map file, and will look up the type in the "binary" map file).
+
+        Returns:
+            TypedValue: The proxy of the value.
+        """
+        if isinstance(address, str):
+            address = self._internal_debugger.resolve_symbol(address, file)
+        else:
+            address = self._internal_debugger.resolve_address(address, file, skip_absolute_address_validation=True)
+
+        types_file = "binary" if file in ["hybrid", "absolute"] else file
+        full_path, _, _ = self._internal_debugger._resolve_backing_file_maps(types_file)
+
+        table = get_type_table(full_path)
+        dwarf_type = table.lookup(type_name)
+
+        if count is not None:
+            dwarf_type = table.array_of(dwarf_type, count)
+
+        if not dwarf_type.size:
+            raise ValueError(f"Type {dwarf_type} has no size.")
+
+        try:
+            buffer = self.read(address, dwarf_type.size)
+        except OSError as e:
+            raise ValueError("Invalid address.") from e
+
+        return TypedValue(self, table, dwarf_type, address, buffer)
+
     def __getitem__(self: AbstractMemoryView, key: int | slice | str | tuple) -> bytes:
         """Read from memory, either a single byte or a byte string.
 
@@ -0,0 +1,246 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import struct
+from dataclasses import dataclass
+from typing import TYPE_CHECKING
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+from libdebug.liblog import liblog
+from libdebug.utils.elf_utils import get_glibc_version
+from libdebug.utils.print_style import PrintStyle
+
+if TYPE_CHECKING:
+    from libdebug.data.heap_chunk import HeapChunk, HeapChunkList, HeapCorruption
+    from libdebug.data.memory_map import MemoryMap
+
+# The number of bins of the arena, each one being a pair of pointers (the first one has no header)
+ARENA_BINS = 127
+
+# The number of fastbins of the arena
+ARENA_FASTBINS = 10
+
+
+@dataclass(frozen=True)
+class GlibcHeapLayout:
+    """The layout of the main arena of glibc, and the bounds of the main heap.
+
+    Attributes:
+        arena (int): The address of `main_arena`.
+        heap_start (int): The start of the main heap.
+        heap_end (int): The end of the main heap.
+        fastbins_offset (int): The offset of `fastbinsY` in the arena.
+        top_offset (int): The offset of `top` in the arena.
+        bins_offset (int): The offset of `bins` in the arena.
+        tcache_counts_size (int): The size of the counters of the tcache, 0 if the tcache is not available.
+        safe_linking (bool): Whether the single-linked lists are protected by safe-linking.
+    """
+
+    arena: int
+    heap_start: int
+    heap_end: int
+    fastbins_offset: int
+    top_offset: int
+    bins_offset: int
+    tcache_counts_size: int
+    safe_linking: bool
+
+
+class GlibcHeap:
+    """The glibc heap of the target process.
+
+    The main heap is read in bulk and parsed natively, together with the tcache of the main thread, the fastbins and
+    the bins of the main arena. Each walk returns a consistent snapshot of the heap.
+    """
+
+    def __init__(self: GlibcHeap) -> None:
+        """Initializes the heap view."""
+        self._arena = None
+        self._arena_process_id = None
+
+    def walk(self: GlibcHeap) -> tuple[HeapChunkList, list[HeapCorruption]]:
+        """Walks the main heap.
+
+        Returns:
+            HeapChunkList: The chunks of the main heap, sorted by address.
+            list[HeapCorruption]: The inconsistencies found in the chunks and in the bins.
+        """
+        internal_debugger = provide_internal_debugger(self)
+        internal_debugger._ensure_process_stopped()
+
+        layout = self._resolve_layout()
+
+        return internal_debugger.debugging_interface.walk_glibc_heap(layout)
+
+    def chunks(self: GlibcHeap) -> HeapChunkList:
+        """Returns the chunks of the main heap, sorted by address."""
+        return self.walk()[0]
+
+    def free_chunks(self: GlibcHeap) -> list[HeapChunk]:
+        """Returns the chunks of the main heap that are not in use, top chunk excluded."""
+        return [chunk for chunk in self.chunks() if not chunk.in_use and not chunk.is_top]
+
+    def bins(self: GlibcHeap) -> dict[str, dict[int, list[HeapChunk]]]:
+        """Returns the chunks in the bins of the main arena and in the tcache of the main thread.
+
+        Returns:
+            dict[str, dict[int, list[HeapChunk]]]: The non-empty bins. Key: the kind of bin (tcache, fastbin,
+            unsorted, smallbin or largebin). Value: the chunks of each bin, by bin index, sorted by address.
+        """
+        bins = {}
+
+        for chunk in self.chunks():
+            if (kind := chunk.bin_kind) is not None:
+                bins.setdefault(kind, {}).setdefault(chunk.bin, []).append(chunk)
+
+        return bins
+
+    def check(self: GlibcHeap) -> list[HeapCorruption]:
+        """Checks the consistency of the main heap, and returns the inconsistencies found."""
+        return self.walk()[1]
+
+    @property
+    def arena(self: GlibcHeap) -> int:
+        """The address of the main arena."""
+        return self._resolve_layout().arena
+
+    def pprint(self: GlibcHeap) -> None:
+        """Prints the chunks of the main heap."""
+        chunks, corruptions = self.walk()
+
+        for chunk in chunks:
+            if chunk.is_top:
+                color = PrintStyle.BLUE
+            elif chunk.in_use:
+                color = PrintStyle.GREEN
+            else:
+                color = PrintStyle.YELLOW
+
+            print(f"{color}{chunk!r}{PrintStyle.RESET}")
+
+        for corruption in corruptions:
+            print(f"{PrintStyle.RED}{corruption!r}{PrintStyle.RESET}")
+
+    def _resolve_layout(self: GlibcHeap) -> GlibcHeapLayout:
+        """Resolves the layout of the main arena and the bounds of the main heap."""
+        internal_debugger = provide_internal_debugger(self)
+        maps = internal_debugger.maps()
+
+        heap_map = next((vmap for vmap in maps if vmap.backing_file == "[heap]"), None)
+        if heap_map is None:
+            raise ValueError("The process has no heap yet.")
+
+        libc_path = next((vmap.backing_file for vmap in maps if get_glibc_version_or_none(vmap.backing_file)), None)
+        if libc_path is None:
+            raise ValueError("The process does not use glibc.")
+
+        version = get_glibc_version(libc_path)
+
+        # have_fastchunks was added before fastbinsY in glibc 2.27
+        fastbins_offset = 16 if version >= (2, 27) else 8
+        top_offset = fastbins_offset + ARENA_FASTBINS * 8
+        bins_offset = top_offset + 16
+
+        if self._arena is None or self._arena_process_id != internal_debugger.process_id:
+            self._arena = self._find_arena(libc_path, maps, heap_map, top_offset, bins_offset)
+            self._arena_process_id = internal_debugger.process_id
+
+        if version >= (2, 30):
+            tcache_counts_size = 2
+        elif version >= (2, 26):
+            tcache_counts_size = 1
+        else:
+            tcache_counts_size = 0
+
+        return GlibcHeapLayout(
+            arena=self._arena,
+            heap_start=heap_map.start,
+            heap_end=heap_map.end,
+            fastbins_offset=fastbins_offset,
+            top_offset=top_offset,
+            bins_offset=bins_offset,
+            tcache_counts_size=tcache_counts_size,
+            safe_linking=version >= (2, 32),
+        )
+
+    def _find_arena(
+        self: GlibcHeap,
+        libc_path: str,
+        maps: list[MemoryMap],
+        heap_map: MemoryMap,
+        top_offset: int,
+        bins_offset: int,
+    ) -> int:
+        """Finds the main arena, through the symbols of glibc if available, or by scanning its data otherwise."""
+        internal_debugger = provide_internal_debugger(self)
+
+        try:
+            return internal_debugger.resolve_symbol("main_arena", libc_path)
+        except ValueError:
+            liblog.debugger("Symbol main_arena not found, scanning the data of glibc.")
+
+        arena_words = (bins_offset + ARENA_BINS * 16) // 8
+
+        for vmap in maps:
+            if vmap.backing_file != libc_path or "w" not in vmap.permissions:
+                continue
+
+            data = internal_debugger._fast_read_memory(vmap.start, vmap.size)
+            words = struct.unpack(f"<{len(data) // 8}Q", data)
+
+            for index in range(len(words) - arena_words):
+                if is_main_arena(words, index, vmap.start + index * 8, heap_map, top_offset, bins_offset):
+                    return vmap.start + index * 8
+
+        raise ValueError("Cannot find the main arena of glibc.")
+
+    def __hash__(self: GlibcHeap) -> int:
+        """Return the hash of the heap view. There is at most one view per debugger."""
+        return id(self)
+
+
+def get_glibc_version_or_none(backing_file: str) -> tuple[int, int] | None:
+    """Returns the version of glibc if the backing file is glibc, None otherwise."""
+    if "libc.so" not in backing_file and "libc-" not in backing_file:
+        return None
+
+    try:
+        return get_glibc_version(backing_file)
+    except OSError:
+        return None
+
+
+def is_main_arena(
+    words: tuple[int, ...],
+    index: int,
+    address: int,
+    heap_map: MemoryMap,
+    top_offset: int,
+    bins_offset: int,
+) -> bool:
+    """Returns whether the words at the specified index look like the main arena.
+
+    The top chunk must be in the heap, and each bin must be either empty, i.e., pointing to its own header, or
+    pointing to the heap in both directions.
+    """
+    if not heap_map.start <= words[index + top_offset // 8] < heap_map.end:
+        return False
+
+    bins = index + bins_offset // 8
+
+    for bin_index in range(ARENA_BINS):
+        header = address + bins_offset + bin_index * 16 - 16
+        fd, bk = words[bins + bin_index * 2], words[bins + bin_index * 2 + 1]
+
+        if fd == header and bk == header:
+            continue
+
+        if not (heap_map.start <= fd < heap_map.end and heap_map.start <= bk < heap_map.end):
+            return False
+
+    return True
@@ -0,0 +1,129 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import mmap
+import os
+from dataclasses import dataclass
+
+from libdebug.debugger.internal_debugger_instance_manager import provide_internal_debugger
+
+# The size of the arenas mapped in the process, unless an allocation needs a larger one
+ARENA_SIZE = 0x10000
+
+# The alignment of the allocations
+ALLOCATION_ALIGNMENT = 16
+
+# The protection flags, by permission character
+PROTECTION_FLAGS = {"r": mmap.PROT_READ, "w": mmap.PROT_WRITE, "x": mmap.PROT_EXEC}
+
+
+def parse_protection(protection: str | int) -> int:
+    """Converts a protection string, e.g., "rw", to the protection flags of mmap.
+
+    Args:
+        protection (str | int): The protection, as a string of permission characters or as flags.
+
+    Returns:
+        int: The protection flags.
+    """
+    if isinstance(protection, int):
+        return protection
+
+    flags = 0
+
+    for permission in protection.lower().replace("-", ""):
+        if permission not in PROTECTION_FLAGS:
+            raise ValueError(f"Invalid permission {permission!r} in protection {protection!r}.")
+
+        flags |= PROTECTION_FLAGS[permission]
+
+    return flags
+
+
+@dataclass
+class ScratchArena:
+    """A memory region mapped in the process, from which the scratch memory is allocated.
+
+    Attributes:
+        address (int): The start address of the arena.
+        size (int): The size of the arena.
+        protection (int): The protection flags of the arena.
+        used (int): The number of bytes allocated from the arena.
+    """
+
+    address: int
+    size: int
+    protection: int
+    used: int = 0
+
+
+class ScratchAllocator:
+    """Allocates scratch memory in the process, from arenas mapped by injected mmap syscalls.
+
+    An arena is mapped once for each protection, and the allocations are carved out of it without any further
+    interaction with the process, until it is full. The memory is never freed, it is unmapped with the process.
+    """
+
+    def __init__(self: ScratchAllocator) -> None:
+        """Initializes the allocator, with no arena."""
+        self.arenas: list[ScratchArena] = []
+
+    def alloc(self: ScratchAllocator, size: int, protection: int) -> int:
+        """Allocates scratch memory in the process.
+
+        Args:
+            size (int): The number of bytes to allocate.
+            protection (int): The protection flags of the memory.
+
+        Returns:
+            int: The address of the allocated memory.
+        """
+        if size <= 0:
+            raise ValueError("The size of an allocation must be positive.")
+
+        size = (size + ALLOCATION_ALIGNMENT - 1) & ~(ALLOCATION_ALIGNMENT - 1)
+
+        arena = next(
+            (arena for arena in self.arenas if arena.protection == protection and arena.size - arena.used >= size),
+            None,
+        )
+
+        if arena is None:
+            arena = self._map_arena(max(size, ARENA_SIZE), protection)
+
+        address = arena.address + arena.used
+        arena.used += size
+
+        return address
+
+    def _map_arena(self: ScratchAllocator, size: int, protection: int) -> ScratchArena:
+        """Maps a new arena in the process, with an injected mmap syscall."""
+        internal_debugger = provide_internal_debugger(self)
+
+        size = (size + mmap.PAGESIZE - 1) & ~(mmap.PAGESIZE - 1)
+
+        address = internal_debugger.syscall(
+            internal_debugger.threads[0],
+            "mmap",
+            0,
+            size,
+            protection,
+            mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+            -1,
+            0,
+        )
+
+        # The errors are returned as negative values
+        if address >= -4095 & 0xFFFFFFFFFFFFFFFF:
+            error = -address & 0xFFFFFFFFFFFFFFFF
+            raise OSError(error, f"Cannot map the scratch arena: {os.strerror(error)}")
+
+        arena = ScratchArena(address, size, protection)
+        self.arenas.append(arena)
+
+        return arena
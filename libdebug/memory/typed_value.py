@@ -0,0 +1,434 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import struct
+from collections.abc import Iterator
+from typing import TYPE_CHECKING, Any
+
+from libdebug.data.dwarf_type import (
+    ENCODING_BOOLEAN,
+    ENCODING_COMPLEX_FLOAT,
+    ENCODING_FLOAT,
+    DwarfType,
+)
+
+if TYPE_CHECKING:
+    from libdebug.data.dwarf_type import DwarfField, DwarfTypeTable
+    from libdebug.memory.abstract_memory_view import AbstractMemoryView
+
+# The formats of the floating point types, by size
+FLOAT_FORMATS = {2: "<e", 4: "<f", 8: "<d"}
+
+# The maximum length of the strings read through pointers
+MAX_STRING_LENGTH = 0x1000
+
+
+class TypedValue:
+    """A value in the memory of the process, decoded through the DWARF debug info.
+
+    The whole value is read in bulk when the proxy is created, and its members and elements are decoded lazily on
+    access. Scalar members are returned as Python values, while structures, unions, arrays and pointers are returned
+    as proxies. Accessing a member through a pointer dereferences it, as the `->` operator of C does.
+
+    Members take precedence over the attributes of the proxy with the same name, which are always available through
+    the methods of the class, e.g., `TypedValue.to_python(node)`.
+    """
+
+    __slots__ = ("_memory", "_table", "_type", "_address", "_buffer", "_offset")
+
+    def __init__(
+        self: TypedValue,
+        memory: AbstractMemoryView,
+        table: DwarfTypeTable,
+        dwarf_type: DwarfType,
+        address: int | None,
+        buffer: bytes,
+        offset: int = 0,
+    ) -> None:
+        """Initializes the proxy.
+
+        Args:
+            memory (AbstractMemoryView): The memory view used to follow the pointers.
+            table (DwarfTypeTable): The table the type belongs to.
+            dwarf_type (DwarfType): The type of the value.
+            address (int | None): The address of the value, None if it does not live in memory.
+            buffer (bytes): The bytes read from memory, containing the value.
+            offset (int, optional): The offset of the value in the buffer. Defaults to 0.
+        """
+        self._memory = memory
+        self._table = table
+        self._type = dwarf_type
+        self._address = address
+        self._buffer = buffer
+        self._offset = offset
+
+    @property
+    def address(self: TypedValue) -> int | None:
+        """The address of the value, None if it does not live in memory (e.g., it is held in registers)."""
+        return self._address
+
+    @property
+    def type(self: TypedValue) -> DwarfType:
+        """The type of the value."""
+        return self._type
+
+    @property
+    def raw(self: TypedValue) -> bytes:
+        """The bytes of the value."""
+        return self._buffer[self._offset : self._offset + self._type.size]
+
+    def to_python(self: TypedValue) -> Any:
+        """Returns the value converted to Python objects.
+
+        Structures and unions become dicts, arrays become lists, and pointers become integers.
+        """
+        return self._decode(self._type, self._offset)
+
+    def member(self: TypedValue, name: str) -> Any:
+        """Returns the member with the specified name, dereferencing the value first if it is a pointer.
+
+        Args:
+            name (str): The name of the member.
+        """
+        resolved = self._type.resolved
+
+        if resolved.kind in ("pointer", "reference"):
+            return self.deref().member(name)
+
+        if resolved.kind not in ("struct", "union", "class"):
+            raise TypeError(f"Type {self._type} has no members.")
+
+        member = resolved.member(name)
+        if member is None:
+            raise AttributeError(f"Type {self._type} has no member {name}.")
+
+        return self._member_value(member)
+
+    def deref(self: TypedValue, count: int | None = None) -> TypedValue:
+        """Follows the pointer, reading the pointed value in bulk.
+
+        Args:
+            count (int, optional): The number of consecutive values to read, as an array. Defaults to None.
+
+        Returns:
+            TypedValue: The pointed value, or the array of pointed values.
+        """
+        resolved = self._type.resolved
+
+        if resolved.kind not in ("pointer", "reference"):
+            raise TypeError(f"Type {self._type} is not a pointer.")
+
+        if resolved.target is None:
+            raise TypeError("Cannot dereference a void pointer.")
+
+        pointer = int(self)
+        if pointer == 0:
+            raise ValueError("NULL pointer dereference.")
+
+        target = resolved.target if count is None else self._table.array_of(resolved.target, count)
+        return self._read(target, pointer)
+
+    def string(self: TypedValue, max_length: int = MAX_STRING_LENGTH) -> bytes:
+        """Returns the NUL-terminated string held by a character array, or pointed by a character pointer.
+
+        Args:
+            max_length (int, optional): The maximum length of the string read through a pointer. Defaults to 4096.
+        """
+        resolved = self._type.resolved
+
+        if resolved.kind == "array" and resolved.target.is_char:
+            return self.raw.split(b"\x00", 1)[0]
+
+        if resolved.kind != "pointer" or resolved.target is None or not resolved.target.is_char:
+            raise TypeError(f"Type {self._type} is not a string.")
+
+        pointer = int(self)
+        if pointer == 0:
+            raise ValueError("NULL pointer dereference.")
+
+        data = b""
+        while len(data) < max_length:
+            # Read page by page, as the string might end right before an unmapped page
+            chunk_size = min(0x1000 - (pointer + len(data)) % 0x1000, max_length - len(data))
+            chunk = self._memory.read(pointer + len(data), chunk_size)
+
+            if b"\x00" in chunk:
+                return data + chunk.split(b"\x00", 1)[0]
+
+            data += chunk
+
+        return data
+
+    def to_numpy(self: TypedValue) -> Any:
+        """Returns the value as a numpy structured array, without copying the bytes read from memory.
+
+        Arrays become one-dimensional arrays, and any other value becomes a single-element array. Bit-fields are
+        not supported by numpy, and are left out of the structured type.
+        """
+        import numpy as np
+
+        resolved = self._type.resolved
+
+        if resolved.kind == "array":
+            dtype = np.dtype(numpy_format(resolved.target))
+            return np.frombuffer(self._buffer, dtype, resolved.count, self._offset)
+
+        return np.frombuffer(self._buffer, np.dtype(numpy_format(self._type)), 1, self._offset)
+
+    def _member_value(self: TypedValue, member: DwarfField) -> Any:
+        """Returns the value of a member of the structure."""
+        if member.bit_size:
+            start = self._offset + member.bit_offset // 8
+            end = self._offset + (member.bit_offset + member.bit_size + 7) // 8
+            value = int.from_bytes(self._buffer[start:end], "little") >> (member.bit_offset % 8)
+            value &= (1 << member.bit_size) - 1
+
+            if member.type.is_signed and value >> (member.bit_size - 1):
+                value -= 1 << member.bit_size
+
+            return value
+
+        return self._element(member.type, self._offset + member.offset, self._address_of(member.offset))
+
+    def _element(self: TypedValue, dwarf_type: DwarfType, offset: int, address: int) -> Any:
+        """Returns a scalar as a Python value, or any other value as a proxy sharing the buffer."""
+        if dwarf_type.resolved.kind in ("base", "enum"):
+            return decode_scalar(dwarf_type, self._buffer, offset)
+
+        return TypedValue(self._memory, self._table, dwarf_type, address, self._buffer, offset)
+
+    def _address_of(self: TypedValue, offset: int) -> int | None:
+        """Returns the address of a part of the value, None if the value does not live in memory."""
+        return None if self._address is None else self._address + offset
+
+    def _decode(self: TypedValue, dwarf_type: DwarfType, offset: int) -> Any:
+        """Converts a value of the buffer to Python objects."""
+        resolved = dwarf_type.resolved
+
+        if resolved.kind in ("struct", "union", "class"):
+            proxy = TypedValue(self._memory, self._table, dwarf_type, self._address, self._buffer, offset)
+            result = {}
+
+            for member in resolved.fields:
+                if member.name is None:
+                    result.update(proxy._decode(member.type, offset + member.offset))
+                elif member.bit_size:
+                    result[member.name] = proxy._member_value(member)
+                else:
+                    result[member.name] = proxy._decode(member.type, offset + member.offset)
+
+            return result
+
+        if resolved.kind == "array":
+            element = resolved.target
+            return [self._decode(element, offset + index * element.size) for index in range(resolved.count)]
+
+        if resolved.kind in ("pointer", "reference"):
+            return int.from_bytes(self._buffer[offset : offset + resolved.size], "little")
+
+        return decode_scalar(dwarf_type, self._buffer, offset)
+
+    def _read(self: TypedValue, dwarf_type: DwarfType, address: int) -> TypedValue:
+        """Reads a value of the specified type in bulk."""
+        try:
+            buffer = self._memory.read(address, dwarf_type.size)
+        except OSError as e:
+            raise ValueError("Invalid address.") from e
+
+        return TypedValue(self._memory, self._table, dwarf_type, address, buffer)
+
+    def __getattribute__(self: TypedValue, name: str) -> Any:
+        """Returns the member with the specified name, or the attribute of the proxy."""
+        if name[0] != "_":
+            resolved = object.__getattribute__(self, "_type").resolved
+
+            if resolved.kind in ("pointer", "reference") and resolved.target is not None:
+                resolved = resolved.target.resolved
+
+            if resolved.fields and resolved.member(name) is not None:
+                return object.__getattribute__(self, "member")(name)
+
+        return object.__getattribute__(self, name)
+
+    def __getattr__(self: TypedValue, name: str) -> Any:
+        """Raises an error for the members that do not exist."""
+        raise AttributeError(f"Type {self._type} has no member {name}.")
+
+    def __getitem__(self: TypedValue, key: int | slice | str) -> Any:
+        """Returns a member by name, an element of an array or of a pointed array, or a list of elements."""
+        if isinstance(key, str):
+            return self.member(key)
+
+        resolved = self._type.resolved
+
+        if isinstance(key, slice):
+            return [self[index] for index in range(*key.indices(len(self)))]
+
+        if not isinstance(key, int):
+            raise TypeError("Invalid key type.")
+
+        if resolved.kind == "array":
+            if key < 0:
+                key += resolved.count
+
+            if not 0 <= key < resolved.count:
+                raise IndexError("Array index out of range.")
+
+            size = resolved.target.size
+            return self._element(resolved.target, self._offset + key * size, self._address_of(key * size))
+
+        if resolved.kind == "pointer":
+            if resolved.target is None:
+                raise TypeError("Cannot dereference a void pointer.")
+
+            pointer = int(self)
+            if pointer == 0:
+                raise ValueError("NULL pointer dereference.")
+
+            pointed = self._read(resolved.target, pointer + key * resolved.target.size)
+            return pointed._element(resolved.target, 0, pointed._address)
+
+        raise TypeError(f"Type {self._type} cannot be indexed.")
+
+    def __len__(self: TypedValue) -> int:
+        """Returns the number of elements of an array."""
+        resolved = self._type.resolved
+
+        if resolved.kind != "array":
+            raise TypeError(f"Type {self._type} has no length.")
+
+        return resolved.count
+
+    def __iter__(self: TypedValue) -> Iterator[Any]:
+        """Iterates over the elements of an array."""
+        for index in range(len(self)):
+            yield self[index]
+
+    def __dir__(self: TypedValue) -> list[str]:
+        """Returns the names of the members, for completion."""
+        resolved = self._type.resolved
+
+        if resolved.kind in ("pointer", "reference") and resolved.target is not None:
+            resolved = resolved.target.resolved
+
+        names = []
+        for member in resolved.fields:
+            if member.name is not None:
+                names.append(member.name)
+            else:
+                names.extend(field.name for field in member.type.resolved.fields if field.name is not None)
+
+        return [*super().__dir__(), *names]
+
+    def __int__(self: TypedValue) -> int:
+        """Returns the value of a pointer or of an integer."""
+        resolved = self._type.resolved
+
+        if resolved.kind in ("pointer", "reference"):
+            return int.from_bytes(self._buffer[self._offset : self._offset + resolved.size], "little")
+
+        if resolved.kind in ("base", "enum"):
+            return int(decode_scalar(self._type, self._buffer, self._offset))
+
+        raise TypeError(f"Type {self._type} is not a scalar.")
+
+    def __index__(self: TypedValue) -> int:
+        """Returns the value of a pointer or of an integer."""
+        return int(self)
+
+    def __bool__(self: TypedValue) -> bool:
+        """Returns whether a pointer is not NULL. Any other value is always true."""
+        if self._type.resolved.kind in ("pointer", "reference"):
+            return int(self) != 0
+
+        return True
+
+    def __repr__(self: TypedValue) -> str:
+        """Return the string representation of the value."""
+        if self._type.resolved.kind in ("pointer", "reference"):
+            return f"TypedValue({self._type} = {int(self):#x})"
+
+        if self._address is None:
+            return f"TypedValue({self._type})"
+
+        return f"TypedValue({self._type} at {self._address:#x})"
+
+
+def decode_scalar(dwarf_type: DwarfType, buffer: bytes, offset: int) -> int | float | bool | complex:
+    """Decodes a base type or an enum from the buffer.
+
+    Args:
+        dwarf_type (DwarfType): The type of the value.
+        buffer (bytes): The buffer containing the value.
+        offset (int): The offset of the value in the buffer.
+    """
+    resolved = dwarf_type.resolved
+    data = buffer[offset : offset + resolved.size]
+
+    if resolved.kind == "base" and resolved.encoding == ENCODING_FLOAT:
+        return decode_float(data)
+
+    if resolved.kind == "base" and resolved.encoding == ENCODING_COMPLEX_FLOAT:
+        half = len(data) // 2
+        return complex(decode_float(data[:half]), decode_float(data[half:]))
+
+    value = int.from_bytes(data, "little", signed=dwarf_type.is_signed)
+
+    if resolved.kind == "base" and resolved.encoding == ENCODING_BOOLEAN:
+        return bool(value)
+
+    return value
+
+
+def decode_float(data: bytes) -> float:
+    """Decodes a floating point value, including the 80-bit extended precision format of x87."""
+    if len(data) in FLOAT_FORMATS:
+        return struct.unpack(FLOAT_FORMATS[len(data)], data)[0]
+
+    # long double is stored in 10 bytes, padded to 12 or 16
+    mantissa = int.from_bytes(data[:8], "little")
+    exponent = int.from_bytes(data[8:10], "little")
+    sign = -1.0 if exponent & 0x8000 else 1.0
+    exponent &= 0x7FFF
+
+    if exponent == 0x7FFF:
+        return sign * float("inf") if mantissa << 1 == 0 else float("nan")
+
+    try:
+        return sign * mantissa * 2.0 ** (exponent - 16383 - 63)
+    except OverflowError:
+        return sign * float("inf")
+
+
+def numpy_format(dwarf_type: DwarfType) -> str | tuple | dict:
+    """Returns the numpy format of the specified type."""
+    resolved = dwarf_type.resolved
+
+    if resolved.kind in ("struct", "union", "class"):
+        members = [member for member in resolved.fields if not member.bit_size]
+
+        return {
+            "names": [member.name or f"_anonymous{index}" for index, member in enumerate(members)],
+            "formats": [numpy_format(member.type) for member in members],
+            "offsets": [member.offset for member in members],
+            "itemsize": resolved.size,
+        }
+
+    if resolved.kind == "array":
+        return (numpy_format(resolved.target), (resolved.count,))
+
+    if resolved.kind == "base" and resolved.encoding == ENCODING_FLOAT and resolved.size in FLOAT_FORMATS:
+        return FLOAT_FORMATS[resolved.size]
+
+    if resolved.kind == "base" and resolved.encoding == ENCODING_BOOLEAN:
+        return "?" if resolved.size == 1 else f"<u{resolved.size}"
+
+    if resolved.size not in (1, 2, 4, 8):
+        return f"V{resolved.size}"
+
+    return f"<{'i' if dwarf_type.is_signed else 'u'}{resolved.size}"
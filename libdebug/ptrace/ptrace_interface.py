@@ -6,10 +6,13 @@
 
 from __future__ import annotations
 
+import contextlib
+import ctypes
 import errno
 import os
 import pty
 import tty
+from dataclasses import asdict
 from pathlib import Path
 from typing import TYPE_CHECKING
 
@@ -17,6 +20,16 @@ from libdebug.architectures.register_helper import register_holder_provider
 from libdebug.architectures.call_utilities_provider import call_utilities_provider
 from libdebug.cffi import _ptrace_cffi
 from libdebug.data.breakpoint import Breakpoint
+from libdebug.data.execution_budget import BUDGET_KINDS, BudgetUsage
+from libdebug.data.fd_table import FdInfo
+from libdebug.data.function_tracer import TracedCall, TracedFunctionStats
+from libdebug.data.heap_chunk import HeapChunkList, HeapCorruption
+from libdebug.data.heap_tracker import HeapAllocation, HeapStats
+from libdebug.data.profiler import ProfiledStack, ProfilerStats
+from libdebug.data.python_frame import PythonFrame
+from libdebug.data.return_address_monitor import ReturnAddressViolation
+from libdebug.data.syscall_profiler import SyscallStats
+from libdebug.data.virtual_clock import VirtualClockStats
 from libdebug.debugger.internal_debugger_instance_manager import (
     extend_internal_debugger,
     provide_internal_debugger,
@@ -25,19 +38,50 @@ from libdebug.interfaces.debugging_interface import DebuggingInterface
 from libdebug.liblog import liblog
 from libdebug.ptrace.ptrace_status_handler import PtraceStatusHandler
 from libdebug.state.thread_context import ThreadContext
+from libdebug.utils.cpython_utils import (
+    CPYTHON_BYTES_DATA_OFFSET,
+    CPYTHON_BYTES_SIZE_OFFSET,
+    CPYTHON_UNICODE_LENGTH_OFFSET,
+    CPYTHON_UNICODE_STATE_OFFSET,
+)
 from libdebug.utils.debugging_utils import normalize_and_validate_address
 from libdebug.utils.elf_utils import get_entry_point
+from libdebug.utils.latency_utils import pin_process
 from libdebug.utils.pipe_manager import PipeManager
 from libdebug.utils.process_utils import (
     disable_self_aslr,
     get_process_maps,
     invalidate_process_cache,
 )
+from libdebug.utils.signal_utils import resolve_signal_name
+from libdebug.utils.syscall_utils import resolve_syscall_name
 
 JUMPSTART_LOCATION = str(
     (Path(__file__) / ".." / ".." / "ptrace" / "jumpstart" / "jumpstart").resolve(),
 )
 
+TRACED_CALLS_CHUNK_SIZE = 4096
+
+# The size of the buffer for the target of a file descriptor, and of the first batch of open descriptors
+FD_PATH_SIZE = 512
+FD_TABLE_CHUNK_SIZE = 256
+
+# The encodings of the kinds of the strings of CPython
+CPYTHON_STRING_ENCODINGS = {1: "latin-1", 2: "utf-16-le", 4: "utf-32-le"}
+
+# The roles of the allocator functions in the native heap tracker
+HEAP_FUNCTION_ROLES = {
+    "malloc": 0,
+    "calloc": 1,
+    "realloc": 2,
+    "free": 3,
+    "memalign": 4,
+    "aligned_alloc": 4,
+    "mmap": 5,
+    "munmap": 6,
+    "sbrk": 7,
+}
+
 if hasattr(os, "posix_spawn"):
     from os import POSIX_SPAWN_CLOSE, POSIX_SPAWN_DUP2, posix_spawn
 else:
@@ -48,11 +92,23 @@ else:
     )
 
 if TYPE_CHECKING:
+    from libdebug.data.execution_budget import ExecutionBudget
     from libdebug.data.memory_map import MemoryMap
     from libdebug.data.registers import Registers
+    from libdebug.data.fd_table import FdTracker
+    from libdebug.data.function_tracer import FunctionTracer
+    from libdebug.data.heap_tracker import HeapTracker
+    from libdebug.data.latency_mode import LatencyMode
+    from libdebug.data.profiler import Profiler
+    from libdebug.data.return_address_monitor import ReturnAddressMonitor
     from libdebug.data.signal_catcher import SignalCatcher
     from libdebug.data.syscall_handler import SyscallHandler
+    from libdebug.data.syscall_profiler import SyscallProfiler
+    from libdebug.data.virtual_clock import VirtualClock
     from libdebug.debugger.internal_debugger import InternalDebugger
+    from libdebug.memory.glibc_heap import GlibcHeapLayout
+    from libdebug.utils.cpython_utils import CPythonLayout
+    from libdebug.utils.dwarf_location_utils import DwarfFramePlan
 
 
 class PtraceInterface(DebuggingInterface):
@@ -85,13 +141,60 @@ class PtraceInterface(DebuggingInterface):
         self.detached = False
 
         self._disabled_aslr = False
+        self._heap_tracker = None
+        self._profiler = None
+        self._budget = None
+        self._virtual_clock = None
+        self._syscall_profiler = None
+        self._fd_tracker = None
+        self._cpython_layout = None
+        self._default_affinity = None
 
         self.reset()
 
     def reset(self: PtraceInterface) -> None:
         """Resets the state of the interface."""
         self.lib_trace.free_thread_list(self._global_state)
+        self.lib_trace.free_ra_monitor(self._global_state)
+        self.lib_trace.free_function_tracer(self._global_state)
+
+        if self._heap_tracker is not None:
+            # The tracker outlives the process, keep what was still allocated
+            self._heap_tracker._freeze(self.get_heap_allocations(), self.get_heap_stats())
+            self._heap_tracker = None
+
+        self.lib_trace.free_heap_tracker(self._global_state)
+
+        if self._profiler is not None:
+            # The samples outlive the process as well
+            self._profiler._freeze(self.get_profiled_stacks(), self.get_profiler_stats())
+            self._profiler = None
+
+        self.lib_trace.free_profiler(self._global_state)
+
+        if self._budget is not None:
+            self._budget._freeze(self.get_budget_usage())
+            self._budget = None
+
+        self.lib_trace.free_budget(self._global_state)
+
+        if self._virtual_clock is not None:
+            self._virtual_clock._freeze(self.get_virtual_clock_stats())
+            self._virtual_clock = None
+
+        self.lib_trace.free_virtual_clock(self._global_state)
+
+        if self._syscall_profiler is not None:
+            self._syscall_profiler._freeze(self.get_profiled_syscalls())
+            self._syscall_profiler = None
+
+        self.lib_trace.free_syscall_profiler(self._global_state)
+
+        self._fd_tracker = None
+        self.lib_trace.free_fd_table(self._global_state)
+        self.lib_trace.free_native_callbacks(self._global_state)
         self.lib_trace.free_breakpoints(self._global_state)
+        self._native_breakpoints = []
 
     def _set_options(self: PtraceInterface) -> None:
         """Sets the tracer options."""
@@ -161,6 +264,10 @@ class PtraceInterface(DebuggingInterface):
         self.process_id = child_pid
         self.detached = False
         self._internal_debugger.process_id = child_pid
+
+        if self._internal_debugger.latency_mode is not None:
+            pin_process(child_pid, {self._internal_debugger.latency_mode.tracee_cpu})
+
         self.register_new_thread(child_pid)
         continue_to_entry_point = self._internal_debugger.autoreach_entrypoint
         self._setup_parent(continue_to_entry_point)
@@ -176,7 +283,8 @@ class PtraceInterface(DebuggingInterface):
         with extend_internal_debugger(self):
             self.status_handler = PtraceStatusHandler()
 
-        res = self.lib_trace.ptrace_attach(pid)
+        # Every thread is seized and stopped natively, including the ones created meanwhile
+        res = self.lib_trace.ptrace_seize_all(self._global_state, pid)
         if res == -1:
             errno_val = self.ffi.errno
             raise OSError(errno_val, errno.errorcode[errno_val])
@@ -184,10 +292,29 @@ class PtraceInterface(DebuggingInterface):
         self.process_id = pid
         self.detached = False
         self._internal_debugger.process_id = pid
+
+        if self._internal_debugger.latency_mode is not None:
+            pin_process(pid, {self._internal_debugger.latency_mode.tracee_cpu})
+
+        # The main thread comes first
         self.register_new_thread(pid)
-        # If we are attaching to a process, we don't want to continue to the entry point
+
+        tids = []
+        cursor = self._global_state.t_HEAD
+
+        while cursor != self.ffi.NULL:
+            if cursor.tid != pid:
+                tids.append(cursor.tid)
+            cursor = cursor.next
+
+        for tid in sorted(tids):
+            self.register_new_thread(tid)
+
+        liblog.debugger("Attached to %d threads", res)
+
+        # The stops of the threads were already collected, and we don't want to continue to the entry point,
         # which we have probably already passed
-        self._setup_parent(False)
+        invalidate_process_cache()
 
     def detach(self: PtraceInterface) -> None:
         """Detaches from the process."""
@@ -231,6 +358,38 @@ class PtraceInterface(DebuggingInterface):
             else:
                 self.unset_breakpoint(bp, delete=False)
 
+        monitor = self._internal_debugger.return_address_monitor
+        if monitor is not None and monitor._changed:
+            monitor._changed = False
+            if monitor.enabled:
+                self.lib_trace.enable_ra_monitor(self._global_state)
+            else:
+                self.lib_trace.disable_ra_monitor(self._global_state)
+
+        tracer = self._internal_debugger.function_tracer
+        if tracer is not None and tracer._changed:
+            tracer._changed = False
+            if tracer.enabled:
+                self.lib_trace.enable_function_tracer(self._global_state)
+            else:
+                self.lib_trace.disable_function_tracer(self._global_state)
+
+        heap_tracker = self._heap_tracker
+        if heap_tracker is not None and heap_tracker._changed:
+            heap_tracker._changed = False
+            if heap_tracker.enabled:
+                self.lib_trace.enable_heap_tracker(self._global_state)
+            else:
+                self.lib_trace.disable_heap_tracker(self._global_state)
+
+        profiler = self._profiler
+        if profiler is not None and profiler._changed:
+            profiler._changed = False
+            if profiler.enabled:
+                self.lib_trace.enable_profiler(self._global_state)
+            else:
+                self.lib_trace.disable_profiler(self._global_state)
+
         for handler in self._internal_debugger.handled_syscalls.values():
             if handler.enabled or handler.on_enter_pprint or handler.on_exit_pprint:
                 self._global_state.handle_syscall_enabled = True
@@ -238,6 +397,35 @@ class PtraceInterface(DebuggingInterface):
         else:
             self._global_state.handle_syscall_enabled = False
 
+        clock = self._virtual_clock
+        if clock is not None and clock._changed:
+            clock._changed = False
+            self.lib_trace.configure_virtual_clock(self._global_state, clock.enabled)
+
+        syscall_profiler = self._syscall_profiler
+        if syscall_profiler is not None and syscall_profiler._changed:
+            syscall_profiler._changed = False
+            self.lib_trace.configure_syscall_profiler(
+                self._global_state,
+                syscall_profiler.enabled,
+                syscall_profiler.call_sites,
+            )
+
+        # The syscalls of a budget are counted natively, the virtual clock fast-forwards them, the syscall profiler
+        # measures them and the descriptors they create are tracked natively as well, their stops are reported only
+        # if a handler wants them
+        budget = self._budget
+        fd_tracker = self._fd_tracker
+        count_syscalls = budget is not None and budget.syscalls is not None and budget.exhausted is None
+        native_syscalls = (
+            count_syscalls
+            or (clock is not None and clock.enabled)
+            or (syscall_profiler is not None and syscall_profiler.enabled)
+            or (fd_tracker is not None and fd_tracker.enabled)
+        )
+        self._global_state.consume_syscall_stops = native_syscalls and not self._global_state.handle_syscall_enabled
+        self._global_state.handle_syscall_enabled |= native_syscalls
+
         result = self.lib_trace.cont_all_and_set_bps(
             self._global_state,
             self.process_id,
@@ -458,11 +646,39 @@ class PtraceInterface(DebuggingInterface):
             results.append((cursor.tid, cursor.status))
             cursor = cursor.next
 
+        # The hits handled by the native callbacks never reach the status handler
+        for bp in self._native_breakpoints:
+            bp.hit_count = self.lib_trace.get_native_callback_hits(self._global_state, bp.address)
+
+        # The calls traced while running must be visible from the callbacks
+        if self._internal_debugger.function_tracer is not None:
+            self._drain_traced_calls()
+
+        # The samples are symbolized with the maps of the process, which are gone after it exits
+        if self._profiler is not None:
+            with contextlib.suppress(OSError):
+                self._profiler._maps = self.maps() or self._profiler._maps
+
         # Check the result of the waitpid and handle the changes.
         self.status_handler.manage_change(results)
 
+        # An exhausted budget stops the process, whatever the handlers decided
+        budget = self._budget
+        if budget is not None and budget.exhausted is None:
+            usage = self.ffi.new("struct budget_usage*")
+            self.lib_trace.get_budget_usage(self._global_state, usage)
+
+            if usage.exhausted:
+                budget.exhausted = BUDGET_KINDS[usage.exhausted - 1]
+                self._internal_debugger.resume_context.resume = False
+                liblog.debugger(f"The {budget.exhausted} budget of the process is exhausted, interrupting the run.")
+
         self.lib_trace.free_thread_status_list(result)
 
+        # Threads that exited might have left some calls unfinished
+        if self._internal_debugger.function_tracer is not None:
+            self._drain_traced_calls()
+
     def forward_signal(self: PtraceInterface) -> None:
         """Set the signals to forward to the threads."""
         # change the global_state
@@ -544,7 +760,7 @@ class PtraceInterface(DebuggingInterface):
 
         # For any hardware breakpoints, we need to reapply them to the new thread
         for bp in self._internal_debugger.breakpoints.values():
-            if bp.hardware:
+            if bp.hardware and bp.selects_thread(new_thread_id):
                 self.lib_trace.register_hw_breakpoint(
                     self._global_state,
                     new_thread_id,
@@ -570,6 +786,15 @@ class PtraceInterface(DebuggingInterface):
 
         self._internal_debugger.set_thread_as_dead(thread_id, exit_code=exit_code, exit_signal=exit_signal)
 
+        heap_tracker = self._heap_tracker
+        if (
+            heap_tracker is not None
+            and heap_tracker.report_on_exit
+            and all(thread.dead for thread in self._internal_debugger.threads)
+        ):
+            # The process is gone, what is still allocated has leaked
+            heap_tracker.pprint_report()
+
     def _set_sw_breakpoint(self: PtraceInterface, bp: Breakpoint) -> None:
         """Sets a software breakpoint at the specified address.
 
@@ -590,6 +815,43 @@ class PtraceInterface(DebuggingInterface):
         """
         self.lib_trace.unregister_breakpoint(self._global_state, bp.address)
 
+    def _set_native_breakpoint(self: PtraceInterface, bp: Breakpoint) -> None:
+        """Sets a software breakpoint handled by a native callback.
+
+        Args:
+            bp (Breakpoint): The breakpoint to set.
+        """
+        callback = self._native_address(bp.native_callback)
+        if not callback:
+            raise ValueError("The native callback must be a valid function pointer.")
+
+        self.lib_trace.register_native_callback(
+            self._global_state,
+            self.process_id,
+            bp.address,
+            callback,
+            self._native_address(bp.native_data),
+        )
+
+        self._native_breakpoints.append(bp)
+
+    def _native_address(self: PtraceInterface, value: object) -> int:
+        """Returns the address of a cffi or ctypes pointer, or of a ctypes object."""
+        if value is None:
+            return 0
+
+        if isinstance(value, int):
+            return value
+
+        if isinstance(value, (ctypes._CFuncPtr, ctypes._Pointer, ctypes.c_void_p)):
+            return ctypes.cast(value, ctypes.c_void_p).value or 0
+
+        if isinstance(value, (ctypes._SimpleCData, ctypes.Structure, ctypes.Union, ctypes.Array)):
+            return ctypes.addressof(value)
+
+        # Any cffi pointer can be cast, whatever FFI instance it comes from
+        return int(self.ffi.cast("uintptr_t", value))
+
     def _enable_breakpoint(self: PtraceInterface, bp: Breakpoint) -> None:
         """Enables a breakpoint at the specified address.
 
@@ -615,6 +877,10 @@ class PtraceInterface(DebuggingInterface):
         """
         if bp.hardware:
             for thread in self._internal_debugger.threads:
+                # The debug registers of the other threads are left untouched
+                if not bp.selects_thread(thread.thread_id):
+                    continue
+
                 if bp.condition == "x":
                     remaining = self.lib_trace.get_remaining_hw_breakpoint_count(self._global_state, thread.thread_id)
                 else:
@@ -630,11 +896,21 @@ class PtraceInterface(DebuggingInterface):
                     bp.condition.encode().ljust(2, b"\x00"),
                     chr(bp.length).encode(),
                 )
+        elif bp.native_callback is not None:
+            if insert:
+                self._set_native_breakpoint(bp)
+            else:
+                self.lib_trace.enable_native_callback(self._global_state, bp.address, True)
         elif insert:
             self._set_sw_breakpoint(bp)
         else:
             self._enable_breakpoint(bp)
 
+        if insert and not bp.hardware and bp.threads is not None:
+            # The hits from the other threads are stepped over by the native code
+            tids = self.ffi.new("int[]", bp.threads)
+            self.lib_trace.set_breakpoint_threads(self._global_state, bp.address, tids, len(bp.threads))
+
         if insert:
             self._internal_debugger.breakpoints[bp.address] = bp
 
@@ -647,11 +923,20 @@ class PtraceInterface(DebuggingInterface):
         """
         if bp.hardware:
             for thread in self._internal_debugger.threads:
+                if not bp.selects_thread(thread.thread_id):
+                    continue
+
                 self.lib_trace.unregister_hw_breakpoint(
                     self._global_state,
                     thread.thread_id,
                     bp.address,
                 )
+        elif bp.native_callback is not None:
+            if delete:
+                self.lib_trace.unregister_native_callback(self._global_state, bp.address)
+                self._native_breakpoints.remove(bp)
+            else:
+                self.lib_trace.enable_native_callback(self._global_state, bp.address, False)
         elif delete:
             self._unset_sw_breakpoint(bp)
         else:
@@ -692,6 +977,771 @@ class PtraceInterface(DebuggingInterface):
         """
         del self._internal_debugger.caught_signals[catcher.signal_number]
 
+    def set_return_address_monitor(
+        self: PtraceInterface,
+        monitor: ReturnAddressMonitor,
+        returns: list[int],
+        canary_offsets: dict[int, int],
+        canary_check: int | None,
+    ) -> None:
+        """Installs the return address monitor in the process.
+
+        Args:
+            monitor (ReturnAddressMonitor): The monitor to install.
+            returns (list[int]): The addresses of the return instructions of the monitored functions.
+            canary_offsets (dict[int, int]): The offset of the stack canary from the return address slot, for each
+            monitored function that stores one.
+            canary_check (int | None): The address of the stack check failure handler, if canary checks are monitored.
+        """
+        for address in monitor.functions:
+            self.lib_trace.register_ra_function(
+                self._global_state,
+                self.process_id,
+                address,
+                canary_offsets.get(address, 0),
+            )
+
+        for address in returns:
+            self.lib_trace.register_ra_return(self._global_state, self.process_id, address)
+
+        if canary_check is not None:
+            self.lib_trace.register_ra_canary_check(self._global_state, self.process_id, canary_check)
+
+        if monitor.enabled:
+            self.lib_trace.enable_ra_monitor(self._global_state)
+
+        monitor._changed = False
+        self._internal_debugger.return_address_monitor = monitor
+
+    def get_return_address_violation(self: PtraceInterface, thread_id: int) -> ReturnAddressViolation | None:
+        """Retrieves the oldest pending return address violation of the specified thread, if any.
+
+        Args:
+            thread_id (int): The thread to query.
+        """
+        violation = self.ffi.new("struct ra_violation*")
+
+        if not self.lib_trace.pop_ra_violation(self._global_state, thread_id, violation):
+            return None
+
+        functions = self._internal_debugger.return_address_monitor.functions
+
+        return ReturnAddressViolation(
+            thread_id=violation.tid,
+            function=functions.get(violation.function, hex(violation.function)),
+            function_address=violation.function,
+            address=violation.address,
+            slot=violation.slot,
+            expected=violation.expected,
+            actual=violation.actual,
+            canary=bool(violation.canary),
+        )
+
+    def set_function_tracer(self: PtraceInterface, tracer: FunctionTracer) -> None:
+        """Installs the function tracer in the process.
+
+        Args:
+            tracer (FunctionTracer): The tracer to install.
+        """
+        self.lib_trace.configure_function_tracer(
+            self._global_state,
+            tracer.args,
+            tracer.capture_return,
+            tracer.buffer_size,
+        )
+
+        # The native code identifies the functions by their index
+        for function_id, address in enumerate(tracer.functions):
+            self.lib_trace.register_traced_function(self._global_state, self.process_id, address, function_id)
+
+        if tracer.enabled:
+            self.lib_trace.enable_function_tracer(self._global_state)
+
+        tracer._changed = False
+        self._traced_function_names = list(tracer.functions.values())
+        self._traced_calls_buffer = self.ffi.new("struct traced_call[]", TRACED_CALLS_CHUNK_SIZE)
+        self._internal_debugger.function_tracer = tracer
+
+    def _drain_traced_calls(self: PtraceInterface) -> None:
+        """Moves the calls collected by the native function tracer to the Python one."""
+        tracer = self._internal_debugger.function_tracer
+        buffer = self._traced_calls_buffer
+        names = self._traced_function_names
+
+        while count := self.lib_trace.pop_traced_calls(self._global_state, buffer, TRACED_CALLS_CHUNK_SIZE):
+            for index in range(count):
+                call = buffer[index]
+
+                tracer.calls.append(
+                    TracedCall(
+                        thread_id=call.tid,
+                        function=names[call.function],
+                        args=list(call.args)[: tracer.args],
+                        return_value=call.return_value if call.returned else None,
+                        timestamp=call.timestamp / 1e9,
+                        duration=call.duration / 1e9 if call.returned else None,
+                    ),
+                )
+
+        tracer.dropped += self.lib_trace.pop_dropped_traced_calls(self._global_state)
+
+    def get_traced_function_stats(self: PtraceInterface) -> dict[str, TracedFunctionStats]:
+        """Returns the call count and latency statistics of each traced function."""
+        stats = {}
+        native_stats = self.ffi.new("struct traced_function_stats*")
+
+        for function_id, name in enumerate(self._traced_function_names):
+            if not self.lib_trace.get_traced_function_stats(self._global_state, function_id, native_stats):
+                continue
+
+            # The same symbol might have been traced in more than one place (e.g., PLT and definition)
+            entry = stats.setdefault(name, TracedFunctionStats(name, 0, 0, 0.0, 0.0, 0.0))
+
+            if native_stats.returns:
+                min_time = native_stats.min_time / 1e9
+                entry.min_time = min(entry.min_time, min_time) if entry.returns else min_time
+                entry.max_time = max(entry.max_time, native_stats.max_time / 1e9)
+
+            entry.calls += native_stats.calls
+            entry.returns += native_stats.returns
+            entry.total_time += native_stats.total_time / 1e9
+
+        return stats
+
+    def set_heap_tracker(self: PtraceInterface, tracker: HeapTracker) -> None:
+        """Installs the heap tracker in the process.
+
+        Args:
+            tracker (HeapTracker): The tracker to install.
+        """
+        self.lib_trace.configure_heap_tracker(self._global_state, tracker.backtrace)
+
+        for address, name in tracker.functions.items():
+            self.lib_trace.register_heap_function(
+                self._global_state,
+                self.process_id,
+                address,
+                HEAP_FUNCTION_ROLES[name],
+            )
+
+        if tracker.enabled:
+            self.lib_trace.enable_heap_tracker(self._global_state)
+
+        tracker._changed = False
+        self._heap_tracker = tracker
+        self._internal_debugger.heap_tracker = tracker
+
+    def get_heap_stats(self: PtraceInterface) -> HeapStats:
+        """Returns the statistics of the heap tracker."""
+        stats = self.ffi.new("struct heap_tracker_stats*")
+
+        self.lib_trace.get_heap_tracker_stats(self._global_state, stats)
+
+        return HeapStats(
+            allocations=stats.allocations,
+            frees=stats.frees,
+            invalid_frees=stats.invalid_frees,
+            live_count=stats.live_count,
+            live_bytes=stats.live_bytes,
+            peak_bytes=stats.peak_bytes,
+            mmap_count=stats.mmap_count,
+            mmap_bytes=stats.mmap_bytes,
+            brk_start=stats.brk_start,
+            brk_end=stats.brk_end,
+        )
+
+    def _convert_heap_allocation(self: PtraceInterface, allocation: object) -> HeapAllocation:
+        """Converts a native heap allocation."""
+        return HeapAllocation(
+            address=allocation.address,
+            size=allocation.size,
+            thread_id=allocation.tid,
+            pc=allocation.pc,
+            backtrace=list(allocation.backtrace)[: allocation.backtrace_depth],
+            mmap=bool(allocation.mmap),
+        )
+
+    def get_heap_allocations(self: PtraceInterface) -> list[HeapAllocation]:
+        """Returns the live allocations tracked by the heap tracker, sorted by address."""
+        stats = self.ffi.new("struct heap_tracker_stats*")
+
+        if not self.lib_trace.get_heap_tracker_stats(self._global_state, stats):
+            return []
+
+        max_count = stats.live_count + stats.mmap_count
+        buffer = self.ffi.new("struct heap_allocation[]", max_count)
+        count = self.lib_trace.get_heap_allocations(self._global_state, buffer, max_count)
+
+        allocations = [self._convert_heap_allocation(buffer[index]) for index in range(count)]
+        allocations.sort(key=lambda allocation: allocation.address)
+
+        return allocations
+
+    def find_heap_allocation(self: PtraceInterface, address: int) -> HeapAllocation | None:
+        """Returns the live allocation containing the specified address, if any.
+
+        Args:
+            address (int): The address to look up.
+        """
+        allocation = self.ffi.new("struct heap_allocation*")
+
+        if not self.lib_trace.find_heap_allocation(self._global_state, address, allocation):
+            return None
+
+        return self._convert_heap_allocation(allocation)
+
+    def set_profiler(self: PtraceInterface, profiler: Profiler) -> None:
+        """Installs the sampling profiler in the process.
+
+        Args:
+            profiler (Profiler): The profiler to install.
+        """
+        self.lib_trace.configure_profiler(
+            self._global_state,
+            self.process_id,
+            profiler.frequency,
+            profiler.max_depth,
+        )
+
+        if profiler.enabled:
+            self.lib_trace.enable_profiler(self._global_state)
+
+        profiler._changed = False
+        profiler._maps = self.maps()
+        self._profiler = profiler
+        self._internal_debugger.profiler = profiler
+
+    def get_profiler_stats(self: PtraceInterface) -> ProfilerStats:
+        """Returns the statistics of the profiler."""
+        stats = self.ffi.new("struct profiler_stats*")
+
+        self.lib_trace.get_profiler_stats(self._global_state, stats)
+
+        return ProfilerStats(
+            samples=stats.samples,
+            requested=stats.requested,
+            missed=stats.missed,
+            truncated=stats.truncated,
+        )
+
+    def get_profiled_stacks(self: PtraceInterface) -> list[ProfiledStack]:
+        """Returns the stacks collected by the profiler, with their sample count."""
+        stats = self.ffi.new("struct profiler_stats*")
+
+        if not self.lib_trace.get_profiler_stats(self._global_state, stats) or not stats.stacks:
+            return []
+
+        stacks = self.ffi.new("struct profiled_stack[]", stats.stacks)
+        stack_count = self.lib_trace.get_profiled_stacks(self._global_state, stacks, stats.stacks)
+
+        frames = self.ffi.new("uint64_t[]", stats.frames)
+        self.lib_trace.get_profiled_frames(self._global_state, frames, stats.frames)
+
+        return [
+            ProfiledStack(
+                thread_id=stack.tid,
+                frames=list(frames[stack.frames_offset : stack.frames_offset + stack.depth]),
+                count=stack.count,
+            )
+            for stack in stacks[0:stack_count]
+        ]
+
+    def reset_profiler(self: PtraceInterface) -> None:
+        """Discards the samples collected by the profiler."""
+        self.lib_trace.reset_profiler(self._global_state)
+
+    def walk_glibc_heap(self: PtraceInterface, layout: GlibcHeapLayout) -> tuple[HeapChunkList, list[HeapCorruption]]:
+        """Walks the main heap of glibc.
+
+        Args:
+            layout (GlibcHeapLayout): The layout of the main arena and the bounds of the main heap.
+
+        Returns:
+            HeapChunkList: The chunks of the main heap, sorted by address.
+            list[HeapCorruption]: The inconsistencies found in the chunks and in the bins.
+        """
+        native_layout = self.ffi.new(
+            "struct glibc_heap_layout*",
+            {
+                "arena": layout.arena,
+                "heap_start": layout.heap_start,
+                "heap_end": layout.heap_end,
+                "fastbins_offset": layout.fastbins_offset,
+                "top_offset": layout.top_offset,
+                "bins_offset": layout.bins_offset,
+                "tcache_counts_size": layout.tcache_counts_size,
+                "safe_linking": layout.safe_linking,
+            },
+        )
+
+        walk = self.lib_trace.walk_glibc_heap(self.process_id, native_layout)
+
+        if walk == self.ffi.NULL:
+            raise RuntimeError("Cannot read the heap of the process.")
+
+        try:
+            chunk_size = self.ffi.sizeof("struct glibc_heap_chunk")
+            chunks = HeapChunkList(bytes(self.ffi.buffer(walk.chunks, walk.chunk_count * chunk_size)))
+
+            corruptions = [
+                HeapCorruption(
+                    code=corruption.code,
+                    address=corruption.address,
+                    value=corruption.value,
+                    bin=corruption.bin,
+                )
+                for corruption in walk.corruptions[0 : walk.corruption_count]
+            ]
+        finally:
+            self.lib_trace.free_glibc_heap_walk(walk)
+
+        return chunks, corruptions
+
+    def walk_python_stack(self: PtraceInterface, layout: CPythonLayout, thread_id: int) -> list[PythonFrame]:
+        """Walks the frames of the Python code executed by a thread of a CPython interpreter.
+
+        Args:
+            layout (CPythonLayout): The layout of the interpreter.
+            thread_id (int): The thread to walk.
+
+        Returns:
+            list[PythonFrame]: The frames of the thread, innermost first.
+        """
+        # The native layout is built once, walks are expected to be frequent
+        if self._cpython_layout is None or self._cpython_layout[0] is not layout:
+            fields = asdict(layout)
+            del fields["version"]
+            fields.update(
+                bytes_size=CPYTHON_BYTES_SIZE_OFFSET,
+                bytes_data=CPYTHON_BYTES_DATA_OFFSET,
+                unicode_length=CPYTHON_UNICODE_LENGTH_OFFSET,
+                unicode_state=CPYTHON_UNICODE_STATE_OFFSET,
+            )
+            self._cpython_layout = (layout, self.ffi.new("struct cpython_layout*", fields))
+
+        native_layout = self._cpython_layout[1]
+
+        stack = self.lib_trace.walk_cpython_stack(self.process_id, native_layout, thread_id)
+
+        try:
+            strings = bytes(self.ffi.buffer(stack.strings, stack.strings_size)) if stack.strings_size else b""
+
+            def decode(offset: int, size: int, kind: int) -> str:
+                if not kind:
+                    return "???"
+
+                return strings[offset : offset + size].decode(CPYTHON_STRING_ENCODINGS[kind], errors="replace")
+
+            frames = [
+                PythonFrame(
+                    function=decode(frame.name_offset, frame.name_size, frame.name_kind),
+                    filename=decode(frame.filename_offset, frame.filename_size, frame.filename_kind),
+                    line=frame.line,
+                    code_address=frame.code,
+                    frame_address=frame.address,
+                    entry=bool(frame.entry),
+                )
+                for frame in stack.frames[0 : stack.frame_count]
+            ]
+        finally:
+            self.lib_trace.free_cpython_stack(stack)
+
+        return frames
+
+    def evaluate_dwarf_locations(
+        self: PtraceInterface,
+        thread_id: int,
+        plan: DwarfFramePlan,
+    ) -> list[list[tuple[int, int, int]] | None]:
+        """Evaluates the locations of the variables of a frame against the registers of a thread.
+
+        Args:
+            thread_id (int): The thread whose registers are used.
+            plan (DwarfFramePlan): The locations to evaluate.
+
+        Returns:
+            list[list[tuple[int, int, int]] | None]: The pieces of each location, as (kind, size, value), None if the
+            location cannot be evaluated.
+        """
+        # The native expressions are built once per plan, evaluations are expected to be frequent
+        if plan._native is None:
+            keep_alive = []
+
+            def compile_expression(ops: tuple) -> dict:
+                native_ops = self.ffi.new("struct dwarf_op[]", [list(op) for op in ops]) if ops else self.ffi.NULL
+                keep_alive.append(native_ops)
+                return {"ops": native_ops, "op_count": len(ops)}
+
+            frame = self.ffi.new(
+                "struct dwarf_frame*",
+                {
+                    "base_address": plan.base_address,
+                    "cfa_register": plan.cfa_register,
+                    "cfa_offset": plan.cfa_offset,
+                    "at_entry": plan.at_entry,
+                    "frame_base": compile_expression(plan.frame_base),
+                },
+            )
+            count = len(plan.expressions)
+            expressions = self.ffi.new(
+                "struct dwarf_expression[]",
+                [compile_expression(ops) for ops in plan.expressions] or 1,
+            )
+            plan._native = (frame, expressions, count, keep_alive)
+
+        frame, expressions, count, _ = plan._native
+
+        self.lib_trace.evaluate_dwarf_expressions(self._global_state, thread_id, frame, expressions, count)
+
+        results = []
+
+        for expression in expressions[0:count]:
+            if expression.piece_count < 0:
+                results.append(None)
+            else:
+                results.append(
+                    [(piece.kind, piece.size, piece.value) for piece in expression.pieces[0 : expression.piece_count]],
+                )
+
+        return results
+
+    def set_budget(self: PtraceInterface, budget: ExecutionBudget) -> None:
+        """Enforces an execution budget on the process, replacing the previous one.
+
+        Args:
+            budget (ExecutionBudget): The budget to enforce.
+        """
+        limits = self.ffi.new("struct budget_usage*")
+        limits.wall_time = int(budget.wall_time * 1e9) if budget.wall_time is not None else 0
+        limits.cpu_time = int(budget.cpu_time * 1e9) if budget.cpu_time is not None else 0
+        limits.syscalls = budget.syscalls or 0
+        limits.breakpoint_hits = budget.breakpoint_hits or 0
+
+        # The replaced budget keeps what it counted
+        if self._budget is not None:
+            self._budget._freeze(self.get_budget_usage())
+
+        self.lib_trace.configure_budget(self._global_state, self.process_id, limits)
+
+        self._budget = budget
+        self._internal_debugger.execution_budget = budget
+
+    def get_budget_usage(self: PtraceInterface) -> BudgetUsage:
+        """Returns the resources used by the process since the budget was set."""
+        usage = self.ffi.new("struct budget_usage*")
+
+        if not self.lib_trace.get_budget_usage(self._global_state, usage):
+            return BudgetUsage(0.0, 0.0, 0, 0)
+
+        return BudgetUsage(usage.wall_time / 1e9, usage.cpu_time / 1e9, usage.syscalls, usage.breakpoint_hits)
+
+    def set_virtual_clock(self: PtraceInterface, clock: VirtualClock) -> None:
+        """Installs the virtual clock in the process.
+
+        Args:
+            clock (VirtualClock): The virtual clock to install.
+        """
+        self.lib_trace.configure_virtual_clock(self._global_state, clock.enabled)
+
+        clock._changed = False
+        self._virtual_clock = clock
+        self._internal_debugger.virtual_clock = clock
+
+    def advance_virtual_clock(self: PtraceInterface, nanoseconds: int) -> None:
+        """Moves the virtual clock of the process forward.
+
+        Args:
+            nanoseconds (int): The nanoseconds to add to the offset of the clocks.
+        """
+        self.lib_trace.advance_virtual_clock(self._global_state, nanoseconds)
+
+    def get_virtual_clock_stats(self: PtraceInterface) -> VirtualClockStats:
+        """Returns the statistics of the virtual clock."""
+        stats = self.ffi.new("struct virtual_clock_stats*")
+
+        if not self.lib_trace.get_virtual_clock_stats(self._global_state, stats):
+            return VirtualClockStats(0.0, 0, 0)
+
+        return VirtualClockStats(stats.offset / 1e9, stats.sleeps, stats.clock_reads)
+
+    def set_syscall_profiler(self: PtraceInterface, profiler: SyscallProfiler) -> None:
+        """Installs the syscall profiler in the process.
+
+        Args:
+            profiler (SyscallProfiler): The syscall profiler to install.
+        """
+        self.lib_trace.configure_syscall_profiler(self._global_state, profiler.enabled, profiler.call_sites)
+
+        profiler._changed = False
+        self._syscall_profiler = profiler
+        self._internal_debugger.syscall_profiler = profiler
+
+    def get_profiled_syscalls(self: PtraceInterface) -> list[SyscallStats]:
+        """Returns the latencies of the syscalls measured by the syscall profiler, per thread and call site."""
+        stats = self.ffi.new("struct syscall_profiler_stats*")
+
+        if not self.lib_trace.get_syscall_profiler_stats(self._global_state, stats) or not stats.entries:
+            return []
+
+        syscalls = self.ffi.new("struct profiled_syscall[]", stats.entries)
+        count = self.lib_trace.get_profiled_syscalls(self._global_state, syscalls, stats.entries)
+
+        return [
+            SyscallStats(
+                syscall=self._resolve_profiled_syscall_name(syscall.number),
+                number=syscall.number,
+                thread_id=syscall.tid,
+                call_site=syscall.call_site or None,
+                count=syscall.count,
+                errors=syscall.errors,
+                total_time=syscall.total_time / 1e9,
+                min_time=syscall.min_time / 1e9,
+                max_time=syscall.max_time / 1e9,
+                histogram=list(syscall.histogram),
+            )
+            for syscall in syscalls[0:count]
+        ]
+
+    def _resolve_profiled_syscall_name(self: PtraceInterface, number: int) -> str:
+        """Returns the name of a profiled syscall, or a placeholder if the number is unknown."""
+        try:
+            return resolve_syscall_name(self._internal_debugger.arch, number)
+        except ValueError:
+            return f"syscall_{number}"
+
+    def reset_syscall_profiler(self: PtraceInterface) -> None:
+        """Discards the latencies measured by the syscall profiler."""
+        self.lib_trace.reset_syscall_profiler(self._global_state)
+
+    def set_fd_tracker(self: PtraceInterface, tracker: FdTracker) -> None:
+        """Installs the tracker of the file descriptors in the process, or applies its state.
+
+        Args:
+            tracker (FdTracker): The tracker to install.
+        """
+        self.lib_trace.configure_fd_table(self._global_state, self.process_id, tracker.enabled)
+
+        self._fd_tracker = tracker
+        self._internal_debugger.fd_tracker = tracker
+
+    def refresh_fd_table(self: PtraceInterface) -> None:
+        """Reads the file descriptors of the process from /proc again."""
+        self.lib_trace.refresh_fd_table(self._global_state)
+
+    def get_fd_info(self: PtraceInterface, fd: int) -> FdInfo | None:
+        """Returns a file descriptor of the process from the tracked table, None if it is not open.
+
+        Args:
+            fd (int): The file descriptor.
+        """
+        buffer = self.ffi.new("char[]", FD_PATH_SIZE)
+        length = self.lib_trace.get_fd_path(self._global_state, fd, buffer, FD_PATH_SIZE)
+
+        if length < 0:
+            return None
+
+        if length >= FD_PATH_SIZE:
+            # The longest paths do not fit in the buffer
+            buffer = self.ffi.new("char[]", length + 1)
+            self.lib_trace.get_fd_path(self._global_state, fd, buffer, length + 1)
+
+        return FdInfo(fd, self.ffi.string(buffer).decode(errors="backslashreplace"))
+
+    def get_fd_table(self: PtraceInterface) -> dict[int, FdInfo]:
+        """Returns the open file descriptors of the process from the tracked table, by number."""
+        fds = self.ffi.new("int[]", FD_TABLE_CHUNK_SIZE)
+
+        while (count := self.lib_trace.get_open_fds(self._global_state, fds, len(fds))) == len(fds):
+            fds = self.ffi.new("int[]", len(fds) * 2)
+
+        return {fd: info for fd in fds[0:count] if (info := self.get_fd_info(fd)) is not None}
+
+    def set_latency_mode(self: PtraceInterface, mode: LatencyMode | None) -> None:
+        """Pins the calling thread and the process to the CPUs of a latency mode.
+
+        Args:
+            mode (LatencyMode | None): The latency mode, None to restore the default placement.
+        """
+        if self._default_affinity is None:
+            self._default_affinity = os.sched_getaffinity(0)
+
+        # The calling thread is the polling thread, which waits for the stops of the process
+        os.sched_setaffinity(0, {mode.tracer_cpu} if mode is not None else self._default_affinity)
+
+        self._global_state.wait_spin_ns = int(mode.spin_time * 1e9) if mode is not None else 0
+
+        if self.process_id and not self.detached:
+            pin_process(self.process_id, {mode.tracee_cpu} if mode is not None else self._default_affinity)
+
+    def inject_syscall(self: PtraceInterface, thread: ThreadContext, number: int, args: list[int], gadget: int) -> int:
+        """Executes a syscall in a stopped thread, restoring the state of the thread afterwards.
+
+        Args:
+            thread (ThreadContext): The thread that executes the syscall.
+            number (int): The number of the syscall.
+            args (list[int]): The arguments of the syscall, at most six.
+            gadget (int): The address of an existing syscall instruction, 0 to patch one at the program counter.
+
+        Returns:
+            int: The return value of the syscall.
+        """
+        arguments = self.ffi.new("uint64_t[6]", [arg & 0xFFFFFFFFFFFFFFFF for arg in args])
+        result = self.ffi.new("uint64_t*")
+
+        if self.lib_trace.inject_syscall(self._global_state, thread.thread_id, gadget, number, arguments, result):
+            errno_val = self.ffi.errno
+            raise OSError(errno_val, errno.errorcode[errno_val])
+
+        # The syscall could have changed the memory maps
+        invalidate_process_cache()
+
+        return result[0]
+
+    def call_function(
+        self: PtraceInterface,
+        thread: ThreadContext,
+        function: int,
+        trap: int,
+        args: list[int],
+    ) -> int:
+        """Calls a function of the process in a stopped thread, restoring the state of the thread afterwards.
+
+        Args:
+            thread (ThreadContext): The thread that executes the function.
+            function (int): The address of the function.
+            trap (int): The address of the instruction that traps the return from the function.
+            args (list[int]): The integer arguments of the function.
+
+        Returns:
+            int: The return value of the function.
+        """
+        arguments = self.ffi.new("uint64_t[]", [arg & 0xFFFFFFFFFFFFFFFF for arg in args])
+        result = self.ffi.new("uint64_t*")
+        mapped = self.ffi.new("_Bool*")
+
+        status = self.lib_trace.call_function(
+            self._global_state,
+            thread.thread_id,
+            function,
+            trap,
+            arguments,
+            len(args),
+            result,
+            mapped,
+        )
+
+        # The maps are read again only if a syscall of the function changed them
+        invalidate_process_cache(maps=mapped[0])
+
+        if status == -1:
+            errno_val = self.ffi.errno
+            raise OSError(errno_val, errno.errorcode[errno_val])
+
+        if status:
+            raise RuntimeError(
+                f"The function at {function:#x} was interrupted by {resolve_signal_name(status)} at {result[0]:#x}.",
+            )
+
+        return result[0]
+
+    def create_lockstep(
+        self: PtraceInterface,
+        mode: int,
+        max_steps: int,
+        registers: list[str],
+        ranges: list[tuple[int, int, int]],
+    ) -> object:
+        """Creates the native state of a lockstep, shared by the debuggers of the two processes.
+
+        Args:
+            mode (int): What a step executes.
+            max_steps (int): The maximum number of steps.
+            registers (list[str]): The compared registers.
+            ranges (list[tuple[int, int, int]]): The compared memory ranges, as the address in the first process, the
+            address in the second process and the size.
+
+        Returns:
+            object: The native lockstep, to release with collect_lockstep.
+        """
+        offsets = []
+
+        for name in registers:
+            try:
+                offsets.append(self.ffi.offsetof("struct ptrace_regs_struct", name))
+            except KeyError as e:
+                raise ValueError(f"Unknown register {name}.") from e
+
+        return self.lib_trace.create_lockstep(
+            mode,
+            max_steps,
+            self.ffi.new("uint32_t[]", offsets),
+            len(offsets),
+            self.ffi.new("uint64_t[]", [first for first, _, _ in ranges]),
+            self.ffi.new("uint64_t[]", [second for _, second, _ in ranges]),
+            self.ffi.new("uint64_t[]", [size for _, _, size in ranges]),
+            len(ranges),
+        )
+
+    def lockstep(self: PtraceInterface, thread: ThreadContext, lockstep: object, side: int) -> None:
+        """Steps a thread in lockstep with the thread of another process, until the lockstep is over.
+
+        Args:
+            thread (ThreadContext): The thread to step.
+            lockstep (object): The native lockstep.
+            side (int): 0 if the process is the first of the lockstep, 1 if it is the second.
+        """
+        status = self.lib_trace.run_lockstep(lockstep, side, self._global_state, thread.thread_id)
+
+        # The steps could have changed the memory maps
+        invalidate_process_cache()
+
+        if status:
+            errno_val = self.ffi.errno
+            raise OSError(errno_val, errno.errorcode[errno_val])
+
+    def collect_lockstep(
+        self: PtraceInterface,
+        lockstep: object,
+        registers: list[str],
+        sizes: list[int],
+    ) -> tuple[int, int, list[tuple[dict[str, int], list[bytes]]]]:
+        """Collects the result of a lockstep, and releases its native state.
+
+        Args:
+            lockstep (object): The native lockstep.
+            registers (list[str]): The compared registers.
+            sizes (list[int]): The sizes of the compared memory ranges.
+
+        Returns:
+            int: Why the lockstep stopped.
+            int: The number of steps taken.
+            list[tuple[dict[str, int], list[bytes]]]: The registers and the memory ranges of both processes.
+        """
+        steps = self.ffi.new("uint64_t*")
+        outcome = self.lib_trace.get_lockstep_result(lockstep, steps)
+
+        states = []
+
+        for side in range(2):
+            regs = self.ffi.new("struct ptrace_regs_struct*")
+            memory = self.ffi.new("uint8_t[]", sum(sizes) + 1)
+
+            self.lib_trace.get_lockstep_state(lockstep, side, regs, memory)
+
+            content = self.ffi.buffer(memory, sum(sizes))[:]
+            offsets = [sum(sizes[:i]) for i in range(len(sizes))]
+
+            states.append(
+                (
+                    {name: getattr(regs, name) for name in registers},
+                    [content[offset : offset + size] for offset, size in zip(offsets, sizes, strict=True)],
+                ),
+            )
+
+        self.lib_trace.free_lockstep(lockstep)
+
+        return outcome, steps[0], states
+
     def peek_memory(self: PtraceInterface, address: int) -> int:
         """Reads the memory at the specified address."""
         result = self.lib_trace.ptrace_peekdata(self.process_id, address)
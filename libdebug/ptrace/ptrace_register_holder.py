@@ -9,12 +9,26 @@ from __future__ import annotations
 from dataclasses import dataclass
 from typing import TYPE_CHECKING
 
+from libdebug.cffi._ptrace_cffi import ffi
 from libdebug.data.register_holder import RegisterHolder
 
 if TYPE_CHECKING:
     from libdebug.state.thread_context import ThreadContext
 
 
+def register_index(name: str) -> int:
+    """Returns the index of a register in the register file, seen as an array of 64-bit words."""
+    return ffi.offsetof("struct ptrace_regs_struct", name) // 8
+
+
+def register_file_view(register_file: object) -> memoryview:
+    """Returns a view of the register file as an array of 64-bit words, sharing its memory.
+
+    The accessors index the view directly, instead of looking up the fields of the cffi struct by name.
+    """
+    return memoryview(ffi.buffer(register_file)).cast("Q")
+
+
 @dataclass
 class PtraceRegisterHolder(RegisterHolder):
     """An abstract class that holds the state of the registers of a process, providing setters and getters for them.
@@ -78,7 +78,7 @@ class PtraceStatusHandler:
         bp: None | Breakpoint
 
         bp = self.internal_debugger.breakpoints.get(ip)
-        if bp and bp.enabled and not bp._disabled_for_step:
+        if bp and bp.enabled and not bp._disabled_for_step and bp.selects_thread(thread_id):
             # Hardware breakpoint hit
             liblog.debugger("Hardware breakpoint hit at 0x%x", ip)
         else:
@@ -87,7 +87,11 @@ class PtraceStatusHandler:
             ip -= software_breakpoint_byte_size(self.internal_debugger.arch)
 
             bp = self.internal_debugger.breakpoints.get(ip)
-            if bp and bp.enabled and not bp._disabled_for_step:
+            if bp and bp.enabled and not bp._disabled_for_step and not bp.selects_thread(thread_id):
+                # The breakpoint is scoped to other threads, the trap is stepped over on resume
+                thread.instruction_pointer = ip
+                bp = None
+            elif bp and bp.enabled and not bp._disabled_for_step:
                 # Software breakpoint hit
                 liblog.debugger("Software breakpoint hit at 0x%x", ip)
 
@@ -108,7 +112,10 @@ class PtraceStatusHandler:
 
         if bp:
             self.forward_signal = False
-            bp.hit_count += 1
+
+            # The hits of the native callbacks are counted by the native code
+            if bp.native_callback is None:
+                bp.hit_count += 1
 
             if bp.callback:
                 bp.callback(thread, bp)
@@ -116,6 +123,29 @@ class PtraceStatusHandler:
                 # If the breakpoint has no callback, we need to stop the process despite the other signals
                 self.internal_debugger.resume_context.resume = False
 
+        if self.internal_debugger.return_address_monitor is not None:
+            self._handle_return_address_violation(thread)
+
+    def _handle_return_address_violation(self: PtraceStatusHandler, thread: ThreadContext) -> None:
+        monitor = self.internal_debugger.return_address_monitor
+
+        # Clean returns are handled by the native code, we only see the corrupted ones
+        violation = self.ptrace_interface.get_return_address_violation(thread.thread_id)
+
+        if violation is None:
+            return
+
+        liblog.debugger("Return address violation at 0x%x: %r", violation.address, violation)
+
+        monitor.violations.append(violation)
+        monitor.hit_count += 1
+        self.forward_signal = False
+
+        if monitor.callback:
+            monitor.callback(thread, violation)
+        else:
+            self.internal_debugger.resume_context.resume = False
+
     def _manage_syscall_on_enter(
         self: PtraceStatusHandler,
         handler: SyscallHandler,
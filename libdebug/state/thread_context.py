@@ -5,18 +5,22 @@
 #
 from __future__ import annotations
 
-from typing import TYPE_CHECKING
+from typing import TYPE_CHECKING, Any
 
 from libdebug.architectures.stack_unwinding_provider import stack_unwinding_provider
+from libdebug.data.python_frame import PythonFrame
 from libdebug.debugger.internal_debugger_instance_manager import (
     provide_internal_debugger,
 )
 from libdebug.liblog import liblog
+from libdebug.utils.cpython_utils import merge_python_frames
 from libdebug.utils.debugging_utils import resolve_address_in_maps
+from libdebug.utils.dwarf_location_utils import build_variable_value, resolve_frame_plan
 from libdebug.utils.print_style import PrintStyle
 from libdebug.utils.signal_utils import resolve_signal_name, resolve_signal_number
 
 if TYPE_CHECKING:
+    from libdebug.data.fd_table import FdInfo
     from libdebug.data.register_holder import RegisterHolder
     from libdebug.data.registers import Registers
     from libdebug.debugger.internal_debugger import InternalDebugger
@@ -174,27 +178,79 @@ class ThreadContext:
         self._signal_number = signal
         self._internal_debugger.resume_context.threads_with_signals_to_forward.append(self.thread_id)
 
-    def backtrace(self: ThreadContext, as_symbols: bool = False) -> list:
+    def backtrace(self: ThreadContext, as_symbols: bool = False, python: bool = False) -> list:
         """Returns the current backtrace of the thread.
 
         Args:
             as_symbols (bool, optional): Whether to return the backtrace as symbols
+            python (bool, optional): Whether to replace the calls to the evaluation loop of a CPython interpreter
+            with the Python frames they execute. Defaults to False.
         """
         self._internal_debugger._ensure_process_stopped()
         stack_unwinder = stack_unwinding_provider(self._internal_debugger.arch)
         backtrace = stack_unwinder.unwind(self)
+        maps = self._internal_debugger.debugging_interface.maps()
+        if python:
+            backtrace = merge_python_frames(backtrace, self.python_backtrace(), maps)
         if as_symbols:
-            maps = self._internal_debugger.debugging_interface.maps()
-            backtrace = [resolve_address_in_maps(x, maps) for x in backtrace]
+            backtrace = [str(x) if isinstance(x, PythonFrame) else resolve_address_in_maps(x, maps) for x in backtrace]
         return backtrace
 
-    def print_backtrace(self: ThreadContext) -> None:
-        """Prints the current backtrace of the thread."""
+    def python_backtrace(self: ThreadContext) -> list[PythonFrame]:
+        """Returns the frames of the Python code executed by the thread, innermost first.
+
+        The process must be a CPython 3.11+ interpreter. The frames are read natively from the interpreter state.
+        """
+        self._internal_debugger._ensure_process_stopped()
+        layout = self._internal_debugger._resolve_cpython_layout()
+        return self._internal_debugger.debugging_interface.walk_python_stack(layout, self.thread_id)
+
+    def locals(self: ThreadContext) -> dict[str, Any]:
+        """Returns the local variables of the function the thread is executing, parameters excluded.
+
+        The locations described by the DWARF debug info are evaluated natively against the registers of the thread.
+        Scalars are returned as Python values, any other type as a TypedValue. Variables optimized out, or whose
+        location cannot be evaluated at the current instruction, are None.
+        """
+        return self._dwarf_variables(parameters=False)
+
+    def args(self: ThreadContext) -> dict[str, Any]:
+        """Returns the parameters of the function the thread is executing.
+
+        Parameters whose location cannot be evaluated at the current instruction are None.
+        """
+        return self._dwarf_variables(parameters=True)
+
+    def _dwarf_variables(self: ThreadContext, parameters: bool) -> dict[str, Any]:
+        """Evaluates the variables in scope at the current instruction of the thread."""
+        self._internal_debugger._ensure_process_stopped()
+
+        plan = resolve_frame_plan(self._internal_debugger, self.instruction_pointer)
+        pieces = self._internal_debugger.debugging_interface.evaluate_dwarf_locations(self.thread_id, plan)
+
+        return {
+            variable.name: build_variable_value(self._internal_debugger, plan.table, variable, variable_pieces)
+            for variable, variable_pieces in zip(plan.variables, pieces, strict=True)
+            if variable.is_parameter == parameters
+        }
+
+    def print_backtrace(self: ThreadContext, python: bool = False) -> None:
+        """Prints the current backtrace of the thread.
+
+        Args:
+            python (bool, optional): Whether to replace the calls to the evaluation loop of a CPython interpreter
+            with the Python frames they execute. Defaults to False.
+        """
         self._internal_debugger._ensure_process_stopped()
         stack_unwinder = stack_unwinding_provider(self._internal_debugger.arch)
         backtrace = stack_unwinder.unwind(self)
         maps = self._internal_debugger.debugging_interface.maps()
+        if python:
+            backtrace = merge_python_frames(backtrace, self.python_backtrace(), maps)
         for return_address in backtrace:
+            if isinstance(return_address, PythonFrame):
+                print(f"{PrintStyle.BLUE}{return_address} {PrintStyle.RESET}")
+                continue
             return_address_symbol = resolve_address_in_maps(return_address, maps)
             if return_address_symbol[:2] == "0x":
                 print(f"{PrintStyle.RED}{return_address:#x} {PrintStyle.RESET}")
@@ -216,6 +272,49 @@ class ThreadContext:
 
         return return_address
 
+    def call(self: ThreadContext, function: int | str, *args: int, file: str = "hybrid") -> int:
+        """Calls a function of the process in the thread, restoring the state of the thread afterwards.
+
+        The thread runs natively from the function until it returns, while the other threads stay stopped.
+
+        Args:
+            function (int | str): The address or the symbol of the function.
+            *args (int): The integer arguments of the function, e.g., the addresses of the buffers.
+            file (str, optional): The backing file to resolve the function in. Defaults to "hybrid".
+
+        Returns:
+            int: The return value of the function.
+        """
+        return self._internal_debugger.call(self, function, *args, file=file)
+
+    def syscall(self: ThreadContext, syscall: int | str, *args: int) -> int:
+        """Executes a syscall in the thread, restoring the state of the thread afterwards.
+
+        The syscall instruction is either found in the process or temporarily patched over the current instruction.
+
+        Args:
+            syscall (int | str): The syscall name or number.
+            *args (int): The arguments of the syscall, at most six.
+
+        Returns:
+            int: The return value of the syscall.
+        """
+        return self._internal_debugger.syscall(self, syscall, *args)
+
+    def fd_info(self: ThreadContext, fd: int) -> FdInfo | None:
+        """Returns what a file descriptor of the thread refers to, e.g., a path, a socket or a pipe.
+
+        The lookup is served by the native table of the descriptors when they are tracked, and it reads /proc
+        otherwise.
+
+        Args:
+            fd (int): The file descriptor.
+
+        Returns:
+            FdInfo | None: The file descriptor, None if it is not open.
+        """
+        return self._internal_debugger.fd_info(fd)
+
     def step(self: ThreadContext) -> None:
         """Executes a single instruction of the process."""
         self._internal_debugger.step(self)
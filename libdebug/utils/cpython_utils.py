@@ -0,0 +1,250 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from dataclasses import dataclass, replace
+from typing import TYPE_CHECKING
+
+from libdebug.liblog import liblog
+from libdebug.utils.debugging_utils import resolve_address_in_maps
+
+if TYPE_CHECKING:
+    from libdebug.data.memory_map import MemoryMap
+    from libdebug.data.python_frame import PythonFrame
+    from libdebug.debugger.internal_debugger import InternalDebugger
+
+
+@dataclass(frozen=True)
+class CPythonLayout:
+    """The addresses and the structure offsets needed to walk the frames of a CPython interpreter.
+
+    Attributes:
+        version (tuple[int, int]): The version of the interpreter.
+        runtime (int): The address of `_PyRuntime`.
+        code_type (int): The address of `PyCode_Type`, 0 if unknown.
+        runtime_interpreters (int): The offset of the head of the interpreters in `_PyRuntimeState`.
+        interp_next (int): The offset of `next` in `PyInterpreterState`.
+        interp_threads (int): The offset of the head of the threads in `PyInterpreterState`.
+        tstate_next (int): The offset of `next` in `PyThreadState`.
+        tstate_native_thread_id (int): The offset of `native_thread_id` in `PyThreadState`.
+        tstate_cframe (int): The offset of `cframe` in `PyThreadState`, 0 if the current frame is in the thread state.
+        tstate_frame (int): The offset of the current frame in `PyThreadState`, or in `_PyCFrame` if
+        `tstate_cframe` is set.
+        frame_code (int): The offset of the code object in `_PyInterpreterFrame`.
+        frame_previous (int): The offset of `previous` in `_PyInterpreterFrame`.
+        frame_instr (int): The offset of the instruction pointer in `_PyInterpreterFrame`.
+        frame_owner (int): The offset of `owner` in `_PyInterpreterFrame`.
+        frame_is_entry (int): The offset of `is_entry` in `_PyInterpreterFrame`, -1 if missing.
+        cstack_owner (int): The owner of the frames pushed by the C stack, -1 if missing.
+        code_filename (int): The offset of `co_filename` in `PyCodeObject`.
+        code_qualname (int): The offset of `co_qualname` in `PyCodeObject`.
+        code_linetable (int): The offset of `co_linetable` in `PyCodeObject`.
+        code_firstlineno (int): The offset of `co_firstlineno` in `PyCodeObject`.
+        code_adaptive (int): The offset of `co_code_adaptive` in `PyCodeObject`.
+        unicode_ascii_data (int): The size of `PyASCIIObject`.
+        unicode_compact_data (int): The size of `PyCompactUnicodeObject`.
+    """
+
+    version: tuple[int, int]
+    runtime: int
+    code_type: int
+    runtime_interpreters: int
+    interp_next: int
+    interp_threads: int
+    tstate_next: int
+    tstate_native_thread_id: int
+    tstate_cframe: int
+    tstate_frame: int
+    frame_code: int
+    frame_previous: int
+    frame_instr: int
+    frame_owner: int
+    frame_is_entry: int
+    cstack_owner: int
+    code_filename: int
+    code_qualname: int
+    code_linetable: int
+    code_firstlineno: int
+    code_adaptive: int
+    unicode_ascii_data: int
+    unicode_compact_data: int
+
+
+# The offsets of the supported versions of CPython, for the default (non-debug, GIL) builds on 64-bit platforms
+CPYTHON_LAYOUTS = {
+    (3, 11): CPythonLayout(
+        version=(3, 11),
+        runtime=0,
+        code_type=0,
+        runtime_interpreters=40,
+        interp_next=0,
+        interp_threads=16,
+        tstate_next=8,
+        tstate_native_thread_id=160,
+        tstate_cframe=56,
+        tstate_frame=8,
+        frame_code=32,
+        frame_previous=48,
+        frame_instr=56,
+        frame_owner=69,
+        frame_is_entry=68,
+        cstack_owner=-1,
+        code_filename=112,
+        code_qualname=128,
+        code_linetable=136,
+        code_firstlineno=72,
+        code_adaptive=184,
+        unicode_ascii_data=48,
+        unicode_compact_data=72,
+    ),
+    (3, 12): CPythonLayout(
+        version=(3, 12),
+        runtime=0,
+        code_type=0,
+        runtime_interpreters=40,
+        interp_next=0,
+        interp_threads=72,
+        tstate_next=8,
+        tstate_native_thread_id=144,
+        tstate_cframe=56,
+        tstate_frame=0,
+        frame_code=0,
+        frame_previous=8,
+        frame_instr=56,
+        frame_owner=70,
+        frame_is_entry=-1,
+        cstack_owner=3,
+        code_filename=112,
+        code_qualname=128,
+        code_linetable=136,
+        code_firstlineno=68,
+        code_adaptive=192,
+        unicode_ascii_data=40,
+        unicode_compact_data=56,
+    ),
+    (3, 13): CPythonLayout(
+        version=(3, 13),
+        runtime=0,
+        code_type=0,
+        runtime_interpreters=632,
+        interp_next=7264,
+        interp_threads=7344,
+        tstate_next=8,
+        tstate_native_thread_id=160,
+        tstate_cframe=0,
+        tstate_frame=72,
+        frame_code=0,
+        frame_previous=8,
+        frame_instr=56,
+        frame_owner=70,
+        frame_is_entry=-1,
+        cstack_owner=3,
+        code_filename=112,
+        code_qualname=128,
+        code_linetable=136,
+        code_firstlineno=68,
+        code_adaptive=200,
+        unicode_ascii_data=40,
+        unicode_compact_data=56,
+    ),
+}
+
+# The offsets shared by all the supported versions
+CPYTHON_BYTES_SIZE_OFFSET = 16
+CPYTHON_BYTES_DATA_OFFSET = 32
+CPYTHON_UNICODE_LENGTH_OFFSET = 16
+CPYTHON_UNICODE_STATE_OFFSET = 32
+
+# The function running the evaluation loop, each call of which executes a chain of Python frames
+CPYTHON_EVAL_FUNCTION = "_PyEval_EvalFrameDefault"
+
+
+def resolve_cpython_layout(internal_debugger: InternalDebugger) -> CPythonLayout:
+    """Finds the CPython runtime in the process, and returns the layout of its structures.
+
+    Args:
+        internal_debugger (InternalDebugger): The internal debugger of the process.
+
+    Returns:
+        CPythonLayout: The layout of the interpreter.
+    """
+    # The runtime is either in libpython or linked into the executable
+    for backing_file in ["libpython", "binary"]:
+        try:
+            runtime = internal_debugger.resolve_symbol("_PyRuntime", backing_file)
+        except ValueError:
+            continue
+
+        break
+    else:
+        raise ValueError("The process is not a CPython interpreter.")
+
+    try:
+        raw_version = int.from_bytes(
+            internal_debugger._fast_read_memory(internal_debugger.resolve_symbol("Py_Version", backing_file), 8),
+            "little",
+        )
+    except ValueError as e:
+        # Py_Version was added in CPython 3.11
+        raise ValueError("Only CPython 3.11 and later is supported.") from e
+
+    version = ((raw_version >> 24) & 0xFF, (raw_version >> 16) & 0xFF)
+
+    if version not in CPYTHON_LAYOUTS:
+        raise ValueError(f"CPython {version[0]}.{version[1]} is not supported.")
+
+    try:
+        code_type = internal_debugger.resolve_symbol("PyCode_Type", backing_file)
+    except ValueError:
+        code_type = 0
+
+    liblog.debugger(f"Found CPython {version[0]}.{version[1]} with _PyRuntime at {runtime:#x}.")
+
+    return replace(CPYTHON_LAYOUTS[version], runtime=runtime, code_type=code_type)
+
+
+def merge_python_frames(
+    backtrace: list[int],
+    python_frames: list[PythonFrame],
+    maps: list[MemoryMap],
+) -> list[int | PythonFrame]:
+    """Merges the Python frames executed by a thread into its native backtrace.
+
+    Each call to the evaluation loop in the native backtrace is replaced by the Python frames it executes. The Python
+    frames without a matching native frame, e.g., because the native unwinding stopped early, are appended at the end.
+
+    Args:
+        backtrace (list[int]): The native backtrace, innermost first.
+        python_frames (list[PythonFrame]): The Python frames, innermost first.
+        maps (list[MemoryMap]): The memory maps of the process.
+
+    Returns:
+        list[int | PythonFrame]: The merged backtrace, innermost first.
+    """
+    # Split the Python frames by the call to the evaluation loop executing them
+    groups = [[]]
+    for frame in python_frames:
+        groups[-1].append(frame)
+
+        if frame.entry:
+            groups.append([])
+
+    groups = [group for group in groups if group]
+    merged = []
+
+    for address in backtrace:
+        symbol = resolve_address_in_maps(address, maps).rpartition("+")[0]
+
+        if groups and symbol.split(".")[0] == CPYTHON_EVAL_FUNCTION:
+            merged.extend(groups.pop(0))
+        else:
+            merged.append(address)
+
+    for group in groups:
+        merged.extend(group)
+
+    return merged
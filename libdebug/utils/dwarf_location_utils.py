@@ -0,0 +1,222 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from bisect import bisect_right
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING, Any
+
+from libdebug.memory.typed_value import TypedValue, decode_scalar
+from libdebug.utils.elf_utils import get_function_table, get_type_table, is_pie
+
+if TYPE_CHECKING:
+    from libdebug.data.dwarf_function import DwarfLocation, DwarfVariable
+    from libdebug.data.dwarf_type import DwarfType, DwarfTypeTable
+    from libdebug.debugger.internal_debugger import InternalDebugger
+
+# The kinds of the pieces of a location, as returned by the native evaluator
+PIECE_EMPTY = 0
+PIECE_MEMORY = 1
+PIECE_REGISTER = 2
+PIECE_VALUE = 3
+
+# The maximum number of pieces of a location
+DWARF_MAX_PIECES = 8
+
+
+@dataclass(eq=False)
+class DwarfFramePlan:
+    """The locations of the variables of a function, valid in a range of program counters.
+
+    Attributes:
+        low (int): The first program counter the plan is valid at.
+        high (int): The first program counter after the range.
+        function (str): The name of the function.
+        base_address (int): The address the ELF file is loaded at, 0 if it is not position independent.
+        at_entry (bool): Whether the range is the first instruction of the function.
+        cfa_register (int): The DWARF number of the base register of the canonical frame address, -1 if unknown.
+        cfa_offset (int): The offset added to the base register of the canonical frame address.
+        frame_base (tuple): The operations computing the frame base, empty if the function has none.
+        variables (list[DwarfVariable]): The variables in scope.
+        expressions (list[tuple]): The operations computing the location of each variable.
+        table (DwarfTypeTable): The types of the ELF file.
+    """
+
+    low: int
+    high: int
+    function: str
+    base_address: int
+    at_entry: bool
+    cfa_register: int
+    cfa_offset: int
+    frame_base: tuple
+    variables: list[DwarfVariable]
+    expressions: list[tuple]
+    table: DwarfTypeTable
+
+    # The native structures of the evaluator, built on first use
+    _native: Any = field(default=None, repr=False)
+
+
+def resolve_frame_plan(internal_debugger: InternalDebugger, address: int) -> DwarfFramePlan:
+    """Returns the locations of the variables visible at the specified address, computing them on first use.
+
+    Args:
+        internal_debugger (InternalDebugger): The internal debugger.
+        address (int): The program counter.
+
+    Returns:
+        DwarfFramePlan: The plan of the frame, cached for the whole range of program counters it is valid in.
+    """
+    plans = internal_debugger._dwarf_frame_plans
+
+    index = bisect_right(plans, address, key=lambda plan: plan.low) - 1
+    if index >= 0 and address < plans[index].high:
+        return plans[index]
+
+    plan = _build_frame_plan(internal_debugger, address)
+    plans.insert(index + 1, plan)
+
+    return plan
+
+
+def _build_frame_plan(internal_debugger: InternalDebugger, address: int) -> DwarfFramePlan:
+    """Computes the locations of the variables visible at the specified address."""
+    maps = internal_debugger.debugging_interface.maps()
+
+    vmap = next((vmap for vmap in maps if vmap.start <= address < vmap.end), None)
+    if vmap is None or not vmap.backing_file or vmap.backing_file[0] == "[":
+        raise ValueError(f"Address {address:#x} does not belong to any ELF file.")
+
+    path = vmap.backing_file
+    base_address = next(vmap.start for vmap in maps if vmap.backing_file == path) if is_pie(path) else 0
+    relative = address - base_address
+
+    functions = get_function_table(path)
+    function = functions.function_at(relative)
+    if function is None:
+        raise ValueError(f"No debug info describes the function at address {address:#x}.")
+
+    # The plan is valid as long as no boundary of the function, of a scope or of a location is crossed
+    bounds = [function.low_pc, function.high_pc]
+
+    def restrict(low: int, high: int) -> bool:
+        if low <= relative < high:
+            bounds[0] = max(bounds[0], low)
+            bounds[1] = min(bounds[1], high)
+            return True
+
+        if high <= relative:
+            bounds[0] = max(bounds[0], high)
+        else:
+            bounds[1] = min(bounds[1], low)
+
+        return False
+
+    def select(locations: tuple[DwarfLocation, ...]) -> tuple:
+        selected = ()
+
+        for location in locations:
+            if restrict(location.low_pc, location.high_pc):
+                selected = location.ops
+
+        return selected
+
+    # Entry values are only reliable before the first instruction of the function
+    at_entry = restrict(function.low_pc, function.low_pc + 1)
+
+    cfa_rule = functions.cfa_rule_at(relative)
+    if cfa_rule is not None:
+        restrict(cfa_rule.low_pc, cfa_rule.high_pc)
+
+    frame_base = select(function.frame_base)
+
+    variables = []
+    for variable in function.variables:
+        if restrict(variable.low_pc, variable.high_pc):
+            variables.append(variable)
+
+    # The innermost scopes shadow the outer ones
+    visible = {variable.name: variable for variable in function.variables_at(relative)}
+    variables = [variable for variable in variables if visible.get(variable.name) is variable]
+
+    expressions = [select(variable.locations) for variable in variables]
+
+    return DwarfFramePlan(
+        low=bounds[0] + base_address,
+        high=bounds[1] + base_address,
+        function=function.name,
+        base_address=base_address,
+        at_entry=at_entry,
+        cfa_register=cfa_rule.register if cfa_rule is not None else -1,
+        cfa_offset=cfa_rule.offset if cfa_rule is not None else 0,
+        frame_base=frame_base,
+        variables=variables,
+        expressions=expressions,
+        table=get_type_table(path),
+    )
+
+
+def build_variable_value(
+    internal_debugger: InternalDebugger,
+    table: DwarfTypeTable,
+    variable: DwarfVariable,
+    pieces: list[tuple[int, int, int]] | None,
+) -> Any:
+    """Builds the value of a variable from the pieces of its location.
+
+    Args:
+        internal_debugger (InternalDebugger): The internal debugger.
+        table (DwarfTypeTable): The types of the ELF file the variable belongs to.
+        variable (DwarfVariable): The variable.
+        pieces (list[tuple[int, int, int]] | None): The pieces of the location, as (kind, size, value), None if the
+        location cannot be evaluated.
+
+    Returns:
+        Any: The value of scalars as a Python object, a TypedValue for any other type, or None if the value is not
+        available.
+    """
+    if not pieces or not variable.type_offset:
+        return None
+
+    dwarf_type = table.type_at(variable.type_offset)
+    size = dwarf_type.size
+    if not size:
+        return None
+
+    memory = internal_debugger.memory
+
+    try:
+        # A value living entirely in memory is read in a single access
+        if len(pieces) == 1 and pieces[0][0] == PIECE_MEMORY:
+            address = pieces[0][2]
+            buffer = memory.read(address, size)
+            return _wrap(memory, table, dwarf_type, address, buffer)
+
+        buffer = bytearray()
+
+        for kind, piece_size, value in pieces:
+            piece_size = piece_size or size
+
+            if kind == PIECE_MEMORY:
+                buffer += memory.read(value, piece_size)
+            elif kind in (PIECE_REGISTER, PIECE_VALUE):
+                buffer += value.to_bytes(8, "little")[:piece_size].ljust(piece_size, b"\x00")
+            else:
+                buffer += bytes(piece_size)
+    except (OSError, ValueError):
+        return None
+
+    return _wrap(memory, table, dwarf_type, None, bytes(buffer[:size].ljust(size, b"\x00")))
+
+
+def _wrap(memory: Any, table: DwarfTypeTable, dwarf_type: DwarfType, address: int | None, buffer: bytes) -> Any:
+    """Returns a scalar as a Python value, or any other value as a proxy."""
+    if dwarf_type.resolved.kind in ("base", "enum"):
+        return decode_scalar(dwarf_type, buffer, 0)
+
+    return TypedValue(memory, table, dwarf_type, address, buffer)
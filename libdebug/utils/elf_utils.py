@@ -5,13 +5,18 @@
 #
 
 import functools
+import re
+from io import BytesIO
 from pathlib import Path
 
 import requests
 from elftools.elf.elffile import ELFFile
+from elftools.elf.enums import ENUM_RELOC_TYPE_x64
 
 from libdebug.cffi.debug_sym_cffi import ffi
 from libdebug.cffi.debug_sym_cffi import lib as lib_sym
+from libdebug.data.dwarf_function import CfaRule, DwarfFunction, DwarfFunctionTable, DwarfLocation, DwarfVariable
+from libdebug.data.dwarf_type import DwarfTypeTable
 from libdebug.liblog import liblog
 from libdebug.utils.libcontext import libcontext
 
@@ -59,21 +64,17 @@ def _debuginfod(buildid: str) -> Path:
     return debuginfod_path
 
 
-@functools.cache
-def _collect_external_info(path: str) -> dict[str, tuple[int, int]]:
-    """Returns a dictionary containing the symbols taken from the external debuginfo file.
+def _convert_symbols(head: "ffi.CData") -> dict[str, tuple[int, int]]:
+    """Converts a native list of symbols to a dictionary, and frees the list.
 
     Args:
-        path (str): The path to the ELF file.
+        head (ffi.CData): The head of the native list of symbols.
 
     Returns:
-        symbols (dict): A dictionary containing the symbols of the specified external debuginfo file.
+        symbols (dict): A dictionary mapping each symbol to its (start, end) address range.
     """
     symbols = {}
 
-    c_file_path = ffi.new("char[]", path.encode("utf-8"))
-    head = lib_sym.collect_external_symbols(c_file_path, libcontext.sym_lvl)
-
     if head != ffi.NULL:
         cursor = head
 
@@ -88,7 +89,27 @@ def _collect_external_info(path: str) -> dict[str, tuple[int, int]]:
 
 
 @functools.cache
-def _parse_elf_file(path: str, debug_info_level: int) -> tuple[dict[str, tuple[int, int]], str | None, str | None]:
+def _collect_external_info(path: str) -> tuple[dict[str, tuple[int, int]], bool]:
+    """Returns a dictionary containing the symbols taken from the external debuginfo file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        symbols (dict): A dictionary containing the symbols of the specified external debuginfo file.
+        indexed (bool): Whether the DWARF symbols are left to be looked up in the name index of the file.
+    """
+    c_file_path = ffi.new("char[]", path.encode("utf-8"))
+    symbols = _convert_symbols(lib_sym.collect_external_symbols(c_file_path, libcontext.sym_lvl))
+
+    return symbols, bool(lib_sym.get_dwarf_index())
+
+
+@functools.cache
+def _parse_elf_file(
+    path: str,
+    debug_info_level: int,
+) -> tuple[dict[str, tuple[int, int]], str | None, str | None, bool]:
     """Returns a dictionary containing the symbols of the specified ELF file and the buildid.
 
     Args:
@@ -99,32 +120,313 @@ def _parse_elf_file(path: str, debug_info_level: int) -> tuple[dict[str, tuple[i
         symbols (dict): A dictionary containing the symbols of the specified ELF file.
         buildid (str): The buildid of the specified ELF file.
         debug_file_path (str): The path to the external debuginfo file corresponding.
+        indexed (bool): Whether the DWARF symbols are left to be looked up in the name index of the file.
     """
-    symbols = {}
     buildid = None
     debug_file_path = None
 
     c_file_path = ffi.new("char[]", path.encode("utf-8"))
-    head = lib_sym.read_elf_info(c_file_path, debug_info_level)
+    symbols = _convert_symbols(lib_sym.read_elf_info(c_file_path, debug_info_level))
+    indexed = bool(lib_sym.get_dwarf_index())
+
+    if debug_info_level > 2:
+        buildid = lib_sym.get_build_id()
+        buildid = ffi.string(buildid).decode("utf-8") if buildid != ffi.NULL else None
+
+        debug_file_path = lib_sym.get_debug_file()
+        debug_file_path = ffi.string(debug_file_path).decode("utf-8") if debug_file_path != ffi.NULL else None
+
+    return symbols, buildid, debug_file_path, indexed
+
+
+@functools.cache
+def _lookup_dwarf_symbol(path: str, symbol: str) -> dict[str, tuple[int, int]]:
+    """Returns the DWARF symbols with the specified name, found through the name index of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+        symbol (str): The name of the symbol.
+
+    Returns:
+        symbols (dict): A dictionary containing the symbols found. Only if the index cannot be read, all the DWARF
+        symbols of the file.
+    """
+    c_file_path = ffi.new("char[]", path.encode("utf-8"))
+    c_symbol = ffi.new("char[]", symbol.encode("utf-8"))
+
+    return _convert_symbols(lib_sym.lookup_dwarf_symbol(c_file_path, c_symbol))
+
+
+@functools.cache
+def _collect_dwarf_symbols(path: str) -> dict[str, tuple[int, int]]:
+    """Returns all the DWARF symbols of the specified ELF file, walking every compilation unit.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        symbols (dict): A dictionary containing the DWARF symbols of the specified ELF file.
+    """
+    c_file_path = ffi.new("char[]", path.encode("utf-8"))
+
+    return _convert_symbols(lib_sym.collect_dwarf_symbols(c_file_path))
+
+
+def _find_symbol(path: str, symbols: dict[str, tuple[int, int]], indexed: bool, symbol: str) -> tuple[int, int] | None:
+    """Returns the address range of the specified symbol, looking it up in the name index of the file if needed.
+
+    Args:
+        path (str): The path to the ELF file.
+        symbols (dict): The symbols read from the file.
+        indexed (bool): Whether the DWARF symbols of the file are left to be looked up in its name index.
+        symbol (str): The symbol to find.
+
+    Returns:
+        tuple[int, int] | None: The (start, end) address range of the symbol, None if it is not found.
+    """
+    if symbol in symbols:
+        return symbols[symbol]
+
+    if indexed:
+        return _lookup_dwarf_symbol(path, symbol).get(symbol)
+
+    return None
+
+
+@functools.cache
+def _complete_symbols(path: str, sym_lvl: int | None = None) -> dict[str, tuple[int, int]]:
+    """Returns all the symbols of the file, walking its DWARF debug info if it was left to its name index.
+
+    Args:
+        path (str): The path to the ELF file.
+        sym_lvl (int | None): The symbol level the file is parsed with, None for an external debuginfo file.
+
+    Returns:
+        symbols (dict): A dictionary mapping each symbol to its (start, end) address range.
+    """
+    if sym_lvl is None:
+        symbols, indexed = _collect_external_info(path)
+    else:
+        symbols, _, _, indexed = _parse_elf_file(path, sym_lvl)
+
+    if not indexed:
+        return symbols
+
+    # The symbol tables take precedence, as when the DWARF symbols are read together with them
+    return {**_collect_dwarf_symbols(path), **symbols}
+
+
+@functools.cache
+def _collect_types(path: str) -> list[tuple]:
+    """Returns the records of the types described by the DWARF debug info of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        list[tuple]: The records of the types, in the order of the debug info.
+    """
+    records = []
+
+    c_file_path = ffi.new("char[]", path.encode("utf-8"))
+    head = lib_sym.collect_types(c_file_path)
 
     if head != ffi.NULL:
         cursor = head
 
         while cursor != ffi.NULL:
-            symbol_name = ffi.string(cursor.name).decode("utf-8")
-            symbols[symbol_name] = (cursor.low_pc, cursor.high_pc)
+            name = ffi.string(cursor.name).decode("utf-8") if cursor.name != ffi.NULL else None
+            records.append(
+                (
+                    cursor.offset,
+                    cursor.type,
+                    cursor.parent,
+                    name,
+                    cursor.size,
+                    cursor.value,
+                    cursor.tag,
+                    cursor.encoding,
+                    cursor.bit_size,
+                    cursor.bit_offset,
+                    bool(cursor.declaration),
+                ),
+            )
             cursor = cursor.next
 
-        lib_sym.free_symbol_info(head)
+        lib_sym.free_type_info(head)
 
-    if debug_info_level > 2:
-        buildid = lib_sym.get_build_id()
-        buildid = ffi.string(buildid).decode("utf-8") if buildid != ffi.NULL else None
+    return records
 
-        debug_file_path = lib_sym.get_debug_file()
-        debug_file_path = ffi.string(debug_file_path).decode("utf-8") if debug_file_path != ffi.NULL else None
 
-    return symbols, buildid, debug_file_path
+@functools.cache
+def get_type_table(path: str) -> DwarfTypeTable:
+    """Returns the types described by the DWARF debug info of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        DwarfTypeTable: The types of the specified ELF file, or of its external debuginfo file.
+    """
+    if libcontext.sym_lvl == 0:
+        raise Exception(
+            "Symbol resolution is disabled. Please enable it by setting the sym_lvl libcontext parameter to a value greater than 0.",
+        )
+
+    records = _collect_types(path)
+    if records:
+        return DwarfTypeTable(records)
+
+    _, buildid, debug_file, _ = _parse_elf_file(path, libcontext.sym_lvl)
+
+    # Retrieve the types from the external debuginfo file
+    if buildid and debug_file and libcontext.sym_lvl > 2:
+        folder = buildid[:2]
+        records = _collect_types(str((LOCAL_DEBUG_PATH / folder / debug_file).resolve()))
+        if records:
+            return DwarfTypeTable(records)
+
+    # Retrieve the types from debuginfod
+    if buildid and libcontext.sym_lvl > 4:
+        absolute_debug_path = _debuginfod(buildid)
+        if absolute_debug_path.exists():
+            records = _collect_types(str(absolute_debug_path))
+
+    return DwarfTypeTable(records)
+
+
+def _convert_locations(cursor: "ffi.CData") -> tuple[DwarfLocation, ...]:
+    """Converts a native list of location expressions."""
+    locations = []
+
+    while cursor != ffi.NULL:
+        ops = tuple((op.atom, op.op1, op.op2, op.offset) for op in cursor.ops[0 : cursor.op_count])
+        locations.append(DwarfLocation(cursor.low_pc, cursor.high_pc, ops))
+        cursor = cursor.next
+
+    return tuple(locations)
+
+
+@functools.cache
+def _collect_functions(path: str) -> list[DwarfFunction]:
+    """Returns the functions described by the DWARF debug info of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        list[DwarfFunction]: The functions, with their parameters and variables.
+    """
+    functions = []
+
+    c_file_path = ffi.new("char[]", path.encode("utf-8"))
+    head = lib_sym.collect_functions(c_file_path)
+
+    if head != ffi.NULL:
+        cursor = head
+
+        while cursor != ffi.NULL:
+            variables = []
+            variable = cursor.variables
+
+            while variable != ffi.NULL:
+                variables.append(
+                    DwarfVariable(
+                        ffi.string(variable.name).decode("utf-8"),
+                        variable.type,
+                        variable.low_pc,
+                        variable.high_pc,
+                        bool(variable.is_parameter),
+                        _convert_locations(variable.locations),
+                    ),
+                )
+                variable = variable.next
+
+            # The native list is built in reverse declaration order
+            variables.reverse()
+
+            name = ffi.string(cursor.name).decode("utf-8") if cursor.name != ffi.NULL else "??"
+            functions.append(
+                DwarfFunction(
+                    name,
+                    cursor.low_pc,
+                    cursor.high_pc,
+                    _convert_locations(cursor.frame_base),
+                    tuple(variables),
+                ),
+            )
+            cursor = cursor.next
+
+        lib_sym.free_function_info(head)
+
+    return functions
+
+
+@functools.cache
+def _collect_cfa_rules(path: str) -> list[CfaRule]:
+    """Returns the rules of the canonical frame address of the call frames of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        list[CfaRule]: The rules, as found in the call frame information.
+    """
+    rules = []
+
+    c_file_path = ffi.new("char[]", path.encode("utf-8"))
+    head = lib_sym.collect_cfa_rules(c_file_path)
+
+    if head != ffi.NULL:
+        cursor = head
+
+        while cursor != ffi.NULL:
+            rules.append(CfaRule(cursor.low_pc, cursor.high_pc, cursor.reg, cursor.offset))
+            cursor = cursor.next
+
+        lib_sym.free_cfa_info(head)
+
+    return rules
+
+
+@functools.cache
+def get_function_table(path: str) -> DwarfFunctionTable:
+    """Returns the functions described by the DWARF debug info of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        DwarfFunctionTable: The functions of the specified ELF file, or of its external debuginfo file.
+    """
+    if libcontext.sym_lvl == 0:
+        raise Exception(
+            "Symbol resolution is disabled. Please enable it by setting the sym_lvl libcontext parameter to a value greater than 0.",
+        )
+
+    # The call frame information is always loaded, even when the debug info is stripped
+    cfa_rules = _collect_cfa_rules(path)
+
+    functions = _collect_functions(path)
+    if functions:
+        return DwarfFunctionTable(functions, cfa_rules)
+
+    _, buildid, debug_file, _ = _parse_elf_file(path, libcontext.sym_lvl)
+
+    # Retrieve the functions from the external debuginfo file
+    if buildid and debug_file and libcontext.sym_lvl > 2:
+        folder = buildid[:2]
+        functions = _collect_functions(str((LOCAL_DEBUG_PATH / folder / debug_file).resolve()))
+        if functions:
+            return DwarfFunctionTable(functions, cfa_rules)
+
+    # Retrieve the functions from debuginfod
+    if buildid and libcontext.sym_lvl > 4:
+        absolute_debug_path = _debuginfod(buildid)
+        if absolute_debug_path.exists():
+            functions = _collect_functions(str(absolute_debug_path))
+
+    return DwarfFunctionTable(functions, cfa_rules)
 
 
 @functools.cache
@@ -143,31 +445,48 @@ def resolve_symbol(path: str, symbol: str) -> int:
             "Symbol resolution is disabled. Please enable it by setting the sym_lvl libcontext parameter to a value greater than 0.",
         )
 
-    # Retrieve the symbols from the SymbolTableSection
-    symbols, buildid, debug_file = _parse_elf_file(path, libcontext.sym_lvl)
-    if symbol in symbols:
-        return symbols[symbol][0]
+    # Retrieve the symbols from the SymbolTableSection, or from the name index of the DWARF debug info
+    symbols, buildid, debug_file, indexed = _parse_elf_file(path, libcontext.sym_lvl)
+    if found := _find_symbol(path, symbols, indexed, symbol):
+        return found[0]
 
     # Retrieve the symbols from the external debuginfo file
     if buildid and debug_file and libcontext.sym_lvl > 2:
         folder = buildid[:2]
         absolute_debug_path_str = str((LOCAL_DEBUG_PATH / folder / debug_file).resolve())
-        symbols = _collect_external_info(absolute_debug_path_str)
-        if symbol in symbols:
-            return symbols[symbol][0]
+        symbols, indexed = _collect_external_info(absolute_debug_path_str)
+        if found := _find_symbol(absolute_debug_path_str, symbols, indexed, symbol):
+            return found[0]
 
     # Retrieve the symbols from debuginfod
     if buildid and libcontext.sym_lvl > 4:
         absolute_debug_path = _debuginfod(buildid)
         if absolute_debug_path.exists():
-            symbols = _collect_external_info(str(absolute_debug_path))
-            if symbol in symbols:
-                return symbols[symbol][0]
+            symbols, indexed = _collect_external_info(str(absolute_debug_path))
+            if found := _find_symbol(str(absolute_debug_path), symbols, indexed, symbol):
+                return found[0]
 
     # Symbol not found
     raise ValueError(f"Symbol {symbol} not found in {path}. Please specify a valid symbol.")
 
 
+def get_symbols(path: str) -> dict[str, tuple[int, int]]:
+    """Returns the symbols of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        dict: A dictionary mapping each symbol to its (start, end) address range.
+    """
+    if libcontext.sym_lvl == 0:
+        raise Exception(
+            "Symbol resolution is disabled. Please enable it by setting the sym_lvl libcontext parameter to a value greater than 0.",
+        )
+
+    return _complete_symbols(path, libcontext.sym_lvl)
+
+
 @functools.cache
 def resolve_address(path: str, address: int) -> str:
     """Returns the symbol corresponding to the specified address in the specified ELF file.
@@ -183,7 +502,8 @@ def resolve_address(path: str, address: int) -> str:
         return hex(address)
 
     # Retrieve the symbols from the SymbolTableSection
-    symbols, buildid, debug_file = _parse_elf_file(path, libcontext.sym_lvl)
+    _, buildid, debug_file, _ = _parse_elf_file(path, libcontext.sym_lvl)
+    symbols = _complete_symbols(path, libcontext.sym_lvl)
     for symbol, (symbol_start, symbol_end) in symbols.items():
         if symbol_start <= address < symbol_end:
             return f"{symbol}+{address-symbol_start:x}"
@@ -192,7 +512,7 @@ def resolve_address(path: str, address: int) -> str:
     if buildid and debug_file and libcontext.sym_lvl > 2:
         folder = buildid[:2]
         absolute_debug_path_str = str((LOCAL_DEBUG_PATH / folder / debug_file).resolve())
-        symbols = _collect_external_info(absolute_debug_path_str)
+        symbols = _complete_symbols(absolute_debug_path_str)
         for symbol, (symbol_start, symbol_end) in symbols.items():
             if symbol_start <= address < symbol_end:
                 return f"{symbol}+{address-symbol_start:x}"
@@ -201,7 +521,7 @@ def resolve_address(path: str, address: int) -> str:
     if buildid and libcontext.sym_lvl > 4:
         absolute_debug_path = _debuginfod(buildid)
         if absolute_debug_path.exists():
-            symbols = _collect_external_info(str(absolute_debug_path))
+            symbols = _complete_symbols(str(absolute_debug_path))
             for symbol, (symbol_start, symbol_end) in symbols.items():
                 if symbol_start <= address < symbol_end:
                     return f"{symbol}+{address-symbol_start:x}"
@@ -230,6 +550,143 @@ def parse_elf_characteristics(path: str) -> tuple[bool, int, str]:
     return pie, entry_point, arch
 
 
+@functools.cache
+def get_plt_entries(path: str) -> dict[str, int]:
+    """Returns the PLT entries of the specified ELF file.
+
+    Args:
+        path (str): The path to the ELF file.
+
+    Returns:
+        dict: A dictionary mapping each imported symbol to the address of its PLT entry.
+    """
+    entries = {}
+
+    with Path(path).open("rb") as elf_file:
+        elf = ELFFile(elf_file)
+
+        relocations = elf.get_section_by_name(".rela.plt")
+
+        # With IBT, the stubs called by the code live in a separate section, without the resolver stub
+        plt = elf.get_section_by_name(".plt.sec")
+
+        if plt is not None:
+            first_entry = plt["sh_addr"]
+        elif (plt := elf.get_section_by_name(".plt")) is not None:
+            first_entry = plt["sh_addr"] + (32 if elf.get_machine_arch() == "AArch64" else 16)
+
+        if relocations is not None and plt is not None:
+            symbols = elf.get_section(relocations["sh_link"])
+            entry_size = plt["sh_entsize"] or 16
+
+            # PLT entries are laid out in the same order as their relocations
+            for index, relocation in enumerate(relocations.iter_relocations()):
+                symbol = symbols.get_symbol(relocation["r_info_sym"])
+
+                if symbol.name:
+                    entries[symbol.name] = first_entry + index * entry_size
+
+        if elf.get_machine_arch() == "x64":
+            entries.update(_get_plt_got_entries(elf, entries))
+
+    return entries
+
+
+def _get_plt_got_entries(elf: ELFFile, plt_entries: dict[str, int]) -> dict[str, int]:
+    """Returns the entries of the .plt.got section, used for the functions whose address is also taken.
+
+    Args:
+        elf (ELFFile): The ELF file.
+        plt_entries (dict[str, int]): The entries already found in the PLT, which take precedence.
+
+    Returns:
+        dict: A dictionary mapping each imported symbol to the address of its entry.
+    """
+    entries = {}
+
+    plt_got = elf.get_section_by_name(".plt.got")
+    relocations = elf.get_section_by_name(".rela.dyn")
+
+    if plt_got is None or relocations is None:
+        return entries
+
+    # The stubs jump through the GOT slots that the GLOB_DAT relocations fill with the address of the symbol
+    symbols = elf.get_section(relocations["sh_link"])
+    slots = {}
+
+    for relocation in relocations.iter_relocations():
+        if relocation["r_info_type"] != ENUM_RELOC_TYPE_x64["R_X86_64_GLOB_DAT"]:
+            continue
+
+        symbol = symbols.get_symbol(relocation["r_info_sym"])
+
+        if symbol.name and symbol.name not in plt_entries:
+            slots[relocation["r_offset"]] = symbol.name
+
+    # Each stub is a jmp *slot(%rip), preceded by an endbr64 with IBT
+    entry_size = plt_got["sh_entsize"] or (16 if elf.get_section_by_name(".plt.sec") is not None else 8)
+    data = plt_got.data()
+
+    for offset in range(0, len(data) - entry_size + 1, entry_size):
+        jump = data.find(b"\xff\x25", offset, offset + entry_size)
+
+        if jump < 0 or jump + 6 > offset + entry_size:
+            continue
+
+        slot = plt_got["sh_addr"] + jump + 6 + int.from_bytes(data[jump + 2 : jump + 6], "little", signed=True)
+
+        if slot in slots:
+            entries[slots[slot]] = plt_got["sh_addr"] + offset
+
+    return entries
+
+
+def get_image_dynamic_symbols(image: bytes) -> dict[str, tuple[int, int]]:
+    """Returns the dynamic symbols of an ELF image loaded in memory, e.g., the vDSO.
+
+    Args:
+        image (bytes): The content of the memory the image is loaded in, from its ELF header.
+
+    Returns:
+        dict: A dictionary mapping each symbol to its offset from the start of the image and its size.
+    """
+    symbols = {}
+
+    elf = ELFFile(BytesIO(image))
+
+    base = min(
+        (segment["p_vaddr"] for segment in elf.iter_segments() if segment["p_type"] == "PT_LOAD"),
+        default=0,
+    )
+
+    dynsym = elf.get_section_by_name(".dynsym")
+
+    if dynsym is None:
+        return symbols
+
+    for symbol in dynsym.iter_symbols():
+        if symbol.name and symbol["st_value"]:
+            symbols[symbol.name] = (symbol["st_value"] - base, symbol["st_size"])
+
+    return symbols
+
+
+@functools.cache
+def get_glibc_version(path: str) -> tuple[int, int] | None:
+    """Returns the version of the specified glibc shared object.
+
+    Args:
+        path (str): The path to the glibc shared object.
+
+    Returns:
+        tuple[int, int] | None: The major and minor version of glibc, None if the file is not glibc.
+    """
+    with Path(path).open("rb") as elf_file:
+        match = re.search(rb"release version (\d+)\.(\d+)", elf_file.read())
+
+    return (int(match.group(1)), int(match.group(2))) if match else None
+
+
 def is_pie(path: str) -> bool:
     """Returns True if the specified ELF file is position independent, False otherwise.
 
@@ -0,0 +1,147 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+from signal import Signals
+
+# The registers of the "g" packet, in the order and with the size (in bytes) GDB expects for each architecture
+# The registers GDB numbers after these, e.g. the floating-point ones, are reported as unavailable
+GDB_REGISTERS = {
+    "amd64": [
+        *(
+            (name, 8)
+            for name in (
+                "rax",
+                "rbx",
+                "rcx",
+                "rdx",
+                "rsi",
+                "rdi",
+                "rbp",
+                "rsp",
+                "r8",
+                "r9",
+                "r10",
+                "r11",
+                "r12",
+                "r13",
+                "r14",
+                "r15",
+                "rip",
+            )
+        ),
+        *((name, 4) for name in ("eflags", "cs", "ss", "ds", "es", "fs", "gs")),
+    ],
+    "aarch64": [
+        *((f"x{i}", 8) for i in range(31)),
+        ("sp", 8),
+        ("pc", 8),
+        ("pstate", 4),
+    ],
+}
+
+# The signals whose number in the protocol differs from the Linux one
+_GDB_SIGNALS = {
+    Signals.SIGBUS: 10,
+    Signals.SIGUSR1: 30,
+    Signals.SIGUSR2: 31,
+    Signals.SIGCHLD: 20,
+    Signals.SIGCONT: 19,
+    Signals.SIGSTOP: 17,
+    Signals.SIGTSTP: 18,
+    Signals.SIGURG: 16,
+    Signals.SIGIO: 23,
+    Signals.SIGPWR: 32,
+    Signals.SIGSYS: 12,
+}
+
+_LINUX_SIGNALS = {value: key for key, value in _GDB_SIGNALS.items()}
+
+
+def to_gdb_signal(signal_number: int) -> int:
+    """Converts a Linux signal number to the one used by the GDB remote protocol."""
+    return _GDB_SIGNALS.get(signal_number, signal_number)
+
+
+def from_gdb_signal(signal_number: int) -> int:
+    """Converts a signal number of the GDB remote protocol to the Linux one."""
+    return int(_LINUX_SIGNALS.get(signal_number, signal_number))
+
+
+def checksum(payload: bytes) -> int:
+    """Returns the checksum of the payload of a packet."""
+    return sum(payload) & 0xFF
+
+
+def frame_packet(payload: bytes) -> bytes:
+    """Frames the payload of a packet, i.e., $payload#checksum, escaping the reserved characters."""
+    escaped = bytearray()
+
+    for byte in payload:
+        if byte in b"#$}*":
+            escaped += bytes((0x7D, byte ^ 0x20))
+        else:
+            escaped.append(byte)
+
+    return b"$" + escaped + b"#" + f"{checksum(escaped):02x}".encode()
+
+
+def unescape_binary(data: bytes) -> bytes:
+    """Unescapes the binary data of a packet, e.g., the one of an X packet."""
+    unescaped = bytearray()
+    escape = False
+
+    for byte in data:
+        if escape:
+            unescaped.append(byte ^ 0x20)
+            escape = False
+        elif byte == 0x7D:
+            escape = True
+        else:
+            unescaped.append(byte)
+
+    return bytes(unescaped)
+
+
+def parse_packets(buffer: bytearray) -> list[bytes | int | None]:
+    """Extracts the complete packets from the received data, removing them from the buffer.
+
+    Args:
+        buffer (bytearray): The data received from the client.
+
+    Returns:
+        list[bytes | int | None]: The payloads of the packets with a valid checksum, None for the corrupted ones,
+        and the out-of-band bytes, i.e., 0x03 for an interrupt request, as integers. The acknowledgments are dropped.
+    """
+    packets = []
+
+    while buffer:
+        if buffer[0] == 0x03:
+            packets.append(0x03)
+            del buffer[0]
+        elif buffer[0] != ord("$"):
+            # Acknowledgments and noise
+            del buffer[0]
+        else:
+            end = buffer.find(b"#")
+
+            if end == -1 or len(buffer) < end + 3:
+                # The packet is not complete yet
+                break
+
+            payload = bytes(buffer[1:end])
+            expected = buffer[end + 1 : end + 3]
+            del buffer[: end + 3]
+
+            try:
+                valid = int(expected, 16) == checksum(payload)
+            except ValueError:
+                valid = False
+
+            packets.append(payload if valid else None)
+
+    return packets
@@ -0,0 +1,95 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import os
+from pathlib import Path
+
+from libdebug.data.latency_mode import LatencyMode
+
+LATENCY_POLICIES = ("same-core", "sibling-core")
+
+CPU_TOPOLOGY_PATH = "/sys/devices/system/cpu/cpu{}/topology/{}"
+
+
+def parse_cpu_list(cpu_list: str) -> list[int]:
+    """Parses a list of CPUs in the format of sysfs, e.g., "0-3,8"."""
+    cpus = []
+
+    for entry in cpu_list.strip().split(","):
+        if not entry:
+            continue
+
+        first, _, last = entry.partition("-")
+        cpus.extend(range(int(first), int(last or first) + 1))
+
+    return cpus
+
+
+def _topology_siblings(cpu: int, name: str) -> list[int]:
+    """Returns the CPUs listed in a topology file of the CPU, empty if it is not available."""
+    try:
+        return parse_cpu_list(Path(CPU_TOPOLOGY_PATH.format(cpu, name)).read_text())
+    except (OSError, ValueError):
+        return []
+
+
+def resolve_latency_mode(policy: str, cpu: int | None, spin_time: float, allowed: set[int]) -> LatencyMode:
+    """Chooses the CPUs of the debugger and of the process for a latency policy.
+
+    Args:
+        policy (str): The policy, either "same-core" or "sibling-core".
+        cpu (int | None): The CPU of the polling thread, None for the first allowed one.
+        spin_time (float): The seconds spent polling for a stop before sleeping.
+        allowed (set[int]): The CPUs the debugger is allowed to run on.
+
+    Returns:
+        LatencyMode: The resolved placement.
+    """
+    if policy not in LATENCY_POLICIES:
+        raise ValueError(f"Invalid latency policy {policy!r}, expected one of {', '.join(LATENCY_POLICIES)}.")
+
+    if spin_time < 0:
+        raise ValueError("The spin time cannot be negative.")
+
+    tracer_cpu = min(allowed) if cpu is None else cpu
+    if tracer_cpu not in allowed:
+        raise ValueError(f"The debugger is not allowed to run on CPU {tracer_cpu}.")
+
+    if policy == "same-core":
+        return LatencyMode(policy, tracer_cpu, tracer_cpu, spin_time)
+
+    # The hyperthreads of the same core share the caches, then the cores of the same package share the last level
+    for name in ("thread_siblings_list", "package_cpus_list", "core_siblings_list"):
+        siblings = [sibling for sibling in _topology_siblings(tracer_cpu, name) if sibling != tracer_cpu]
+        siblings = [sibling for sibling in siblings if sibling in allowed]
+
+        if siblings:
+            return LatencyMode(policy, tracer_cpu, siblings[0], spin_time)
+
+    others = sorted(allowed - {tracer_cpu})
+    if not others:
+        raise ValueError("The sibling-core policy needs at least two CPUs.")
+
+    return LatencyMode(policy, tracer_cpu, others[0], spin_time)
+
+
+def pin_process(process_id: int, cpus: set[int]) -> None:
+    """Sets the CPUs of all the threads of a process."""
+    tasks = Path(f"/proc/{process_id}/task")
+
+    try:
+        thread_ids = [int(task.name) for task in tasks.iterdir()]
+    except OSError:
+        thread_ids = [process_id]
+
+    for thread_id in thread_ids:
+        try:
+            os.sched_setaffinity(thread_id, cpus)
+        except ProcessLookupError:
+            # The thread exited in the meantime
+            continue
@@ -0,0 +1,103 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+from __future__ import annotations
+
+import gzip
+import time
+
+
+def _varint(value: int) -> bytes:
+    """Encodes an unsigned protobuf varint."""
+    encoded = bytearray()
+
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+
+        if value:
+            encoded.append(byte | 0x80)
+        else:
+            encoded.append(byte)
+            return bytes(encoded)
+
+
+def _field_varint(number: int, value: int) -> bytes:
+    """Encodes a varint field."""
+    return _varint(number << 3) + _varint(value)
+
+
+def _field_bytes(number: int, value: bytes) -> bytes:
+    """Encodes a length-delimited field."""
+    return _varint((number << 3) | 2) + _varint(len(value)) + value
+
+
+def _field_packed(number: int, values: list[int]) -> bytes:
+    """Encodes a packed repeated varint field."""
+    return _field_bytes(number, b"".join(_varint(value) for value in values))
+
+
+def encode_pprof(samples: list[tuple[list[int], list[str], int, int]], period: int) -> bytes:
+    """Encodes stack samples in the gzipped protobuf format of pprof.
+
+    Args:
+        samples (list[tuple[list[int], list[str], int, int]]): The samples. Each sample is made of the addresses of
+        the frames, the names of their functions (both innermost first), the thread ID and the sample count.
+        period (int): The sampling period, in nanoseconds.
+
+    Returns:
+        bytes: The encoded profile.
+    """
+    strings = {"": 0}
+
+    def string_index(value: str) -> int:
+        return strings.setdefault(value, len(strings))
+
+    locations = {}
+    functions = {}
+    profile = bytearray()
+
+    sample_type = _field_varint(1, string_index("samples")) + _field_varint(2, string_index("count"))
+    profile += _field_bytes(1, sample_type)
+    sample_type = _field_varint(1, string_index("cpu")) + _field_varint(2, string_index("nanoseconds"))
+    profile += _field_bytes(1, sample_type)
+
+    thread_key = string_index("thread_id")
+
+    for addresses, names, thread_id, count in samples:
+        location_ids = []
+
+        for address, name in zip(addresses, names, strict=True):
+            if address not in locations:
+                function_id = functions.setdefault(name, len(functions) + 1)
+                locations[address] = (len(locations) + 1, function_id)
+
+            location_ids.append(locations[address][0])
+
+        sample = _field_packed(1, location_ids) + _field_packed(2, [count, count * period])
+        sample += _field_bytes(3, _field_varint(1, thread_key) + _field_varint(3, thread_id))
+        profile += _field_bytes(2, sample)
+
+    for address, (location_id, function_id) in locations.items():
+        line = _field_varint(1, function_id)
+        location = _field_varint(1, location_id) + _field_varint(3, address) + _field_bytes(4, line)
+        profile += _field_bytes(4, location)
+
+    for name, function_id in functions.items():
+        name_index = string_index(name)
+        function = _field_varint(1, function_id) + _field_varint(2, name_index) + _field_varint(3, name_index)
+        profile += _field_bytes(5, function)
+
+    period_type = _field_varint(1, string_index("cpu")) + _field_varint(2, string_index("nanoseconds"))
+
+    for value in strings:
+        profile += _field_bytes(6, value.encode())
+
+    profile += _field_varint(9, time.time_ns())
+    profile += _field_bytes(11, period_type)
+    profile += _field_varint(12, period)
+
+    return gzip.compress(bytes(profile))
@@ -41,10 +41,34 @@ def get_open_fds(process_id: int) -> list[int]:
     return [int(fd) for fd in os.listdir(f"/proc/{process_id}/fd")]
 
 
-def invalidate_process_cache() -> None:
-    """Invalidates the cache of the functions in this module. Must be executed any time the process executes code."""
-    get_process_maps.cache_clear()
+@functools.cache
+def get_fd_target(process_id: int, fd: int) -> str | None:
+    """Returns the target of a file descriptor of the specified process.
+
+    Args:
+        process_id (int): The PID of the process.
+        fd (int): The file descriptor.
+
+    Returns:
+        str | None: The target of the file descriptor, as in /proc/pid/fd, None if it is not open.
+    """
+    try:
+        return os.readlink(f"/proc/{process_id}/fd/{fd}")
+    except FileNotFoundError:
+        return None
+
+
+def invalidate_process_cache(maps: bool = True) -> None:
+    """Invalidates the cache of the functions in this module. Must be executed any time the process executes code.
+
+    Args:
+        maps (bool, optional): Whether the memory maps are invalidated as well. Defaults to True.
+    """
+    if maps:
+        get_process_maps.cache_clear()
+
     get_open_fds.cache_clear()
+    get_fd_target.cache_clear()
 
 
 def disable_self_aslr() -> None:
@@ -5,8 +5,10 @@
 #
 
 import os
+import runpy
+from pathlib import Path
 
-from setuptools import find_packages, setup
+from setuptools import Command, find_packages, setup
 
 try:
     from setuptools.command.build import build
@@ -35,19 +37,21 @@ if not os.path.isfile("/usr/include/libelf.h"):
     print("Required C libraries not found. Please install libelf-dev or elfutils")
     exit(1)
 
-if os.path.isfile("/usr/include/libdwarf/dwarf.h") and os.path.isfile(
-    "/usr/include/libdwarf/libdwarf.h"
-):
-    debug_sym_cffi = "debug_sym_cffi_build_legacy"
-elif (
-    os.path.isfile("/usr/include/libdwarf/libdwarf-0/dwarf.h")
-    and os.path.isfile("/usr/include/libdwarf/libdwarf-0/libdwarf.h")
-) or (
-    os.path.isfile("/usr/include/libdwarf-0/dwarf.h")
-    and os.path.isfile("/usr/include/libdwarf-0/libdwarf.h")
+# The source of the reader of the symbols for the installed headers is chosen by libdebug/core/build_core.py
+if not (
+    (
+        os.path.isfile("/usr/include/libdwarf/dwarf.h")
+        and os.path.isfile("/usr/include/libdwarf/libdwarf.h")
+    )
+    or (
+        os.path.isfile("/usr/include/libdwarf/libdwarf-0/dwarf.h")
+        and os.path.isfile("/usr/include/libdwarf/libdwarf-0/libdwarf.h")
+    )
+    or (
+        os.path.isfile("/usr/include/libdwarf-0/dwarf.h")
+        and os.path.isfile("/usr/include/libdwarf-0/libdwarf.h")
+    )
 ):
-    debug_sym_cffi = "debug_sym_cffi_build"
-else:
     print(
         "Required C libraries not found. Please install libdwarf-dev or libdwarf-devel"
     )
@@ -67,6 +71,23 @@ class JumpstartBuildCommand(build):
         return outputs
 
 
+class CoreBuildCommand(Command):
+    description = "build libdebug-core, the native core as a standalone C library, and its benchmarks"
+    user_options = [("build-dir=", None, "the directory of the outputs")]
+
+    def initialize_options(self):
+        self.build_dir = "build/libdebug-core"
+
+    def finalize_options(self):
+        pass
+
+    def run(self):
+        # The script is run by path, since the package cannot be imported before its cffi modules are built
+        build_core = runpy.run_path("./libdebug/core/build_core.py")["build"]
+
+        build_core(Path(self.build_dir))
+
+
 setup(
     name="libdebug",
     version="0.6.0",
@@ -78,12 +99,13 @@ setup(
     cffi_modules=[
         "./libdebug/cffi/ptrace_cffi_build.py:ffibuilder",
         "./libdebug/cffi/personality_cffi_build.py:ffibuilder",
-        f"./libdebug/cffi/{debug_sym_cffi}.py:ffibuilder",
+        "./libdebug/cffi/debug_sym_cffi_build.py:ffibuilder",
     ],
-    cmdclass={"build": JumpstartBuildCommand},
+    cmdclass={"build": JumpstartBuildCommand, "build_core": CoreBuildCommand},
     package_data={
         "libdebug.ptrace.jumpstart": ["jumpstart", "jumpstart.c"],
-        "libdebug.cffi": ["*.c"],
+        "libdebug.cffi": ["*.c", "*.h"],
+        "libdebug.core": ["*.c", "*.h", "libdebug-core.so"],
         "libdebug": ["py.typed"],
     },
     include_package_data=True,
@@ -111,6 +111,37 @@ class BasicTest(unittest.TestCase):
         d.kill()
         d.terminate()
 
+    def test_registers_round_trip(self):
+        d = debugger("binaries/basic_test")
+        d.run()
+
+        bp = d.breakpoint("register_test")
+
+        d.cont()
+
+        assert d.regs.pc == bp.address
+
+        # The callee-saved registers are only stored by the first instruction
+        d.regs.x28 = 0x1122334455667788
+        d.regs.x27 = 0xFFFFFFFFFFFFFFFF
+        d.regs.w27 = 0x99AABBCC
+
+        # The accessors share their memory with the register file
+        assert d.regs.register_file.x28 == 0x1122334455667788
+        assert d.regs.register_file.x27 == 0x99AABBCC
+
+        # The values reach the process, and are read back after the step
+        d.step()
+
+        assert d.regs.pc == bp.address + 4
+        assert d.regs.x28 == 0x1122334455667788
+        assert d.regs.w28 == 0x55667788
+        assert d.regs.x27 == 0x99AABBCC
+        assert d.regs.w27 == 0x99AABBCC
+
+        d.kill()
+        d.terminate()
+
     def test_step(self):
         d = debugger("binaries/basic_test")
 
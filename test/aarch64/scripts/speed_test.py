@@ -55,3 +55,28 @@ class SpeedTest(unittest.TestCase):
         end_time = perf_counter_ns()
 
         self.assertTrue((end_time - start_time) < 15 * 1e9)  # 15 seconds
+
+    def test_speed_registers(self):
+        d = self.d
+
+        d.run()
+
+        bp = d.breakpoint("do_nothing")
+
+        d.cont()
+
+        self.assertTrue(bp.address == d.regs.pc)
+
+        start_time = perf_counter_ns()
+
+        for i in range(65536):
+            d.regs.x0 = i
+            self.assertTrue(d.regs.x0 == i)
+            d.regs.w0 = i
+            self.assertTrue(d.regs.w0 == i)
+
+        end_time = perf_counter_ns()
+
+        d.kill()
+
+        self.assertTrue((end_time - start_time) < 1 * 1e9)  # 1 second, about 4 us per access
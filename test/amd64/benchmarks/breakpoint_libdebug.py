@@ -6,6 +6,8 @@
 
 from time import perf_counter
 import pickle
+import statistics
+import sys
 from libdebug import debugger
 
 
@@ -49,14 +51,24 @@ results = []
 # Initialize the debugger
 d = debugger("../binaries/math_loop_test")
 
+# Optionally pin the debugger and the process, e.g., python breakpoint_libdebug.py sibling-core 0.0001
+if len(sys.argv) > 1:
+    mode = d.set_latency_mode(sys.argv[1], spin_time=float(sys.argv[2]) if len(sys.argv) > 2 else 0.0)
+    print("Latency mode:", mode)
+
 for _ in range(1000):
     test()
 
 # Terminate the debugger
 d.terminate()
 
+# Summarize the distribution, the tail is the part affected by the latency mode
+quantiles = statistics.quantiles(results, n=100)
+print(f"median: {statistics.median(results):.6f} s, p90: {quantiles[89]:.6f} s, p99: {quantiles[98]:.6f} s")
+
 # Save the result in a pickle file
-with open("breakpoint_libdebug.pkl", "wb") as f:
+suffix = f"_{sys.argv[1]}" if len(sys.argv) > 1 else ""
+with open(f"breakpoint_libdebug{suffix}.pkl", "wb") as f:
     pickle.dump(results, f)
 
 # print("Results:", results)  
\ No newline at end of file
@@ -16,26 +16,48 @@ from scripts.basic_test import BasicPieTest, BasicTest, ControlFlowTest, HwBasic
 from scripts.breakpoint_test import BreakpointTest
 from scripts.brute_test import BruteTest
 from scripts.builtin_handler_test import AntidebugEscapingTest
+from scripts.call_test import CallTest
 from scripts.callback_test import CallbackTest
 from scripts.catch_signal_test import SignalCatchTest
+from scripts.core_library_test import CoreLibraryTest
 from scripts.death_test import DeathTest
 from scripts.deep_dive_division_test import DeepDiveDivision
+from scripts.dwarf_index_test import DwarfIndexTest
+from scripts.dwarf_locals_test import DwarfLocalsTest
+from scripts.execution_budget_test import ExecutionBudgetTest
+from scripts.fd_table_test import FdTableTest
 from scripts.finish_test import FinishTest
 from scripts.floating_point_test import FloatingPointTest
+from scripts.function_trace_test import FunctionTraceTest
+from scripts.gdb_server_test import GdbServerTest
+from scripts.glibc_heap_test import GlibcHeapTest
 from scripts.handle_syscall_test import HandleSyscallTest
+from scripts.heap_tracker_test import HeapTrackerTest
 from scripts.hijack_syscall_test import SyscallHijackTest
+from scripts.internal_debugger_registry_test import InternalDebuggerRegistryTest
 from scripts.jumpout_test import Jumpout
 from scripts.jumpstart_test import JumpstartTest
 from scripts.large_binary_sym_test import LargeBinarySymTest
+from scripts.latency_mode_test import LatencyModeTest
+from scripts.lockstep_test import LockstepTest
 from scripts.memory_test import MemoryTest
 from scripts.memory_fast_test import MemoryFastTest
 from scripts.multiple_debuggers_test import MultipleDebuggersTest
+from scripts.native_callback_test import NativeCallbackTest
 from scripts.next_test import NextTest
 from scripts.nlinks_test import Nlinks
 from scripts.pprint_syscalls_test import PPrintSyscallsTest
+from scripts.profiler_test import ProfilerTest
+from scripts.python_frames_test import PythonFramesTest
+from scripts.return_address_test import ReturnAddressTest
 from scripts.signals_multithread_test import SignalMultithreadTest
 from scripts.speed_test import SpeedTest
+from scripts.syscall_injection_test import SyscallInjectionTest
+from scripts.syscall_profile_test import SyscallProfileTest
+from scripts.thread_breakpoint_test import ThreadBreakpointTest
 from scripts.thread_test import ComplexThreadTest, ThreadTest
+from scripts.typed_memory_test import TypedMemoryTest
+from scripts.virtual_time_test import VirtualTimeTest
 from scripts.vmwhere1_test import Vmwhere1
 from scripts.waiting_test import WaitingNlinks, WaitingTest
 from scripts.watchpoint_alias_test import WatchpointAliasTest
@@ -46,6 +68,7 @@ def fast_suite():
     suite = unittest.TestSuite()
     suite.addTest(BasicTest("test_basic"))
     suite.addTest(BasicTest("test_registers"))
+    suite.addTest(BasicTest("test_registers_round_trip"))
     suite.addTest(BasicTest("test_step"))
     suite.addTest(BasicTest("test_step_hardware"))
     suite.addTest(BasicPieTest("test_basic"))
@@ -87,6 +110,7 @@ def fast_suite():
     suite.addTest(AttachDetachTest("test_attach_and_detach_2"))
     suite.addTest(AttachDetachTest("test_attach_and_detach_3"))
     suite.addTest(AttachDetachTest("test_attach_and_detach_4"))
+    suite.addTest(AttachDetachTest("test_attach_threads"))
     suite.addTest(ThreadTest("test_thread"))
     suite.addTest(ThreadTest("test_thread_hardware"))
     suite.addTest(ComplexThreadTest("test_thread"))
@@ -117,6 +141,7 @@ def fast_suite():
     suite.addTest(ControlFlowTest("test_step_until_1"))
     suite.addTest(ControlFlowTest("test_step_until_2"))
     suite.addTest(ControlFlowTest("test_step_until_3"))
+    suite.addTest(ControlFlowTest("test_step_until_blocks"))
     suite.addTest(ControlFlowTest("test_step_and_cont"))
     suite.addTest(ControlFlowTest("test_step_and_cont_hardware"))
     suite.addTest(ControlFlowTest("test_step_until_and_cont"))
@@ -216,6 +241,85 @@ def fast_suite():
     suite.addTest(AtexitHandlerTest("test_run_2"))
     suite.addTest(AtexitHandlerTest("test_run_3"))
     suite.addTest(AtexitHandlerTest("test_run_4"))
+    suite.addTest(ReturnAddressTest("test_return_address_clean_run"))
+    suite.addTest(ReturnAddressTest("test_return_address_hijack"))
+    suite.addTest(ReturnAddressTest("test_return_address_callback"))
+    suite.addTest(ReturnAddressTest("test_return_address_disable"))
+    suite.addTest(ReturnAddressTest("test_return_address_canary"))
+    suite.addTest(FunctionTraceTest("test_trace_functions"))
+    suite.addTest(FunctionTraceTest("test_trace_functions_plt_got"))
+    suite.addTest(FunctionTraceTest("test_trace_functions_names"))
+    suite.addTest(FunctionTraceTest("test_trace_functions_unfinished"))
+    suite.addTest(FunctionTraceTest("test_trace_functions_no_return"))
+    suite.addTest(FunctionTraceTest("test_trace_functions_with_breakpoint"))
+    suite.addTest(HeapTrackerTest("test_heap_tracker_leaks"))
+    suite.addTest(HeapTrackerTest("test_heap_tracker_owner"))
+    suite.addTest(HeapTrackerTest("test_heap_tracker_report"))
+    suite.addTest(HeapTrackerTest("test_heap_tracker_disable"))
+    suite.addTest(GlibcHeapTest("test_heap_bins"))
+    suite.addTest(GlibcHeapTest("test_heap_many_chunks"))
+    suite.addTest(GlibcHeapTest("test_heap_corruption"))
+    suite.addTest(ProfilerTest("test_profiler_folded"))
+    suite.addTest(ProfilerTest("test_profiler_pprof"))
+    suite.addTest(ProfilerTest("test_profiler_breakpoints"))
+    suite.addTest(ProfilerTest("test_profiler_steps"))
+    suite.addTest(PythonFramesTest("test_python_backtrace"))
+    suite.addTest(PythonFramesTest("test_python_backtrace_merged"))
+    suite.addTest(PythonFramesTest("test_python_backtrace_threads"))
+    suite.addTest(PythonFramesTest("test_python_backtrace_not_python"))
+    suite.addTest(TypedMemoryTest("test_typed_struct"))
+    suite.addTest(TypedMemoryTest("test_typed_pointers"))
+    suite.addTest(TypedMemoryTest("test_typed_arrays"))
+    suite.addTest(TypedMemoryTest("test_typed_numpy"))
+    suite.addTest(DwarfLocalsTest("test_args_and_locals"))
+    suite.addTest(DwarfLocalsTest("test_no_debug_info"))
+    suite.addTest(DwarfIndexTest("test_gdb_index"))
+    suite.addTest(CoreLibraryTest("test_benchmark"))
+    suite.addTest(CoreLibraryTest("test_api"))
+    suite.addTest(NativeCallbackTest("test_native_callback_resume"))
+    suite.addTest(NativeCallbackTest("test_native_callback_stop"))
+    suite.addTest(NativeCallbackTest("test_native_callback_moves_thread"))
+    suite.addTest(NativeCallbackTest("test_native_callback_validation"))
+    suite.addTest(LatencyModeTest("test_same_core"))
+    suite.addTest(LatencyModeTest("test_sibling_core"))
+    suite.addTest(LatencyModeTest("test_resolve_latency_mode"))
+    suite.addTest(LatencyModeTest("test_invalid_latency_mode"))
+    suite.addTest(ExecutionBudgetTest("test_wait_timeout"))
+    suite.addTest(ExecutionBudgetTest("test_wait_timeout_stop"))
+    suite.addTest(ExecutionBudgetTest("test_wall_time_budget"))
+    suite.addTest(ExecutionBudgetTest("test_cpu_time_budget"))
+    suite.addTest(ExecutionBudgetTest("test_syscall_budget"))
+    suite.addTest(ExecutionBudgetTest("test_breakpoint_hit_budget"))
+    suite.addTest(ExecutionBudgetTest("test_invalid_budget"))
+    suite.addTest(ThreadBreakpointTest("test_software_breakpoint"))
+    suite.addTest(ThreadBreakpointTest("test_hardware_breakpoint"))
+    suite.addTest(ThreadBreakpointTest("test_callback"))
+    suite.addTest(ThreadBreakpointTest("test_invalid_threads"))
+    suite.addTest(InternalDebuggerRegistryTest("test_equal_objects"))
+    suite.addTest(InternalDebuggerRegistryTest("test_no_registry_growth"))
+    suite.addTest(GdbServerTest("test_gdb_server_registers_memory"))
+    suite.addTest(GdbServerTest("test_gdb_server_breakpoint"))
+    suite.addTest(GdbServerTest("test_gdb_server_interrupt"))
+    suite.addTest(SyscallInjectionTest("test_inject_syscall"))
+    suite.addTest(SyscallInjectionTest("test_inject_syscall_patched"))
+    suite.addTest(SyscallInjectionTest("test_inject_syscall_callback"))
+    suite.addTest(SyscallInjectionTest("test_alloc"))
+    suite.addTest(CallTest("test_call"))
+    suite.addTest(CallTest("test_call_buffer"))
+    suite.addTest(CallTest("test_call_after_dlclose"))
+    suite.addTest(CallTest("test_call_crash"))
+    suite.addTest(VirtualTimeTest("test_virtual_time"))
+    suite.addTest(VirtualTimeTest("test_virtual_time_handlers"))
+    suite.addTest(VirtualTimeTest("test_virtual_time_vdso"))
+    suite.addTest(LockstepTest("test_lockstep_block"))
+    suite.addTest(LockstepTest("test_lockstep_instruction"))
+    suite.addTest(LockstepTest("test_lockstep_max_steps"))
+    suite.addTest(LockstepTest("test_lockstep_breakpoint"))
+    suite.addTest(LockstepTest("test_lockstep_syscall"))
+    suite.addTest(SyscallProfileTest("test_syscall_profile"))
+    suite.addTest(SyscallProfileTest("test_syscall_profile_handlers"))
+    suite.addTest(FdTableTest("test_fd_table"))
+    suite.addTest(FdTableTest("test_fd_table_untracked"))
     return suite
 
 
@@ -227,6 +331,7 @@ def complete_suite():
     suite.addTest(CallbackTest("test_callback_bruteforce"))
     suite.addTest(SpeedTest("test_speed"))
     suite.addTest(SpeedTest("test_speed_hardware"))
+    suite.addTest(SpeedTest("test_speed_registers"))
     suite.addTest(DeepDiveDivision("test_deep_dive_division"))
     return suite
 
@@ -5,6 +5,7 @@
 #
 
 import logging
+import os
 import unittest
 
 from pwn import process
@@ -91,6 +92,29 @@ class AttachDetachTest(unittest.TestCase):
         # Validate that, after detaching and killing, the process is effectively terminated
         self.assertRaises(EOFError, r.sendline, b"provola")
 
+    def test_attach_threads(self):
+        r = process("binaries/attach_threads_test")
+        r.recvuntil(b"ready")
+
+        d = debugger()
+        d.attach(r.pid)
+
+        # Every thread is registered at once, while the process is stopped
+        tids = {int(tid) for tid in os.listdir(f"/proc/{r.pid}/task")}
+        self.assertGreaterEqual(len(tids), 34)
+        self.assertEqual({thread.thread_id for thread in d.threads}, tids)
+        self.assertEqual(d.threads[0].thread_id, r.pid)
+
+        bp = d.breakpoint("tick")
+
+        d.cont()
+        d.wait()
+
+        self.assertGreaterEqual(bp.hit_count, 1)
+        self.assertTrue(any(thread.regs.rip == bp.address for thread in d.threads))
+
+        d.kill()
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -119,6 +119,61 @@ class BasicTest(unittest.TestCase):
         self.d.cont()
         self.d.kill()
 
+    def test_registers_round_trip(self):
+        d = self.d
+
+        d.run()
+
+        # The instruction at the breakpoint is a nop, stepping it only moves rip
+        bp = d.breakpoint(0x4011F4)
+
+        d.cont()
+        self.assertEqual(d.regs.rip, bp.address)
+
+        d.regs.rax = 0x1122334455667788
+        d.regs.ebx = 0x99AABBCC
+        d.regs.rcx = 0x1111111111111111
+        d.regs.cx = 0x2222
+        d.regs.rdx = 0x3333333333333333
+        d.regs.dl = 0x44
+        d.regs.dh = 0x55
+        d.regs.r8 = 0xFFFFFFFFFFFFFFFF
+        d.regs.r9d = 0x66666666
+        d.regs.r10 = 0x7777777777777777
+        d.regs.r10w = 0x8888
+        d.regs.r11 = 0x9999999999999999
+        d.regs.r11b = 0xAA
+
+        # The accessors share their memory with the register file
+        register_file = d.regs.register_file
+        self.assertEqual(register_file.rax, 0x1122334455667788)
+        self.assertEqual(register_file.rbx, 0x99AABBCC)
+        self.assertEqual(register_file.rcx, 0x1111111111112222)
+        self.assertEqual(register_file.rdx, 0x3333333333335544)
+        self.assertEqual(register_file.r8, 0xFFFFFFFFFFFFFFFF)
+        self.assertEqual(register_file.r9, 0x66666666)
+        self.assertEqual(register_file.r10, 0x7777777777778888)
+        self.assertEqual(register_file.r11, 0x99999999999999AA)
+
+        # The values reach the process, and are read back after the step
+        d.step()
+
+        self.assertEqual(d.regs.rip, bp.address + 1)
+        self.assertEqual(d.regs.rax, 0x1122334455667788)
+        self.assertEqual(d.regs.eax, 0x55667788)
+        self.assertEqual(d.regs.ax, 0x7788)
+        self.assertEqual(d.regs.al, 0x88)
+        self.assertEqual(d.regs.ah, 0x77)
+        self.assertEqual(d.regs.rbx, 0x99AABBCC)
+        self.assertEqual(d.regs.rcx, 0x1111111111112222)
+        self.assertEqual(d.regs.rdx, 0x3333333333335544)
+        self.assertEqual(d.regs.r8, 0xFFFFFFFFFFFFFFFF)
+        self.assertEqual(d.regs.r9, 0x66666666)
+        self.assertEqual(d.regs.r10, 0x7777777777778888)
+        self.assertEqual(d.regs.r11, 0x99999999999999AA)
+
+        d.kill()
+
     def test_step(self):
         d = self.d
 
@@ -356,6 +411,40 @@ class ControlFlowTest(unittest.TestCase):
 
         d.kill()
 
+    def test_step_until_blocks(self):
+        # The straight-line code is run at once, the thread must stop exactly where single steps would stop it
+        for max_steps in (3, 40, 500):
+            positions = []
+
+            for block_step in (False, True):
+                d = debugger("./binaries/math_loop_test")
+                d.run()
+
+                d.breakpoint("main")
+                d.cont()
+
+                if block_step:
+                    # The entry of main is never reached again
+                    d.step_until(d.regs.rip, max_steps=max_steps, file="absolute")
+                else:
+                    steps, previous = 0, d.regs.rip
+
+                    while steps < max_steps:
+                        d.step()
+
+                        # A repeated string instruction is stepped once for each iteration
+                        if d.regs.rip != previous:
+                            steps += 1
+
+                        previous = d.regs.rip
+
+                positions.append((d.regs.rip, d.regs.rsp, d.regs.rbp))
+
+                d.kill()
+                d.terminate()
+
+            self.assertEqual(positions[0], positions[1])
+
     def test_step_and_cont(self):
         d = debugger("./binaries/breakpoint_test")
         d.run()
@@ -0,0 +1,164 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import os
+import unittest
+
+from libdebug import debugger
+
+
+def encrypt(data, key):
+    encrypted = bytearray()
+
+    for byte in data:
+        encrypted.append(byte ^ key)
+        key = (key * 31 + 7) & 0xFF
+
+    return bytes(encrypted)
+
+
+class CallTest(unittest.TestCase):
+    def test_call(self):
+        d = debugger("binaries/call_test")
+
+        r = d.run()
+
+        d.breakpoint("main")
+        d.cont()
+        d.wait()
+
+        rip, rsp, rdi, rsi = d.regs.rip, d.regs.rsp, d.regs.rdi, d.regs.rsi
+
+        self.assertEqual(d.call("increment"), 1)
+        self.assertEqual(d.call("increment"), 2)
+
+        # The arguments after the sixth are passed on the stack
+        self.assertEqual(d.call("weighted_sum", *range(1, 10)), sum(i * i for i in range(1, 10)))
+        self.assertEqual(d.call("weighted_sum", -1, 0, 0, 0, 0, 0, 0, 0, 0), 2**64 - 1)
+
+        # The function is also callable by address
+        increment = d._internal_debugger.resolve_symbol("increment", "binary")
+        self.assertEqual(d.call(increment, file="absolute"), 3)
+
+        # The state of the thread is restored
+        self.assertEqual(d.regs.rip, rip)
+        self.assertEqual(d.regs.rsp, rsp)
+        self.assertEqual(d.regs.rdi, rdi)
+        self.assertEqual(d.regs.rsi, rsi)
+
+        d.cont()
+
+        # The changes of the calls to the memory of the process persist
+        self.assertEqual(r.recvline(), b"4 1.500000")
+
+        d.kill()
+        d.terminate()
+
+    def test_call_buffer(self):
+        d = debugger("binaries/call_test")
+
+        d.run()
+
+        d.breakpoint("main")
+        d.cont()
+        d.wait()
+
+        buffer = d.alloc(16)
+        d.memory[buffer, 16, "absolute"] = encrypt(b"libdebug oracles", 0x42)
+
+        self.assertEqual(d.call("decrypt", buffer, 16, 0x42), 16)
+        self.assertEqual(d.memory[buffer, 16, "absolute"], b"libdebug oracles")
+
+        with self.assertRaises(TypeError):
+            d.call("decrypt", b"libdebug", 8, 0x42)
+
+        d.kill()
+        d.terminate()
+
+    def test_call_after_dlclose(self):
+        d = debugger("binaries/call_test")
+
+        d.run()
+
+        d.breakpoint("main")
+        d.cont()
+        d.wait()
+
+        path = d.alloc(256)
+        d.memory[path, 256, "absolute"] = os.path.abspath("binaries/jumpstart_test_preload.so").encode().ljust(256, b"\0")
+
+        # RTLD_NOW
+        handle = d.call("dlopen", path, 2, file="libc")
+        self.assertNotEqual(handle, 0)
+
+        # The replacement of execve in the library only prints its arguments
+        self.assertEqual(d.call("execve", path, 0, 0, file="jumpstart_test_preload"), 0)
+
+        self.assertEqual(d.call("dlclose", handle, file="libc"), 0)
+
+        # The address resolved before the dlclose is not used anymore
+        with self.assertRaises(ValueError):
+            d.call("execve", path, 0, 0, file="jumpstart_test_preload")
+
+        d.kill()
+        d.terminate()
+
+    def test_call_maps(self):
+        d = debugger("binaries/call_test")
+
+        d.run()
+
+        d.breakpoint("main")
+        d.cont()
+        d.wait()
+
+        # The first call maps the trap of the return
+        d.call("increment")
+
+        maps = d.maps()
+
+        # A function that does not map memory keeps the maps read before the call
+        d.call("increment")
+        self.assertIs(d.maps(), maps)
+
+        # PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS
+        address = d.call("mmap", 0, 0x10000, 3, 0x22, -1, 0, file="libc")
+
+        self.assertIsNot(d.maps(), maps)
+        self.assertTrue(any(vmap.start == address for vmap in d.maps()))
+
+        d.kill()
+        d.terminate()
+
+    def test_call_crash(self):
+        d = debugger("binaries/call_test")
+
+        r = d.run()
+
+        values = []
+
+        def callback(t, _):
+            values.append(t.call("increment"))
+
+            with self.assertRaises(RuntimeError) as context:
+                t.call("crash", 0)
+
+            self.assertIn("SIGSEGV", str(context.exception))
+
+            values.append(t.call("increment"))
+
+        d.breakpoint("main", callback=callback)
+
+        d.cont()
+
+        # The crash of the function is not delivered to the process
+        self.assertEqual(r.recvline(), b"3 1.500000")
+
+        d.kill()
+
+        self.assertEqual(values, [1, 2])
+
+        d.terminate()
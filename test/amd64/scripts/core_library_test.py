@@ -0,0 +1,71 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import ctypes
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+from libdebug.core.build_core import build
+
+
+class CoreLibraryTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.build_dir = tempfile.TemporaryDirectory()
+        cls.library = build(Path(cls.build_dir.name))
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.build_dir.cleanup()
+
+    def test_benchmark(self):
+        bench = Path(self.build_dir.name) / "core_bench"
+
+        output = subprocess.run(
+            [str(bench), "binaries/benchmark", "f", "1000"], capture_output=True, text=True, check=True
+        ).stdout
+
+        self.assertIn("breakpoint hits: 100000 ", output)
+        self.assertIn("memory reads: 1000 pages", output)
+        self.assertIn("stopped at: f+0", output)
+
+    def test_api(self):
+        core = ctypes.CDLL(str(self.library))
+        core.ld_session_new.restype = ctypes.c_void_p
+        core.ld_session_free.argtypes = [ctypes.c_void_p]
+        core.ld_run.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.POINTER(ctypes.c_char_p), ctypes.c_void_p]
+        core.ld_pid.argtypes = [ctypes.c_void_p]
+        core.ld_resolve_symbol.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_char_p,
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_uint64),
+        ]
+        core.ld_read_memory.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_void_p, ctypes.c_size_t]
+
+        self.assertEqual(core.ld_api_version(), 1)
+
+        session = core.ld_session_new()
+        argv = (ctypes.c_char_p * 2)(b"binaries/basic_test", None)
+
+        pid = core.ld_run(session, b"binaries/basic_test", argv, None)
+        self.assertGreater(pid, 0)
+        self.assertEqual(core.ld_pid(session), pid)
+
+        address = ctypes.c_uint64()
+        self.assertEqual(core.ld_resolve_symbol(session, None, b"register_test", ctypes.byref(address)), 0)
+        self.assertEqual(address.value, 0x401126)
+
+        self.assertEqual(core.ld_resolve_symbol(session, None, b"not_a_symbol", ctypes.byref(address)), -1)
+
+        # The ELF magic of the executable
+        buffer = ctypes.create_string_buffer(4)
+        self.assertEqual(core.ld_read_memory(session, 0x400000, buffer, 4), 0)
+        self.assertEqual(buffer.raw, b"\x7fELF")
+
+        core.ld_session_free(session)
@@ -0,0 +1,50 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+from pathlib import Path
+
+from libdebug import debugger, libcontext
+from libdebug.utils.elf_utils import _parse_elf_file
+
+
+class DwarfIndexTest(unittest.TestCase):
+    def test_gdb_index(self):
+        path = str(Path("binaries/dwarf_index_test").resolve())
+
+        # The binary is linked by gold with a .gdb_index, and its local symbols are discarded
+        self.assertTrue(_parse_elf_file(path, 4)[3])
+
+        d = debugger("binaries/dwarf_index_test")
+
+        r = d.run()
+
+        with libcontext.tmp(sym_lvl=1), self.assertRaises(ValueError):
+            d.breakpoint("indexed_square")
+
+        # The functions are only named by the debug info, and are found through the index
+        bp = d.breakpoint("indexed_square")
+        d.breakpoint("indexed_sum")
+
+        d.cont()
+        self.assertEqual(d.regs.rdi, 10)
+
+        for i in range(10):
+            d.cont()
+            self.assertEqual(d.regs.rip, bp.address)
+            self.assertEqual(d.regs.rdi, i)
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"285")
+        self.assertEqual(bp.hit_count, 10)
+
+        d.kill()
+        d.terminate()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,75 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class DwarfLocalsTest(unittest.TestCase):
+    def test_args_and_locals(self):
+        d = debugger("binaries/dwarf_locals_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+        d.finish()
+
+        args = d.args()
+
+        self.assertEqual(list(args), ["count", "factor", "label"])
+        self.assertEqual(args["count"], 4)
+        self.assertEqual(args["factor"], 10)
+        self.assertEqual(d.memory[args["label"].deref(6).address, 6], b"result")
+
+        # The innermost total shadows the outer one
+        local_variables = d.locals()
+
+        self.assertEqual(set(local_variables), {"bounds", "ratio", "total", "i"})
+        self.assertEqual(local_variables["i"], 3)
+        self.assertEqual(local_variables["total"], 30)
+        self.assertEqual(local_variables["ratio"], 5.0)
+        self.assertEqual(local_variables["bounds"].first, 4)
+        self.assertEqual(local_variables["bounds"].second, 8 + 0 + 10 + 20)
+        self.assertEqual(local_variables["bounds"].to_python(), {"first": 4, "second": 38})
+
+        d.cont()
+        d.finish()
+
+        local_variables = d.locals()
+
+        self.assertEqual(set(local_variables), {"bounds", "ratio", "total"})
+        self.assertEqual(local_variables["total"], 4 + 68)
+        self.assertEqual(local_variables["bounds"].address, d.regs.rbp + 16 - 56)
+
+        d.kill()
+
+    def test_no_debug_info(self):
+        d = debugger("binaries/dwarf_locals_test")
+
+        d.run()
+
+        bp = d.breakpoint("checkpoint")
+
+        d.cont()
+
+        self.assertEqual(d.locals(), {})
+        self.assertEqual(d.args(), {})
+
+        bp.disable()
+
+        # Return from checkpoint, compute and main
+        d.finish()
+        d.finish()
+        d.finish()
+
+        # The libc function calling main has no debug info
+        with self.assertRaises(ValueError):
+            d.locals()
+
+        d.kill()
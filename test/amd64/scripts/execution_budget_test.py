@@ -0,0 +1,192 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import time
+import unittest
+
+from libdebug import debugger
+
+
+class ExecutionBudgetTest(unittest.TestCase):
+    def test_wait_timeout(self):
+        d = debugger("binaries/infinite_loop_test")
+
+        r = d.run()
+
+        r.sendline(b"3")
+
+        d.cont()
+
+        start = time.monotonic()
+        self.assertFalse(d.wait(timeout=0.3))
+        self.assertGreaterEqual(time.monotonic() - start, 0.3)
+
+        self.assertFalse(d.running)
+        self.assertEqual(d.memory.read(d.regs.rip, 2), b"\xeb\xfe")
+
+        # The process can be resumed as usual
+        d.cont()
+        self.assertFalse(d.wait(timeout=0.1))
+
+        d.kill()
+        d.terminate()
+
+    def test_wait_timeout_stop(self):
+        d = debugger("binaries/breakpoint_test")
+
+        d.run()
+
+        bp = d.breakpoint("random_function")
+
+        d.cont()
+        self.assertTrue(d.wait(timeout=10))
+
+        self.assertEqual(d.regs.rip, bp.address)
+
+        d.kill()
+        d.terminate()
+
+    def test_wall_time_budget(self):
+        d = debugger("binaries/infinite_loop_test")
+
+        r = d.run()
+
+        budget = d.budget(wall_time=0.3)
+
+        self.assertIs(d.execution_budget, budget)
+        self.assertIsNone(budget.exhausted)
+
+        r.sendline(b"3")
+
+        d.cont()
+        d.wait()
+
+        self.assertFalse(d.running)
+        self.assertEqual(budget.exhausted, "wall_time")
+        self.assertGreaterEqual(budget.usage().wall_time, 0.3)
+
+        # The budget is disarmed once exhausted
+        d.cont()
+        self.assertFalse(d.wait(timeout=0.1))
+        self.assertEqual(budget.exhausted, "wall_time")
+
+        d.kill()
+
+        # The usage outlives the process
+        self.assertGreaterEqual(budget.usage().wall_time, 0.3)
+
+        d.terminate()
+
+    def test_cpu_time_budget(self):
+        d = debugger("binaries/infinite_loop_test")
+
+        r = d.run()
+
+        budget = d.budget(cpu_time=0.2)
+
+        r.sendline(b"3")
+
+        d.cont()
+        d.wait()
+
+        usage = budget.usage()
+
+        self.assertEqual(budget.exhausted, "cpu_time")
+        self.assertGreaterEqual(usage.cpu_time, 0.2)
+        self.assertGreaterEqual(usage.wall_time, usage.cpu_time)
+
+        d.kill()
+        d.terminate()
+
+    def test_syscall_budget(self):
+        d = debugger("binaries/syscall_loop_test")
+
+        d.run()
+
+        budget = d.budget(syscalls=1000)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(budget.exhausted, "syscalls")
+        self.assertEqual(budget.usage().syscalls, 1001)
+
+        # The last syscall is interrupted on its entry
+        self.assertEqual(d.syscall_number, 110)
+
+        d.kill()
+
+        # The handlers still see the syscalls of the budget
+        d.run()
+
+        entries = []
+
+        def on_enter_getppid(t, _):
+            entries.append(t.syscall_number)
+
+        d.handle_syscall("getppid", on_enter=on_enter_getppid)
+
+        budget = d.budget(syscalls=100)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(budget.exhausted, "syscalls")
+        self.assertEqual(budget.usage().syscalls, 101)
+        self.assertEqual(len(entries), 101)
+
+        d.kill()
+        d.terminate()
+
+    def test_breakpoint_hit_budget(self):
+        d = debugger("binaries/benchmark")
+
+        d.run()
+
+        bp = d.breakpoint("f", callback=lambda _, __: None)
+
+        budget = d.budget(breakpoint_hits=1000)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(budget.exhausted, "breakpoint_hits")
+        self.assertEqual(budget.usage().breakpoint_hits, 1001)
+        self.assertEqual(bp.hit_count, 1001)
+
+        # The last hit is handled, and the process stops right after
+        self.assertEqual(d.regs.rip, bp.address)
+        self.assertEqual(d.regs.rdi, 1000)
+
+        # Once the budget is exhausted, the process runs until the end
+        d.cont()
+        d.wait()
+
+        self.assertEqual(bp.hit_count, 100000)
+        self.assertEqual(budget.usage().breakpoint_hits, 1001)
+
+        d.kill()
+        d.terminate()
+
+    def test_invalid_budget(self):
+        d = debugger("binaries/breakpoint_test")
+
+        with self.assertRaises(RuntimeError):
+            d.budget(wall_time=1)
+
+        d.run()
+
+        with self.assertRaises(ValueError):
+            d.budget()
+
+        with self.assertRaises(ValueError):
+            d.budget(syscalls=0)
+
+        with self.assertRaises(ValueError):
+            d.wait(timeout=-1)
+
+        d.kill()
+        d.terminate()
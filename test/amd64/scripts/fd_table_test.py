@@ -0,0 +1,98 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class FdTableTest(unittest.TestCase):
+    def test_fd_table(self):
+        d = debugger("binaries/fd_table_test")
+
+        r = d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+        d.wait()
+
+        tracker = d.track_fds()
+
+        # The descriptors opened before the tracking are read from /proc
+        self.assertEqual(d.threads[0].fd_info(3).path, "/dev/null")
+        self.assertIsNone(d.threads[0].fd_info(4))
+
+        d.cont()
+        d.wait()
+
+        fds = tracker.fds()
+
+        self.assertEqual(fds[4].path, "/etc/passwd")
+        self.assertEqual(fds[4].kind, "file")
+        self.assertEqual(fds[5].kind, "pipe")
+        self.assertEqual(fds[6].kind, "pipe")
+        self.assertEqual(fds[7].kind, "socket")
+        self.assertEqual(fds[40].path, "/etc/passwd")
+        self.assertEqual(fds[50].path, fds[7].path)
+
+        d.cont()
+        d.wait()
+
+        # The closed descriptors are dropped from the table
+        self.assertIsNone(d.threads[0].fd_info(4))
+        self.assertIsNone(d.threads[0].fd_info(5))
+        self.assertIsNone(d.threads[0].fd_info(50))
+        self.assertEqual(d.threads[0].fd_info(6).kind, "pipe")
+        self.assertEqual(d.threads[0].fd_info(40).path, "/etc/passwd")
+
+        self.assertIs(d.fd_tracker, tracker)
+
+        with self.assertRaises(RuntimeError):
+            d.track_fds()
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"3 4 7 50")
+
+        d.kill()
+        d.terminate()
+
+    def test_fd_table_untracked(self):
+        d = debugger("binaries/fd_table_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+        d.wait()
+        d.cont()
+        d.wait()
+
+        # Without a tracker, the lookups read /proc
+        self.assertIsNone(d.fd_tracker)
+        self.assertEqual(d.threads[0].fd_info(4).path, "/etc/passwd")
+        self.assertEqual(d.threads[0].fd_info(7).kind, "socket")
+        self.assertIsNone(d.threads[0].fd_info(60))
+
+        # A disabled tracker reads /proc as well
+        tracker = d.track_fds()
+        tracker.disable()
+
+        d.cont()
+        d.wait()
+
+        self.assertIsNone(d.threads[0].fd_info(4))
+        self.assertEqual(d.threads[0].fd_info(40).path, "/etc/passwd")
+
+        tracker.enable()
+
+        self.assertEqual(d.threads[0].fd_info(6).kind, "pipe")
+        self.assertIsNone(d.threads[0].fd_info(5))
+
+        d.kill()
+        d.terminate()
@@ -0,0 +1,190 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class FunctionTraceTest(unittest.TestCase):
+    def test_trace_functions(self):
+        d = debugger("binaries/function_trace_test")
+
+        r = d.run()
+
+        tracer = d.trace_functions(["malloc", "free", "add", "recurse"], args=2)
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"45 5")
+        self.assertEqual(r.recvline(), b"100 200")
+
+        d.wait()
+        d.kill()
+
+        mallocs = [call for call in tracer.calls if call.function == "malloc"]
+        frees = [call for call in tracer.calls if call.function == "free"]
+
+        self.assertEqual(len(mallocs), 10)
+        self.assertEqual(len(frees), 10)
+
+        for i, call in enumerate(mallocs):
+            self.assertEqual(call.args[0], (i + 1) * 16)
+            self.assertEqual(frees[i].args[0], call.return_value)
+            self.assertGreaterEqual(call.duration, 0)
+
+        adds = [call for call in tracer.calls if call.function == "add"]
+        self.assertEqual(len(adds), 210)
+
+        main_adds = adds[:10]
+        for i, call in enumerate(main_adds):
+            self.assertEqual(call.args[1], i)
+            self.assertEqual(call.return_value, call.args[0] + call.args[1])
+
+        # The calls are reported when they return, innermost first
+        recursions = [call for call in tracer.calls if call.function == "recurse"]
+        self.assertEqual([call.return_value for call in recursions], list(range(6)))
+        self.assertEqual([call.args[0] for call in recursions], list(range(6)))
+
+        threads = {call.thread_id for call in adds[10:]}
+        self.assertEqual(len(threads), 2)
+        self.assertNotIn(d.threads[0].thread_id, threads)
+
+        stats = tracer.stats()
+        self.assertEqual(stats["add"].calls, 210)
+        self.assertEqual(stats["add"].returns, 210)
+        self.assertEqual(stats["recurse"].calls, 6)
+        self.assertLessEqual(stats["malloc"].min_time, stats["malloc"].max_time)
+        self.assertEqual(tracer.dropped, 0)
+
+        d.terminate()
+
+    def test_trace_functions_plt_got(self):
+        d = debugger("binaries/call_test")
+
+        r = d.run()
+
+        # The PIE binaries call __cxa_finalize through .plt.got, as its address is also taken
+        tracer = d.trace_functions(["__cxa_finalize", "printf"], args=1)
+
+        addresses = {name: address - d.maps()[0].start for address, name in tracer.functions.items()}
+        self.assertEqual(addresses, {"printf": 0x1040, "__cxa_finalize": 0x1050})
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"1 1.500000")
+
+        d.wait()
+        d.kill()
+
+        self.assertEqual([call.function for call in tracer.calls], ["printf", "__cxa_finalize"])
+
+        d.terminate()
+
+    def test_trace_functions_names(self):
+        d = debugger("binaries/function_trace_test")
+
+        d.run()
+
+        # Without a file prefix, the name is a symbol and not a glob pattern
+        with self.assertRaisesRegex(ValueError, r"Symbol rec\* not found"):
+            d.trace_functions(["rec*"])
+
+        with self.assertRaisesRegex(ValueError, r"Symbol add\[0\] not found"):
+            d.trace_functions(["add[0]"])
+
+        # A double colon is never a file prefix
+        with self.assertRaisesRegex(ValueError, "Symbol ns::add not found"):
+            d.trace_functions(["ns::add"])
+
+        tracer = d.trace_functions(["binary:rec*", "binary:ad[d]"])
+
+        self.assertEqual(sorted(tracer.functions.values()), ["add", "recurse"])
+
+        d.kill()
+        d.terminate()
+
+    def test_trace_functions_unfinished(self):
+        d = debugger("binaries/function_trace_test")
+
+        r = d.run()
+
+        tracer = d.trace_functions(["exit", "binary:rec*"], args=1)
+
+        self.assertEqual(sorted(tracer.functions.values()), ["exit", "recurse"])
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"45 5")
+
+        d.wait()
+        d.kill()
+
+        # exit never returns
+        self.assertEqual(tracer.calls[-1].function, "exit")
+        self.assertIsNone(tracer.calls[-1].return_value)
+        self.assertIsNone(tracer.calls[-1].duration)
+        self.assertEqual(tracer.calls[-1].args, [0])
+
+        d.terminate()
+
+    def test_trace_functions_no_return(self):
+        d = debugger("binaries/function_trace_test")
+
+        r = d.run()
+
+        tracer = d.trace_functions(["add"], args=2, capture_return=False, buffer_size=16)
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"45 5")
+        self.assertEqual(r.recvline(), b"100 200")
+
+        d.wait()
+        d.kill()
+
+        # The buffer is drained on every stop, the calls that did not fit in between are lost
+        self.assertGreater(tracer.dropped, 0)
+        self.assertEqual(len(tracer.calls) + tracer.dropped, 210)
+        self.assertTrue(all(call.return_value is None for call in tracer.calls))
+
+        stats = tracer.stats()
+        self.assertEqual(stats["add"].calls, 210)
+        self.assertEqual(stats["add"].returns, 0)
+
+        d.terminate()
+
+    def test_trace_functions_with_breakpoint(self):
+        d = debugger("binaries/function_trace_test")
+
+        r = d.run()
+
+        tracer = d.trace_functions(["add"], args=2)
+        bp = d.breakpoint("recurse")
+
+        d.cont()
+
+        self.assertEqual(d.regs.rip, bp.address)
+        self.assertEqual(len(tracer.calls), 10)
+
+        tracer.disable()
+        bp.disable()
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"45 5")
+        self.assertEqual(r.recvline(), b"100 200")
+
+        d.wait()
+        d.kill()
+
+        self.assertEqual(len(tracer.calls), 10)
+
+        d.terminate()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,163 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import socket
+import unittest
+
+from libdebug import debugger
+from libdebug.utils.elf_utils import is_pie, resolve_symbol
+from libdebug.utils.gdb_remote_utils import frame_packet, parse_packets
+
+
+class RemoteClient:
+    """A minimal client of the GDB remote serial protocol."""
+
+    def __init__(self, address):
+        host, port = address.rsplit(":", 1)
+        self.socket = socket.create_connection((host, int(port)), timeout=10)
+        self.buffer = bytearray()
+
+    def send(self, payload):
+        self.socket.sendall(frame_packet(payload))
+        return self.receive()
+
+    def receive(self):
+        while True:
+            packets = parse_packets(self.buffer)
+
+            if packets:
+                self.socket.sendall(b"+")
+                return packets[0]
+
+            data = self.socket.recv(4096)
+
+            if not data:
+                return None
+
+            self.buffer += data
+
+    def close(self):
+        self.socket.close()
+
+
+class GdbServerTest(unittest.TestCase):
+    def test_gdb_server_registers_memory(self):
+        d = debugger("binaries/breakpoint_test")
+
+        d.run()
+
+        rip, rsp = d.regs.rip, d.regs.rsp
+        code = d.memory.read(rip, 16)
+
+        server = d.gdb_server()
+        client = RemoteClient(server.address)
+
+        self.assertIn(b"swbreak+", client.send(b"qSupported:multiprocess+;swbreak+"))
+        self.assertEqual(client.send(b"?"), f"T05thread:{d.pid:x};".encode())
+        self.assertEqual(client.send(b"qfThreadInfo"), f"m{d.pid:x}".encode())
+        self.assertEqual(client.send(b"qAttached"), b"1")
+
+        registers = bytes.fromhex(client.send(b"g").decode())
+        self.assertEqual(int.from_bytes(registers[7 * 8 : 8 * 8], "little"), rsp)
+        self.assertEqual(int.from_bytes(registers[16 * 8 : 17 * 8], "little"), rip)
+
+        self.assertEqual(client.send(f"p{16:x}".encode()), rip.to_bytes(8, "little").hex().encode())
+        self.assertEqual(client.send(b"P0=" + (0xDEADBEEF).to_bytes(8, "little").hex().encode()), b"OK")
+
+        self.assertEqual(bytes.fromhex(client.send(f"m{rip:x},10".encode()).decode()), code)
+        self.assertTrue(client.send(b"m0,8").startswith(b"E"))
+
+        self.assertEqual(client.send(b"D"), b"OK")
+        self.assertTrue(server.wait(timeout=10))
+        client.close()
+
+        # The process is still debugged by libdebug, with the changes of the client
+        self.assertEqual(d.regs.rax, 0xDEADBEEF)
+        self.assertEqual(d.regs.rip, rip)
+
+        server.stop()
+        self.assertFalse(server.serving)
+
+        d.kill()
+        d.terminate()
+
+    def test_gdb_server_breakpoint(self):
+        d = debugger("binaries/breakpoint_test")
+
+        r = d.run()
+
+        address = resolve_symbol("binaries/breakpoint_test", "random_function")
+
+        if is_pie("binaries/breakpoint_test"):
+            address += d.maps()[0].start
+
+        server = d.gdb_server()
+        client = RemoteClient(server.address)
+
+        self.assertEqual(client.send(b"QStartNoAckMode"), b"OK")
+        self.assertEqual(client.send(f"Z0,{address:x},1".encode()), b"OK")
+
+        reply = client.send(b"vCont;c")
+        self.assertEqual(reply, f"T05thread:{d.pid:x};swbreak:;".encode())
+
+        registers = bytes.fromhex(client.send(b"g").decode())
+        self.assertEqual(int.from_bytes(registers[16 * 8 : 17 * 8], "little"), address)
+
+        # Step over the breakpoint
+        self.assertEqual(client.send(b"z0," + f"{address:x}".encode() + b",1"), b"OK")
+        self.assertEqual(client.send(f"vCont;s:{d.pid:x};c".encode()), f"T05thread:{d.pid:x};".encode())
+
+        registers = bytes.fromhex(client.send(b"g").decode())
+        self.assertNotEqual(int.from_bytes(registers[16 * 8 : 17 * 8], "little"), address)
+
+        self.assertEqual(client.send(b"D"), b"OK")
+        self.assertTrue(server.wait(timeout=10))
+        client.close()
+
+        # The breakpoints of the client are disabled when it detaches
+        self.assertFalse(d.breakpoints[address].enabled)
+
+        # Another client can connect to the same server, and run the process until it exits
+        client = RemoteClient(server.address)
+
+        self.assertEqual(client.send(b"c"), b"W00")
+        client.close()
+
+        self.assertTrue(server.wait(timeout=10))
+        self.assertIn(b"Random function", r.recvline(timeout=5) + r.recvline(timeout=5))
+
+        d.terminate()
+
+    def test_gdb_server_interrupt(self):
+        d = debugger("binaries/infinite_loop_test")
+
+        r = d.run()
+
+        r.sendline(b"3")
+
+        server = d.gdb_server()
+        client = RemoteClient(server.address)
+
+        client.socket.sendall(frame_packet(b"c"))
+
+        # The process runs until the client interrupts it
+        client.socket.settimeout(0.3)
+        with self.assertRaises(TimeoutError):
+            client.receive()
+        client.socket.settimeout(10)
+
+        client.socket.sendall(b"\x03")
+        self.assertEqual(client.receive(), f"T02thread:{d.pid:x};".encode())
+
+        self.assertEqual(client.send(b"D"), b"OK")
+        self.assertTrue(server.wait(timeout=10))
+        client.close()
+
+        self.assertFalse(d.running)
+        self.assertEqual(d.memory.read(d.regs.rip, 2), b"\xeb\xfe")
+
+        d.kill()
+        d.terminate()
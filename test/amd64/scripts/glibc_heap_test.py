@@ -0,0 +1,100 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class GlibcHeapTest(unittest.TestCase):
+    def test_heap_bins(self):
+        d = debugger("binaries/glibc_heap_test")
+
+        d.run()
+
+        bp = d.breakpoint("checkpoint")
+
+        d.cont()
+
+        self.assertTrue(bp.hit_on(d))
+
+        chunks, corruptions = d.heap.walk()
+
+        self.assertEqual(corruptions, [])
+        self.assertTrue(chunks[-1].is_top)
+
+        bins = d.heap.bins()
+        self.assertEqual(len(bins["tcache"][1]), 7)
+        self.assertEqual(len(bins["fastbin"][1]), 3)
+        self.assertEqual([chunk.size for chunk in bins["unsorted"][1]], [0x510])
+
+        # The pointers returned by malloc belong to the freed chunks
+        small = [int.from_bytes(d.memory[d.regs.rdi + i * 8, 8, "absolute"], "little") for i in range(10)]
+
+        for i, pointer in enumerate(small):
+            chunk = chunks.find(pointer)
+            self.assertEqual(chunk.user_address, pointer)
+            self.assertEqual(chunk.size, 0x30)
+            self.assertFalse(chunk.in_use)
+            self.assertEqual(chunk.bin_kind, "tcache" if i < 7 else "fastbin")
+
+        in_use = [chunk.size for chunk in chunks if chunk.in_use]
+        self.assertIn(0x510, in_use)
+        self.assertEqual(in_use.count(0x20), 2)
+
+        self.assertEqual(len(d.heap.free_chunks()), 11)
+
+        d.kill()
+
+    def test_heap_many_chunks(self):
+        d = debugger("binaries/glibc_heap_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+        d.cont()
+
+        chunks, corruptions = d.heap.walk()
+
+        self.assertEqual(corruptions, [])
+        self.assertGreater(len(chunks), 100000)
+        self.assertGreaterEqual(sum(1 for chunk in chunks if chunk.in_use and chunk.size == 0x20), 100000)
+
+        d.kill()
+
+    def test_heap_corruption(self):
+        d = debugger("binaries/glibc_heap_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+
+        small = [int.from_bytes(d.memory[d.regs.rdi + i * 8, 8, "absolute"], "little") for i in range(10)]
+
+        # Link the last fastbin chunk back to the first one, which glibc protects with safe-linking
+        fastbin_head = small[9] - 0x10
+        link = fastbin_head ^ (small[7] >> 12)
+        d.memory[small[7], 8, "absolute"] = link.to_bytes(8, "little")
+
+        corruptions = d.heap.check()
+        self.assertEqual([corruption.kind for corruption in corruptions], ["loop in bin"])
+        self.assertEqual(corruptions[0].address, fastbin_head)
+
+        # A corrupted size field stops the walk
+        d.memory[small[3] - 8, 8, "absolute"] = (0x31337).to_bytes(8, "little")
+
+        chunks, corruptions = d.heap.walk()
+        self.assertEqual(corruptions[0].kind, "invalid chunk size")
+        self.assertEqual(corruptions[0].address, small[3] - 0x10)
+        self.assertEqual(corruptions[0].value, 0x31337)
+        self.assertIn("top chunk not found", [corruption.kind for corruption in corruptions])
+        self.assertEqual(chunks[-1].address, small[2] - 0x10)
+
+        d.kill()
@@ -0,0 +1,142 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import io
+import sys
+import unittest
+
+from libdebug import debugger
+
+
+class HeapTrackerTest(unittest.TestCase):
+    def test_heap_tracker_leaks(self):
+        d = debugger("binaries/heap_tracker_test")
+
+        r = d.run()
+
+        heap = d.track_heap(backtrace=2)
+
+        d.cont()
+
+        r.recvline()
+        zeroed, grown, mapping = (int(value, 16) for value in r.recvline().split())
+
+        d.wait()
+
+        # The stdout buffer of libc is allocated as well, only keep what the binary allocated
+        leaks = [allocation for allocation in heap.allocations() if allocation.pc < 0x500000]
+
+        self.assertEqual(len(leaks), 4)
+
+        chunks = {allocation.address: allocation for allocation in leaks}
+        self.assertEqual(chunks[zeroed].size, 128)
+        self.assertEqual(chunks[grown].size, 64)
+        self.assertTrue(chunks[mapping].mmap)
+        self.assertEqual(chunks[mapping].size, 4096)
+
+        # The leaked chunk is allocated by leak(), called from main()
+        kept = next(allocation for allocation in leaks if allocation.size == 100)
+        self.assertTrue(0x40119B <= kept.pc < 0x4011B5)
+        self.assertEqual(len(kept.backtrace), 2)
+        self.assertGreaterEqual(kept.backtrace[0], 0x4011B5)
+
+        stats = heap.stats()
+        self.assertGreaterEqual(stats.allocations, 6)
+        self.assertGreaterEqual(stats.frees, 3)
+        self.assertEqual(stats.invalid_frees, 0)
+        self.assertGreaterEqual(stats.peak_bytes, 1 << 20)
+        self.assertLess(stats.live_bytes, 1 << 20)
+
+        d.kill()
+
+    def test_heap_tracker_owner(self):
+        d = debugger("binaries/heap_tracker_test")
+
+        r = d.run()
+
+        heap = d.track_heap(mmap=False)
+        bp = d.breakpoint("checkpoint")
+
+        d.cont()
+
+        self.assertTrue(bp.hit_on(d))
+
+        pointer = d.regs.rdi
+        owner = heap.owner(pointer)
+
+        self.assertIsNotNone(owner)
+        self.assertEqual(owner.size, 100)
+        self.assertEqual(pointer - owner.address, 10)
+        self.assertIsNone(heap.owner(0x1000))
+
+        # The large chunk is still live, and the libc mapping behind it is not reported on its own
+        sizes = [allocation.size for allocation in heap.allocations()]
+        self.assertIn(1 << 20, sizes)
+        self.assertFalse(any(allocation.mmap for allocation in heap.allocations()))
+
+        sites = heap.live_bytes_by_call_site()
+        self.assertEqual(next(iter(sites.values())), 1 << 20)
+
+        d.cont()
+
+        r.recvline(2)
+
+        d.kill()
+
+    def test_heap_tracker_report(self):
+        d = debugger("binaries/heap_tracker_test")
+
+        r = d.run()
+
+        heap = d.track_heap(report_on_exit=True)
+
+        stdout = sys.stdout
+        sys.stdout = io.StringIO()
+
+        try:
+            d.cont()
+            r.recvline(2)
+            d.wait()
+            report = sys.stdout.getvalue()
+        finally:
+            sys.stdout = stdout
+
+        self.assertIn("still live", report)
+        self.assertIn("100 bytes in 1 allocations", report)
+
+        d.kill()
+
+        # The tracker keeps the leaks after the process is gone
+        d.run()
+        d.kill()
+
+        self.assertIn(100, [allocation.size for allocation in heap.allocations()])
+
+    def test_heap_tracker_disable(self):
+        d = debugger("binaries/heap_tracker_test")
+
+        r = d.run()
+
+        heap = d.track_heap()
+        bp = d.breakpoint("checkpoint")
+
+        heap.disable()
+
+        d.cont()
+
+        self.assertTrue(bp.hit_on(d))
+        self.assertEqual(heap.stats().allocations, 0)
+
+        heap.enable()
+
+        d.cont()
+        r.recvline(2)
+        d.wait()
+
+        # The large chunk was allocated while the tracker was disabled
+        self.assertEqual(heap.stats().invalid_frees, 1)
+
+        d.kill()
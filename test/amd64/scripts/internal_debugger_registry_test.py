@@ -0,0 +1,77 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import gc
+import unittest
+import weakref
+
+from libdebug import debugger
+from libdebug.data.breakpoint import Breakpoint
+from libdebug.debugger.internal_debugger_holder import internal_debugger_holder
+from libdebug.debugger.internal_debugger_instance_manager import (
+    link_to_internal_debugger,
+    provide_internal_debugger,
+)
+
+
+class InternalDebuggerRegistryTest(unittest.TestCase):
+    def test_equal_objects(self):
+        d1 = debugger("binaries/breakpoint_test")
+        d2 = debugger("binaries/breakpoint_test")
+
+        d1.run()
+        d2.run()
+
+        # The breakpoints compare equal, but each one belongs to its own debugger
+        bp1 = d1.breakpoint("random_function")
+        bp2 = d2.breakpoint("random_function")
+
+        self.assertEqual(bp1, bp2)
+        self.assertIs(provide_internal_debugger(bp1), d1._internal_debugger)
+        self.assertIs(provide_internal_debugger(bp2), d2._internal_debugger)
+
+        bp1.disable()
+
+        d2.cont()
+        d2.wait()
+
+        self.assertEqual(d2.regs.rip, bp2.address)
+        self.assertEqual(bp2.hit_count, 1)
+        self.assertEqual(bp1.hit_count, 0)
+
+        d1.kill()
+        d2.kill()
+        d1.terminate()
+        d2.terminate()
+
+    def test_no_registry_growth(self):
+        d = debugger("binaries/breakpoint_test")
+
+        d.run()
+
+        gc.collect()
+        debuggers = len(internal_debugger_holder.internal_debuggers)
+
+        bp = Breakpoint(0x1234)
+        link_to_internal_debugger(bp, d._internal_debugger)
+        reference = weakref.ref(bp)
+
+        self.assertIs(provide_internal_debugger(bp), d._internal_debugger)
+
+        # Only the debuggers are tracked, the linked objects die with their last reference
+        del bp
+        gc.collect()
+
+        self.assertIsNone(reference())
+        self.assertEqual(len(internal_debugger_holder.internal_debuggers), debuggers)
+        self.assertIn(d._internal_debugger, internal_debugger_holder.internal_debuggers)
+
+        d.kill()
+        d.terminate()
+
+
+if __name__ == "__main__":
+    unittest.main()
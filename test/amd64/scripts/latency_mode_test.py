@@ -0,0 +1,100 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import os
+import unittest
+
+from libdebug import debugger
+from libdebug.utils.latency_utils import parse_cpu_list, resolve_latency_mode
+
+
+def polling_thread_affinity(d):
+    polling_thread = d._internal_debugger._InternalDebugger__polling_thread
+    return os.sched_getaffinity(polling_thread.native_id)
+
+
+class LatencyModeTest(unittest.TestCase):
+    def test_same_core(self):
+        allowed = os.sched_getaffinity(0)
+        cpu = max(allowed)
+
+        d = debugger("binaries/breakpoint_test")
+
+        mode = d.set_latency_mode("same-core", cpu=cpu, spin_time=0.0001)
+
+        self.assertEqual(mode.tracer_cpu, cpu)
+        self.assertEqual(mode.tracee_cpu, cpu)
+        self.assertIs(d.latency_mode, mode)
+
+        d.run()
+
+        self.assertEqual(os.sched_getaffinity(d.pid), {cpu})
+        self.assertEqual(polling_thread_affinity(d), {cpu})
+
+        bp = d.breakpoint("random_function")
+
+        d.cont()
+        d.wait()
+
+        self.assertTrue(bp.hit_on(d))
+
+        # The default placement is restored on the running process as well
+        self.assertIsNone(d.set_latency_mode(None))
+        self.assertEqual(os.sched_getaffinity(d.pid), allowed)
+        self.assertEqual(polling_thread_affinity(d), allowed)
+
+        d.kill()
+        d.terminate()
+
+    @unittest.skipIf(len(os.sched_getaffinity(0)) < 2, "The sibling-core policy needs at least two CPUs")
+    def test_sibling_core(self):
+        d = debugger("binaries/breakpoint_test")
+
+        mode = d.set_latency_mode("sibling-core", spin_time=0.0001)
+
+        self.assertNotEqual(mode.tracer_cpu, mode.tracee_cpu)
+
+        d.run()
+
+        self.assertEqual(os.sched_getaffinity(d.pid), {mode.tracee_cpu})
+        self.assertEqual(polling_thread_affinity(d), {mode.tracer_cpu})
+
+        bp = d.breakpoint("random_function")
+
+        d.cont()
+        d.wait()
+
+        self.assertTrue(bp.hit_on(d))
+
+        d.kill()
+        d.terminate()
+
+    def test_resolve_latency_mode(self):
+        self.assertEqual(parse_cpu_list("0-3,8,10-11\n"), [0, 1, 2, 3, 8, 10, 11])
+
+        mode = resolve_latency_mode("sibling-core", None, 0.0, {0, 1})
+
+        self.assertEqual(mode.tracer_cpu, 0)
+        self.assertEqual(mode.tracee_cpu, 1)
+
+        with self.assertRaises(ValueError):
+            resolve_latency_mode("sibling-core", 0, 0.0, {0})
+
+    def test_invalid_latency_mode(self):
+        d = debugger("binaries/breakpoint_test")
+
+        with self.assertRaises(ValueError):
+            d.set_latency_mode("other-core")
+
+        with self.assertRaises(ValueError):
+            d.set_latency_mode("same-core", cpu=max(os.sched_getaffinity(0)) + 1)
+
+        with self.assertRaises(ValueError):
+            d.set_latency_mode("same-core", spin_time=-1)
+
+        self.assertIsNone(d.latency_mode)
+
+        d.terminate()
@@ -0,0 +1,128 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger, lockstep
+
+
+def start(seed):
+    d = debugger(["binaries/lockstep_test", str(seed)])
+
+    r = d.run()
+
+    d.breakpoint("compute")
+    d.cont()
+    d.wait()
+
+    return d, r
+
+
+class LockstepTest(unittest.TestCase):
+    def test_lockstep_block(self):
+        d1, _ = start(0)
+        d2, _ = start(7)
+
+        result = lockstep(d1, d2, memory=[("table", 256)])
+
+        self.assertTrue(result.diverged)
+        self.assertGreater(result.steps, 40)
+
+        # The block that adds the seed to the table is the first that differs
+        self.assertEqual(result.first.registers["rip"], result.second.registers["rip"])
+        self.assertEqual(result.memory, [0])
+        self.assertEqual(result.first.memory[0][160:164], (1600).to_bytes(4, "little"))
+        self.assertEqual(result.second.memory[0][160:164], (1607).to_bytes(4, "little"))
+        self.assertEqual(result.first.memory[0][:160], result.second.memory[0][:160])
+
+        # The processes are left at the divergence
+        self.assertEqual(d1.regs.rip, result.first.registers["rip"])
+        self.assertEqual(d2.regs.rip, result.second.registers["rip"])
+
+        d1.kill()
+        d2.kill()
+        d1.terminate()
+        d2.terminate()
+
+    def test_lockstep_instruction(self):
+        d1, _ = start(0)
+        d2, _ = start(7)
+
+        result = lockstep(d1, d2, mode="instruction")
+
+        # The first instruction that differs loads the seed
+        self.assertTrue(result.diverged)
+        self.assertEqual(result.registers, {"rax": (0, 7)})
+
+        d1.kill()
+        d2.kill()
+        d1.terminate()
+        d2.terminate()
+
+    def test_lockstep_max_steps(self):
+        d1, r1 = start(3)
+        d2, r2 = start(3)
+
+        result = lockstep(d1, d2, mode="instruction", max_steps=100, memory=[("table", 256)])
+
+        self.assertEqual(result.outcome, "max_steps")
+        self.assertEqual(result.steps, 100)
+        self.assertEqual(result.registers, {})
+        self.assertEqual(result.first, result.second)
+
+        # The processes keep running normally afterwards
+        d1.cont()
+        d2.cont()
+
+        self.assertEqual(r1.recvline(), b"ready")
+        self.assertEqual(r1.recvline(), b"85347")
+        self.assertEqual(r2.recvline(), b"ready")
+        self.assertEqual(r2.recvline(), b"85347")
+
+        d1.kill()
+        d2.kill()
+        d1.terminate()
+        d2.terminate()
+
+    def test_lockstep_breakpoint(self):
+        d1, _ = start(0)
+        d2, _ = start(0)
+
+        d1.breakpoint("checkpoint")
+        d2.breakpoint("checkpoint")
+
+        result = lockstep(d1, d2, mode="breakpoint", registers=["rip"], memory=[("table", 256)])
+
+        # Both processes stop at the checkpoint, and then at their exit
+        self.assertEqual(result.outcome, "exited")
+        self.assertEqual(result.steps, 2)
+
+        d1.kill()
+        d2.kill()
+        d1.terminate()
+        d2.terminate()
+
+    def test_lockstep_syscall(self):
+        d1, _ = start(0)
+        d2, _ = start(7)
+
+        result = lockstep(d1, d2, mode="syscall", registers=["orig_rax"], max_steps=2)
+
+        # The processes make the same syscalls, despite their different data
+        self.assertEqual(result.outcome, "max_steps")
+        self.assertEqual(d1.syscall_number, d2.syscall_number)
+        self.assertEqual(result.first.registers["orig_rax"], d1.syscall_number)
+
+        with self.assertRaises(ValueError):
+            lockstep(d1, d2, registers=["xyz"])
+
+        with self.assertRaises(ValueError):
+            lockstep(d1, d2, mode="forever")
+
+        d1.kill()
+        d2.kill()
+        d1.terminate()
+        d2.terminate()
@@ -0,0 +1,94 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import ctypes
+import unittest
+
+from libdebug import debugger
+
+
+class StopState(ctypes.Structure):
+    _fields_ = [("sum", ctypes.c_uint64), ("stop_at", ctypes.c_uint64), ("return_address", ctypes.c_uint64)]
+
+
+class NativeCallbackTest(unittest.TestCase):
+    def setUp(self):
+        self.callbacks = ctypes.CDLL("binaries/native_callback_test.so")
+
+    def test_native_callback_resume(self):
+        total = ctypes.c_uint64(0)
+
+        d = debugger("binaries/benchmark")
+        d.run()
+
+        bp = d.breakpoint("f", native_callback=self.callbacks.sum_argument, native_data=total)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(bp.hit_count, 100000)
+        self.assertEqual(total.value, sum(range(100000)))
+
+        d.kill()
+
+    def test_native_callback_stop(self):
+        state = StopState(stop_at=1234)
+
+        d = debugger("binaries/benchmark")
+        d.run()
+
+        bp = d.breakpoint("f", native_callback=self.callbacks.stop_on_argument, native_data=ctypes.pointer(state))
+
+        d.cont()
+        d.wait()
+
+        self.assertTrue(bp.hit_on(d))
+        self.assertEqual(d.regs.rip, bp.address)
+        self.assertEqual(d.regs.rdi, 1234)
+        self.assertEqual(bp.hit_count, 1235)
+        self.assertEqual(state.sum, sum(range(1235)))
+        self.assertEqual(state.return_address, int.from_bytes(d.memory[d.regs.rsp, 8], "little"))
+
+        # The native callback keeps running once disabled and enabled again
+        bp.disable()
+        d.step()
+        bp.enable()
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(bp.hit_count, 100000)
+        self.assertEqual(state.sum, sum(range(100000)))
+
+        d.kill()
+
+    def test_native_callback_moves_thread(self):
+        skipped = ctypes.c_uint64(0)
+
+        d = debugger("binaries/benchmark")
+        d.run()
+
+        bp = d.breakpoint("f", native_callback=self.callbacks.skip_function, native_data=skipped)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(skipped.value, 100000)
+        self.assertEqual(bp.hit_count, 100000)
+
+        d.kill()
+
+    def test_native_callback_validation(self):
+        d = debugger("binaries/benchmark")
+        d.run()
+
+        with self.assertRaises(ValueError):
+            d.breakpoint("f", hardware=True, native_callback=self.callbacks.sum_argument)
+
+        with self.assertRaises(ValueError):
+            d.breakpoint("f", callback=lambda _, __: None, native_callback=self.callbacks.sum_argument)
+
+        d.kill()
@@ -0,0 +1,133 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import gzip
+import os
+import tempfile
+import unittest
+
+from libdebug import debugger
+
+
+class ProfilerTest(unittest.TestCase):
+    def test_profiler_folded(self):
+        d = debugger("binaries/profiler_test")
+
+        d.run()
+
+        profiler = d.profile(frequency=1000)
+
+        d.cont()
+        d.wait()
+        d.kill()
+
+        stats = profiler.stats()
+        self.assertGreater(stats.samples, 50)
+        self.assertGreater(stats.requested, 0)
+
+        counts = {}
+        for line in profiler.folded().splitlines():
+            stack, count = line.rsplit(" ", 1)
+            counts[stack] = int(count)
+
+        hot = sum(count for stack, count in counts.items() if "main;hot;spin" in stack)
+        cold = sum(count for stack, count in counts.items() if "main;cold;spin" in stack)
+
+        # The hot function spins three times as long as the cold one
+        self.assertGreater(hot, cold * 2)
+        self.assertGreater(cold, 0)
+
+        # Almost every sample was taken while spinning
+        self.assertGreater(hot + cold, stats.samples * 0.9)
+
+        self.assertTrue(profiler.folded(threads=True).startswith(f"thread-{d.pid}"))
+
+    def test_profiler_pprof(self):
+        d = debugger("binaries/profiler_test")
+
+        d.run()
+
+        profiler = d.profile(frequency=500, max_depth=2)
+
+        d.cont()
+        d.wait()
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "profile.pb.gz")
+            profiler.write_pprof(path)
+
+            with open(path, "rb") as file:
+                data = gzip.decompress(file.read())
+
+        self.assertIn(b"hot", data)
+        self.assertIn(b"cold", data)
+        self.assertIn(b"nanoseconds", data)
+
+        self.assertTrue(all(len(stack.frames) <= 2 for stack in profiler.stacks()))
+        self.assertGreater(profiler.stats().truncated, 0)
+
+        d.kill()
+
+    def test_profiler_breakpoints(self):
+        d = debugger("binaries/profiler_test")
+
+        d.run()
+
+        profiler = d.profile(frequency=2000)
+        bp = d.breakpoint("cold", hardware=False)
+
+        for _ in range(100):
+            d.cont()
+            d.wait()
+            self.assertEqual(d.regs.rip, bp.address)
+
+        self.assertEqual(bp.hit_count, 100)
+
+        bp.disable()
+        profiler.disable()
+        samples = profiler.stats().samples
+        self.assertGreater(samples, 0)
+
+        profiler.reset()
+        self.assertEqual(profiler.stats().samples, 0)
+        self.assertEqual(profiler.stacks(), [])
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(profiler.stats().samples, 0)
+
+        d.kill()
+
+
+    def test_profiler_steps(self):
+        d = debugger("binaries/profiler_test")
+
+        d.run()
+
+        profiler = d.profile(frequency=5000)
+        bp = d.breakpoint("cold", hardware=False)
+
+        # The requests whose stop is swallowed by the steps must not block the sampling
+        for _ in range(20):
+            d.cont()
+            d.wait()
+            self.assertEqual(d.regs.rip, bp.address)
+
+            d.step_until("main", max_steps=200)
+
+        bp.disable()
+        samples = profiler.stats().samples
+
+        d.cont()
+        d.wait()
+
+        self.assertGreater(profiler.stats().samples, samples + 10)
+
+        d.kill()
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,129 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import sys
+import unittest
+
+from libdebug import debugger
+
+NESTED_SCRIPT = """
+import os
+
+def inner(n):
+    if n:
+        return inner(n - 1)
+    return os.getppid()
+
+class Outer:
+    def method(self):
+        return inner(2)
+
+Outer().method()
+"""
+
+THREADED_SCRIPT = """
+import os
+import threading
+
+def worker():
+    os.getppid()
+
+thread = threading.Thread(target=worker)
+thread.start()
+thread.join()
+"""
+
+
+@unittest.skipIf(sys.version_info < (3, 11), "The frame walker requires CPython 3.11+")
+class PythonFramesTest(unittest.TestCase):
+    def test_python_backtrace(self):
+        d = debugger([sys.executable, "-c", NESTED_SCRIPT])
+
+        d.run()
+
+        bp = d.breakpoint("getppid", file="libc", hardware=False)
+
+        d.cont()
+        d.wait()
+
+        self.assertTrue(bp.hit_on(d))
+
+        frames = d.python_backtrace()
+
+        self.assertEqual(
+            [frame.function for frame in frames],
+            ["inner", "inner", "inner", "Outer.method", "<module>"],
+        )
+        self.assertEqual([frame.line for frame in frames], [7, 6, 6, 11, 13])
+        self.assertTrue(all(frame.filename == "<string>" for frame in frames))
+
+        # The whole script runs in a single call to the evaluation loop
+        self.assertTrue(frames[-1].entry)
+        self.assertFalse(any(frame.entry for frame in frames[:-1]))
+        self.assertEqual(len({frame.frame_address for frame in frames}), 5)
+
+        d.kill()
+
+    def test_python_backtrace_merged(self):
+        d = debugger([sys.executable, "-c", NESTED_SCRIPT])
+
+        d.run()
+
+        d.breakpoint("getppid", file="libc", hardware=False)
+
+        d.cont()
+        d.wait()
+
+        backtrace = d.backtrace(as_symbols=True, python=True)
+
+        self.assertEqual(backtrace[0], "getppid+0")
+        self.assertIn("inner (<string>:7)", backtrace)
+        self.assertIn("<module> (<string>:13)", backtrace)
+
+        # The Python frames are in the same order as the native ones
+        self.assertLess(backtrace.index("inner (<string>:7)"), backtrace.index("<module> (<string>:13)"))
+
+        # Without the Python frames, the backtrace is unchanged
+        self.assertNotIn("inner (<string>:7)", d.backtrace(as_symbols=True))
+
+        d.kill()
+
+    def test_python_backtrace_threads(self):
+        d = debugger([sys.executable, "-c", THREADED_SCRIPT])
+
+        d.run()
+
+        bp = d.breakpoint("getppid", file="libc", hardware=False)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(len(d.threads), 2)
+
+        worker = next(thread for thread in d.threads if bp.hit_on(thread))
+        main = next(thread for thread in d.threads if thread is not worker)
+
+        self.assertEqual(worker.python_backtrace()[0].function, "worker")
+        self.assertEqual(worker.python_backtrace()[0].line, 6)
+        self.assertEqual(main.python_backtrace()[-1].function, "<module>")
+        # The main thread is either still starting the worker or already joining it
+        self.assertIn(main.python_backtrace()[-1].line, [9, 10])
+
+        d.kill()
+
+    def test_python_backtrace_not_python(self):
+        d = debugger("binaries/basic_test")
+
+        d.run()
+
+        with self.assertRaises(ValueError):
+            d.python_backtrace()
+
+        d.kill()
+
+
+if __name__ == "__main__":
+    unittest.main()
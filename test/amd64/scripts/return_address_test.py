@@ -0,0 +1,147 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class ReturnAddressTest(unittest.TestCase):
+    def test_return_address_clean_run(self):
+        d = debugger("binaries/return_address_test")
+
+        r = d.run()
+
+        monitor = d.monitor_return_addresses(canary=True)
+
+        self.assertIn("fibonacci", monitor.functions.values())
+        self.assertIn("main", monitor.functions.values())
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"55")
+
+        d.wait()
+
+        self.assertEqual(monitor.hit_count, 0)
+        self.assertEqual(monitor.violations, [])
+
+        d.kill()
+        d.terminate()
+
+    def test_return_address_hijack(self):
+        d = debugger(["binaries/return_address_test", "hijack"])
+
+        r = d.run()
+
+        monitor = d.monitor_return_addresses()
+        functions = {name: address for address, name in monitor.functions.items()}
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"55")
+
+        d.wait()
+
+        self.assertEqual(monitor.hit_count, 1)
+        self.assertTrue(monitor.hit_on(d))
+
+        violation = monitor.last_violation
+        self.assertFalse(violation.canary)
+        self.assertEqual(violation.function, "overwrite_return_address")
+        self.assertEqual(violation.function_address, functions["overwrite_return_address"])
+        self.assertEqual(violation.actual, functions["hijacked"])
+        self.assertEqual(violation.address, d.regs.rip)
+        self.assertEqual(violation.slot, d.regs.rsp)
+        self.assertEqual(d.memory[d.regs.rip, 1], b"\xc3")
+
+        # The saved value belongs to main
+        self.assertGreater(violation.expected, functions["main"])
+        self.assertEqual(int.from_bytes(d.memory[violation.slot, 8], "little"), functions["hijacked"])
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"hijacked")
+
+        d.kill()
+        d.terminate()
+
+    def test_return_address_callback(self):
+        d = debugger(["binaries/return_address_test", "hijack"])
+
+        r = d.run()
+
+        violations = []
+
+        def callback(t, violation):
+            violations.append((t.regs.rip, violation))
+
+            # Repair the frame
+            d.memory[violation.slot, 8] = violation.expected.to_bytes(8, "little")
+
+        monitor = d.monitor_return_addresses(["overwrite_return_address"], callback=callback)
+
+        self.assertEqual(list(monitor.functions.values()), ["overwrite_return_address"])
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"55")
+        self.assertEqual(r.recvline(), b"done")
+
+        d.kill()
+        d.terminate()
+
+        self.assertEqual(len(violations), 1)
+        self.assertEqual(violations[0][0], violations[0][1].address)
+        self.assertEqual(monitor.hit_count, 1)
+
+    def test_return_address_disable(self):
+        d = debugger(["binaries/return_address_test", "hijack"])
+
+        r = d.run()
+
+        monitor = d.monitor_return_addresses()
+        monitor.disable()
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"55")
+        self.assertEqual(r.recvline(), b"hijacked")
+
+        d.kill()
+        d.terminate()
+
+        self.assertEqual(monitor.hit_count, 0)
+
+    def test_return_address_canary(self):
+        d = debugger(["binaries/return_address_test", "smash", "64"])
+
+        r = d.run()
+
+        monitor = d.monitor_return_addresses(canary=True)
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"55")
+
+        d.wait()
+
+        self.assertEqual(monitor.hit_count, 1)
+
+        violation = monitor.last_violation
+        self.assertTrue(violation.canary)
+        self.assertEqual(violation.function, "smash_canary")
+        self.assertEqual(violation.actual, 0x4141414141414141)
+        self.assertNotEqual(violation.expected, violation.actual)
+        self.assertEqual(int.from_bytes(d.memory[violation.slot, 8], "little"), violation.actual)
+        self.assertEqual(d.regs.rip, violation.address)
+
+        d.kill()
+        d.terminate()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -56,6 +56,31 @@ class SpeedTest(unittest.TestCase):
 
         self.assertTrue((end_time - start_time) < 15 * 1e9)  # 15 seconds
 
+    def test_speed_registers(self):
+        d = self.d
+
+        d.run()
+
+        bp = d.breakpoint("do_nothing")
+
+        d.cont()
+
+        self.assertTrue(bp.address == d.regs.rip)
+
+        start_time = perf_counter_ns()
+
+        for i in range(65536):
+            d.regs.rax = i
+            self.assertTrue(d.regs.rax == i)
+            d.regs.eax = i
+            self.assertTrue(d.regs.eax == i)
+
+        end_time = perf_counter_ns()
+
+        d.kill()
+
+        self.assertTrue((end_time - start_time) < 0.5 * 1e9)  # 0.5 seconds, about 2 us per access
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,126 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import os
+import unittest
+
+from libdebug import debugger
+
+
+class SyscallInjectionTest(unittest.TestCase):
+    def test_inject_syscall(self):
+        d = debugger("binaries/breakpoint_test")
+
+        d.run()
+
+        bp = d.breakpoint("random_function")
+
+        rip, rax, rcx, r11 = d.regs.rip, d.regs.rax, d.regs.rcx, d.regs.r11
+
+        self.assertEqual(d.syscall("getpid"), d.pid)
+        self.assertEqual(d.syscall(110), os.getpid())
+
+        # The syscall instruction of the vDSO is used, instead of patching one
+        self.assertNotEqual(d._internal_debugger._syscall_gadget, 0)
+
+        # The state of the thread is restored
+        self.assertEqual(d.regs.rip, rip)
+        self.assertEqual(d.regs.rax, rax)
+        self.assertEqual(d.regs.rcx, rcx)
+        self.assertEqual(d.regs.r11, r11)
+
+        # The errors are returned as negative values
+        self.assertEqual(d.syscall("close", 1000), -9 & 0xFFFFFFFFFFFFFFFF)
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(d.regs.rip, bp.address)
+
+        d.kill()
+        d.terminate()
+
+    def test_inject_syscall_patched(self):
+        d = debugger("binaries/breakpoint_test")
+
+        d.run()
+
+        # Without a gadget, the syscall instruction is patched over the current instruction
+        d._internal_debugger._syscall_gadget = 0
+
+        rip = d.regs.rip
+        code = d.memory.read(rip, 8)
+
+        self.assertEqual(d.syscall("getpid"), d.pid)
+
+        self.assertEqual(d.regs.rip, rip)
+        self.assertEqual(d.memory.read(rip, 8), code)
+
+        bp = d.breakpoint("random_function")
+
+        d.cont()
+        d.wait()
+
+        self.assertEqual(d.regs.rip, bp.address)
+
+        d.kill()
+        d.terminate()
+
+    def test_inject_syscall_callback(self):
+        d = debugger("binaries/breakpoint_test")
+
+        r = d.run()
+
+        pids = []
+
+        def callback(t, _):
+            pids.append(t.syscall("getpid"))
+
+        d.breakpoint("random_function", callback=callback)
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"Provola")
+        self.assertEqual(r.recvline(), b"Random function")
+
+        d.kill()
+
+        self.assertEqual(pids, [d.pid])
+
+        d.terminate()
+
+    def test_alloc(self):
+        d = debugger("binaries/breakpoint_test")
+
+        d.run()
+
+        first = d.alloc(100)
+        second = d.alloc(8)
+
+        # The allocations are carved out of the same arena
+        self.assertEqual(second, first + 112)
+
+        d.memory[first, 16, "absolute"] = b"libdebug scratch"
+        self.assertEqual(d.memory[first, 16, "absolute"], b"libdebug scratch")
+
+        code = d.alloc(16, "rwx")
+        large = d.alloc(0x20000)
+
+        def find_map(address):
+            return next(vmap for vmap in d.maps() if vmap.start <= address < vmap.end)
+
+        self.assertEqual(find_map(first).permissions[:3], "rw-")
+        self.assertEqual(find_map(code).permissions[:3], "rwx")
+        self.assertGreaterEqual(find_map(large).end - large, 0x20000)
+
+        with self.assertRaises(ValueError):
+            d.alloc(16, "rwz")
+
+        with self.assertRaises(ValueError):
+            d.alloc(0)
+
+        d.kill()
+        d.terminate()
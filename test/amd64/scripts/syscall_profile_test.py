@@ -0,0 +1,99 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class SyscallProfileTest(unittest.TestCase):
+    def test_syscall_profile(self):
+        d = debugger("binaries/syscall_profile_test")
+
+        r = d.run()
+
+        profiler = d.profile_syscalls(call_sites=True)
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"done")
+
+        d.kill()
+
+        stats = d.syscall_stats()
+        by_name = {entry.syscall: entry for entry in stats}
+
+        # The syscalls that took the most time come first
+        self.assertEqual(stats, sorted(stats, key=lambda entry: entry.total_time, reverse=True))
+
+        self.assertEqual(by_name["getppid"].count, 20)
+        self.assertEqual(by_name["close"].count, 3)
+        self.assertEqual(by_name["close"].errors, 3)
+
+        nanosleep = by_name["nanosleep"] if "nanosleep" in by_name else by_name["clock_nanosleep"]
+        self.assertEqual(nanosleep.count, 5)
+        self.assertEqual(sum(nanosleep.histogram), 5)
+        self.assertGreaterEqual(nanosleep.min_time, 0.002)
+        self.assertGreaterEqual(nanosleep.percentile(50), 0.002)
+        self.assertLessEqual(nanosleep.percentile(100), nanosleep.max_time)
+        self.assertAlmostEqual(nanosleep.mean_time, nanosleep.total_time / 5)
+
+        # The calls of each thread are kept apart
+        per_thread = [entry for entry in d.syscall_stats(per_thread=True) if entry.syscall == "getppid"]
+        self.assertEqual(sorted(entry.count for entry in per_thread), [4, 16])
+        self.assertEqual(len({entry.thread_id for entry in per_thread}), 2)
+
+        # The libc wrapper of getppid and the generic syscall function are two call sites
+        per_call_site = [entry for entry in profiler.stats(per_call_site=True) if entry.syscall == "getppid"]
+        self.assertEqual(sorted(entry.count for entry in per_call_site), [6, 14])
+        self.assertTrue(all(entry.call_site is not None for entry in per_call_site))
+
+        self.assertIs(d.syscall_profiler, profiler)
+
+        d.terminate()
+
+    def test_syscall_profile_handlers(self):
+        d = debugger("binaries/syscall_profile_test")
+
+        r = d.run()
+
+        with self.assertRaises(RuntimeError):
+            d.syscall_stats()
+
+        entered = []
+
+        def on_enter_getppid(t, _):
+            entered.append(t.thread_id)
+
+        # The handlers keep seeing the syscalls
+        d.handle_syscall("getppid", on_enter=on_enter_getppid)
+
+        profiler = d.profile_syscalls()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+        d.wait()
+
+        getppid = next(entry for entry in d.syscall_stats() if entry.syscall == "getppid")
+        self.assertEqual(getppid.count, 16)
+        self.assertEqual(getppid.call_site, None)
+        self.assertEqual(len(entered), 16)
+
+        # Nothing is measured once the profiler is disabled
+        profiler.reset()
+        profiler.disable()
+
+        d.cont()
+
+        self.assertEqual(r.recvline(), b"done")
+
+        d.kill()
+
+        self.assertEqual(d.syscall_stats(), [])
+        self.assertEqual(len(entered), 20)
+
+        d.terminate()
@@ -0,0 +1,86 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import unittest
+
+from libdebug import debugger
+
+
+class ThreadBreakpointTest(unittest.TestCase):
+    def setUp(self):
+        self.d = debugger("binaries/attach_threads_test")
+
+        r = self.d.run()
+
+        self.d.cont()
+        r.recvuntil(b"ready")
+        self.d.interrupt()
+
+        # The first threads are the workers calling tick
+        self.worker = self.d.threads[5]
+
+    def tearDown(self):
+        self.d.kill()
+        self.d.terminate()
+
+    def hit_threads(self, bp, count):
+        hits = []
+
+        for _ in range(count):
+            self.d.cont()
+            self.d.wait()
+
+            hits.extend(thread.thread_id for thread in self.d.threads if thread.regs.rip == bp.address)
+
+        return hits
+
+    def test_software_breakpoint(self):
+        bp = self.d.breakpoint("tick", threads=[self.worker.thread_id])
+
+        self.assertEqual(bp.threads, [self.worker.thread_id])
+
+        hits = self.hit_threads(bp, 10)
+
+        self.assertEqual(hits, [self.worker.thread_id] * 10)
+        self.assertEqual(bp.hit_count, 10)
+
+    def test_hardware_breakpoint(self):
+        bp = self.d.breakpoint("tick", hardware=True, threads=[self.worker])
+
+        hits = self.hit_threads(bp, 10)
+
+        self.assertEqual(hits, [self.worker.thread_id] * 10)
+        self.assertEqual(bp.hit_count, 10)
+
+    def test_callback(self):
+        other = self.d.threads[10]
+        callers = []
+
+        def callback(t, _):
+            callers.append(t.thread_id)
+
+        bp = self.d.breakpoint("tick", callback=callback, threads=[self.worker, other])
+
+        self.d.cont()
+
+        while len(callers) < 100:
+            pass
+
+        self.d.interrupt()
+
+        self.assertEqual(set(callers), {self.worker.thread_id, other.thread_id})
+        self.assertEqual(bp.hit_count, len(callers))
+
+    def test_invalid_threads(self):
+        with self.assertRaises(ValueError):
+            self.d.breakpoint("tick", threads=[])
+
+        with self.assertRaises(ValueError):
+            self.d.breakpoint("tick", threads=[0x7FFFFFFF])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,118 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import importlib.util
+import unittest
+
+from libdebug import debugger
+
+
+class TypedMemoryTest(unittest.TestCase):
+    def test_typed_struct(self):
+        d = debugger("binaries/typed_memory_test")
+
+        d.run()
+
+        bp = d.breakpoint("checkpoint")
+
+        d.cont()
+
+        self.assertTrue(bp.hit_on(d))
+
+        record = d.memory.typed("global_record", "record_t")
+
+        self.assertEqual(record.type.size, 104)
+        self.assertEqual(record.name.string(), b"libdebug")
+        self.assertEqual(record.id, 0xBEEF)
+        self.assertEqual(record.weight, 2.5)
+        self.assertEqual(record.origin.x, -7)
+        self.assertEqual(record.origin.y, 9)
+        self.assertEqual([point.y for point in record.path], [0, 1, 4])
+        self.assertEqual(record.path[-1].x, 2)
+        self.assertEqual(record.color, -1)
+        self.assertEqual(record.type.resolved.member("color").type.enumerators[record.color], "BLUE")
+
+        # Bit-fields and members of anonymous unions
+        self.assertEqual(record.flags, 5)
+        self.assertEqual(record.delta, -3)
+        self.assertEqual(record.as_float, 1.5)
+
+        # The decoded value reads nothing more from memory
+        value = record.to_python()
+        self.assertEqual(value["origin"], {"x": -7, "y": 9})
+        self.assertEqual(value["path"][2], {"x": 2, "y": 4})
+        self.assertEqual(value["as_int"], 0x3FC00000)
+        self.assertEqual(value["numbers"], d.memory.typed("numbers", "int[5]").address)
+
+        d.kill()
+
+    def test_typed_pointers(self):
+        d = debugger("binaries/typed_memory_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+
+        record = d.memory.typed("global_record", "struct record")
+
+        # Pointers are followed on member access
+        self.assertEqual(record.list.value, 100)
+        self.assertEqual(record.list.next.value, 200)
+        self.assertEqual(record.list.next.next.value, 300)
+        self.assertFalse(record.list.next.next.next)
+
+        with self.assertRaises(ValueError):
+            record.list.next.next.next.value
+
+        self.assertEqual(record.numbers[3], 40)
+        self.assertEqual(record.numbers.deref(5).to_python(), [10, 20, 30, 40, 50])
+        self.assertEqual(record.label.string(), b"typed memory")
+
+        d.kill()
+
+    def test_typed_arrays(self):
+        d = debugger("binaries/typed_memory_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+
+        numbers = d.memory.typed("numbers", "int", count=5)
+        self.assertEqual(len(numbers), 5)
+        self.assertEqual(list(numbers), [10, 20, 30, 40, 50])
+        self.assertEqual(numbers[1:3], [20, 30])
+
+        grid = d.memory.typed("grid", "struct point[2][3]")
+        self.assertEqual(str(grid.type), "struct point[2][3]")
+        self.assertEqual(grid.type.size, 48)
+        self.assertEqual([[(point.x, point.y) for point in row] for row in grid], [[(i, j) for j in range(3)] for i in range(2)])
+
+        path = d.memory.typed(d.memory.typed("global_record", "record_t").path.address, "struct point", count=3)
+        self.assertEqual(path.to_python(), [{"x": i, "y": i * i} for i in range(3)])
+
+        with self.assertRaises(ValueError):
+            d.memory.typed("numbers", "struct missing")
+
+        d.kill()
+
+    @unittest.skipUnless(importlib.util.find_spec("numpy"), "numpy is not installed")
+    def test_typed_numpy(self):
+        d = debugger("binaries/typed_memory_test")
+
+        d.run()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+
+        path = d.memory.typed("global_record", "record_t").path.to_numpy()
+        self.assertEqual(list(path["y"]), [0, 1, 4])
+
+        d.kill()
@@ -0,0 +1,101 @@
+#
+# This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+# Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+# Licensed under the MIT license. See LICENSE file in the project root for details.
+#
+
+import time
+import unittest
+
+from libdebug import debugger
+
+
+class VirtualTimeTest(unittest.TestCase):
+    def test_virtual_time(self):
+        d = debugger("binaries/virtual_time_test")
+
+        r = d.run()
+
+        clock = d.virtual_time()
+
+        start = time.monotonic()
+
+        d.cont()
+
+        # Every clock of the process saw the 200 seconds pass
+        monotonic, wall, seconds = (int(r.recvline()) for _ in range(3))
+
+        d.kill()
+
+        self.assertLess(time.monotonic() - start, 10)
+
+        self.assertEqual(monotonic, 200)
+        self.assertIn(wall, (199, 200, 201))
+        self.assertIn(seconds, (199, 200, 201))
+
+        stats = clock.stats()
+        self.assertEqual(stats.sleeps, 4)
+        self.assertGreaterEqual(stats.clock_reads, 6)
+        self.assertAlmostEqual(stats.offset, 200, delta=1)
+
+        self.assertIs(d.virtual_clock, clock)
+
+        d.terminate()
+
+    def test_virtual_time_handlers(self):
+        d = debugger("binaries/virtual_time_test")
+
+        r = d.run()
+
+        sleeps = []
+
+        def on_enter_clock_nanosleep(t, _):
+            sleeps.append(t.syscall_arg1)
+
+        # The syscall stops are reported to the handlers as well
+        d.handle_syscall("clock_nanosleep", on_enter=on_enter_clock_nanosleep)
+
+        clock = d.virtual_time()
+
+        d.breakpoint("checkpoint")
+
+        d.cont()
+        d.wait()
+
+        # The process can be moved forward in time while it is stopped
+        clock.advance(1000)
+
+        d.cont()
+
+        monotonic, wall, seconds = (int(r.recvline()) for _ in range(3))
+
+        d.kill()
+
+        self.assertEqual(monotonic, 1200)
+        self.assertIn(wall, (1199, 1200, 1201))
+        self.assertEqual(sleeps, [0, 1])
+
+        d.terminate()
+
+    def test_virtual_time_vdso(self):
+        d = debugger("binaries/virtual_time_test")
+
+        d.run()
+
+        vdso = next(vmap for vmap in d.maps() if vmap.backing_file == "[vdso]")
+        code = d.memory.read(vdso.start, vdso.size)
+
+        clock = d.virtual_time()
+
+        # The clock functions of the vDSO are replaced by the syscalls
+        self.assertNotEqual(d.memory.read(vdso.start, vdso.size), code)
+
+        clock.disable()
+
+        self.assertEqual(d.memory.read(vdso.start, vdso.size), code)
+
+        with self.assertRaises(RuntimeError):
+            d.virtual_time()
+
+        d.kill()
+        d.terminate()
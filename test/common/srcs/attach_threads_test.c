@@ -0,0 +1,70 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define WORKERS 32
+
+volatile int ticks[WORKERS];
+
+__attribute__((noinline)) void tick(int id)
+{
+    ticks[id]++;
+}
+
+void *worker(void *arg)
+{
+    int id = (int)(long)arg;
+
+    while (1) {
+        tick(id);
+        usleep(1000);
+    }
+
+    return NULL;
+}
+
+void *short_lived(void *arg)
+{
+    (void)arg;
+
+    return NULL;
+}
+
+void *spawner(void *arg)
+{
+    (void)arg;
+
+    // Threads are always being created and destroyed while the debugger attaches
+    while (1) {
+        pthread_t thread;
+
+        pthread_create(&thread, NULL, short_lived, NULL);
+        pthread_join(thread, NULL);
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    pthread_t threads[WORKERS + 1];
+
+    for (long i = 0; i < WORKERS; i++)
+        pthread_create(&threads[i], NULL, worker, (void *)i);
+
+    pthread_create(&threads[WORKERS], NULL, spawner, NULL);
+
+    printf("ready\n");
+    fflush(stdout);
+
+    for (int i = 0; i <= WORKERS; i++)
+        pthread_join(threads[i], NULL);
+
+    return 0;
+}
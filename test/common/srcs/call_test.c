@@ -0,0 +1,56 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+uint64_t counter = 0;
+
+// Decrypts the buffer in place with a rolling xor, returning the number of decrypted bytes
+__attribute__((noinline)) size_t decrypt(char *buffer, size_t size, uint8_t key)
+{
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] ^= key;
+        key = key * 31 + 7;
+    }
+
+    return size;
+}
+
+// Receives some of the arguments on the stack
+__attribute__((noinline)) uint64_t weighted_sum(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e,
+                                                uint64_t f, uint64_t g, uint64_t h, uint64_t i)
+{
+    return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h + 9 * i;
+}
+
+// Returns its result in a vector register
+__attribute__((noinline)) double average(uint64_t a, uint64_t b)
+{
+    return (a + b) / 2.0;
+}
+
+__attribute__((noinline)) uint64_t increment(void)
+{
+    return ++counter;
+}
+
+__attribute__((noinline)) int crash(int *pointer)
+{
+    return *pointer;
+}
+
+int main()
+{
+    char secret[] = "libdebug";
+
+    decrypt(secret, strlen(secret), 0x42);
+
+    printf("%lu %f\n", increment(), average(1, 2));
+
+    return 0;
+}
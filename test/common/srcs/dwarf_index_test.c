@@ -0,0 +1,29 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdio.h>
+
+// The local symbols are discarded from the symbol table, so these functions are only named by the debug info
+static __attribute__((noinline)) int indexed_square(int value)
+{
+    return value * value;
+}
+
+static __attribute__((noinline)) int indexed_sum(int count)
+{
+    int sum = 0;
+
+    for (int i = 0; i < count; i++)
+        sum += indexed_square(i);
+
+    return sum;
+}
+
+int main(void)
+{
+    printf("%d\n", indexed_sum(10));
+
+    return 0;
+}
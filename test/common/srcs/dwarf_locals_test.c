@@ -0,0 +1,47 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdio.h>
+
+struct pair
+{
+    int first;
+    int second;
+};
+
+void checkpoint(void)
+{
+    asm volatile("nop");
+}
+
+long compute(int count, long factor, const char *label)
+{
+    struct pair bounds = {count, count * 2};
+    double ratio = factor / 2.0;
+    long total = 0;
+
+    for (int i = 0; i < count; i++) {
+        long total = i * factor;
+
+        if (i == count - 1)
+            checkpoint();
+
+        bounds.second += total;
+    }
+
+    total = bounds.first + bounds.second;
+    checkpoint();
+
+    printf("%s: %ld %f\n", label, total, ratio);
+
+    return total;
+}
+
+int main()
+{
+    compute(4, 10, "result");
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+__attribute__((noinline)) void checkpoint(void)
+{
+    asm volatile("" ::: "memory");
+}
+
+int main(void)
+{
+    int pipe_fds[2];
+
+    int seeded = open("/dev/null", O_RDONLY);
+
+    checkpoint();
+
+    int file = open("/etc/passwd", O_RDONLY);
+    pipe(pipe_fds);
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    dup2(file, 40);
+    int copy = fcntl(sock, F_DUPFD, 50);
+
+    checkpoint();
+
+    close(file);
+    close(pipe_fds[0]);
+    close(copy);
+
+    checkpoint();
+
+    printf("%d %d %d %d\n", seeded, file, sock, copy);
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int __attribute__((noinline)) add(int a, int b)
+{
+    return a + b;
+}
+
+int __attribute__((noinline)) recurse(int n)
+{
+    if (n == 0) return 0;
+
+    return 1 + recurse(n - 1);
+}
+
+void *worker(void *arg)
+{
+    int sum = 0;
+
+    for (int i = 0; i < 100; i++)
+        sum = add(sum, (int)(long)arg);
+
+    return (void *)(long)sum;
+}
+
+int main()
+{
+    int sum = 0;
+
+    for (int i = 0; i < 10; i++) {
+        void *chunk = malloc((i + 1) * 16);
+        sum = add(sum, i);
+        free(chunk);
+    }
+
+    printf("%d %d\n", sum, recurse(5));
+
+    pthread_t threads[2];
+    void *results[2];
+
+    for (long i = 0; i < 2; i++)
+        pthread_create(&threads[i], NULL, worker, (void *)(i + 1));
+
+    for (int i = 0; i < 2; i++)
+        pthread_join(threads[i], &results[i]);
+
+    printf("%ld %ld\n", (long)results[0], (long)results[1]);
+
+    exit(0);
+}
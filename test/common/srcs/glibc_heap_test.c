@@ -0,0 +1,53 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHUNKS 100000
+
+void __attribute__((noinline)) checkpoint(void **pointers)
+{
+    printf("%p\n", (void *)pointers);
+}
+
+int main()
+{
+    void *small[10], *large[2], *guard[2];
+
+    // Seven chunks fill the tcache bin, the other three go to the fastbin
+    for (int i = 0; i < 10; i++)
+        small[i] = malloc(0x28);
+
+    large[0] = malloc(0x500);
+    guard[0] = malloc(0x18);
+    large[1] = malloc(0x500);
+    guard[1] = malloc(0x18);
+
+    for (int i = 0; i < 10; i++)
+        free(small[i]);
+
+    // Too large for the tcache, the chunk goes to the unsorted bin
+    free(large[0]);
+
+    checkpoint(small);
+
+    void **many = malloc(CHUNKS * sizeof(void *));
+
+    for (int i = 0; i < CHUNKS; i++)
+        many[i] = malloc(0x18);
+
+    checkpoint(many);
+
+    for (int i = 0; i < CHUNKS; i++)
+        free(many[i]);
+
+    free(many);
+    free(large[1]);
+    free(guard[0]);
+    free(guard[1]);
+
+    return 0;
+}
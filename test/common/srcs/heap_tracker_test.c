@@ -0,0 +1,43 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+void __attribute__((noinline)) checkpoint(char *pointer)
+{
+    printf("%p\n", pointer);
+}
+
+char * __attribute__((noinline)) leak(size_t size)
+{
+    return malloc(size);
+}
+
+int main()
+{
+    char *kept = leak(100);
+    char *freed = leak(200);
+    free(freed);
+
+    int *zeroed = calloc(4, 32);
+
+    char *grown = malloc(16);
+    grown = realloc(grown, 64);
+
+    char *large = malloc(1 << 20);
+    large[0] = 1;
+
+    void *mapping = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    checkpoint(kept + 10);
+
+    free(large);
+
+    printf("%p %p %p\n", (void *)zeroed, (void *)grown, mapping);
+
+    return 0;
+}
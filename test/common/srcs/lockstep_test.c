@@ -0,0 +1,47 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int seed;
+int table[64];
+
+__attribute__((noinline)) int compute(void)
+{
+    int accumulator = 0;
+
+    for (int i = 0; i < 64; i++) {
+        table[i] = i * i;
+
+        // The two runs only differ here, if their seeds differ
+        if (i == 40) table[i] += seed;
+
+        accumulator += table[i];
+    }
+
+    return accumulator;
+}
+
+__attribute__((noinline)) void checkpoint(void)
+{
+    asm volatile("" ::: "memory");
+}
+
+int main(int argc, char **argv)
+{
+    seed = argc > 1 ? atoi(argv[1]) : 0;
+
+    puts("ready");
+
+    int result = compute();
+
+    checkpoint();
+
+    printf("%d\n", result);
+
+    return 0;
+}
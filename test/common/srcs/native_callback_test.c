@@ -0,0 +1,55 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include "native_callback.h"
+
+struct stop_state {
+    uint64_t sum;
+    uint64_t stop_at;
+    uint64_t return_address;
+};
+
+// Sums the first argument of every call
+int sum_argument(struct libdebug_thread *thread, struct libdebug_memory *memory, void *user_data)
+{
+    (void) memory;
+
+    *(uint64_t *)user_data += thread->regs.rdi;
+
+    return LIBDEBUG_CALLBACK_RESUME;
+}
+
+// Stops on the call with the requested argument, saving its return address
+int stop_on_argument(struct libdebug_thread *thread, struct libdebug_memory *memory, void *user_data)
+{
+    struct stop_state *state = user_data;
+
+    state->sum += thread->regs.rdi;
+
+    if (thread->regs.rdi != state->stop_at)
+        return LIBDEBUG_CALLBACK_RESUME;
+
+    if (memory->read(memory, thread->regs.rsp, &state->return_address, sizeof(uint64_t)))
+        return LIBDEBUG_CALLBACK_RESUME;
+
+    return LIBDEBUG_CALLBACK_STOP;
+}
+
+// Returns immediately from the function, without executing it
+int skip_function(struct libdebug_thread *thread, struct libdebug_memory *memory, void *user_data)
+{
+    uint64_t return_address;
+
+    (*(uint64_t *)user_data)++;
+
+    if (memory->read(memory, thread->regs.rsp, &return_address, sizeof(uint64_t)))
+        return LIBDEBUG_CALLBACK_STOP;
+
+    thread->regs.rip = return_address;
+    thread->regs.rsp += sizeof(uint64_t);
+
+    return LIBDEBUG_CALLBACK_RESUME;
+}
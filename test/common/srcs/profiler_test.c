@@ -0,0 +1,36 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdio.h>
+
+volatile unsigned long sink;
+
+void spin(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; i++)
+        sink += i;
+}
+
+void hot(void)
+{
+    spin(300000);
+}
+
+void cold(void)
+{
+    spin(100000);
+}
+
+int main(void)
+{
+    for (int i = 0; i < 500; i++) {
+        hot();
+        cold();
+    }
+
+    printf("%lu\n", sink);
+
+    return 0;
+}
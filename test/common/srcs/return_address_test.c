@@ -0,0 +1,53 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void hijacked()
+{
+    puts("hijacked");
+    exit(0);
+}
+
+int fibonacci(int n)
+{
+    if (n < 2) return n;
+
+    return fibonacci(n - 1) + fibonacci(n - 2);
+}
+
+void overwrite_return_address()
+{
+    // The return address is right above the saved frame pointer
+    uintptr_t *slot = (uintptr_t *)__builtin_frame_address(0) + 1;
+    *slot = (uintptr_t)hijacked;
+}
+
+void smash_canary(size_t length)
+{
+    char buffer[16];
+
+    memset(buffer, 'A', length);
+    puts(buffer);
+}
+
+int main(int argc, char **argv)
+{
+    printf("%d\n", fibonacci(10));
+
+    if (argc < 2) return 0;
+
+    if (!strcmp(argv[1], "hijack"))
+        overwrite_return_address();
+    else if (!strcmp(argv[1], "smash"))
+        smash_canary(strtoul(argv[2], NULL, 10));
+
+    puts("done");
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main()
+{
+    // Never stops issuing syscalls
+    while (1)
+        syscall(SYS_getppid);
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+__attribute__((noinline)) void checkpoint(void)
+{
+    asm volatile("" ::: "memory");
+}
+
+void *worker(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < 4; i++) getppid();
+
+    return NULL;
+}
+
+int main(void)
+{
+    struct timespec delay = {0, 2000000};
+    pthread_t thread;
+
+    // The same syscall from two call sites
+    for (int i = 0; i < 10; i++) getppid();
+    for (int i = 0; i < 6; i++) syscall(SYS_getppid);
+
+    checkpoint();
+
+    for (int i = 0; i < 3; i++) close(-1);
+    for (int i = 0; i < 5; i++) nanosleep(&delay, NULL);
+
+    pthread_create(&thread, NULL, worker, NULL);
+    pthread_join(thread, NULL);
+
+    puts("done");
+
+    return 0;
+}
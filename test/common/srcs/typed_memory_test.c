@@ -0,0 +1,93 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+#include <stdlib.h>
+#include <string.h>
+
+enum color { RED = 1, GREEN = 2, BLUE = -1 };
+
+struct point
+{
+    int x;
+    int y;
+};
+
+struct node
+{
+    long value;
+    struct node *next;
+};
+
+struct record
+{
+    char name[16];
+    unsigned short id;
+    double weight;
+    struct point origin;
+    struct point path[3];
+    enum color color;
+    unsigned int flags : 3;
+    signed int delta : 5;
+    int *numbers;
+    struct node *list;
+    union
+    {
+        int as_int;
+        float as_float;
+    };
+    const char *label;
+};
+
+typedef struct record record_t;
+
+record_t global_record;
+int numbers[5] = {10, 20, 30, 40, 50};
+struct point grid[2][3];
+
+void checkpoint(void)
+{
+}
+
+int main()
+{
+    struct node *head = NULL;
+
+    for (long i = 3; i > 0; i--) {
+        struct node *node = malloc(sizeof(struct node));
+        node->value = i * 100;
+        node->next = head;
+        head = node;
+    }
+
+    strcpy(global_record.name, "libdebug");
+    global_record.id = 0xbeef;
+    global_record.weight = 2.5;
+    global_record.origin.x = -7;
+    global_record.origin.y = 9;
+
+    for (int i = 0; i < 3; i++) {
+        global_record.path[i].x = i;
+        global_record.path[i].y = i * i;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 3; j++) {
+            grid[i][j].x = i;
+            grid[i][j].y = j;
+        }
+    }
+
+    global_record.color = BLUE;
+    global_record.flags = 5;
+    global_record.delta = -3;
+    global_record.numbers = numbers;
+    global_record.list = head;
+    global_record.as_float = 1.5f;
+    global_record.label = "typed memory";
+
+    checkpoint();
+
+    return 0;
+}
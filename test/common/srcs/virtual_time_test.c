@@ -0,0 +1,48 @@
+//
+// This file is part of libdebug Python library (https://github.com/libdebug/libdebug).
+// Copyright (c) 2024 Roberto Alessandro Bertolini, Gabriele Digregorio. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for details.
+//
+
+#include <poll.h>
+#include <stdio.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+__attribute__((noinline)) void checkpoint(void)
+{
+    asm volatile("" ::: "memory");
+}
+
+int main(void)
+{
+    struct timespec start, end, deadline;
+    struct timeval wall_start, wall_end, timeout = {20, 0};
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    gettimeofday(&wall_start, NULL);
+    time_t seconds = time(NULL);
+
+    // 100 seconds of relative sleep, 50 of poll timeout and 20 of select timeout
+    sleep(100);
+    poll(NULL, 0, 50000);
+    select(0, NULL, NULL, NULL, &timeout);
+
+    // The remaining 30 seconds until an absolute deadline
+    deadline = start;
+    deadline.tv_sec += 200;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+    checkpoint();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    gettimeofday(&wall_end, NULL);
+
+    printf("%ld\n", (long)(end.tv_sec - start.tv_sec));
+    printf("%ld\n", (long)(wall_end.tv_sec - wall_start.tv_sec));
+    printf("%ld\n", (long)(time(NULL) - seconds));
+
+    return 0;
+}